@@ -1709,6 +1709,7 @@ static void RTLSMaster_processRtlsSrvMsg(rtlsSrv_evt_t *pEvt)
     {
       rtlsSrv_connectionIQReport_t *pReport = (rtlsSrv_connectionIQReport_t *)pEvt->evtData;
 
+      // RTLS Control takes iqSamples over, only the report itself is freed below
       RTLSAoa_processAoaResults(pReport->connHandle,
                                 pReport->rssi,
                                 pReport->dataChIndex,
@@ -50,11 +50,14 @@
 #include <ti/devices/DeviceFamily.h>
 
 #include <stdlib.h>
+#include <string.h>
 #include <complex.h>
 #include <math.h>
 
 #include "rf_hal.h"
 #include "AOA.h"
+#include "AOA_kernel.h"
+#include "AOA_rfRam.h"
 
 #include <ti/drivers/PIN.h>
 #include <ti/drivers/pin/PINCC26XX.h>
@@ -68,6 +71,7 @@
 #define AOA_OFFSET_FIRST_VALID_SAMPLE    8
 #define AOA_NUM_SAMPLES_PER_BLOCK        16
 #define AOA_SLOT_DURATION_1US            1
+#define AOA_SLOT_DURATION_2US            2
 
 #define AOA_CTEINFO_ADDR                 0x21000021
 #define AOA_CTE_TIME_ADDR                0x210000C7
@@ -78,32 +82,44 @@
 
 #define angleconst                       180/128
 
+// Pairs up to this much wider than half a wavelength still count as unambiguous
+#define AOA_ARRAY_SPACING_TOLERANCE      0.01f
+
+// Lags of the carrier frequency offset estimate within the reference period in us
+// The 1 us lag is unambiguous to +-250 kHz, the 4 us lag is one tone period and is 4 times finer
+#define AOA_CFO_COARSE_LAG_US            1
+#define AOA_CFO_FINE_LAG_US              4
+
+#define AOA_PI                           3.14159265358979323846f
+
+// Board frame direction of the A1 broadside, A2 is at right angles to it
+#define AOA_BOOSTXL_BROADSIDE_A1         45
+
+// Number of antennas the specialized angle kernels are built for
+#define AOA_SPEC_NUM_ANT                 BOOSTXL_AOA_NUM_ANT
+
+// AOA_iatan2sc scales its inputs by 32, phasors are shifted below this bound first.
+// AOA_atan2Fixed takes any int32.
+#if (AOA_ATAN_BITS == 0)
+#define AOA_ATAN_MAX_INPUT               (1 << 25)
+#else
+#define AOA_ATAN_MAX_INPUT               (1 << 30)
+#endif
+
+// Default pair angle averaging method, see AoA_AvgMode_t
+#ifndef AOA_AVG_MODE_DEFAULT
+#define AOA_AVG_MODE_DEFAULT             AOA_AVG_MODE_ANGLE
+#endif
+
 // Number of AoA reps to run
 #define AOA_NUM_REPS(x)                 (AOA_RES_MAX_SIZE / (x * AOA_NUM_SAMPLES_PER_BLOCK))
 
-// CTE RF registers
-#define RFC_CTE_MCE_RAM_DATA                           (RFC_RAM_BASE + 0x8000) //0x21008000
-#define RFC_CTE_RFE_RAM_DATA                           (RFC_RAM_BASE + 0xC000) //0x2100C000
-#define RFC_CTE_LAST_CAPTURE                           (RFC_RAM_BASE + 0x19)
-#define RFC_CTE_MCE_RAM_STATE                          (RFC_RAM_BASE + 0x1C)
+// CTE RF registers, the capture RAM ones are read by AOA_rfRam
 #define RFC_CTE_MCE_RX_CTEINFO                         (RFC_RAM_BASE + 0x1D)
 #define RFC_CTE_MCE_RF_GAIN                            (RFC_RAM_BASE + 0x1E)
-#define RFC_CTE_RFE_RAM_STATE                          (RFC_RAM_BASE + 0x20)
 #define RFC_CTE_RFE_RX_CTEINFO                         (RFC_RAM_BASE + 0x21)
 #define RFC_CTE_RFE_RF_GAIN                            (RFC_RAM_BASE + 0x22)
 
-// CTE RF ram types
-#define RFC_CTE_CAPTURE_RAM_MCE                        (0x00)
-#define RFC_CTE_CAPTURE_RAM_RFE                        (0x01)
-#define RFC_CTE_NO_CAPTURE                             (0xFF)
-
-// CTE RF ram states
-#define RFC_CTE_RAM_STATE_EMPTY                        (0x00)
-#define RFC_CTE_RAM_STATE_BUSY                         (0x01)
-#define RFC_CTE_RAM_STATE_DUAL_BUSY                    (0x02)
-#define RFC_CTE_RAM_STATE_READY                        (0x03)
-#define RFC_CTE_RAM_STATE_DUAL_READY                   (0x04)
-
 // RF FW write param command type
 #define RFC_FWPAR_ADDRESS_TYPE_BYTE                    (0x03)
 #define RFC_FWPAR_ADDRESS_TYPE_DWORD                   (0x00)
@@ -124,10 +140,56 @@
  * MACROS
  */
 
+// Template functions of the specialized kernels must be inlined into every instance
+#if defined(__GNUC__) || defined(__clang__) || defined(__TI_COMPILER_VERSION__)
+#define AOA_ALWAYS_INLINE                inline __attribute__((always_inline))
+#else
+#define AOA_ALWAYS_INLINE                inline
+#endif
+
+// Capture configurations with a specialized angle kernel: X(sampleSize, sampleRate, slotDuration)
+// The kernels are built for AOA_SPEC_NUM_ANT antennas. 16 bit captures are
+// narrowed by AOA_normalizeSamples first and run the AOA_NORM_SAMPLE_SIZE kernels.
+#define AOA_ANGLE_KERNEL_LIST(X)  \
+  X(1, 1, 1) X(1, 1, 2)           \
+  X(1, 2, 1) X(1, 2, 2)           \
+  X(1, 3, 1) X(1, 3, 2)           \
+  X(1, 4, 1) X(1, 4, 2)
+
 /*********************************************************************
  * TYPEDEFS
  */
 
+// Position of the switch slot samples within an IQ capture
+typedef struct
+{
+  uint16_t firstSample;     // Index of the first sample of repetition 0, antenna 0
+  uint16_t repStride;       // Samples between two repetitions of the pattern
+  uint16_t antStride;       // Samples between two antennas of one repetition
+  uint16_t numReps;         // Number of complete pattern repetitions
+  uint16_t refSamples;      // Samples of the reference period, from the start of the capture
+  uint8_t  refRate;         // Reference period samples per us
+  uint8_t  samplesPerSlot;  // Samples used from every slot
+  uint8_t  numAnt;          // Number of antennas in the pattern
+  uint8_t  slotLag;         // Lag of the tone rotation measured inside every slot, 0 for the reference period only
+} AoA_CaptureLayout_t;
+
+// Angle kernel specialized for one capture configuration, sums the angles of one pair over a capture
+typedef int32_t (*AoA_AngleKernel_t)(const int8_t *pIQ, uint16_t numReps, uint8_t a, uint8_t b, bool halfTurn);
+
+#ifdef RTLS_MASTER
+
+// Capture configuration an angle kernel was built for
+typedef struct
+{
+  uint8_t sampleSize;
+  uint8_t sampleRate;
+  uint8_t slotDuration;
+  uint8_t numAnt;
+  AoA_AngleKernel_t kernel;
+} AoA_AngleKernelEntry_t;
+#endif
+
 /*********************************************************************
  * LOCAL VARIABLES
  */
@@ -135,8 +197,20 @@
 // Pin Handle
 PIN_Handle gPinHandle = NULL;
 
+// Nominal tone rotation between the sample slots of a pair in half turns, by slot duration and pair
+// distance parity. Sample slots follow each other every 2 slot durations whatever the sample rate,
+// and the tone turns by a quarter period per us: half a turn per slot at 1 us, a whole turn at 2 us.
+static const uint8_t aoaPairHalfTurns[AOA_SLOT_DURATION_2US][2] =
+{
+  {0, 1},
+  {0, 0},
+};
+
 #ifdef RTLS_PASSIVE
 AoA_IQSample_Ext_t *gSamplesBuff = 0;
+
+// Sample size of gSamplesBuff, AOA_NORM_SAMPLE_SIZE once the capture was normalized
+uint8_t gSamplesSize = 2;
 #endif
 
 // Will be equal to 4*cteScanOvs
@@ -153,8 +227,13 @@ rfOpImmedCmd_ForceClkEnab_t enableRamCmd;
 // RF Handle
 extern RF_Handle urfiHandle;
 
-// Sample state for passive
-AoA_IQSampleState_t gSampleState = SAMPLES_NOT_READY;
+// Pair angle averaging method
+static AoA_AvgMode_t gAvgMode = AOA_AVG_MODE_DEFAULT;
+
+#ifdef RTLS_MASTER
+// Specialized angle kernel selected by AOA_selectKernel, NULL for the generic loop
+static const AoA_AngleKernelEntry_t *gpAngleKernel = NULL;
+#endif
 
 /*********************************************************************
  * LOCAL FUNCTIONS
@@ -162,8 +241,16 @@ AoA_IQSampleState_t gSampleState = SAMPLES_NOT_READY;
 int16_t AOA_iatan2sc(int32_t y, int32_t x);
 int32_t AOA_AngleComplexProductComp(int32_t Xre, int32_t Xim, int32_t Yre, int32_t Yim);
 bool AOA_initAntArray(uint8_t antArray[], uint8_t antArrLen);
-void AOA_rfEnableRam( uint16 selectedRam);
+void AOA_rfEnableRam(uint16 selectedRam, uint8_t seq);
 void AOA_getRfIqSamples(RF_Handle rfHandle, RF_CmdHandle cmdHandle, RF_EventMask events);
+static void AOA_getPairAnglesLayout(AoA_AntennaConfig_t *antConfig, AoA_AntennaResult_t *antResult, const AoA_CaptureLayout_t *layout, uint8_t sampleSize, uint8_t slotDuration, const int8_t *pIQ, AoA_AngleKernel_t kernel);
+static float AOA_getSlotRotation(const AoA_CaptureLayout_t *layout, uint8_t sampleSize, uint8_t slotDuration, const int8_t *pIQ);
+static bool AOA_screenCaptureLayout(const AoA_CaptureLayout_t *layout, uint16_t numSamples, uint8_t sampleSize, const int8_t *pIQ, const AoA_ScreenParams_t *pParams, AoA_CaptureQuality_t *pQuality);
+static void AOA_getPairAnglesPhasor(AoA_AntennaConfig_t *antConfig, AoA_AntennaResult_t *antResult, const AoA_CaptureLayout_t *layout, uint8_t sampleSize, uint8_t slotDuration, const int8_t *pIQ);
+static void AOA_capturePhasor(const AoA_CaptureLayout_t *layout, uint8_t sampleSize, const int8_t *pIQ, uint16_t offsetX, uint16_t offsetY, uint16_t numReps, AoA_Phasor_t *pAcc);
+static void AOA_slotEnergies(const AoA_CaptureLayout_t *layout, uint8_t sampleSize, const int8_t *pIQ, int64_t *pEnergy);
+static void AOA_pairQuality(const AoA_Phasor_t *pPairSum, int64_t energyA, int64_t energyB, AoA_PairQuality_t *pQuality);
+static bool AOA_getCovarianceLayout(const AoA_AntennaConfig_t *antConfig, const AoA_CaptureLayout_t *layout, uint8_t sampleSize, uint8_t slotDuration, const int8_t *pIQ, AoA_Covariance_t *pCov);
 
 /*********************************************************************
 * @fn      iat2
@@ -226,6 +313,30 @@ int16_t AOA_iatan2sc(int32_t y, int32_t x)
   }
 }
 
+/*********************************************************************
+* @fn      AOA_atan2Deg
+*
+* @brief   atan2 of the angle path, selected by AOA_ATAN_BITS
+*
+* @param   y, x - coordinates
+*
+* @return  angle in degrees
+*/
+static inline int16_t AOA_atan2Deg(int32_t y, int32_t x)
+{
+#if (AOA_ATAN_BITS == 0)
+  // Angle. The angle is returned in 256/2*pi format [-128,127] values
+  int16_t angle = AOA_iatan2sc(y, x);
+
+  return (angle * angleconst);
+#else
+  int64_t angle = AOA_atan2Fixed(y, x, AOA_ATAN_BITS);
+
+  // Round to the nearest degree
+  return (int16_t)((angle * 360 + (1 << (AOA_ATAN_BITS - 1))) >> AOA_ATAN_BITS);
+#endif
+}
+
 /*********************************************************************
 * @fn      AOA_angleComplexProductComp
 *
@@ -238,16 +349,72 @@ int16_t AOA_iatan2sc(int32_t y, int32_t x)
 int32_t AOA_AngleComplexProductComp(int32_t Xre, int32_t Xim, int32_t Yre, int32_t Yim)
 {
   int32_t Zre, Zim;
-  int16_t angle;
 
   // X*conj(Y)
   Zre = Xre*Yre + Xim*Yim;
   Zim = Xim*Yre - Xre*Yim;
 
-  // Angle. The angle is returned in 256/2*pi format [-128,127] values
-  angle = AOA_iatan2sc((int32_t) Zim, (int32_t) Zre);
+  return AOA_atan2Deg((int32_t) Zim, (int32_t) Zre);
+}
 
-  return (angle * angleconst);
+/*********************************************************************
+* @fn      AOA_phasorAngle
+*
+* @brief   Angle of an accumulated phasor
+*
+* @param   re, im - real and imaginary part of the phasor
+*
+* @return  angle in degrees
+*/
+static int16_t AOA_phasorAngle(int64_t re, int64_t im)
+{
+  // Only the ratio matters, scale down into the range the atan2 can handle
+  while (re >= AOA_ATAN_MAX_INPUT || re <= -AOA_ATAN_MAX_INPUT ||
+         im >= AOA_ATAN_MAX_INPUT || im <= -AOA_ATAN_MAX_INPUT)
+  {
+    re >>= 1;
+    im >>= 1;
+  }
+
+  return AOA_atan2Deg((int32_t) im, (int32_t) re);
+}
+
+/*********************************************************************
+* @fn      AOA_wrapAngle
+*
+* @brief   Keep an angle on the circle
+*
+* @param   angle - angle in degrees
+*
+* @return  angle in (-180, 180]
+*/
+static int32_t AOA_wrapAngle(int32_t angle)
+{
+  while (angle > 180)
+  {
+    angle -= 360;
+  }
+
+  while (angle <= -180)
+  {
+    angle += 360;
+  }
+
+  return angle;
+}
+
+/*********************************************************************
+* @fn      AOA_setAvgMode
+*
+* @brief   Select how AOA_getPairAngles averages pair angles
+*
+* @param   avgMode - AOA_AVG_MODE_ANGLE/AOA_AVG_MODE_PHASOR
+*
+* @return  none
+*/
+void AOA_setAvgMode(AoA_AvgMode_t avgMode)
+{
+  gAvgMode = avgMode;
 }
 
 /*********************************************************************
@@ -327,307 +494,1414 @@ void AOA_init(uint8_t startAntenna)
 #endif
 }
 
-#ifdef RTLS_PASSIVE
 /*********************************************************************
-* @fn      AOA_getPairAngles
+* @fn      AOA_readSample
 *
-* @brief   Extract results and estimates an angle between two antennas
+* @brief   Read one IQ sample, sampleSize is a constant in the kernels
 *
-* @param   antConfig - antenna configuration provided from antenna files
-* @param   antResult - struct to write results into
+* @param   pIQ - pointer to IQ samples
+* @param   sampleSize - sample size 1 = 8 bit, 2 = 16 bit
+* @param   idx - sample index
+* @param   pI, pQ - returned I and Q
 *
 * @return  none
 */
-void AOA_getPairAngles(AoA_AntennaConfig_t *antConfig, AoA_AntennaResult_t *antResult)
+static AOA_ALWAYS_INLINE void AOA_readSample(const int8_t *pIQ, const uint8_t sampleSize, uint16_t idx, int32_t *pI, int32_t *pQ)
 {
-  const uint16_t numReps = AOA_NUM_REPS(antConfig->numAntennas);
-  const uint8_t numAnt = antConfig->numAntennas;
-  const uint8_t numPairs = antConfig->numPairs;
+  if (sampleSize == 1)
+  {
+    *pI = ((const AoA_IQSample_t *)pIQ)[idx].i;
+    *pQ = ((const AoA_IQSample_t *)pIQ)[idx].q;
+  }
+  else
+  {
+    *pI = ((const AoA_IQSample_Ext_t *)pIQ)[idx].i;
+    *pQ = ((const AoA_IQSample_Ext_t *)pIQ)[idx].q;
+  }
+}
+
+/*********************************************************************
+* @fn      AOA_pairHalfTurn
+*
+* @brief   Whether the tone turns by half a period between the sample slots of a pair
+*
+* @param   slotDuration - slot duration 1 = 1us, 2 = 2us
+* @param   distance - pattern slots between the two slots of the pair
+*
+* @return  TRUE if the second slot is to be turned by half a period
+*/
+static inline bool AOA_pairHalfTurn(uint8_t slotDuration, int8_t distance)
+{
+  if ((slotDuration < AOA_SLOT_DURATION_1US) || (slotDuration > AOA_SLOT_DURATION_2US))
+  {
+    return FALSE;
+  }
+
+  return aoaPairHalfTurns[slotDuration - 1][abs(distance) & 1];
+}
 
-  // Average relative angle across repetitions
-  int32_t antenna_versus_avg[6][6] = {0};
-  int32_t antenna_versus_cnt[6][6] = {0};
+/*********************************************************************
+* @fn      AOA_angleLoop
+*
+* @brief   Sum of the angles of one antenna pair over a capture, for one nominal rotation
+*
+* @param   pIQ - pointer to IQ samples
+* @param   numReps - number of complete pattern repetitions
+* @param   a, b - pattern slots of the pair
+* @param   halfTurn - turn the samples of slot b by half a period, a constant in every loop
+* @param   sampleSize - sample size 1 = 8 bit, 2 = 16 bit
+* @param   firstSample - index of the first sample of repetition 0, slot 0
+* @param   antStride - samples between two slots of one repetition
+* @param   samplesPerSlot - samples used from every slot
+* @param   numAnt - number of slots in the pattern
+*
+* @return  sum of the pair angles
+*/
+static AOA_ALWAYS_INLINE int32_t AOA_angleLoop(const int8_t *pIQ, uint16_t numReps, uint8_t a, uint8_t b, const bool halfTurn,
+                                               const uint8_t sampleSize, const uint16_t firstSample, const uint16_t antStride,
+                                               const uint8_t samplesPerSlot, const uint8_t numAnt)
+{
+  const uint16_t repStride = numAnt * antStride;
+  uint16_t baseA = firstSample + a * antStride;
+  uint16_t baseB = firstSample + b * antStride;
+  int32_t sum = 0;
 
-  for (uint16_t r = 1; r < numReps; ++r)
+  for (uint16_t r = 0; r < numReps; ++r, baseA += repStride, baseB += repStride) // Sample Slot
   {
-    for (uint16_t i = AOA_OFFSET_FIRST_VALID_SAMPLE; i < AOA_NUM_VALID_SAMPLES + AOA_OFFSET_FIRST_VALID_SAMPLE; ++i)
+    for (uint8_t i = 0; i < samplesPerSlot; ++i) // Sample inside Sample Slot
     {
-      // Loop through antenna pairs and calculate phase difference
-      for (uint8_t pair = 0; pair < numPairs; ++pair)
+      int32_t Xre, Xim, Bre, Bim;
+
+      AOA_readSample(pIQ, sampleSize, baseA + i, &Xre, &Xim);
+      AOA_readSample(pIQ, sampleSize, baseB + i, &Bre, &Bim);
+
+      // Phase difference between antenna a vs. antenna b, taken near 0 so the angles of the sum do not wrap
+      if (halfTurn)
+      {
+        sum += AOA_AngleComplexProductComp(Xre, Xim, -Bre, -Bim);
+      }
+      else
       {
-        const AoA_AntennaPair_t *p = &antConfig->pairs[pair];
-        uint8_t a = p->a; // First antenna in pair
-        uint8_t b = p->b; // Second antenna in pair
-
-        // Calculate the phase drift across one antenna repetition (X * complex conjugate (Y))
-        int16_t Paa_rel = AOA_AngleComplexProductComp(gSamplesBuff[32 + r*numAnt*AOA_NUM_SAMPLES_PER_BLOCK     + a*AOA_NUM_SAMPLES_PER_BLOCK + i].i,
-                                                      gSamplesBuff[32 + r*numAnt*AOA_NUM_SAMPLES_PER_BLOCK     + a*AOA_NUM_SAMPLES_PER_BLOCK + i].q,
-                                                      gSamplesBuff[32 + (r-1)*numAnt*AOA_NUM_SAMPLES_PER_BLOCK + a*AOA_NUM_SAMPLES_PER_BLOCK + i].i,
-                                                      gSamplesBuff[32 + (r-1)*numAnt*AOA_NUM_SAMPLES_PER_BLOCK + a*AOA_NUM_SAMPLES_PER_BLOCK + i].q);
-
-        // Calculate phase difference between antenna a vs. antenna b
-        int16_t Pab_rel = AOA_AngleComplexProductComp(gSamplesBuff[32 + r*numAnt*AOA_NUM_SAMPLES_PER_BLOCK + a*AOA_NUM_SAMPLES_PER_BLOCK + i].i,
-                                                      gSamplesBuff[32 + r*numAnt*AOA_NUM_SAMPLES_PER_BLOCK + a*AOA_NUM_SAMPLES_PER_BLOCK + i].q,
-                                                      gSamplesBuff[32 + r*numAnt*AOA_NUM_SAMPLES_PER_BLOCK + b*AOA_NUM_SAMPLES_PER_BLOCK + i].i,
-                                                      gSamplesBuff[32 + r*numAnt*AOA_NUM_SAMPLES_PER_BLOCK + b*AOA_NUM_SAMPLES_PER_BLOCK + i].q);
-
-        // Add to averages
-        // v-- Correct for angle drift / ADC sampling frequency error
-        antenna_versus_avg[a][b] += Pab_rel + ((Paa_rel * abs(a-b)) / numAnt);
-        antenna_versus_cnt[a][b] ++;
+        sum += AOA_AngleComplexProductComp(Xre, Xim, Bre, Bim);
       }
     }
   }
 
-  // Calculate the average relative angles
-  for (int i = 0; i < numAnt; ++i)
-  {
-    for (int j = 0; j < numAnt; ++j)
-    {
-      antenna_versus_avg[i][j] /= antenna_versus_cnt[i][j];
-    }
-  }
+  return sum;
+}
 
-  // Write back result for antenna pairs
-  for (uint8_t pair = 0; pair < numPairs; ++pair)
+/*********************************************************************
+* @fn      AOA_angleKernel
+*
+* @brief   Sum of the angles of one antenna pair over a capture
+*
+*          Template of the angle kernels. The specialized kernels pass the
+*          capture configuration as constants, AOA_angleSumGeneric passes
+*          the layout of the capture. The repetition base index is advanced
+*          by a constant stride. The nominal rotation between the slots is
+*          chosen once per pair, each loop is built for one of them. The
+*          carrier frequency offset is corrected once per pair by the caller.
+*
+* @param   pIQ - pointer to IQ samples
+* @param   numReps - number of complete pattern repetitions
+* @param   a, b - pattern slots of the pair
+* @param   halfTurn - turn the samples of slot b by half a period
+* @param   sampleSize - sample size 1 = 8 bit, 2 = 16 bit
+* @param   firstSample - index of the first sample of repetition 0, slot 0
+* @param   antStride - samples between two slots of one repetition
+* @param   samplesPerSlot - samples used from every slot
+* @param   numAnt - number of slots in the pattern
+*
+* @return  sum of the pair angles
+*/
+static AOA_ALWAYS_INLINE int32_t AOA_angleKernel(const int8_t *pIQ, uint16_t numReps, uint8_t a, uint8_t b, bool halfTurn,
+                                                 const uint8_t sampleSize, const uint16_t firstSample, const uint16_t antStride,
+                                                 const uint8_t samplesPerSlot, const uint8_t numAnt)
+{
+  if (halfTurn)
   {
-    AoA_AntennaPair_t *p = &antConfig->pairs[pair];
-    antResult->pairAngle[pair] = (int)((p->sign * antenna_versus_avg[p->a][p->b] + p->offset) * p->gain);
+    return AOA_angleLoop(pIQ, numReps, a, b, TRUE, sampleSize, firstSample, antStride, samplesPerSlot, numAnt);
   }
+
+  return AOA_angleLoop(pIQ, numReps, a, b, FALSE, sampleSize, firstSample, antStride, samplesPerSlot, numAnt);
 }
-#elif RTLS_MASTER
+
 /*********************************************************************
-* @fn      AOA_getPairAngles
+* @fn      AOA_angleSumGeneric
 *
-* @brief   Extract results and estimates an angle between two antennas
+* @brief   AOA_angleKernel for any capture layout
 *
-* @param   antConfig - antenna configuration provided from antenna files
+* @param   layout - position of the slot samples in the capture
+* @param   sampleSize - sample size 1 = 8 bit, 2 = 16 bit
+* @param   pIQ - pointer to IQ samples
+* @param   a, b - pattern slots of the pair
+* @param   halfTurn - turn the samples of slot b by half a period
+*
+* @return  sum of the pair angles
+*/
+static int32_t AOA_angleSumGeneric(const AoA_CaptureLayout_t *layout, uint8_t sampleSize, const int8_t *pIQ, uint8_t a, uint8_t b, bool halfTurn)
+{
+  return AOA_angleKernel(pIQ, layout->numReps, a, b, halfTurn,
+                         sampleSize, layout->firstSample, layout->antStride, layout->samplesPerSlot, layout->numAnt);
+}
+
+/*********************************************************************
+* @fn      AOA_getPairAnglesLayout
+*
+* @brief   Average the pair angles of a capture, one pair after the other
+*
+*          Only one accumulator is live at a time, the cost grows linearly
+*          with the number of pairs and no storage depends on the array size.
+*
+* @param   antConfig - antenna configuration
 * @param   antResult - struct to write results into
-* @param   numIqSamples - number of I and Q samples
-* @param   sampleRate - sample rate that was used to capture (1,2,3 or 4 Mhz)
+* @param   layout - position of the slot samples in the capture
 * @param   sampleSize - sample size 1 = 8 bit, 2 = 16 bit
-* @param   numAnt - number of antennas in capture array
+* @param   slotDuration - slot duration 1 = 1us, 2 = 2us
 * @param   pIQ - pointer to IQ samples
+* @param   kernel - angle kernel specialized for this capture, NULL for the generic loop
 *
 * @return  none
 */
-void AOA_getPairAngles(AoA_AntennaConfig_t *antConfig, AoA_AntennaResult_t *antResult, uint16_t numIqSamples, uint8_t sampleRate, uint8_t sampleSize, uint8_t slotDuration, uint8_t numAnt, int8_t *pIQ)
+static void AOA_getPairAnglesLayout(AoA_AntennaConfig_t *antConfig, AoA_AntennaResult_t *antResult, const AoA_CaptureLayout_t *layout,
+                                    uint8_t sampleSize, uint8_t slotDuration, const int8_t *pIQ, AoA_AngleKernel_t kernel)
 {
-  // IQ Samples can be 32 bit per sample or 16 bit per sample (where each sample is normalized to 8 bits)
-  AoA_IQSample_Ext_t *pIQExt;
-  AoA_IQSample_t *pIQNorm;
-
-  int16_t Paa_rel;
-  int16_t Pab_rel;
-  int8_t  secondIQfactor = 1; // in slot duration of 1 usec, there are 180 degrees between adjacent antennas samples so the factor will be -1
+  const uint8_t numPairs = antConfig->numPairs;
+  const int32_t samplesPerPair = layout->numReps * layout->samplesPerSlot;
+  const float slotRotation = AOA_getSlotRotation(layout, sampleSize, slotDuration, pIQ) * RadToDeg;
+  int64_t energy[AOA_MAX_NUM_ANT];
 
-  uint8_t numPairs = antConfig->numPairs;
+  antResult->numSamples = samplesPerPair;
 
-  // Average relative angle across repetitions
-  int32_t antenna_versus_avg[6][6] = {0};
-  int32_t antenna_versus_cnt[6][6] = {0};
+  // The angle sums hold no magnitudes, the spread takes one phasor pass per pair
+  if (antResult->pPairQuality != NULL)
+  {
+    AOA_slotEnergies(layout, sampleSize, pIQ, energy);
+  }
 
-  for (uint16_t r = 1; r < (numIqSamples - (AOA_OFFSET_FIRST_VALID_SAMPLE*sampleRate))/(numAnt*sampleRate) ; ++r) // Sample Slot
+  for (uint8_t pair = 0; pair < numPairs; ++pair)
   {
-    for (uint16_t i = 0; i < sampleRate; ++i) // Sample inside Sample Slot
+    const AoA_AntennaPair_t *p = &antConfig->pairs[pair];
+    // In slot duration of 1 usec, there are 180 degrees between samples of slots at odd distance,
+    // because the antenna switch is in the middle of the sine wave period
+    const bool halfTurn = AOA_pairHalfTurn(slotDuration, p->b - p->a);
+    int32_t sum;
+    int32_t angle;
+
+    if (kernel != NULL)
     {
-      // Loop through antenna pairs and calculate phase difference
-      for (uint8_t pair = 0; pair < numPairs; ++pair)
-      {
-        const AoA_AntennaPair_t *p = &antConfig->pairs[pair];
-        uint8_t a = p->a; // First antenna in pair
-        uint8_t b = p->b; // Second antenna in pair
-
-        // In slot duration of 1 usec, there are 180 degrees between adjacent antennas samples
-        if (slotDuration == AOA_SLOT_DURATION_1US)
-        {
-          if ((abs(a-b) % 2) == 1)
-          {
-            secondIQfactor = -1; // in slot duration of 1 usec, there are 180 degrees between adjacent antennas samples,
-                                 // because the antenna switch is in the middle of the sine wave period
-          }
-        }
-
-        if (sampleSize == 1)
-        {
-          pIQNorm = (AoA_IQSample_t *)pIQ;
-
-          // Calculate the phase drift across one antenna repetition (X * complex conjugate (Y))
-          Paa_rel = AOA_AngleComplexProductComp(pIQNorm[AOA_OFFSET_FIRST_VALID_SAMPLE*sampleRate + r*numAnt*sampleRate + a*sampleRate + i].i,
-                                                pIQNorm[AOA_OFFSET_FIRST_VALID_SAMPLE*sampleRate + r*numAnt*sampleRate + a*sampleRate + i].q,
-                                                pIQNorm[AOA_OFFSET_FIRST_VALID_SAMPLE*sampleRate + (r-1)*numAnt*sampleRate + a*sampleRate + i].i * secondIQfactor,
-                                                pIQNorm[AOA_OFFSET_FIRST_VALID_SAMPLE*sampleRate + (r-1)*numAnt*sampleRate + a*sampleRate + i].q * secondIQfactor);
-
-          // Calculate phase difference between antenna a vs. antenna b
-          Pab_rel = AOA_AngleComplexProductComp(pIQNorm[AOA_OFFSET_FIRST_VALID_SAMPLE*sampleRate + r*numAnt*sampleRate + a*sampleRate + i].i,
-                                                pIQNorm[AOA_OFFSET_FIRST_VALID_SAMPLE*sampleRate + r*numAnt*sampleRate + a*sampleRate + i].q,
-                                                pIQNorm[AOA_OFFSET_FIRST_VALID_SAMPLE*sampleRate + r*numAnt*sampleRate + b*sampleRate + i].i * secondIQfactor,
-                                                pIQNorm[AOA_OFFSET_FIRST_VALID_SAMPLE*sampleRate + r*numAnt*sampleRate + b*sampleRate + i].q * secondIQfactor);
-        }
-        else // sampleSize == 2
-        {
-          pIQExt = (AoA_IQSample_Ext_t *)pIQ;
-
-          // Calculate the phase drift across one antenna repetition (X * complex conjugate (Y))
-          Paa_rel = AOA_AngleComplexProductComp(pIQExt[AOA_OFFSET_FIRST_VALID_SAMPLE*sampleRate + r*numAnt*sampleRate + a*sampleRate + i].i,
-                                                pIQExt[AOA_OFFSET_FIRST_VALID_SAMPLE*sampleRate + r*numAnt*sampleRate + a*sampleRate + i].q,
-                                                pIQExt[AOA_OFFSET_FIRST_VALID_SAMPLE*sampleRate + (r-1)*numAnt*sampleRate + a*sampleRate + i].i * secondIQfactor,
-                                                pIQExt[AOA_OFFSET_FIRST_VALID_SAMPLE*sampleRate + (r-1)*numAnt*sampleRate + a*sampleRate + i].q * secondIQfactor);
-
-          // Calculate phase difference between antenna a vs. antenna b
-          Pab_rel = AOA_AngleComplexProductComp(pIQExt[AOA_OFFSET_FIRST_VALID_SAMPLE*sampleRate + r*numAnt*sampleRate + a*sampleRate + i].i,
-                                                pIQExt[AOA_OFFSET_FIRST_VALID_SAMPLE*sampleRate + r*numAnt*sampleRate + a*sampleRate + i].q,
-                                                pIQExt[AOA_OFFSET_FIRST_VALID_SAMPLE*sampleRate + r*numAnt*sampleRate + b*sampleRate + i].i * secondIQfactor,
-                                                pIQExt[AOA_OFFSET_FIRST_VALID_SAMPLE*sampleRate + r*numAnt*sampleRate + b*sampleRate + i].q * secondIQfactor);
-        }
-
-
-        // Add to averages
-        // v-- Correct for angle drift / ADC sampling frequency error
-        antenna_versus_avg[a][b] += Pab_rel + ((Paa_rel * abs(a-b)) / numAnt);
-        antenna_versus_cnt[a][b] ++;
-      }
+      sum = kernel(pIQ, layout->numReps, p->a, p->b, halfTurn);
+    }
+    else
+    {
+      sum = AOA_angleSumGeneric(layout, sampleSize, pIQ, p->a, p->b, halfTurn);
     }
-  }
 
-  // Calculate the average relative angles
-  for (int i = 0; i < numAnt; ++i)
-  {
-    for (int j = 0; j < numAnt; ++j)
+    // Average relative angle across repetitions
+    if (samplesPerPair != 0)
     {
-      antenna_versus_avg[i][j] /= antenna_versus_cnt[i][j];
+      sum /= samplesPerPair;
     }
-  }
 
-  // Write back result for antenna pairs
-  for (uint8_t pair = 0; pair < numPairs; ++pair)
-  {
-    AoA_AntennaPair_t *p = &antConfig->pairs[pair];
-    antResult->pairAngle[pair] = (int)((p->sign * antenna_versus_avg[p->a][p->b] + p->offset) * p->gain);
+    // v-- Correct for the carrier frequency offset between the two slots
+    angle = AOA_wrapAngle(sum + (int32_t)lroundf(slotRotation * (p->b - p->a)));
+
+    // Write back result for antenna pair
+    antResult->pairAngle[pair] = ((p->sign * angle + p->offset) * (int32_t)p->gain) / AOA_PAIR_GAIN_ONE;
+
+    if (antResult->pPairQuality != NULL)
+    {
+      AoA_Phasor_t pairSum = {0};
+
+      AOA_capturePhasor(layout, sampleSize, pIQ, p->a * layout->antStride, p->b * layout->antStride, layout->numReps, &pairSum);
+      AOA_pairQuality(&pairSum, energy[p->a], energy[p->b], &antResult->pPairQuality[pair]);
+    }
   }
 }
-#endif
 
+#ifdef RTLS_PASSIVE
 /*********************************************************************
-* @fn      AOA_postProcess
+* @fn      AOA_getCaptureLayout
 *
-* @brief   This function will update the final result report with rssi and channel
-*          For RTLS Passive it will also send a command to enable RF RAM so we can read
-*          the samples that we captured (if any)
+* @brief   Position of the slot samples in a passive capture
 *
-* @param   rssi - rssi to be stamped on final result
-* @param   channel - channel to be stamped on final result
-* @param   samplesBuff - buffer to copy samples to
+* @param   layout - layout to fill
+* @param   numAnt - number of antennas in capture array
 *
+* @return  none
 */
-void AOA_postProcess(int8_t rssi, uint8_t channel, AoA_IQSample_Ext_t *samplesBuff)
+static void AOA_getCaptureLayout(AoA_CaptureLayout_t *layout, uint8_t numAnt)
 {
-#ifdef RTLS_PASSIVE
-  gSamplesBuff = samplesBuff;
-  AOA_rfEnableRam(RFC_FORCE_CLK_ENA_RAM_RFE);
-#endif
+  // Passive captures 2 us slots, the valid samples are in the second half of every block
+  layout->firstSample    = 32 + AOA_OFFSET_FIRST_VALID_SAMPLE;
+  layout->repStride      = numAnt * AOA_NUM_SAMPLES_PER_BLOCK;
+  layout->antStride      = AOA_NUM_SAMPLES_PER_BLOCK;
+  layout->numReps        = AOA_NUM_REPS(numAnt);
+  layout->refSamples     = 32;
+  layout->refRate        = AOA_NUM_SAMPLES_PER_BLOCK / 4;   // A block is a 2 us switch slot and a 2 us sample slot
+  layout->samplesPerSlot = AOA_NUM_VALID_SAMPLES;
+  layout->numAnt         = numAnt;
+  layout->slotLag        = 0;
 }
 
-#ifdef RTLS_PASSIVE
 /*********************************************************************
-* @fn      AOA_getRawSamples
+* @fn      AOA_getCovariance
 *
-* @brief   Returns pointer to raw I/Q samples
+* @brief   Estimate the array covariance of the last capture
 *
-* @param   none
+* @param   antConfig - antenna configuration provided from antenna files
+* @param   pCov - covariance to write, sized for antConfig->numElements
 *
-* @return  Pointer to raw I/Q samples
+* @return  TRUE if the capture held a usable signal
 */
-AoA_IQSample_Ext_t * AOA_getRawSamples(void)
+bool AOA_getCovariance(AoA_AntennaConfig_t *antConfig, AoA_Covariance_t *pCov)
 {
-  return gSamplesBuff;
-}
-#endif
+  AoA_CaptureLayout_t layout;
 
-/*******************************************************************************
- * @fn          AOA_getSampleState
- *
- * @brief       Used to check if samples are ready
- *
- * input parameters
- *
- * @param       none
- *
- * output parameters
- *
- * @param       None.
- *
- * @return      State of samples
- */
-AoA_IQSampleState_t AOA_getSampleState(void)
-{
-  return gSampleState;
+  AOA_getCaptureLayout(&layout, antConfig->numAntennas);
+
+  return AOA_getCovarianceLayout(antConfig, &layout, gSamplesSize, 2, (const int8_t *)gSamplesBuff, pCov);
 }
 
-#ifdef RTLS_PASSIVE
-/*******************************************************************************
- * @fn          AOA_rfEnableRam
- *
- * @brief       This function is used to force enable or disable MCE RAM, RFE RAM or both
- *
- * input parameters
- *
- * @param       selectedRam - as the following bitmask values:
- *              RFC_FORCE_CLK_ENA_RAM_MCE - to enable MCE ram
- *              RFC_FORCE_CLK_ENA_RAM_RFE - to enable RFE ram
- *              or
- *              RFC_FORCE_CLK_DIS_RAM - to disable
- *
- * output parameters
- *
- * @param       None.
- *
- * @return      None
- */
-void AOA_rfEnableRam(uint16 selectedRam)
+/*********************************************************************
+* @fn      AOA_getPairAngles
+*
+* @brief   Extract results and estimates an angle between two antennas
+*
+* @param   antConfig - antenna configuration provided from antenna files
+* @param   antResult - struct to write results into
+*
+* @return  none
+*/
+void AOA_getPairAngles(AoA_AntennaConfig_t *antConfig, AoA_AntennaResult_t *antResult)
 {
-  RF_ScheduleCmdParams cmdParams = {
-    0,
-    RF_StartNotSpecified,
-    RF_AllowDelayAny,
-    0,
-    RF_EndNotSpecified,
-    0,
-    0,
-    RF_PriorityCoexDefault
-  };
+  AoA_CaptureLayout_t layout;
 
-  enableRamCmd.cmdNum = CMD_FORCE_CLK_ENA;
-  enableRamCmd.clkEnab = selectedRam;
+  AOA_getCaptureLayout(&layout, antConfig->numAntennas);
 
-  // setup radio command to run an immediate command
-  runEnableRamCmd.rfOpCmd.cmdNum    = CMD_RUN_IMMEDIATE_COMMAND;
-  runEnableRamCmd.rfOpCmd.status    = RFSTAT_IDLE;
-  runEnableRamCmd.rfOpCmd.pNextRfOp = (rfOpCmd_t *)NULL;
-  runEnableRamCmd.rfOpCmd.startTime = 0;
-  runEnableRamCmd.rfOpCmd.startTrig = TRIGTYPE_NOW;
-  runEnableRamCmd.rfOpCmd.condition = CONDTYPE_ALWAYS_RUN_NEXT_CMD;
-  runEnableRamCmd.reserved          = 0;
-  runEnableRamCmd.cmdVal            = (uint32)&enableRamCmd;
-  runEnableRamCmd.cmdStatVal        = 0;
+  if (gAvgMode == AOA_AVG_MODE_PHASOR)
+  {
+    AOA_getPairAnglesPhasor(antConfig, antResult, &layout, gSamplesSize, 2, (const int8_t *)gSamplesBuff);
+    return;
+  }
 
-  RF_scheduleCmd( urfiHandle,
-                 (RF_Op *)&runEnableRamCmd,
-                 &cmdParams,
-                 (RF_Callback)AOA_getRfIqSamples,
-                 RF_EventCmdDone | RF_EventInternalError );
+  AOA_getPairAnglesLayout(antConfig, antResult, &layout, gSamplesSize, 2, (const int8_t *)gSamplesBuff, NULL);
 }
 
-/*******************************************************************************
- * @fn          AOA_getRfIqSamples
- *
- * @brief       This callback is used to get the IQ samples from RF RAM
- *
- * input parameters
+/*********************************************************************
+* @fn      AOA_normalizeSamples
+*
+* @brief   Normalize the last capture to 8 bit samples with a block exponent
+*
+* @return  block exponent the samples were shifted right by
+*/
+uint8_t AOA_normalizeSamples(void)
+{
+  uint8_t shift;
+
+  if (gSamplesSize != 2)
+  {
+    return 0;
+  }
+
+  shift = AOA_blockExponent(gSamplesBuff, AOA_RES_MAX_SIZE);
+  AOA_narrowSamples(gSamplesBuff, (AoA_IQSample_t *)gSamplesBuff, AOA_RES_MAX_SIZE, shift);
+  gSamplesSize = AOA_NORM_SAMPLE_SIZE;
+
+  return shift;
+}
+
+/*********************************************************************
+* @fn      AOA_screenCapture
+*
+* @brief   Measure the last capture and check it against the limits of a usable capture
+*
+* @param   pParams - limits of a usable capture
+* @param   pQuality - measures of the capture
+*
+* @return  TRUE if the capture is usable
+*/
+bool AOA_screenCapture(const AoA_ScreenParams_t *pParams, AoA_CaptureQuality_t *pQuality)
+{
+  AoA_CaptureLayout_t layout;
+
+  // The reference period does not depend on the pattern
+  AOA_getCaptureLayout(&layout, 1);
+
+  return AOA_screenCaptureLayout(&layout, AOA_RES_MAX_SIZE, gSamplesSize, (const int8_t *)gSamplesBuff, pParams, pQuality);
+}
+#elif RTLS_MASTER
+/*********************************************************************
+* @fn      AOA_getCaptureLayout
+*
+* @brief   Position of the slot samples in a master capture
+*
+* @param   layout - layout to fill
+* @param   numIqSamples - number of I and Q samples
+* @param   sampleRate - sample rate that was used to capture (1,2,3 or 4 Mhz)
+* @param   numAnt - number of antennas in capture array
+*
+* @return  none
+*/
+static void AOA_getCaptureLayout(AoA_CaptureLayout_t *layout, uint16_t numIqSamples, uint8_t sampleRate, uint8_t numAnt)
+{
+  layout->firstSample    = AOA_OFFSET_FIRST_VALID_SAMPLE * sampleRate;
+  layout->repStride      = numAnt * sampleRate;
+  layout->antStride      = sampleRate;
+  layout->numReps        = 0;
+  layout->refSamples     = 0;
+  layout->refRate        = sampleRate;
+  layout->samplesPerSlot = sampleRate;
+  layout->numAnt         = numAnt;
+  layout->slotLag        = 0;
+
+  // The reference period holds no switch slots
+  if (numIqSamples > layout->firstSample)
+  {
+    layout->refSamples = layout->firstSample;
+    layout->numReps = (numIqSamples - layout->firstSample) / layout->repStride;
+  }
+}
+
+/*********************************************************************
+* @fn      AOA_getCovariance
+*
+* @brief   Estimate the array covariance of a capture
+*
+* @param   antConfig - antenna configuration
+* @param   pCov - covariance to write, sized for antConfig->numElements
+* @param   numIqSamples - number of I and Q samples
+* @param   sampleRate - sample rate that was used to capture (1,2,3 or 4 Mhz)
+* @param   sampleSize - sample size 1 = 8 bit, 2 = 16 bit
+* @param   slotDuration - slot duration 1 = 1us, 2 = 2us
+* @param   numAnt - number of antennas in capture array
+* @param   pIQ - pointer to IQ samples
+*
+* @return  TRUE if the capture held a usable signal
+*/
+bool AOA_getCovariance(AoA_AntennaConfig_t *antConfig, AoA_Covariance_t *pCov, uint16_t numIqSamples, uint8_t sampleRate, uint8_t sampleSize, uint8_t slotDuration, uint8_t numAnt, int8_t *pIQ)
+{
+  AoA_CaptureLayout_t layout;
+
+  AOA_getCaptureLayout(&layout, numIqSamples, sampleRate, numAnt);
+
+  return AOA_getCovarianceLayout(antConfig, &layout, sampleSize, slotDuration, pIQ, pCov);
+}
+
+// One instance of AOA_angleKernel per entry of AOA_ANGLE_KERNEL_LIST
+#define AOA_ANGLE_KERNEL_DEFINE(size, rate, slot)                                                             \
+static int32_t AOA_angleKernel_s##size##_r##rate##_d##slot(const int8_t *pIQ, uint16_t numReps, uint8_t a,     \
+                                                           uint8_t b, bool halfTurn)                          \
+{                                                                                                             \
+  return AOA_angleKernel(pIQ, numReps, a, b, halfTurn,                                                        \
+                         size, AOA_OFFSET_FIRST_VALID_SAMPLE * rate, rate, rate, AOA_SPEC_NUM_ANT);           \
+}
+
+#define AOA_ANGLE_KERNEL_ENTRY(size, rate, slot) \
+  {size, rate, slot, AOA_SPEC_NUM_ANT, AOA_angleKernel_s##size##_r##rate##_d##slot},
+
+AOA_ANGLE_KERNEL_LIST(AOA_ANGLE_KERNEL_DEFINE)
+
+// Dispatch table searched by AOA_selectKernel
+static const AoA_AngleKernelEntry_t aoaAngleKernels[] =
+{
+  AOA_ANGLE_KERNEL_LIST(AOA_ANGLE_KERNEL_ENTRY)
+};
+
+/*********************************************************************
+* @fn      AOA_selectKernel
+*
+* @brief   Select the specialized angle kernel for a capture configuration
+*
+* @param   sampleRate - sample rate that will be used to capture (1,2,3 or 4 Mhz)
+* @param   sampleSize - sample size 1 = 8 bit, 2 = 16 bit
+* @param   slotDuration - slot duration 1 = 1us, 2 = 2us
+* @param   numAnt - number of antennas in capture array
+*
+* @return  TRUE if a specialized kernel was selected, FALSE if the generic loop will be used
+*/
+bool AOA_selectKernel(uint8_t sampleRate, uint8_t sampleSize, uint8_t slotDuration, uint8_t numAnt)
+{
+  gpAngleKernel = NULL;
+
+  for (uint8_t k = 0; k < sizeof(aoaAngleKernels) / sizeof(aoaAngleKernels[0]); k++)
+  {
+    const AoA_AngleKernelEntry_t *pEntry = &aoaAngleKernels[k];
+
+    if ((pEntry->sampleRate == sampleRate) && (pEntry->sampleSize == sampleSize) &&
+        (pEntry->slotDuration == slotDuration) && (pEntry->numAnt == numAnt))
+    {
+      gpAngleKernel = pEntry;
+      return TRUE;
+    }
+  }
+
+  return FALSE;
+}
+
+/*********************************************************************
+* @fn      AOA_normalizeSamples
+*
+* @brief   Normalize a 16 bit capture to 8 bit samples with a block exponent
+*
+*          Raw 16 bit products reach 2^31 for strong tags, which overflows
+*          the int32 sum of AOA_AngleComplexProductComp and the input range
+*          of the atan2. After the shift they stay below 2^15.
+*
+* @param   pIQ - pointer to IQ samples, holds AoA_IQSample_t samples afterwards
+* @param   numIqSamples - number of I and Q samples
+* @param   pSampleSize - sample size of the capture, AOA_NORM_SAMPLE_SIZE afterwards
+*
+* @return  block exponent the samples were shifted right by
+*/
+uint8_t AOA_normalizeSamples(int8_t *pIQ, uint16_t numIqSamples, uint8_t *pSampleSize)
+{
+  uint8_t shift;
+
+  if (*pSampleSize != 2)
+  {
+    return 0;
+  }
+
+  shift = AOA_blockExponent((const AoA_IQSample_Ext_t *)pIQ, numIqSamples);
+  AOA_narrowSamples((const AoA_IQSample_Ext_t *)pIQ, (AoA_IQSample_t *)pIQ, numIqSamples, shift);
+  *pSampleSize = AOA_NORM_SAMPLE_SIZE;
+
+  return shift;
+}
+
+/*********************************************************************
+* @fn      AOA_decimateSamples
+*
+* @brief   Average every factor consecutive samples of a capture into one, in place
+*
+*          The factor divides the sample rate, so no group straddles two
+*          slots. Within a group the tone turns by a quarter of a cycle
+*          per us at most, the mean keeps the phase of the group centre at
+*          0.9 of the amplitude or more while the noise of the group
+*          averages down. Every group is shifted by the same time, the
+*          phase between slots and the reference lags in us are kept.
+*
+* @param   pIQ - pointer to IQ samples
+* @param   pNumIqSamples - number of I and Q samples, divided by the factor afterwards
+* @param   pSampleRate - sample rate that was used to capture, divided by the factor afterwards
+* @param   sampleSize - sample size 1 = 8 bit, 2 = 16 bit
+* @param   factor - samples averaged into one
+*
+* @return  factor the capture was decimated by, 1 if it was left as it is
+*/
+uint8_t AOA_decimateSamples(int8_t *pIQ, uint16_t *pNumIqSamples, uint8_t *pSampleRate, uint8_t sampleSize, uint8_t factor)
+{
+  const uint16_t numOut = *pNumIqSamples / ((factor != 0) ? factor : 1);
+  const int32_t half = factor / 2;
+
+  if ((factor <= 1) || ((*pSampleRate % factor) != 0))
+  {
+    return 1;
+  }
+
+  // Output k only reads inputs k * factor and up, writing in place never overtakes the reads
+  for (uint16_t k = 0; k < numOut; k++)
+  {
+    int32_t sumI = 0;
+    int32_t sumQ = 0;
+
+    for (uint8_t n = 0; n < factor; n++)
+    {
+      int32_t re, im;
+
+      AOA_readSample(pIQ, sampleSize, k * factor + n, &re, &im);
+      sumI += re;
+      sumQ += im;
+    }
+
+    // Round half away from zero, a truncated mean would pull every sample towards the origin
+    sumI = (sumI >= 0) ? (sumI + half) / factor : (sumI - half) / factor;
+    sumQ = (sumQ >= 0) ? (sumQ + half) / factor : (sumQ - half) / factor;
+
+    if (sampleSize == 2)
+    {
+      ((AoA_IQSample_Ext_t *)pIQ)[k].i = (int16_t)sumI;
+      ((AoA_IQSample_Ext_t *)pIQ)[k].q = (int16_t)sumQ;
+    }
+    else
+    {
+      ((AoA_IQSample_t *)pIQ)[k].i = (int8_t)sumI;
+      ((AoA_IQSample_t *)pIQ)[k].q = (int8_t)sumQ;
+    }
+  }
+
+  *pNumIqSamples = numOut;
+  *pSampleRate /= factor;
+
+  return factor;
+}
+
+/*********************************************************************
+* @fn      AOA_screenCapture
+*
+* @brief   Measure a capture and check it against the limits of a usable capture
+*
+* @param   pParams - limits of a usable capture
+* @param   pQuality - measures of the capture
+* @param   numIqSamples - number of I and Q samples
+* @param   sampleRate - sample rate that was used to capture (1,2,3 or 4 Mhz)
+* @param   sampleSize - sample size 1 = 8 bit, 2 = 16 bit
+* @param   numAnt - number of antennas in capture array
+* @param   pIQ - pointer to IQ samples
+*
+* @return  TRUE if the capture is usable
+*/
+bool AOA_screenCapture(const AoA_ScreenParams_t *pParams, AoA_CaptureQuality_t *pQuality, uint16_t numIqSamples, uint8_t sampleRate, uint8_t sampleSize, uint8_t numAnt, const int8_t *pIQ)
+{
+  AoA_CaptureLayout_t layout;
+
+  AOA_getCaptureLayout(&layout, numIqSamples, sampleRate, numAnt);
+
+  return AOA_screenCaptureLayout(&layout, numIqSamples, sampleSize, pIQ, pParams, pQuality);
+}
+
+/*********************************************************************
+* @fn      AOA_getPairAngles
+*
+* @brief   Extract results and estimates an angle between two antennas
+*
+* @param   antConfig - antenna configuration provided from antenna files
+* @param   antResult - struct to write results into
+* @param   numIqSamples - number of I and Q samples
+* @param   sampleRate - sample rate that was used to capture (1,2,3 or 4 Mhz)
+* @param   sampleSize - sample size 1 = 8 bit, 2 = 16 bit
+* @param   numAnt - number of antennas in capture array
+* @param   pIQ - pointer to IQ samples
+*
+* @return  none
+*/
+void AOA_getPairAngles(AoA_AntennaConfig_t *antConfig, AoA_AntennaResult_t *antResult, uint16_t numIqSamples, uint8_t sampleRate, uint8_t sampleSize, uint8_t slotDuration, uint8_t numAnt, int8_t *pIQ)
+{
+  AoA_AngleKernel_t kernel = NULL;
+  AoA_CaptureLayout_t layout;
+
+  AOA_getCaptureLayout(&layout, numIqSamples, sampleRate, numAnt);
+
+  if (gAvgMode == AOA_AVG_MODE_PHASOR)
+  {
+    AOA_getPairAnglesPhasor(antConfig, antResult, &layout, sampleSize, slotDuration, pIQ);
+    return;
+  }
+
+  // Use the kernel selected in AOA_selectKernel if this capture matches its configuration
+  if ((gpAngleKernel != NULL) &&
+      (gpAngleKernel->sampleRate == sampleRate) && (gpAngleKernel->sampleSize == sampleSize) &&
+      (gpAngleKernel->slotDuration == slotDuration) && (gpAngleKernel->numAnt == numAnt))
+  {
+    kernel = gpAngleKernel->kernel;
+  }
+
+  AOA_getPairAnglesLayout(antConfig, antResult, &layout, sampleSize, slotDuration, pIQ, kernel);
+}
+
+/*********************************************************************
+* @fn      AOA_rawCoherence
+*
+* @brief   Coherence of a sample position of every slot with the reference position
+*
+* @param   slots - layout of one sample per slot
+* @param   sampleSize - sample size 1 = 8 bit, 2 = 16 bit
+* @param   pIQ - pointer to IQ samples
+* @param   pos - sample position in the slot
+* @param   ref - reference position in the slot
+* @param   numSlots - number of slots to sum over
+* @param   refEnergy - sum of |X|^2 of the reference position
+*
+* @return  |sum X[pos]*conj(X[ref])| / sqrt(sum |X[pos]|^2 * sum |X[ref]|^2)
+*/
+static float AOA_rawCoherence(const AoA_CaptureLayout_t *slots, uint8_t sampleSize, const int8_t *pIQ,
+                              uint8_t pos, uint8_t ref, uint16_t numSlots, int64_t refEnergy)
+{
+  AoA_Phasor_t sum = {0};
+  AoA_Phasor_t energy = {0};
+
+  AOA_capturePhasor(slots, sampleSize, pIQ, pos, ref, numSlots, &sum);
+  AOA_capturePhasor(slots, sampleSize, pIQ, pos, pos, numSlots, &energy);
+
+  return sqrtf((float)sum.re * (float)sum.re + (float)sum.im * (float)sum.im) /
+         (sqrtf((float)energy.re) * sqrtf((float)refEnergy) + 1);
+}
+
+/*********************************************************************
+* @fn      AOA_getRawCaptureLayout
+*
+* @brief   Position of the slot samples in a RAW RF master capture
+*
+*          Every slot of the layout is the switch slot and the sample slot
+*          of one antenna. The last sample of the slot is the reference,
+*          the coherence of every earlier position with it is summed over
+*          all slots. The tone turns by the same phase between two
+*          positions in every slot, a transient leaves them incoherent.
+*          Switch slot positions are kept from the end of the switch slot
+*          back to the first one that falls below AOA_RAW_MIN_COHERENCE of
+*          the coherence of the sample slot.
+*
+* @param   layout - layout to fill
+* @param   numIqSamples - number of I and Q samples
+* @param   sampleRate - sample rate that was used to capture (1,2,3 or 4 Mhz)
+* @param   sampleSize - sample size 1 = 8 bit, 2 = 16 bit
+* @param   slotDuration - slot duration 1 = 1us, 2 = 2us
+* @param   numAnt - number of antennas in capture array
+* @param   pIQ - pointer to IQ samples
+*
+* @return  none
+*/
+static void AOA_getRawCaptureLayout(AoA_CaptureLayout_t *layout, uint16_t numIqSamples, uint8_t sampleRate, uint8_t sampleSize,
+                                    uint8_t slotDuration, uint8_t numAnt, const int8_t *pIQ)
+{
+  const uint8_t switchSamples = slotDuration * sampleRate;
+  const uint8_t ref = 2 * switchSamples - 1;
+  AoA_CaptureLayout_t slots;
+  AoA_Phasor_t refEnergy = {0};
+  float minCoherence = (float)AOA_RAW_MIN_COHERENCE / UINT8_MAX;
+  uint8_t first = switchSamples;
+  uint16_t numSlots;
+
+  AOA_getCaptureLayout(layout, numIqSamples, sampleRate, numAnt);
+
+  layout->repStride = numAnt * 2 * switchSamples;
+  layout->antStride = 2 * switchSamples;
+  layout->samplesPerSlot = 2 * switchSamples;
+  layout->numReps = (numIqSamples > layout->firstSample) ? (numIqSamples - layout->firstSample) / layout->repStride : 0;
+
+  // One sample of every slot of every repetition
+  slots = *layout;
+  slots.repStride = layout->antStride;
+  slots.samplesPerSlot = 1;
+
+  numSlots = layout->numReps * numAnt;
+  AOA_capturePhasor(&slots, sampleSize, pIQ, ref, ref, numSlots, &refEnergy);
+
+  if (refEnergy.re == 0)
+  {
+    return;
+  }
+
+  // Noise lowers the coherence of every position, the first sample slot position sets the bar
+  if (switchSamples != ref)
+  {
+    minCoherence *= AOA_rawCoherence(&slots, sampleSize, pIQ, switchSamples, ref, numSlots, refEnergy.re);
+  }
+
+  while ((first > 0) && (AOA_rawCoherence(&slots, sampleSize, pIQ, first - 1, ref, numSlots, refEnergy.re) >= minCoherence))
+  {
+    first--;
+  }
+
+  layout->firstSample += first;
+  layout->samplesPerSlot -= first;
+
+  // Every slot holds the tone without a switch for longer than a filtered slot
+  layout->slotLag = layout->samplesPerSlot / 2;
+}
+
+/*********************************************************************
+* @fn      AOA_getPairAnglesRaw
+*
+* @brief   Extract results and estimates an angle between two antennas of a RAW RF capture
+*
+* @param   antConfig - antenna configuration provided from antenna files
+* @param   antResult - struct to write results into
+* @param   numIqSamples - number of I and Q samples
+* @param   sampleRate - sample rate that was used to capture (1,2,3 or 4 Mhz)
+* @param   sampleSize - sample size 1 = 8 bit, 2 = 16 bit
+* @param   slotDuration - slot duration 1 = 1us, 2 = 2us
+* @param   numAnt - number of antennas in capture array
+* @param   pIQ - pointer to IQ samples
+*
+* @return  none
+*/
+void AOA_getPairAnglesRaw(AoA_AntennaConfig_t *antConfig, AoA_AntennaResult_t *antResult, uint16_t numIqSamples, uint8_t sampleRate, uint8_t sampleSize, uint8_t slotDuration, uint8_t numAnt, int8_t *pIQ)
+{
+  AoA_CaptureLayout_t layout;
+
+  AOA_getRawCaptureLayout(&layout, numIqSamples, sampleRate, sampleSize, slotDuration, numAnt, pIQ);
+
+  if (gAvgMode == AOA_AVG_MODE_PHASOR)
+  {
+    AOA_getPairAnglesPhasor(antConfig, antResult, &layout, sampleSize, slotDuration, pIQ);
+    return;
+  }
+
+  // The specialized kernels are built for the filtered slot length
+  AOA_getPairAnglesLayout(antConfig, antResult, &layout, sampleSize, slotDuration, pIQ, NULL);
+}
+
+/*********************************************************************
+* @fn      AOA_getCovarianceRaw
+*
+* @brief   Estimate the array covariance of a RAW RF capture
+*
+* @param   antConfig - antenna configuration
+* @param   pCov - covariance to write, sized for antConfig->numElements
+* @param   numIqSamples - number of I and Q samples
+* @param   sampleRate - sample rate that was used to capture (1,2,3 or 4 Mhz)
+* @param   sampleSize - sample size 1 = 8 bit, 2 = 16 bit
+* @param   slotDuration - slot duration 1 = 1us, 2 = 2us
+* @param   numAnt - number of antennas in capture array
+* @param   pIQ - pointer to IQ samples
+*
+* @return  TRUE if the capture held a usable signal
+*/
+bool AOA_getCovarianceRaw(AoA_AntennaConfig_t *antConfig, AoA_Covariance_t *pCov, uint16_t numIqSamples, uint8_t sampleRate, uint8_t sampleSize, uint8_t slotDuration, uint8_t numAnt, int8_t *pIQ)
+{
+  AoA_CaptureLayout_t layout;
+
+  AOA_getRawCaptureLayout(&layout, numIqSamples, sampleRate, sampleSize, slotDuration, numAnt, pIQ);
+
+  return AOA_getCovarianceLayout(antConfig, &layout, sampleSize, slotDuration, pIQ, pCov);
+}
+#endif
+
+/*********************************************************************
+* @fn      AOA_capturePhasor
+*
+* @brief   Accumulate X*conj(Y) over the slots of a capture
+*
+* @param   layout - position of the slot samples in the capture
+* @param   sampleSize - sample size 1 = 8 bit, 2 = 16 bit
+* @param   pIQ - pointer to IQ samples
+* @param   offsetX, offsetY - first X and Y sample relative to layout->firstSample
+* @param   numReps - number of repetitions to sum over
+* @param   pAcc - accumulator the sum is added to
+*
+* @return  none
+*/
+static void AOA_capturePhasor(const AoA_CaptureLayout_t *layout, uint8_t sampleSize, const int8_t *pIQ,
+                              uint16_t offsetX, uint16_t offsetY, uint16_t numReps, AoA_Phasor_t *pAcc)
+{
+  if (sampleSize == 1)
+  {
+    const AoA_IQSample_t *pBase = &((const AoA_IQSample_t *)pIQ)[layout->firstSample];
+
+    AOA_cmacConj(&pBase[offsetX], &pBase[offsetY], layout->samplesPerSlot, numReps, layout->repStride, pAcc);
+  }
+  else
+  {
+    const AoA_IQSample_Ext_t *pBase = &((const AoA_IQSample_Ext_t *)pIQ)[layout->firstSample];
+
+    AOA_cmacConjExt(&pBase[offsetX], &pBase[offsetY], layout->samplesPerSlot, numReps, layout->repStride, pAcc);
+  }
+}
+
+/*********************************************************************
+* @fn      AOA_refPhasor
+*
+* @brief   Accumulate X[k + lag] * conj(X[k]) over the reference period
+*
+* @param   layout - position of the reference samples in the capture
+* @param   sampleSize - sample size 1 = 8 bit, 2 = 16 bit
+* @param   pIQ - pointer to IQ samples
+* @param   lag - samples between X and Y
+* @param   pAcc - returned phasor, 0 if the reference period is not longer than lag
+*
+* @return  none
+*/
+static void AOA_refPhasor(const AoA_CaptureLayout_t *layout, uint8_t sampleSize, const int8_t *pIQ, uint16_t lag, AoA_Phasor_t *pAcc)
+{
+  pAcc->re = 0;
+  pAcc->im = 0;
+
+  if (layout->refSamples <= lag)
+  {
+    return;
+  }
+
+  if (sampleSize == 1)
+  {
+    const AoA_IQSample_t *pRef = (const AoA_IQSample_t *)pIQ;
+
+    AOA_cmacConj(&pRef[lag], pRef, layout->refSamples - lag, 1, 0, pAcc);
+  }
+  else
+  {
+    const AoA_IQSample_Ext_t *pRef = (const AoA_IQSample_Ext_t *)pIQ;
+
+    AOA_cmacConjExt(&pRef[lag], pRef, layout->refSamples - lag, 1, 0, pAcc);
+  }
+}
+
+/*********************************************************************
+* @fn      AOA_getSlotRotation
+*
+* @brief   Carrier frequency offset of a capture, as phase rotation per switch slot
+*
+*          Estimated once per CTE from the reference period, where the
+*          reference antenna receives the tone without switching. Over 1 us
+*          the tone turns by +-90 degrees, the offset from that is the coarse
+*          estimate. Over 4 us the tone turns by a whole period, the coarse
+*          estimate resolves the ambiguity of that finer measurement.
+*          RAW RF layouts also measure the rotation over slotLag inside
+*          every slot, weighed against the reference period by the number
+*          of sample products times the lag squared.
+*
+* @param   layout - position of the reference samples in the capture
+* @param   sampleSize - sample size 1 = 8 bit, 2 = 16 bit
+* @param   slotDuration - slot duration 1 = 1us, 2 = 2us
+* @param   pIQ - pointer to IQ samples
+*
+* @return  rotation between two consecutive switch slots in radians, 0 without reference signal
+*/
+static float AOA_getSlotRotation(const AoA_CaptureLayout_t *layout, uint8_t sampleSize, uint8_t slotDuration, const int8_t *pIQ)
+{
+  AoA_Phasor_t coarse;
+  AoA_Phasor_t fine;
+  float tone;
+  float cfo;
+  float refWeight;
+
+  AOA_refPhasor(layout, sampleSize, pIQ, AOA_CFO_COARSE_LAG_US * layout->refRate, &coarse);
+
+  if ((coarse.re == 0) && (coarse.im == 0))
+  {
+    return 0;
+  }
+
+  // Radians per us, whichever side of the carrier the tone is on
+  cfo = atan2f((float)coarse.im, (float)coarse.re);
+  tone = (cfo >= 0) ? AOA_PI / 2 : -AOA_PI / 2;
+  cfo = (cfo - tone) / AOA_CFO_COARSE_LAG_US;
+  refWeight = (float)(layout->refSamples - AOA_CFO_COARSE_LAG_US * layout->refRate) * AOA_CFO_COARSE_LAG_US * AOA_CFO_COARSE_LAG_US;
+
+  AOA_refPhasor(layout, sampleSize, pIQ, AOA_CFO_FINE_LAG_US * layout->refRate, &fine);
+
+  if ((fine.re != 0) || (fine.im != 0))
+  {
+    const float fineAngle = atan2f((float)fine.im, (float)fine.re);
+    const float turns = roundf((cfo * AOA_CFO_FINE_LAG_US - fineAngle) / (2 * AOA_PI));
+
+    cfo = (fineAngle + turns * 2 * AOA_PI) / AOA_CFO_FINE_LAG_US;
+    refWeight = (float)(layout->refSamples - AOA_CFO_FINE_LAG_US * layout->refRate) * AOA_CFO_FINE_LAG_US * AOA_CFO_FINE_LAG_US;
+  }
+
+  if (layout->slotLag != 0)
+  {
+    const float lagUs = (float)layout->slotLag / layout->refRate;
+    AoA_CaptureLayout_t slots = *layout;
+    AoA_Phasor_t inSlot = {0};
+
+    // Every slot of every repetition as one repetition
+    slots.repStride = layout->antStride;
+    slots.samplesPerSlot = layout->samplesPerSlot - layout->slotLag;
+    AOA_capturePhasor(&slots, sampleSize, pIQ, layout->slotLag, 0, layout->numReps * layout->numAnt, &inSlot);
+
+    if ((inSlot.re != 0) || (inSlot.im != 0))
+    {
+      const float slotAngle = atan2f((float)inSlot.im, (float)inSlot.re);
+      const float turns = roundf(((tone + cfo) * lagUs - slotAngle) / (2 * AOA_PI));
+      const float slotCfo = (slotAngle + turns * 2 * AOA_PI) / lagUs - tone;
+      const float slotWeight = (float)slots.samplesPerSlot * layout->numReps * layout->numAnt * lagUs * lagUs;
+
+      cfo = (cfo * refWeight + slotCfo * slotWeight) / (refWeight + slotWeight);
+    }
+  }
+
+  // Switch slots follow each other every 2 slot durations, the nominal tone rotation is removed by the sign flips
+  return cfo * 2 * slotDuration;
+}
+
+/*********************************************************************
+* @fn      AOA_screenCaptureLayout
+*
+* @brief   Measure a capture and check it against the limits of a usable capture
+*
+*          The peak catches saturated captures, the power of the reference
+*          period captures in the noise floor. During the reference period
+*          the tone turns by the same phase every sample, the coherence of
+*          X[k + 1us] * conj(X[k]) drops when noise or a second transmitter
+*          bends that phase.
+*
+* @param   layout - position of the reference samples in the capture
+* @param   numSamples - number of I and Q samples
+* @param   sampleSize - sample size 1 = 8 bit, 2 = 16 bit
+* @param   pIQ - pointer to IQ samples
+* @param   pParams - limits of a usable capture
+* @param   pQuality - measures of the capture
+*
+* @return  TRUE if the capture is usable
+*/
+static bool AOA_screenCaptureLayout(const AoA_CaptureLayout_t *layout, uint16_t numSamples, uint8_t sampleSize, const int8_t *pIQ, const AoA_ScreenParams_t *pParams, AoA_CaptureQuality_t *pQuality)
+{
+  const float fullScale = (sampleSize == 1) ? INT8_MAX : INT16_MAX;
+  const uint16_t lag = AOA_CFO_COARSE_LAG_US * layout->refRate;
+  // Without a reference period the power is measured over the whole capture
+  const uint16_t powerSamples = (layout->refSamples != 0) ? layout->refSamples : numSamples;
+  uint32_t peak = 0;
+  uint64_t energy = 0;
+  AoA_Phasor_t tone;
+
+  for (uint16_t k = 0; k < numSamples; k++)
+  {
+    int32_t i, q;
+
+    if (sampleSize == 1)
+    {
+      i = ((const AoA_IQSample_t *)pIQ)[k].i;
+      q = ((const AoA_IQSample_t *)pIQ)[k].q;
+    }
+    else
+    {
+      i = ((const AoA_IQSample_Ext_t *)pIQ)[k].i;
+      q = ((const AoA_IQSample_Ext_t *)pIQ)[k].q;
+    }
+
+    peak = ((uint32_t)abs(i) > peak) ? (uint32_t)abs(i) : peak;
+    peak = ((uint32_t)abs(q) > peak) ? (uint32_t)abs(q) : peak;
+
+    if (k < powerSamples)
+    {
+      energy += (uint64_t)(i * i) + (uint64_t)(q * q);
+    }
+  }
+
+  pQuality->peakDb = (peak == 0) ? INT8_MIN : (int8_t)floorf(20 * log10f(peak / fullScale));
+  pQuality->powerDb = (energy == 0) ? INT8_MIN : (int8_t)lroundf(10 * log10f((float)energy / powerSamples / (fullScale * fullScale)));
+  pQuality->linearity = UINT8_MAX;
+
+  // Coherence of the tone, the lagged products cover all but lag samples of the reference period
+  AOA_refPhasor(layout, sampleSize, pIQ, lag, &tone);
+
+  if ((layout->refSamples > lag) && (energy != 0))
+  {
+    const float magnitude = sqrtf((float)tone.re * (float)tone.re + (float)tone.im * (float)tone.im);
+    const float coherence = magnitude * layout->refSamples / ((float)energy * (layout->refSamples - lag));
+
+    pQuality->linearity = (coherence >= 1) ? UINT8_MAX : (uint8_t)(coherence * UINT8_MAX);
+  }
+
+  return (pQuality->peakDb < pParams->maxPeakDb) &&
+         (pQuality->powerDb >= pParams->minPowerDb) &&
+         (pQuality->linearity >= pParams->minLinearity);
+}
+
+/*********************************************************************
+* @fn      AOA_getCovarianceLayout
+*
+* @brief   Estimate the array covariance of a capture
+*
+*          (i, j) is the pair phasor of the first pattern slots of elements
+*          i and j, rotated by the carrier frequency offset over the slots
+*          between them, as AOA_getPairAnglesPhasor does for the pair angles.
+*
+* @param   antConfig - antenna configuration
+* @param   layout - position of the slot samples in the capture
+* @param   sampleSize - sample size 1 = 8 bit, 2 = 16 bit
+* @param   slotDuration - slot duration 1 = 1us, 2 = 2us
+* @param   pIQ - pointer to IQ samples
+* @param   pCov - covariance to write
+*
+* @return  TRUE if the capture held a usable signal
+*/
+static bool AOA_getCovarianceLayout(const AoA_AntennaConfig_t *antConfig, const AoA_CaptureLayout_t *layout, uint8_t sampleSize, uint8_t slotDuration, const int8_t *pIQ, AoA_Covariance_t *pCov)
+{
+  const uint8_t numElements = pCov->numAnt;
+  uint8_t slot[AOA_MAX_NUM_ANT];
+  float slotRotation;
+  float trace = 0;
+
+  pCov->valid = FALSE;
+
+  if ((numElements != antConfig->numElements) || (numElements > AOA_MAX_NUM_ANT) || (layout->numReps < 1))
+  {
+    return FALSE;
+  }
+
+  // First pattern slot of every element
+  for (uint8_t e = 0; e < numElements; ++e)
+  {
+    slot[e] = layout->numAnt;
+
+    for (uint8_t k = 0; (k < layout->numAnt) && (slot[e] == layout->numAnt); ++k)
+    {
+      if (((antConfig->pElement != NULL) ? antConfig->pElement[k] : k) == e)
+      {
+        slot[e] = k;
+      }
+    }
+
+    if (slot[e] == layout->numAnt)
+    {
+      return FALSE;
+    }
+  }
+
+  slotRotation = AOA_getSlotRotation(layout, sampleSize, slotDuration, pIQ);
+
+  for (uint8_t i = 0; i < numElements; ++i)
+  {
+    for (uint8_t j = i; j < numElements; ++j)
+    {
+      const int8_t distance = slot[j] - slot[i];
+      AoA_Phasor_t phasor = {0};
+      float re, im, c, s;
+
+      AOA_capturePhasor(layout, sampleSize, pIQ, slot[i] * layout->antStride, slot[j] * layout->antStride, layout->numReps, &phasor);
+
+      re = (float)phasor.re;
+      im = (float)phasor.im;
+
+      // In slot duration of 1 usec, there are 180 degrees between samples of adjacent slots
+      if (AOA_pairHalfTurn(slotDuration, distance))
+      {
+        re = -re;
+        im = -im;
+      }
+
+      // v-- Correct for the carrier frequency offset between the two slots
+      c = cosf(slotRotation * distance);
+      s = sinf(slotRotation * distance);
+
+      AOA_COV_RE(pCov, i, j) = re * c - im * s;
+      AOA_COV_IM(pCov, i, j) = re * s + im * c;
+      AOA_COV_RE(pCov, j, i) = AOA_COV_RE(pCov, i, j);
+      AOA_COV_IM(pCov, j, i) = -AOA_COV_IM(pCov, i, j);
+    }
+
+    AOA_COV_IM(pCov, i, i) = 0;
+    trace += AOA_COV_RE(pCov, i, i);
+  }
+
+  if (trace <= 0)
+  {
+    return FALSE;
+  }
+
+  // Unit trace, the estimate does not depend on the received power
+  for (uint16_t k = 0; k < 2 * numElements * numElements; ++k)
+  {
+    pCov->elem[k] /= trace;
+  }
+
+  pCov->valid = TRUE;
+
+  return TRUE;
+}
+
+/*********************************************************************
+* @fn      AOA_getPairAnglesPhasor
+*
+* @brief   Estimate pair angles from phasors accumulated over the whole capture
+*
+*          For every pair X*conj(Y) is summed over all repetitions and samples,
+*          and one angle is taken from the sum. The carrier frequency offset
+*          of the capture is applied once per pair, scaled by the pair distance.
+*          This is a circular mean, so it is not biased near the +-180 wrap.
+*
+* @param   antConfig - antenna configuration provided from antenna files
+* @param   antResult - struct to write results into
+* @param   layout - position of the slot samples in the capture
+* @param   sampleSize - sample size 1 = 8 bit, 2 = 16 bit
+* @param   slotDuration - slot duration 1 = 1us, 2 = 2us
+* @param   pIQ - pointer to IQ samples
+*
+* @return  none
+*/
+static void AOA_getPairAnglesPhasor(AoA_AntennaConfig_t *antConfig, AoA_AntennaResult_t *antResult, const AoA_CaptureLayout_t *layout, uint8_t sampleSize, uint8_t slotDuration, const int8_t *pIQ)
+{
+  const float slotRotation = AOA_getSlotRotation(layout, sampleSize, slotDuration, pIQ) * RadToDeg;
+  int64_t energy[AOA_MAX_NUM_ANT];
+
+  antResult->numSamples = layout->numReps * layout->samplesPerSlot;
+
+  // The spread of a pair is its phasor sum against the energy of its slots
+  if (antResult->pPairQuality != NULL)
+  {
+    AOA_slotEnergies(layout, sampleSize, pIQ, energy);
+  }
+
+  for (uint8_t pair = 0; pair < antConfig->numPairs; ++pair)
+  {
+    const AoA_AntennaPair_t *p = &antConfig->pairs[pair];
+    const int8_t distance = p->b - p->a;
+    AoA_Phasor_t pairSum = {0};
+    int32_t angle;
+
+    // Phase difference between antenna a vs. antenna b (X * complex conjugate (Y))
+    AOA_capturePhasor(layout, sampleSize, pIQ, p->a * layout->antStride, p->b * layout->antStride, layout->numReps, &pairSum);
+
+    if (AOA_pairHalfTurn(slotDuration, distance))
+    {
+      pairSum.re = -pairSum.re;
+      pairSum.im = -pairSum.im;
+    }
+
+    // v-- Correct for the carrier frequency offset between the two slots
+    angle = AOA_wrapAngle(AOA_phasorAngle(pairSum.re, pairSum.im) + (int32_t)lroundf(slotRotation * distance));
+
+    // Write back result for antenna pair
+    antResult->pairAngle[pair] = ((p->sign * angle + p->offset) * (int32_t)p->gain) / AOA_PAIR_GAIN_ONE;
+
+    if (antResult->pPairQuality != NULL)
+    {
+      AOA_pairQuality(&pairSum, energy[p->a], energy[p->b], &antResult->pPairQuality[pair]);
+    }
+  }
+}
+
+/*********************************************************************
+* @fn      AOA_slotEnergies
+*
+* @brief   Energy of the samples of every pattern slot over a capture
+*
+* @param   layout - position of the slot samples in the capture
+* @param   sampleSize - sample size 1 = 8 bit, 2 = 16 bit
+* @param   pIQ - pointer to IQ samples
+* @param   pEnergy - sum of |X|^2 per slot, layout->numAnt entries
+*
+* @return  none
+*/
+static void AOA_slotEnergies(const AoA_CaptureLayout_t *layout, uint8_t sampleSize, const int8_t *pIQ, int64_t *pEnergy)
+{
+  for (uint8_t k = 0; k < layout->numAnt; k++)
+  {
+    AoA_Phasor_t acc = {0};
+
+    AOA_capturePhasor(layout, sampleSize, pIQ, k * layout->antStride, k * layout->antStride, layout->numReps, &acc);
+    pEnergy[k] = acc.re;
+  }
+}
+
+/*********************************************************************
+* @fn      AOA_pairQuality
+*
+* @brief   Spread of the sample products of a pair
+*
+*          The coherence is the length of the mean product over the mean
+*          product length bound, it falls with noise, phase noise and
+*          multipath. For a wrapped normal phase it is exp(-var / 2).
+*
+* @param   pPairSum - sum of X*conj(Y) of the pair
+* @param   energyA - sum of |X|^2 of the first slot
+* @param   energyB - sum of |Y|^2 of the second slot
+* @param   pQuality - spread to write
+*
+* @return  none
+*/
+static void AOA_pairQuality(const AoA_Phasor_t *pPairSum, int64_t energyA, int64_t energyB, AoA_PairQuality_t *pQuality)
+{
+  const float bound = sqrtf((float)energyA) * sqrtf((float)energyB);
+  const float length = sqrtf((float)pPairSum->re * (float)pPairSum->re + (float)pPairSum->im * (float)pPairSum->im);
+  float coherence = (bound > 0) ? length / bound : 0;
+  float var;
+
+  coherence = (coherence > 1) ? 1 : coherence;
+  pQuality->coherence = (uint8_t)lroundf(coherence * UINT8_MAX);
+
+  var = (coherence > 0) ? -2 * logf(coherence) * (180 / AOA_PI) * (180 / AOA_PI) : UINT16_MAX;
+  pQuality->phaseVar = (var >= UINT16_MAX) ? UINT16_MAX : (uint16_t)lroundf(var);
+}
+
+/*********************************************************************
+* @fn      AOA_initArrayConfig
+*
+* @brief   Build the antenna configuration of an array described at runtime
+*
+* @param   antConfig - configuration to fill
+* @param   numAnt - number of slots in the antenna pattern
+* @param   numElements - number of array elements
+* @param   pElement - array element of every pattern slot
+* @param   pPosition - element positions along the array axis in wavelengths
+* @param   pairs - pair table to fill, CALC_NUM_ANT_PAIRS(numElements) entries
+*
+* @return  TRUE if every element is visited by the pattern
+*/
+bool AOA_initArrayConfig(AoA_AntennaConfig_t *antConfig, uint8_t numAnt, uint8_t numElements, uint8_t *pElement, float *pPosition, AoA_AntennaPair_t *pairs)
+{
+  uint8_t slot[AOA_MAX_NUM_ANT];
+  uint8_t pair = 0;
+
+  if ((numAnt > AOA_MAX_NUM_ANT) || (numElements < 2) || (numElements > numAnt))
+  {
+    return FALSE;
+  }
+
+  // First pattern slot of every element
+  memset(slot, numAnt, sizeof(slot));
+
+  for (uint8_t k = numAnt; k > 0; --k)
+  {
+    if (pElement[k - 1] >= numElements)
+    {
+      return FALSE;
+    }
+
+    slot[pElement[k - 1]] = k - 1;
+  }
+
+  for (uint8_t i = 0; i < numElements; ++i)
+  {
+    if (slot[i] == numAnt)
+    {
+      return FALSE;
+    }
+
+    for (uint8_t j = i + 1; j < numElements; ++j, ++pair)
+    {
+      // Slots are kept in capture order, the sign restores element i vs. element j
+      const bool swap = (slot[j] < slot[i]);
+
+      pairs[pair].a = swap ? slot[j] : slot[i];
+      pairs[pair].b = swap ? slot[i] : slot[j];
+      pairs[pair].d = pPosition[j] - pPosition[i];
+      pairs[pair].sign = swap ? -1 : 1;
+      pairs[pair].offset = 0;
+      pairs[pair].gain = AOA_PAIR_GAIN_ONE;
+    }
+  }
+
+  antConfig->numAntennas = numAnt;
+  antConfig->numPairs = pair;
+  antConfig->pairs = pairs;
+  antConfig->channelOffset = NULL;
+  antConfig->numElements = numElements;
+  antConfig->pElement = pElement;
+  antConfig->pPosition = pPosition;
+
+  return TRUE;
+}
+
+/*********************************************************************
+* @fn      AOA_getArrayAngle
+*
+* @brief   Angle of arrival from the pair angles of a linear array
+*
+* @param   antConfig - antenna configuration, pair spacing in d
+* @param   antResult - pair angles of the last capture
+* @param   pAngle - returned angle in degrees from broadside
+*
+* @return  TRUE if at least one pair is unambiguous
+*/
+bool AOA_getArrayAngle(const AoA_AntennaConfig_t *antConfig, const AoA_AntennaResult_t *antResult, int16_t *pAngle)
+{
+  float sum = 0;
+  uint8_t cnt = 0;
+
+  for (uint8_t pair = 0; pair < antConfig->numPairs; ++pair)
+  {
+    const float d = antConfig->pairs[pair].d;
+    float sinAngle;
+
+    // Wider pairs wrap before the end of the field of view
+    if ((d == 0) || (fabsf(d) > 0.5f + AOA_ARRAY_SPACING_TOLERANCE))
+    {
+      continue;
+    }
+
+    // The pair angle is 360 * d * sin(angle)
+    sinAngle = antResult->pairAngle[pair] / (360 * d);
+    sinAngle = (sinAngle > 1) ? 1 : ((sinAngle < -1) ? -1 : sinAngle);
+
+    sum += asinf(sinAngle);
+    cnt++;
+  }
+
+  if (cnt == 0)
+  {
+    return FALSE;
+  }
+
+  *pAngle = (int16_t)lroundf((sum / cnt) * RadToDeg);
+
+  return TRUE;
+}
+
+/*********************************************************************
+* @fn      AOA_fuseArrayAngles
+*
+* @brief   Azimuth and elevation from the angles of both BOOSTXL-AOA arrays
+*
+* @param   angleA1 - angle from the broadside of A1 in degrees
+* @param   angleA2 - angle from the broadside of A2 in degrees
+* @param   pAzimuth - returned azimuth in the board frame of the single array angles, AOA_AZIMUTH_MIN to 225
+* @param   pElevation - returned elevation, 0 in the board plane to 90 perpendicular to it
+*
+* @return  none
+*/
+void AOA_fuseArrayAngles(int16_t angleA1, int16_t angleA2, int16_t *pAzimuth, int16_t *pElevation)
+{
+  // The broadside of A1 points to +45 degrees and the broadside of A2 to -45 degrees of the board frame.
+  // For a tag at azimuth az and elevation el, A1 sees sin(angleA1) = sin(az - 45) * cos(el)
+  // and A2 sees sin(angleA2) = cos(az - 45) * cos(el).
+  const float u1 = sinf(((angleA1 > 90) ? 90 : ((angleA1 < -90) ? -90 : angleA1)) * AOA_PI / 180);
+  const float u2 = sinf(((angleA2 > 90) ? 90 : ((angleA2 < -90) ? -90 : angleA2)) * AOA_PI / 180);
+  const float inPlane = sqrtf(u1 * u1 + u2 * u2);
+  int16_t azimuth = (int16_t)lroundf(atan2f(u1, u2) * RadToDeg) + AOA_BOOSTXL_BROADSIDE_A1;
+
+  // atan2 rounded to whole degrees can give either end of the turn
+  *pAzimuth = (azimuth < AOA_AZIMUTH_MIN) ? azimuth + 360 : azimuth;
+  *pElevation = (int16_t)lroundf(acosf((inPlane > 1) ? 1 : inPlane) * RadToDeg);
+}
+
+/*********************************************************************
+* @fn      AOA_postProcess
+*
+* @brief   For RTLS Passive this function will send a command to enable RF RAM so we can read
+*          the samples that we captured (if any), the read must be armed with
+*          AOA_rfRamArm first
+*
+* @param   seq - read returned by AOA_rfRamArm
+*
+*/
+void AOA_postProcess(uint8_t seq)
+{
+#ifdef RTLS_PASSIVE
+  AOA_rfEnableRam(RFC_FORCE_CLK_ENA_RAM_RFE, seq);
+#endif
+}
+
+#ifdef RTLS_PASSIVE
+/*********************************************************************
+* @fn      AOA_setSamples
+*
+* @brief   Select the capture the next results are computed from
+*
+* @param   samplesBuff - AOA_RES_MAX_SIZE samples read out of RF RAM
+*
+* @return  none
+*/
+void AOA_setSamples(AoA_IQSample_Ext_t *samplesBuff)
+{
+  gSamplesBuff = samplesBuff;
+  gSamplesSize = 2;
+}
+#endif
+
+#ifdef RTLS_PASSIVE
+/*********************************************************************
+* @fn      AOA_getRawSamples
+*
+* @brief   Returns pointer to raw I/Q samples
+*
+* @param   none
+*
+* @return  Pointer to raw I/Q samples
+*/
+AoA_IQSample_Ext_t * AOA_getRawSamples(void)
+{
+  return gSamplesBuff;
+}
+#endif
+
+#ifdef RTLS_PASSIVE
+/*******************************************************************************
+ * @fn          AOA_rfEnableRam
  *
- * @param       rfHandle - RF Handle
- *              cmdHandle - Cmd Handle
- *              events - RF Event
+ * @brief       This function is used to force enable or disable MCE RAM, RFE RAM or both
+ *
+ * input parameters
+ *
+ * @param       selectedRam - as the following bitmask values:
+ *              RFC_FORCE_CLK_ENA_RAM_MCE - to enable MCE ram
+ *              RFC_FORCE_CLK_ENA_RAM_RFE - to enable RFE ram
+ *              or
+ *              RFC_FORCE_CLK_DIS_RAM - to disable
+ *              seq - read of AOA_rfRam the command is issued for
  *
  * output parameters
  *
@@ -635,60 +1909,78 @@ void AOA_rfEnableRam(uint16 selectedRam)
  *
  * @return      None
  */
-void AOA_getRfIqSamples(RF_Handle rfHandle, RF_CmdHandle cmdHandle, RF_EventMask events)
+void AOA_rfEnableRam(uint16 selectedRam, uint8_t seq)
 {
-  uint8_t state = 0;
-  uint8_t lastCapture;
-  uint32_t *cteData;
-  uint32_t *extCteData = NULL;
+  RF_ScheduleCmdParams cmdParams = {
+    0,
+    RF_StartNotSpecified,
+    RF_AllowDelayAny,
+    0,
+    RF_EndNotSpecified,
+    0,
+    0,
+    RF_PriorityCoexDefault
+  };
+
+  enableRamCmd.cmdNum = CMD_FORCE_CLK_ENA;
+  enableRamCmd.clkEnab = selectedRam;
 
-  gSampleState = SAMPLES_NOT_READY;
+  // setup radio command to run an immediate command
+  runEnableRamCmd.rfOpCmd.cmdNum    = CMD_RUN_IMMEDIATE_COMMAND;
+  runEnableRamCmd.rfOpCmd.status    = RFSTAT_IDLE;
+  runEnableRamCmd.rfOpCmd.pNextRfOp = (rfOpCmd_t *)NULL;
+  runEnableRamCmd.rfOpCmd.startTime = 0;
+  runEnableRamCmd.rfOpCmd.startTrig = TRIGTYPE_NOW;
+  runEnableRamCmd.rfOpCmd.condition = CONDTYPE_ALWAYS_RUN_NEXT_CMD;
+  runEnableRamCmd.reserved          = 0;
+  runEnableRamCmd.cmdVal            = (uint32)(uintptr_t)&enableRamCmd;
+  runEnableRamCmd.cmdStatVal        = 0;
 
-  if (events & RF_EventCmdDone)
+  // The callback learns the read the command belongs to from its tag, commands are done in order
+  if (!AOA_rfRamIssue(seq))
   {
-    lastCapture = HWREGB(RFC_CTE_LAST_CAPTURE);
-    // check which RAM is capturing samples
-    if ((lastCapture == RFC_CTE_CAPTURE_RAM_MCE) || (lastCapture == RFC_CTE_CAPTURE_RAM_RFE))
-    {
-      // wait while buffer is busy
-      do
-      {
-        state = (lastCapture == RFC_CTE_CAPTURE_RAM_MCE)?HWREGB(RFC_CTE_MCE_RAM_STATE):HWREGB(RFC_CTE_RFE_RAM_STATE);
-      } while ((state == RFC_CTE_RAM_STATE_BUSY) || (state == RFC_CTE_RAM_STATE_DUAL_BUSY));
+    return;
+  }
 
-      // check if buffer is ready for reading
-      if ((state == RFC_CTE_RAM_STATE_READY) || (state == RFC_CTE_RAM_STATE_DUAL_READY))
-      {
-        if (lastCapture == RFC_CTE_CAPTURE_RAM_MCE)
-        {
-          // get the MCE buffer address
-          cteData = (uint32_t *)RFC_CTE_MCE_RAM_DATA;
-          extCteData = (uint32_t *)RFC_CTE_RFE_RAM_DATA;
-        }
-        else
-        {
-          // get the RFE buffer address
-          cteData = (uint32_t *)RFC_CTE_RFE_RAM_DATA;
-        }
-
-        // This will trigger the upper layer which polls samplesReady
-        if (cteData != NULL && extCteData == NULL)
-        {
-          memcpy(gSamplesBuff, cteData, AOA_RES_MAX_SIZE * sizeof(AoA_IQSample_Ext_t));
-          gSampleState = SAMPLES_READY;
-        }
-      }
-    }
+  if (RF_scheduleCmd( urfiHandle,
+                     (RF_Op *)&runEnableRamCmd,
+                     &cmdParams,
+                     (RF_Callback)AOA_getRfIqSamples,
+                     RF_EventCmdDone | RF_EventInternalError ) < 0)
+  {
+    AOA_rfRamCancel();
   }
+}
 
-  // release the RAM so it should be available for next CTE
-  HWREGB(RFC_CTE_MCE_RAM_STATE) = RFC_CTE_RAM_STATE_EMPTY;
-  HWREGB(RFC_CTE_RFE_RAM_STATE) = RFC_CTE_RAM_STATE_EMPTY;
+/*******************************************************************************
+ * @fn          AOA_getRfIqSamples
+ *
+ * @brief       This callback is used to get the IQ samples from RF RAM
+ *
+ * input parameters
+ *
+ * @param       rfHandle - RF Handle
+ *              cmdHandle - Cmd Handle
+ *              events - RF Event
+ *
+ * output parameters
+ *
+ * @param       None.
+ *
+ * @return      None
+ */
+void AOA_getRfIqSamples(RF_Handle rfHandle, RF_CmdHandle cmdHandle, RF_EventMask events)
+{
+  uint8_t seq;
 
-  // If we don't have samples at this point then they are not valid
-  if (gSampleState != SAMPLES_READY)
+  if (!(events & RF_EventCmdDone))
+  {
+    AOA_rfRamFail();
+  }
+  // The RF core is still writing the capture, look again once the next command is done
+  else if (AOA_rfRamRead(&seq))
   {
-    gSampleState = SAMPLES_NOT_VALID;
+    AOA_rfEnableRam(RFC_FORCE_CLK_ENA_RAM_RFE, seq);
   }
 }
 #endif // RTLS_PASSIVE
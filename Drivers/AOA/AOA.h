@@ -65,6 +65,7 @@ extern "C"
  */
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <driverlib/ioc.h>
 #include "ant_array2_config_boostxl_rev1v1.h"
 
@@ -76,10 +77,47 @@ extern "C"
 #define AOA_RES_MAX_SIZE                 512       //!< Data Size at maximum resolution
 #define AOA_RES_MAX_CTE_TIME             20        //!< CTE Time at maximum resolution
 
+/// @brief Longest antenna pattern and largest array a host may describe
+#ifndef AOA_MAX_NUM_ANT
+#define AOA_MAX_NUM_ANT                  16
+#endif
+
+/// @brief Largest pair table, every element against every other element
+#define AOA_MAX_NUM_PAIRS                CALC_NUM_ANT_PAIRS(AOA_MAX_NUM_ANT)
+
+/// @brief Sample size of a capture after AOA_normalizeSamples, angle kernels are built for it
+#define AOA_NORM_SAMPLE_SIZE             1
+
+/// @brief Default limits of AOA_screenCapture, levels in dB of the sample full scale
+#ifndef AOA_SCREEN_MAX_PEAK_DB
+#define AOA_SCREEN_MAX_PEAK_DB           0
+#endif
+#ifndef AOA_SCREEN_MIN_POWER_DB
+#define AOA_SCREEN_MIN_POWER_DB          -40
+#endif
+#ifndef AOA_SCREEN_MIN_LINEARITY
+#define AOA_SCREEN_MIN_LINEARITY         128
+#endif
+
+/// @brief Least coherence of a RAW RF sample after an antenna switch against the sample slot, 255 = as coherent
+#ifndef AOA_RAW_MIN_COHERENCE
+#define AOA_RAW_MIN_COHERENCE            230
+#endif
+
+/// @brief Smallest azimuth of AOA_fuseArrayAngles, azimuths cover one turn up to AOA_AZIMUTH_MIN + 359 = 225
+#define AOA_AZIMUTH_MIN                  -134
+
 /*********************************************************************
  * MACROS
  */
 
+/// @brief Bytes of an AoA_Covariance_t of numAnt elements
+#define AOA_COV_SIZE(numAnt)             (sizeof(AoA_Covariance_t) + 2 * (numAnt) * (numAnt) * sizeof(float))
+
+/// @brief Real and imaginary part of element (a, b) of a covariance
+#define AOA_COV_RE(pCov, a, b)           ((pCov)->elem[(a) * (pCov)->numAnt + (b)])
+#define AOA_COV_IM(pCov, a, b)           ((pCov)->elem[((pCov)->numAnt + (a)) * (pCov)->numAnt + (b)])
+
 /// @brief Relevant only for RTLS Passive
 #define AOA_PIN(x)                       (1 << (x&0xff))
 
@@ -105,12 +143,21 @@ typedef enum
   AOA_ROLE_PASSIVE   //!< Passive Role
 } AoA_Role_t;
 
+/// @brief Spread of the sample products of an antenna pair
+typedef struct
+{
+  uint8_t  coherence;       //!< |sum X*conj(Y)| / sqrt(sum |X|^2 * sum |Y|^2), 255 if every product has the same phase
+  uint16_t phaseVar;        //!< Phase variance of one sample product in deg^2, -2 ln(coherence) of a wrapped normal phase
+} AoA_PairQuality_t;
+
 /// @brief AoA result per antenna array
 typedef struct
 {
   int16_t *pairAngle;       //!< Antenna pair angle
   int8_t rssi;              //!< Last Rx rssi
   uint8_t ch;               //!< Channel
+  uint16_t numSamples;      //!< Sample products every pair angle was averaged over
+  AoA_PairQuality_t *pPairQuality; //!< Spread of every pair, NULL if not needed
 } AoA_AntennaResult_t;
 
 /// @brief 32 bit IQ Sample structure
@@ -134,8 +181,46 @@ typedef struct
   int8_t q;  //!< Q - Quadrature
 } AoA_IQSample_t;
 
+/// @brief Array covariance estimated from one capture, normalized to unit trace
+///
+/// Allocated with AOA_COV_SIZE(numAnt) bytes, elements are read through
+/// AOA_COV_RE/AOA_COV_IM. (a, b) is E[x_a * conj(x_b)] of array elements a and b.
+typedef struct
+{
+  uint8_t numAnt;   //!< Number of array elements
+  uint8_t valid;    //!< FALSE while the estimate is empty
+  float elem[];     //!< Real part, then imaginary part, row major
+} AoA_Covariance_t;
+
 /** @} End AOA_Structs */
 
+/// @brief Method used to average the antenna pair angles of a capture
+///
+/// AOA_AVG_MODE_ANGLE until AOA_setAvgMode selects another, RTLS Control does on
+/// RTLS_PARAM_AOA_AVG_MODE. Builds that define AOA_AVG_MODE_DEFAULT, e.g.
+/// -DAOA_AVG_MODE_DEFAULT=AOA_AVG_MODE_PHASOR, start with that method instead.
+typedef enum
+{
+  AOA_AVG_MODE_ANGLE,   //!< Average the angle of every sample product
+  AOA_AVG_MODE_PHASOR   //!< Accumulate X*conj(Y) per pair and take one angle per pair (circular mean)
+} AoA_AvgMode_t;
+
+/// @brief Signal measures of a capture, levels in dB of the sample full scale
+typedef struct
+{
+  int8_t  peakDb;        //!< Largest I or Q of the capture, 0 if it reaches full scale
+  int8_t  powerDb;       //!< Mean power of the reference period
+  uint8_t linearity;     //!< Coherence of the reference tone, 255 for a clean tone, low for noise or a collision
+} AoA_CaptureQuality_t;
+
+/// @brief Limits of a usable capture
+typedef struct
+{
+  int8_t  maxPeakDb;     //!< Captures with a peak at or above this are saturated
+  int8_t  minPowerDb;    //!< Captures with less power are in the noise floor
+  uint8_t minLinearity;  //!< Captures with a less coherent reference tone are corrupted
+} AoA_ScreenParams_t;
+
 /// @brief IQ Sample state - relevant for Passive
 typedef enum
 {
@@ -156,6 +241,44 @@ typedef enum
 */
 
 void AOA_getPairAngles(AoA_AntennaConfig_t *antConfig, AoA_AntennaResult_t *antResult);
+
+/**
+* @brief   Normalize the last capture to 8 bit samples with a block exponent
+*
+*          The samples are narrowed in place, AOA_getPairAngles and
+*          AOA_getCovariance then run the 8 bit kernels. Captures that are
+*          reported through AOA_getRawSamples must not be normalized.
+*
+* @return  block exponent the samples were shifted right by
+*/
+uint8_t AOA_normalizeSamples(void);
+
+/**
+* @brief   Measure the last capture and check it against the limits of a usable capture
+*
+*          Must run before AOA_normalizeSamples, the levels are measured
+*          against the full scale of the captured samples.
+*
+* @param   pParams - limits of a usable capture
+* @param   pQuality - measures of the capture
+*
+* @return  TRUE if the capture is usable
+*/
+bool AOA_screenCapture(const AoA_ScreenParams_t *pParams, AoA_CaptureQuality_t *pQuality);
+
+/**
+* @brief   Estimate the array covariance of the last capture
+*
+*          Antennas are sampled one after the other, the rotation of the
+*          CTE tone between two slots is removed, so the result matches
+*          a capture of all antennas at the same time.
+*
+* @param   antConfig - antenna configuration provided from antenna files
+* @param   pCov - covariance to write, sized for antConfig->numElements
+*
+* @return  TRUE if the capture held a usable signal
+*/
+bool AOA_getCovariance(AoA_AntennaConfig_t *antConfig, AoA_Covariance_t *pCov);
 #elif RTLS_MASTER
 /***
 * @brief   Extract results and estimates an angle between two antennas
@@ -171,7 +294,202 @@ void AOA_getPairAngles(AoA_AntennaConfig_t *antConfig, AoA_AntennaResult_t *antR
 * @return  none
 */
 void AOA_getPairAngles(AoA_AntennaConfig_t *antConfig, AoA_AntennaResult_t *antResult, uint16_t numIqSamples, uint8_t sampleRate, uint8_t sampleSize, uint8_t slotDuration, uint8_t numAnt, int8_t *pIQ);
+
+/**
+* @brief   Select the angle kernel specialized for a capture configuration
+*
+*          AOA_getPairAngles uses the selected kernel for captures with this
+*          configuration and the generic loop for any other capture.
+*
+* @param   sampleRate - sample rate that will be used to capture (1,2,3 or 4 Mhz)
+* @param   sampleSize - sample size 1 = 8 bit, 2 = 16 bit
+* @param   slotDuration - slot duration 1 = 1us, 2 = 2us
+* @param   numAnt - number of antennas in capture array
+*
+* @return  TRUE if a specialized kernel was selected, FALSE if the generic loop will be used
+*/
+bool AOA_selectKernel(uint8_t sampleRate, uint8_t sampleSize, uint8_t slotDuration, uint8_t numAnt);
+
+/**
+* @brief   Normalize a 16 bit capture to 8 bit samples with a block exponent
+*
+*          One pass finds the largest I or Q of the capture, a second pass
+*          shifts all samples right by the same exponent into the range of
+*          AoA_IQSample_t, in place. The phase between samples is kept, and
+*          sample products can no longer overflow. 8 bit captures are left
+*          as they are.
+*
+* @param   pIQ - pointer to IQ samples, holds AoA_IQSample_t samples afterwards
+* @param   numIqSamples - number of I and Q samples
+* @param   pSampleSize - sample size of the capture, AOA_NORM_SAMPLE_SIZE afterwards
+*
+* @return  block exponent the samples were shifted right by
+*/
+uint8_t AOA_normalizeSamples(int8_t *pIQ, uint16_t numIqSamples, uint8_t *pSampleSize);
+
+/**
+* @brief   Collapse an oversampled capture to a lower sample rate by coherent averaging
+*
+*          Every factor consecutive samples of a slot are averaged into
+*          one sample, in place. The result is a capture at sampleRate /
+*          factor with the noise of every sample averaged down, the pair
+*          loop then runs over a factor fewer samples. RAW RF captures
+*          must not be decimated, their switching transients are masked
+*          per sample.
+*
+* @param   pIQ - pointer to IQ samples
+* @param   pNumIqSamples - number of I and Q samples, divided by the factor afterwards
+* @param   pSampleRate - sample rate that was used to capture, divided by the factor afterwards
+* @param   sampleSize - sample size 1 = 8 bit, 2 = 16 bit
+* @param   factor - samples averaged into one, must divide the sample rate
+*
+* @return  factor the capture was decimated by, 1 if it was left as it is
+*/
+uint8_t AOA_decimateSamples(int8_t *pIQ, uint16_t *pNumIqSamples, uint8_t *pSampleRate, uint8_t sampleSize, uint8_t factor);
+
+/**
+* @brief   Measure a capture and check it against the limits of a usable capture
+*
+*          One pass over the capture finds the peak, the reference period
+*          gives the power and the coherence of the tone. Must run before
+*          AOA_normalizeSamples, the levels are measured against the full
+*          scale of the captured samples.
+*
+* @param   pParams - limits of a usable capture
+* @param   pQuality - measures of the capture
+* @param   numIqSamples - number of I and Q samples
+* @param   sampleRate - sample rate that was used to capture (1,2,3 or 4 Mhz)
+* @param   sampleSize - sample size 1 = 8 bit, 2 = 16 bit
+* @param   numAnt - number of antennas in capture array
+* @param   pIQ - pointer to IQ samples
+*
+* @return  TRUE if the capture is usable
+*/
+bool AOA_screenCapture(const AoA_ScreenParams_t *pParams, AoA_CaptureQuality_t *pQuality, uint16_t numIqSamples, uint8_t sampleRate, uint8_t sampleSize, uint8_t numAnt, const int8_t *pIQ);
+
+/**
+* @brief   Estimate the array covariance of a capture
+*
+*          Antennas are sampled one after the other, the rotation of the
+*          CTE tone between two slots is removed, so the result matches
+*          a capture of all antennas at the same time.
+*
+* @param   antConfig - antenna configuration provided from antenna files
+* @param   pCov - covariance to write, sized for antConfig->numElements
+* @param   numIqSamples - number of I and Q samples
+* @param   sampleRate - sample rate that was used to capture (1,2,3 or 4 Mhz)
+* @param   sampleSize - sample size 1 = 8 bit, 2 = 16 bit
+* @param   slotDuration - slot duration 1 = 1us, 2 = 2us
+* @param   numAnt - number of antennas in capture array
+* @param   pIQ - pointer to IQ samples
+*
+* @return  TRUE if the capture held a usable signal
+*/
+bool AOA_getCovariance(AoA_AntennaConfig_t *antConfig, AoA_Covariance_t *pCov, uint16_t numIqSamples, uint8_t sampleRate, uint8_t sampleSize, uint8_t slotDuration, uint8_t numAnt, int8_t *pIQ);
+
+/**
+* @brief   Extract results and estimates an angle between two antennas of a RAW RF capture
+*
+*          RAW RF captures keep the switch slots: after the reference period
+*          every antenna has a switch slot and a sample slot of slotDuration
+*          each, sampled at sampleRate. The antenna is switched at the start
+*          of the switch slot, so all of it but the switching transient sees
+*          the new antenna. Sample positions after the switch that are less
+*          coherent with the sample slot than AOA_RAW_MIN_COHERENCE are
+*          masked in every slot, the rest are used for the angles.
+*
+* @param   antConfig - antenna configuration provided from antenna files
+* @param   antResult - struct to write results into
+* @param   numIqSamples - number of I and Q samples
+* @param   sampleRate - sample rate that was used to capture (1,2,3 or 4 Mhz)
+* @param   sampleSize - sample size 1 = 8 bit, 2 = 16 bit
+* @param   slotDuration - slot duration 1 = 1us, 2 = 2us
+* @param   numAnt - number of antennas in capture array
+* @param   pIQ - pointer to IQ samples
+*
+* @return  none
+*/
+void AOA_getPairAnglesRaw(AoA_AntennaConfig_t *antConfig, AoA_AntennaResult_t *antResult, uint16_t numIqSamples, uint8_t sampleRate, uint8_t sampleSize, uint8_t slotDuration, uint8_t numAnt, int8_t *pIQ);
+
+/**
+* @brief   Estimate the array covariance of a RAW RF capture
+*
+*          Switching transients are masked as in AOA_getPairAnglesRaw.
+*
+* @param   antConfig - antenna configuration provided from antenna files
+* @param   pCov - covariance to write, sized for antConfig->numElements
+* @param   numIqSamples - number of I and Q samples
+* @param   sampleRate - sample rate that was used to capture (1,2,3 or 4 Mhz)
+* @param   sampleSize - sample size 1 = 8 bit, 2 = 16 bit
+* @param   slotDuration - slot duration 1 = 1us, 2 = 2us
+* @param   numAnt - number of antennas in capture array
+* @param   pIQ - pointer to IQ samples
+*
+* @return  TRUE if the capture held a usable signal
+*/
+bool AOA_getCovarianceRaw(AoA_AntennaConfig_t *antConfig, AoA_Covariance_t *pCov, uint16_t numIqSamples, uint8_t sampleRate, uint8_t sampleSize, uint8_t slotDuration, uint8_t numAnt, int8_t *pIQ);
 #endif
+
+/**
+* @brief   Build the antenna configuration of an array described at runtime
+*
+*          Every element is paired with every later element, each pair uses
+*          the first pattern slot of its elements. The caller provides the
+*          storage, pairs must hold CALC_NUM_ANT_PAIRS(numElements) entries.
+*
+* @param   antConfig - configuration to fill
+* @param   numAnt - number of slots in the antenna pattern
+* @param   numElements - number of array elements
+* @param   pElement - array element of every pattern slot
+* @param   pPosition - element positions along the array axis in wavelengths
+* @param   pairs - pair table to fill
+*
+* @return  TRUE if every element is visited by the pattern
+*/
+bool AOA_initArrayConfig(AoA_AntennaConfig_t *antConfig, uint8_t numAnt, uint8_t numElements, uint8_t *pElement, float *pPosition, AoA_AntennaPair_t *pairs);
+
+/**
+* @brief   Angle of arrival from the pair angles of a linear array
+*
+*          Each pair with a spacing of at most half a wavelength gives
+*          asin(pairAngle / (360 * d)), the result is the mean over those pairs.
+*
+* @param   antConfig - antenna configuration, pair spacing in d
+* @param   antResult - pair angles of the last capture
+* @param   pAngle - returned angle in degrees from broadside
+*
+* @return  TRUE if at least one pair is unambiguous
+*/
+bool AOA_getArrayAngle(const AoA_AntennaConfig_t *antConfig, const AoA_AntennaResult_t *antResult, int16_t *pAngle);
+
+/**
+* @brief   Azimuth and elevation from the angles of both BOOSTXL-AOA arrays
+*
+*          A1 and A2 are at right angles in the board plane, each measures
+*          the direction cosine of the tag along its own axis. Together they
+*          give the azimuth over the full circle and the elevation from the
+*          board plane. On which side of the board the tag is stays unknown.
+*          Azimuths wrap at AOA_AZIMUTH_MIN, track and fuse them as angles
+*          of that turn (AOA_trackUpdateCircular, AOA_reportUpdate).
+*
+* @param   angleA1 - angle from the broadside of A1 in degrees
+* @param   angleA2 - angle from the broadside of A2 in degrees
+* @param   pAzimuth - returned azimuth in the board frame of the single array angles, AOA_AZIMUTH_MIN to 225
+* @param   pElevation - returned elevation, 0 in the board plane to 90 perpendicular to it
+*
+* @return  none
+*/
+void AOA_fuseArrayAngles(int16_t angleA1, int16_t angleA2, int16_t *pAzimuth, int16_t *pElevation);
+
+/**
+* @brief   Select how AOA_getPairAngles averages pair angles
+*
+* @param   avgMode - AOA_AVG_MODE_ANGLE/AOA_AVG_MODE_PHASOR
+*
+* @return  none
+*/
+void AOA_setAvgMode(AoA_AvgMode_t avgMode);
+
 /**
 * @brief   Initialize AoA for the defined role
 *
@@ -210,18 +528,22 @@ void AOA_cteCapEnable(uint8_t cteTime, uint8_t cteScanOvs, uint8_t cteOffset);
 uint16_t AOA_calcNumOfCteSamples(uint8_t cteTime, uint8_t cteScanOvs, uint8_t cteOffset);
 
 /**
-* @brief   This function will update the final result report with rssi and channel
-*          For RTLS Passive it will also send a command to enable RF RAM so we can read
+* @brief   For RTLS Passive this function will send a command to enable RF RAM so we can read
 *          the samples that we captured (if any)
 *
-* @param   rssi - rssi to be stamped on final result
-* @param   channel - channel to be stamped on final result
-* @param   samplesBuff - buffer to copy samples to
+* @param   seq - read returned by AOA_rfRamArm
 *
 */
-void AOA_postProcess(int8_t rssi, uint8_t channel, AoA_IQSample_Ext_t *samplesBuff);
+void AOA_postProcess(uint8_t seq);
 
 #ifdef RTLS_PASSIVE
+/**
+* @brief   Select the capture the next results are computed from
+*
+* @param   samplesBuff - AOA_RES_MAX_SIZE samples read out of RF RAM
+*/
+void AOA_setSamples(AoA_IQSample_Ext_t *samplesBuff);
+
 /**
 * @brief   Returns pointer to raw I/Q samples
 *
@@ -236,12 +558,6 @@ AoA_IQSample_Ext_t *AOA_getRawSamples(void);
 */
 uint8_t AOA_getActiveAnt(void);
 
-/**
-* @brief   Returns active antenna id
-*
-* @return  Pointer to Sample State
-*/
-AoA_IQSampleState_t AOA_getSampleState(void);
 /*********************************************************************
 *********************************************************************/
 
@@ -0,0 +1,289 @@
+/******************************************************************************
+
+ @file  AOA_cal.c
+
+ @brief AoA channel and angle calibration tables
+ Group: WCS, BTS
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2018-2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "rf_hal.h"
+#include "AOA_cal.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define AOA_CAL_HALF                     (1 << (AOA_CAL_FRAC_BITS - 1))
+
+// Range of a learned Q15 pair gain
+#define AOA_CAL_MIN_GAIN                 (1 << (AOA_CAL_FRAC_BITS - 2))
+#define AOA_CAL_MAX_GAIN                 UINT16_MAX
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+/*********************************************************************
+* @fn      AOA_calDivRound
+*
+* @brief   Divide rounding to the nearest integer
+*
+* @param   num - dividend
+* @param   den - divisor, positive
+*
+* @return  num / den
+*/
+static int64_t AOA_calDivRound(int64_t num, int64_t den)
+{
+  return (num >= 0) ? (num + den / 2) / den : -((-num + den / 2) / den);
+}
+
+/*********************************************************************
+ * PUBLIC FUNCTIONS
+ */
+
+/*********************************************************************
+* @fn      AOA_calInit
+*
+* @brief   Convert measured offsets to a calibration table
+*
+* @param   pCal - table to fill
+* @param   pPoints - table storage, AOA_CAL_SIZE(numBins) bytes
+* @param   numBins - angle bins per channel, 1 - AOA_CAL_MAX_BINS
+* @param   startAngle - angle of bin 0 in degrees
+* @param   stepAngle - degrees between two bins, ignored for a single bin
+* @param   pOffsets - offsets in degrees, AOA_CAL_NUM_CHANNELS rows of numBins
+*
+* @return  TRUE if the table is valid
+*/
+bool AOA_calInit(AoA_CalTable_t *pCal, AoA_CalPoint_t *pPoints, uint8_t numBins, int16_t startAngle, uint8_t stepAngle, const int8_t *pOffsets)
+{
+  if ((numBins == 0) || (numBins > AOA_CAL_MAX_BINS) || ((numBins > 1) && (stepAngle == 0)))
+  {
+    return FALSE;
+  }
+
+  for (uint16_t i = 0; i < AOA_CAL_NUM_CHANNELS * numBins; i++)
+  {
+    const uint8_t bin = i % numBins;
+
+    pPoints[i].offset = (int32_t)pOffsets[i] << AOA_CAL_FRAC_BITS;
+
+    // The last bin of a channel holds its offset beyond the table
+    if (bin == numBins - 1)
+    {
+      pPoints[i].slope = 0;
+    }
+    else
+    {
+      pPoints[i].slope = (((int32_t)pOffsets[i + 1] - pOffsets[i]) << AOA_CAL_FRAC_BITS) / stepAngle;
+    }
+  }
+
+  pCal->numBins = numBins;
+  pCal->startAngle = startAngle;
+  pCal->stepAngle = (numBins > 1) ? stepAngle : 1;
+  pCal->pPoints = pPoints;
+
+  return TRUE;
+}
+
+/*********************************************************************
+* @fn      AOA_calGetOffset
+*
+* @brief   Calibration offset of an angle
+*
+* @param   pCal - calibration table
+* @param   channel - BLE channel the angle was measured on
+* @param   angle - uncalibrated angle in degrees
+*
+* @return  offset in degrees, rounded
+*/
+int16_t AOA_calGetOffset(const AoA_CalTable_t *pCal, uint8_t channel, int16_t angle)
+{
+  const AoA_CalPoint_t *pRow = &pCal->pPoints[((channel < AOA_CAL_NUM_CHANNELS) ? channel : 0) * pCal->numBins];
+  const int32_t lastBin = pCal->numBins - 1;
+  int32_t delta = angle - pCal->startAngle;
+  int32_t bin;
+
+  // Below the first bin and above the last bin the offset of that bin is used
+  if (delta <= 0)
+  {
+    return (int16_t)((pRow[0].offset + AOA_CAL_HALF) >> AOA_CAL_FRAC_BITS);
+  }
+
+  bin = delta / pCal->stepAngle;
+
+  if (bin >= lastBin)
+  {
+    return (int16_t)((pRow[lastBin].offset + AOA_CAL_HALF) >> AOA_CAL_FRAC_BITS);
+  }
+
+  delta -= bin * pCal->stepAngle;
+
+  return (int16_t)((pRow[bin].offset + pRow[bin].slope * delta + AOA_CAL_HALF) >> AOA_CAL_FRAC_BITS);
+}
+
+/*********************************************************************
+* @fn      AOA_calCaptureInit
+*
+* @brief   Start a calibration capture
+*
+* @param   pCap - capture to start
+* @param   numPairs - pairs of the array, 1 - AOA_CAL_CAPTURE_MAX_PAIRS
+* @param   numAnglePairs - pairs the array angle is the mean of, 1 - numPairs
+* @param   refAngle - angle of the reference tag from broadside in degrees
+*
+* @return  TRUE if the capture can be taken
+*/
+bool AOA_calCaptureInit(AoA_CalCapture_t *pCap, uint8_t numPairs, uint8_t numAnglePairs, int16_t refAngle)
+{
+  if ((numPairs == 0) || (numPairs > AOA_CAL_CAPTURE_MAX_PAIRS) ||
+      (numAnglePairs == 0) || (numAnglePairs > numPairs))
+  {
+    return FALSE;
+  }
+
+  memset(pCap, 0, sizeof(AoA_CalCapture_t));
+  pCap->refAngle = refAngle;
+  pCap->numPairs = numPairs;
+  pCap->numAnglePairs = numAnglePairs;
+
+  return TRUE;
+}
+
+/*********************************************************************
+* @fn      AOA_calCaptureAdd
+*
+* @brief   Add the pair angles of one CTE to a calibration capture
+*
+* @param   pCap - capture
+* @param   channel - BLE channel of the CTE
+* @param   pPairAngle - pair angles of the CTE, numPairs entries
+*
+* @return  none
+*/
+void AOA_calCaptureAdd(AoA_CalCapture_t *pCap, uint8_t channel, const int16_t *pPairAngle)
+{
+  // A channel is full once its sums could overflow
+  if ((channel >= AOA_CAL_NUM_CHANNELS) || (pCap->count[channel] == UINT16_MAX))
+  {
+    return;
+  }
+
+  for (uint8_t p = 0; p < pCap->numPairs; p++)
+  {
+    pCap->sum[channel][p] += pPairAngle[p];
+  }
+
+  pCap->count[channel]++;
+  pCap->numCtes++;
+}
+
+/*********************************************************************
+* @fn      AOA_calCaptureSolve
+*
+* @brief   Learn pair gains and channel offsets from a calibration capture
+*
+* @param   pCap - capture
+* @param   pGain - in: Q15 pair gains the capture was taken with, out: learned gains
+* @param   sign - 1 if the offset is added to the array angle, -1 if it is subtracted
+* @param   pOffsets - in: current offsets, out: learned offsets in degrees, AOA_CAL_NUM_CHANNELS entries
+*
+* @return  none
+*/
+void AOA_calCaptureSolve(const AoA_CalCapture_t *pCap, uint16_t *pGain, int8_t sign, int8_t *pOffsets)
+{
+  uint16_t oldGain[AOA_CAL_CAPTURE_MAX_PAIRS];
+
+  // Scale every pair so its mean over all channels is the reference angle
+  for (uint8_t p = 0; p < pCap->numPairs; p++)
+  {
+    int64_t sum = 0;
+
+    oldGain[p] = pGain[p];
+
+    for (uint8_t ch = 0; ch < AOA_CAL_NUM_CHANNELS; ch++)
+    {
+      sum += pCap->sum[ch][p];
+    }
+
+    // The pair must see the tag on the side it is on
+    if ((pCap->numCtes != 0) && (abs(pCap->refAngle) >= AOA_CAL_MIN_GAIN_ANGLE) && ((sum > 0) == (pCap->refAngle > 0)) && (sum != 0))
+    {
+      int64_t gain = AOA_calDivRound((int64_t)oldGain[p] * pCap->refAngle * pCap->numCtes, sum);
+
+      gain = (gain < AOA_CAL_MIN_GAIN) ? AOA_CAL_MIN_GAIN : gain;
+      pGain[p] = (gain > AOA_CAL_MAX_GAIN) ? AOA_CAL_MAX_GAIN : (uint16_t)gain;
+    }
+  }
+
+  // Angles the new gains give, against the reference angle
+  for (uint8_t ch = 0; ch < AOA_CAL_NUM_CHANNELS; ch++)
+  {
+    int64_t angle = 0;
+    int32_t offset;
+
+    if (pCap->count[ch] < AOA_CAL_MIN_CTES)
+    {
+      continue;
+    }
+
+    // Q15 sum of the array angles
+    for (uint8_t p = 0; p < pCap->numAnglePairs; p++)
+    {
+      angle += AOA_calDivRound(((int64_t)pCap->sum[ch][p] * pGain[p]) << AOA_CAL_FRAC_BITS, oldGain[p]);
+    }
+
+    angle = AOA_calDivRound(angle, (int64_t)pCap->count[ch] * pCap->numAnglePairs);
+    offset = sign * (int32_t)AOA_calDivRound(((int64_t)pCap->refAngle << AOA_CAL_FRAC_BITS) - angle, 1 << AOA_CAL_FRAC_BITS);
+
+    pOffsets[ch] = (offset > INT8_MAX) ? INT8_MAX : ((offset < INT8_MIN) ? INT8_MIN : (int8_t)offset);
+  }
+}
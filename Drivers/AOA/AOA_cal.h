@@ -0,0 +1,220 @@
+/******************************************************************************
+
+ @file  AOA_cal.h
+
+ @brief AoA channel and angle calibration tables
+ Group: WCS, BTS
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2018-2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+
+
+/**
+ *  @defgroup AOA_CAL AOA_CAL
+ *  @brief This module corrects array angles by channel and angle
+ *
+ *  @{
+ *  @file  AOA_cal.h
+ *  @brief      AOA calibration table interface
+ */
+
+#ifndef AOA_CAL_H_
+#define AOA_CAL_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*******************************************************************************
+ * INCLUDES
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/// @brief BLE channels of a table, data channels 0-36 and advertising channels 37-39
+#define AOA_CAL_NUM_CHANNELS             40
+
+/// @brief Largest number of angle bins per channel
+#define AOA_CAL_MAX_BINS                 19
+
+/// @brief Fraction bits of the converted table
+#define AOA_CAL_FRAC_BITS                15
+
+/// @brief Bytes of the converted table of numBins angle bins
+#define AOA_CAL_SIZE(numBins)            (AOA_CAL_NUM_CHANNELS * (numBins) * sizeof(AoA_CalPoint_t))
+
+/// @brief Largest number of pairs a calibration capture keeps statistics of
+#define AOA_CAL_CAPTURE_MAX_PAIRS        3
+
+/// @brief CTEs a channel needs before a capture learns its offset
+#ifndef AOA_CAL_MIN_CTES
+#define AOA_CAL_MIN_CTES                 4
+#endif
+
+/// @brief Smallest reference angle in degrees a capture learns pair gains at
+///
+/// Close to broadside a gain error hardly changes the angle and cannot be told from an offset.
+#ifndef AOA_CAL_MIN_GAIN_ANGLE
+#define AOA_CAL_MIN_GAIN_ANGLE           15
+#endif
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+/// @brief Calibration at one angle bin, Q15 degrees
+typedef struct
+{
+  int32_t offset;            //!< Offset at the bin angle
+  int32_t slope;             //!< Offset change per degree up to the next bin
+} AoA_CalPoint_t;
+
+/// @brief Calibration offsets by channel and angle
+///
+/// Offsets are measured at numBins angles from startAngle in steps of
+/// stepAngle. Between two bins the offset is interpolated linearly, outside
+/// the bins the offset of the closest bin is used.
+typedef struct
+{
+  uint8_t numBins;           //!< Angle bins per channel, 1 for an offset per channel only
+  int16_t startAngle;        //!< Angle of bin 0 in degrees
+  uint8_t stepAngle;         //!< Degrees between two bins
+  AoA_CalPoint_t *pPoints;   //!< AOA_CAL_NUM_CHANNELS rows of numBins points
+} AoA_CalTable_t;
+
+/// @brief Pair angle statistics of a tag at a known angle, by channel
+typedef struct
+{
+  int16_t refAngle;          //!< Angle of the reference tag from broadside in degrees
+  uint8_t numPairs;          //!< Pairs with statistics, 1 - AOA_CAL_CAPTURE_MAX_PAIRS
+  uint8_t numAnglePairs;     //!< The array angle is the mean of the first numAnglePairs pairs
+  uint32_t numCtes;          //!< CTEs added on all channels
+  uint16_t count[AOA_CAL_NUM_CHANNELS];                           //!< CTEs added per channel
+  int32_t sum[AOA_CAL_NUM_CHANNELS][AOA_CAL_CAPTURE_MAX_PAIRS];   //!< Sum of the pair angles per channel
+} AoA_CalCapture_t;
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+
+/**
+* @brief   Convert measured offsets to a calibration table
+*
+*          The interpolation slopes are computed here, so a lookup takes
+*          no division and no float.
+*
+* @param   pCal - table to fill
+* @param   pPoints - table storage, AOA_CAL_SIZE(numBins) bytes
+* @param   numBins - angle bins per channel, 1 - AOA_CAL_MAX_BINS
+* @param   startAngle - angle of bin 0 in degrees
+* @param   stepAngle - degrees between two bins, ignored for a single bin
+* @param   pOffsets - offsets in degrees, AOA_CAL_NUM_CHANNELS rows of numBins
+*
+* @return  TRUE if the table is valid
+*/
+bool AOA_calInit(AoA_CalTable_t *pCal, AoA_CalPoint_t *pPoints, uint8_t numBins, int16_t startAngle, uint8_t stepAngle, const int8_t *pOffsets);
+
+/**
+* @brief   Calibration offset of an angle
+*
+* @param   pCal - calibration table
+* @param   channel - BLE channel the angle was measured on
+* @param   angle - uncalibrated angle in degrees
+*
+* @return  offset in degrees, rounded
+*/
+int16_t AOA_calGetOffset(const AoA_CalTable_t *pCal, uint8_t channel, int16_t angle);
+
+/**
+* @brief   Start a calibration capture
+*
+* @param   pCap - capture to start
+* @param   numPairs - pairs of the array, 1 - AOA_CAL_CAPTURE_MAX_PAIRS
+* @param   numAnglePairs - pairs the array angle is the mean of, 1 - numPairs
+* @param   refAngle - angle of the reference tag from broadside in degrees
+*
+* @return  TRUE if the capture can be taken
+*/
+bool AOA_calCaptureInit(AoA_CalCapture_t *pCap, uint8_t numPairs, uint8_t numAnglePairs, int16_t refAngle);
+
+/**
+* @brief   Add the pair angles of one CTE to a calibration capture
+*
+* @param   pCap - capture
+* @param   channel - BLE channel of the CTE
+* @param   pPairAngle - pair angles of the CTE, numPairs entries
+*
+* @return  none
+*/
+void AOA_calCaptureAdd(AoA_CalCapture_t *pCap, uint8_t channel, const int16_t *pPairAngle);
+
+/**
+* @brief   Learn pair gains and channel offsets from a calibration capture
+*
+*          Gains are learned first, from the statistics of all channels,
+*          and the offsets from the angles the new gains give. Gains are
+*          left as they are if the reference angle is below
+*          AOA_CAL_MIN_GAIN_ANGLE, offsets of channels with fewer than
+*          AOA_CAL_MIN_CTES CTEs.
+*
+* @param   pCap - capture
+* @param   pGain - in: Q15 pair gains the capture was taken with, out: learned gains
+* @param   sign - 1 if the offset is added to the array angle, -1 if it is subtracted
+* @param   pOffsets - in: current offsets, out: learned offsets in degrees, AOA_CAL_NUM_CHANNELS entries
+*
+* @return  none
+*/
+void AOA_calCaptureSolve(const AoA_CalCapture_t *pCap, uint16_t *pGain, int8_t sign, int8_t *pOffsets);
+
+/*********************************************************************
+*********************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AOA_CAL_H_ */
+
+/** @} End AOA_CAL */
@@ -0,0 +1,299 @@
+/******************************************************************************
+
+ @file  AOA_iq.c
+
+ @brief AoA IQ capture handles
+ Group: WCS, BTS
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2018-2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <ti/sysbios/hal/Hwi.h>
+
+#include "rf_hal.h"
+#include "AOA_iq.h"
+
+#ifdef RTLS_MASTER
+
+/*********************************************************************
+ * MACROS
+ */
+
+#define AOA_IQ_HANDLE(gen, entry)  ((AoA_IqHandle_t)(((gen) << 8) | (entry)))
+#define AOA_IQ_ENTRY(handle)       ((handle) & 0xFF)
+#define AOA_IQ_GEN(handle)         ((handle) >> 8)
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef struct
+{
+  int8_t *pIQ;
+  pfnAoaIqFree_t pfnFree;
+  uint8_t refCount;                // References held, 0 = free
+  uint8_t gen;                     // Bumped every time the entry is handed out
+} AoA_IqEntry_t;
+
+typedef struct
+{
+  AoA_IqEntry_t entries[AOA_IQ_NUM_HANDLES];
+  AoA_IqStats_t stats;
+} AoA_IqHandles_t;
+
+/*********************************************************************
+ * GLOBAL VARIABLES
+ */
+
+static AoA_IqHandles_t gAoaIq =
+{
+  .stats.numFree = AOA_IQ_NUM_HANDLES,
+  .stats.minFree = AOA_IQ_NUM_HANDLES,
+};
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+/*********************************************************************
+* @fn      AOA_iqEntry
+*
+* @brief   Find the entry of a held handle, called with interrupts disabled
+*
+* @param   handle - handle returned by AOA_iqWrap
+*
+* @return  entry, NULL if handle is not held or was handed out again
+*/
+static AoA_IqEntry_t *AOA_iqEntry(AoA_IqHandle_t handle)
+{
+  AoA_IqEntry_t *pEntry;
+
+  if (AOA_IQ_ENTRY(handle) >= AOA_IQ_NUM_HANDLES)
+  {
+    return NULL;
+  }
+
+  pEntry = &gAoaIq.entries[AOA_IQ_ENTRY(handle)];
+
+  return ((pEntry->refCount != 0) && (pEntry->gen == AOA_IQ_GEN(handle))) ? pEntry : NULL;
+}
+
+/*********************************************************************
+* @fn      AOA_iqWrap
+*
+* @brief   Wrap a capture in a handle with one reference
+*
+* @param   pIQ - capture, freed with pfnFree once the last reference is given back
+* @param   pfnFree - frees pIQ
+*
+* @return  handle, AOA_IQ_NO_HANDLE if none is free, the caller keeps pIQ then
+*/
+AoA_IqHandle_t AOA_iqWrap(int8_t *pIQ, pfnAoaIqFree_t pfnFree)
+{
+  AoA_IqHandle_t handle = AOA_IQ_NO_HANDLE;
+  volatile uint32_t keyHwi;
+
+  keyHwi = Hwi_disable();
+
+  for (uint8_t entry = 0; (entry < AOA_IQ_NUM_HANDLES) && (pIQ != NULL); entry++)
+  {
+    AoA_IqEntry_t *pEntry = &gAoaIq.entries[entry];
+
+    if (pEntry->refCount == 0)
+    {
+      pEntry->pIQ = pIQ;
+      pEntry->pfnFree = pfnFree;
+      pEntry->refCount = 1;
+      pEntry->gen++;
+      handle = AOA_IQ_HANDLE(pEntry->gen, entry);
+      break;
+    }
+  }
+
+  if (handle != AOA_IQ_NO_HANDLE)
+  {
+    gAoaIq.stats.numWraps++;
+    gAoaIq.stats.numFree--;
+
+    if (gAoaIq.stats.numFree < gAoaIq.stats.minFree)
+    {
+      gAoaIq.stats.minFree = gAoaIq.stats.numFree;
+    }
+  }
+  else
+  {
+    gAoaIq.stats.numDrops++;
+  }
+
+  Hwi_restore(keyHwi);
+
+  return handle;
+}
+
+/*********************************************************************
+* @fn      AOA_iqGet
+*
+* @brief   Samples of a capture
+*
+* @param   handle - handle returned by AOA_iqWrap and still held
+*
+* @return  capture, NULL if handle is not held
+*/
+int8_t *AOA_iqGet(AoA_IqHandle_t handle)
+{
+  AoA_IqEntry_t *pEntry;
+  int8_t *pIQ = NULL;
+  volatile uint32_t keyHwi;
+
+  keyHwi = Hwi_disable();
+
+  if ((pEntry = AOA_iqEntry(handle)) != NULL)
+  {
+    pIQ = pEntry->pIQ;
+  }
+
+  Hwi_restore(keyHwi);
+
+  return pIQ;
+}
+
+/*********************************************************************
+* @fn      AOA_iqRetain
+*
+* @brief   Take another reference to a capture
+*
+* @param   handle - handle returned by AOA_iqWrap and still held
+*
+* @return  TRUE on success, FALSE if handle is not held
+*/
+bool AOA_iqRetain(AoA_IqHandle_t handle)
+{
+  AoA_IqEntry_t *pEntry;
+  bool status = FALSE;
+  volatile uint32_t keyHwi;
+
+  keyHwi = Hwi_disable();
+
+  if (((pEntry = AOA_iqEntry(handle)) != NULL) && (pEntry->refCount != UINT8_MAX))
+  {
+    pEntry->refCount++;
+    status = TRUE;
+  }
+  else
+  {
+    gAoaIq.stats.numBadRefs++;
+  }
+
+  Hwi_restore(keyHwi);
+
+  return status;
+}
+
+/*********************************************************************
+* @fn      AOA_iqRelease
+*
+* @brief   Give back a reference to a capture, the last one frees it
+*
+* @param   handle - handle returned by AOA_iqWrap and still held
+*
+* @return  TRUE on success, FALSE if handle is not held
+*/
+bool AOA_iqRelease(AoA_IqHandle_t handle)
+{
+  AoA_IqEntry_t *pEntry;
+  int8_t *pFree = NULL;
+  pfnAoaIqFree_t pfnFree = NULL;
+  bool status = FALSE;
+  volatile uint32_t keyHwi;
+
+  keyHwi = Hwi_disable();
+
+  // The generation tells a stale handle from the one of the capture now in the entry
+  if ((pEntry = AOA_iqEntry(handle)) != NULL)
+  {
+    if (--pEntry->refCount == 0)
+    {
+      pFree = pEntry->pIQ;
+      pfnFree = pEntry->pfnFree;
+      pEntry->pIQ = NULL;
+      gAoaIq.stats.numFree++;
+    }
+
+    status = TRUE;
+  }
+  else
+  {
+    gAoaIq.stats.numBadRefs++;
+  }
+
+  Hwi_restore(keyHwi);
+
+  // The capture goes back to the heap with interrupts enabled
+  if ((pFree != NULL) && (pfnFree != NULL))
+  {
+    pfnFree(pFree);
+  }
+
+  return status;
+}
+
+/*********************************************************************
+* @fn      AOA_iqGetStats
+*
+* @brief   Read the handle statistics
+*
+* @param   pStats - statistics
+*
+* @return  none
+*/
+void AOA_iqGetStats(AoA_IqStats_t *pStats)
+{
+  volatile uint32_t keyHwi;
+
+  keyHwi = Hwi_disable();
+  *pStats = gAoaIq.stats;
+  Hwi_restore(keyHwi);
+}
+
+#endif // RTLS_MASTER
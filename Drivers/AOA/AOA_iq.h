@@ -0,0 +1,171 @@
+/******************************************************************************
+
+ @file  AOA_iq.h
+
+ @brief AoA IQ capture handles
+ Group: WCS, BTS
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2018-2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+
+
+/**
+ *  @defgroup AOA_IQ AOA_IQ
+ *  @brief This module counts the references to IQ captures handed over on the heap
+ *
+ *  A capture is wrapped in a handle with one reference, owned by the caller.
+ *  The samples stay where they were allocated and are never copied. Every
+ *  module that keeps the capture past the call it was handed over in takes
+ *  its own reference with AOA_iqRetain and gives it back with AOA_iqRelease,
+ *  the last release frees the capture. A handle carries a generation, so a
+ *  stale handle is rejected once its entry was handed to the next capture.
+ *
+ *  @{
+ *  @file  AOA_iq.h
+ *  @brief      AOA IQ capture handle interface
+ */
+
+#ifndef AOA_IQ_H_
+#define AOA_IQ_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*******************************************************************************
+ * INCLUDES
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "AOA.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Captures held at the same time at most, later ones are dropped until one is released
+#ifndef AOA_IQ_NUM_HANDLES
+#define AOA_IQ_NUM_HANDLES        3
+#endif
+
+#define AOA_IQ_NO_HANDLE          0xFFFF  //!< No capture
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+/// @brief Generation in the high byte, entry in the low byte
+typedef uint16_t AoA_IqHandle_t;
+
+/// @brief Frees a capture once its last reference is given back
+typedef void (*pfnAoaIqFree_t)(int8_t *pIQ);
+
+/// @brief Handle statistics
+typedef struct
+{
+  uint32_t numWraps;         //!< Captures wrapped
+  uint32_t numDrops;         //!< Captures not wrapped, no handle free
+  uint32_t numBadRefs;       //!< Retains and releases of a handle that is not held
+  uint8_t  numFree;          //!< Handles free now
+  uint8_t  minFree;          //!< Fewest handles free so far
+} AoA_IqStats_t;
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+
+/**
+* @brief   Wrap a capture in a handle with one reference
+*
+* @param   pIQ - capture, freed with pfnFree once the last reference is given back
+* @param   pfnFree - frees pIQ
+*
+* @return  handle, AOA_IQ_NO_HANDLE if none is free, the caller keeps pIQ then
+*/
+AoA_IqHandle_t AOA_iqWrap(int8_t *pIQ, pfnAoaIqFree_t pfnFree);
+
+/**
+* @brief   Samples of a capture
+*
+* @param   handle - handle returned by AOA_iqWrap and still held
+*
+* @return  capture, NULL if handle is not held
+*/
+int8_t *AOA_iqGet(AoA_IqHandle_t handle);
+
+/**
+* @brief   Take another reference to a capture
+*
+* @param   handle - handle returned by AOA_iqWrap and still held
+*
+* @return  TRUE on success, FALSE if handle is not held
+*/
+bool AOA_iqRetain(AoA_IqHandle_t handle);
+
+/**
+* @brief   Give back a reference to a capture, the last one frees it
+*
+* @param   handle - handle returned by AOA_iqWrap and still held
+*
+* @return  TRUE on success, FALSE if handle is not held
+*/
+bool AOA_iqRelease(AoA_IqHandle_t handle);
+
+/**
+* @brief   Read the handle statistics
+*
+* @param   pStats - statistics
+*
+* @return  none
+*/
+void AOA_iqGetStats(AoA_IqStats_t *pStats);
+
+/*********************************************************************
+*********************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AOA_IQ_H_ */
+
+/** @} End AOA_IQ */
@@ -0,0 +1,878 @@
+/******************************************************************************
+
+ @file  AOA_kernel.c
+
+ @brief This file contains the vectorized sample kernels used by AOA.c
+ Group: WCS, BTS
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2018-2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "AOA_kernel.h"
+
+#if (AOA_KERNEL_IMPL == AOA_KERNEL_IMPL_ARM_DSP)
+#include <arm_acle.h>
+#elif (AOA_KERNEL_IMPL == AOA_KERNEL_IMPL_AVX2)
+#include <immintrin.h>
+#elif (AOA_KERNEL_IMPL == AOA_KERNEL_IMPL_SSE2)
+#include <emmintrin.h>
+#endif
+
+/*********************************************************************
+ * MACROS
+ */
+
+// Passive reads AoA_IQSample_Ext_t straight from RF core RAM, Q is in the low half-word
+#ifdef RTLS_PASSIVE
+#define AOA_KERNEL_EXT_Q_LOW             1
+#else
+#define AOA_KERNEL_EXT_Q_LOW             0
+#endif
+
+// atan2 works in 2^18 steps per turn internally, two bits below AOA_ATAN_MAX_BITS
+#define AOA_ATAN_INT_BITS                18
+#define AOA_ATAN_EIGHTH_TURN             (1 << (AOA_ATAN_INT_BITS - 3))
+
+// atan(t) table, t in [0, 1] in AOA_ATAN_LUT_SIZE segments
+#define AOA_ATAN_LUT_BITS                8
+#define AOA_ATAN_LUT_SIZE                (1 << AOA_ATAN_LUT_BITS)
+
+// 1/d table, d in [1, 2) in AOA_RECIP_LUT_SIZE segments
+#define AOA_RECIP_LUT_BITS               6
+#define AOA_RECIP_LUT_SIZE               (1 << AOA_RECIP_LUT_BITS)
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// atan(i/256) in 2^18 steps per turn
+static const uint16_t aoaAtanLut[AOA_ATAN_LUT_SIZE + 1] =
+{
+  0x0000, 0x00A3, 0x0146, 0x01E9, 0x028C, 0x032F, 0x03D2, 0x0475, 0x0517, 0x05BA, 0x065D, 0x0700,
+  0x07A2, 0x0845, 0x08E7, 0x098A, 0x0A2C, 0x0ACF, 0x0B71, 0x0C13, 0x0CB5, 0x0D57, 0x0DF9, 0x0E9A,
+  0x0F3C, 0x0FDD, 0x107F, 0x1120, 0x11C1, 0x1262, 0x1303, 0x13A4, 0x1444, 0x14E5, 0x1585, 0x1625,
+  0x16C5, 0x1765, 0x1804, 0x18A4, 0x1943, 0x19E2, 0x1A80, 0x1B1F, 0x1BBD, 0x1C5C, 0x1CFA, 0x1D97,
+  0x1E35, 0x1ED2, 0x1F6F, 0x200C, 0x20A9, 0x2145, 0x21E1, 0x227D, 0x2319, 0x23B4, 0x2450, 0x24EA,
+  0x2585, 0x261F, 0x26BA, 0x2753, 0x27ED, 0x2886, 0x291F, 0x29B8, 0x2A50, 0x2AE8, 0x2B80, 0x2C17,
+  0x2CAF, 0x2D46, 0x2DDC, 0x2E72, 0x2F08, 0x2F9E, 0x3033, 0x30C8, 0x315D, 0x31F1, 0x3285, 0x3319,
+  0x33AC, 0x343F, 0x34D2, 0x3564, 0x35F6, 0x3687, 0x3719, 0x37A9, 0x383A, 0x38CA, 0x395A, 0x39E9,
+  0x3A78, 0x3B07, 0x3B95, 0x3C23, 0x3CB1, 0x3D3E, 0x3DCB, 0x3E58, 0x3EE4, 0x3F6F, 0x3FFB, 0x4086,
+  0x4110, 0x419A, 0x4224, 0x42AD, 0x4336, 0x43BF, 0x4447, 0x44CF, 0x4556, 0x45DD, 0x4664, 0x46EA,
+  0x4770, 0x47F5, 0x487A, 0x48FF, 0x4983, 0x4A07, 0x4A8B, 0x4B0D, 0x4B90, 0x4C12, 0x4C94, 0x4D15,
+  0x4D96, 0x4E17, 0x4E97, 0x4F17, 0x4F96, 0x5015, 0x5093, 0x5111, 0x518F, 0x520C, 0x5289, 0x5306,
+  0x5382, 0x53FD, 0x5478, 0x54F3, 0x556E, 0x55E8, 0x5661, 0x56DA, 0x5753, 0x57CB, 0x5843, 0x58BA,
+  0x5932, 0x59A8, 0x5A1E, 0x5A94, 0x5B0A, 0x5B7F, 0x5BF3, 0x5C67, 0x5CDB, 0x5D4E, 0x5DC1, 0x5E34,
+  0x5EA6, 0x5F18, 0x5F89, 0x5FFA, 0x606A, 0x60DB, 0x614A, 0x61B9, 0x6228, 0x6297, 0x6305, 0x6373,
+  0x63E0, 0x644D, 0x64B9, 0x6525, 0x6591, 0x65FC, 0x6667, 0x66D1, 0x673B, 0x67A5, 0x680E, 0x6877,
+  0x68E0, 0x6948, 0x69B0, 0x6A17, 0x6A7E, 0x6AE4, 0x6B4B, 0x6BB0, 0x6C16, 0x6C7B, 0x6CDF, 0x6D44,
+  0x6DA8, 0x6E0B, 0x6E6E, 0x6ED1, 0x6F33, 0x6F95, 0x6FF7, 0x7058, 0x70B9, 0x7119, 0x717A, 0x71D9,
+  0x7239, 0x7298, 0x72F6, 0x7355, 0x73B3, 0x7410, 0x746D, 0x74CA, 0x7527, 0x7583, 0x75DF, 0x763A,
+  0x7695, 0x76F0, 0x774A, 0x77A4, 0x77FE, 0x7857, 0x78B0, 0x7909, 0x7961, 0x79B9, 0x7A10, 0x7A68,
+  0x7ABF, 0x7B15, 0x7B6B, 0x7BC1, 0x7C17, 0x7C6C, 0x7CC1, 0x7D16, 0x7D6A, 0x7DBE, 0x7E11, 0x7E65,
+  0x7EB7, 0x7F0A, 0x7F5C, 0x7FAE, 0x8000
+};
+
+// 2^31/(1 + i/64)
+static const uint32_t aoaRecipLut[AOA_RECIP_LUT_SIZE + 1] =
+{
+  0x80000000, 0x7E07E07E, 0x7C1F07C2, 0x7A44C6B0, 0x78787878, 0x76B981DB,
+  0x75075075, 0x73615A24, 0x71C71C72, 0x70381C0E, 0x6EB3E453, 0x6D3A06D4,
+  0x6BCA1AF3, 0x6A63BD82, 0x69069069, 0x67B23A54, 0x66666666, 0x6522C3F3,
+  0x63E7063E, 0x62B2E43E, 0x61861862, 0x60606060, 0x5F417D06, 0x5E293206,
+  0x5D1745D1, 0x5C0B8170, 0x5B05B05B, 0x5A05A05A, 0x590B2164, 0x58160581,
+  0x572620AE, 0x563B48C2, 0x55555555, 0x54741FAC, 0x5397829D, 0x52BF5A81,
+  0x51EB851F, 0x511BE196, 0x50505050, 0x4F88B2F4, 0x4EC4EC4F, 0x4E04E04E,
+  0x4D4873ED, 0x4C8F8D29, 0x4BDA12F7, 0x4B27ED36, 0x4A7904A8, 0x49CD42E2,
+  0x49249249, 0x487EDE05, 0x47DC11F7, 0x473C1AB7, 0x469EE584, 0x46046046,
+  0x456C797E, 0x44D72045, 0x44444444, 0x43B3D5B0, 0x4325C53F, 0x429A042A,
+  0x42108421, 0x4189374C, 0x41041041, 0x40810204, 0x40000000
+};
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+/*********************************************************************
+* @fn      AOA_cmacConjRunScalar
+*
+* @brief   X*conj(Y) over n consecutive 8 bit samples
+*
+* @param   pX, pY - first samples
+* @param   n - number of samples
+* @param   pRe, pIm - 32 bit accumulators
+*
+* @return  none
+*/
+static inline void AOA_cmacConjRunScalar(const AoA_IQSample_t *pX, const AoA_IQSample_t *pY, uint32_t n, int32_t *pRe, int32_t *pIm)
+{
+  int32_t re = *pRe;
+  int32_t im = *pIm;
+
+  for (uint32_t k = 0; k < n; k++)
+  {
+    re += pX[k].i * pY[k].i + pX[k].q * pY[k].q;
+    im += pX[k].q * pY[k].i - pX[k].i * pY[k].q;
+  }
+
+  *pRe = re;
+  *pIm = im;
+}
+
+/*********************************************************************
+* @fn      AOA_cmacConjExtRunScalar
+*
+* @brief   X*conj(Y) over n consecutive 16 bit samples
+*
+* @param   pX, pY - first samples
+* @param   n - number of samples
+* @param   pRe, pIm - 64 bit accumulators
+*
+* @return  none
+*/
+static inline void AOA_cmacConjExtRunScalar(const AoA_IQSample_Ext_t *pX, const AoA_IQSample_Ext_t *pY, uint32_t n, int64_t *pRe, int64_t *pIm)
+{
+  int64_t re = *pRe;
+  int64_t im = *pIm;
+
+  for (uint32_t k = 0; k < n; k++)
+  {
+    re += (int64_t)(pX[k].i * pY[k].i) + (int64_t)(pX[k].q * pY[k].q);
+    im += (int64_t)(pX[k].q * pY[k].i) - (int64_t)(pX[k].i * pY[k].q);
+  }
+
+  *pRe = re;
+  *pIm = im;
+}
+
+/*********************************************************************
+* @fn      AOA_magBitsRunScalar
+*
+* @brief   OR of the magnitudes of n consecutive 16 bit samples
+*
+*          v ^ (v >> 15) is v for positive and -v - 1 for negative v, so
+*          -128 takes as few bits as 127. The highest bit set in the
+*          result is the highest bit of the largest I or Q.
+*
+* @param   pIQ - first sample
+* @param   n - number of samples
+* @param   bits - magnitudes so far
+*
+* @return  bits with the magnitudes of the run added
+*/
+static inline uint32_t AOA_magBitsRunScalar(const AoA_IQSample_Ext_t *pIQ, uint32_t n, uint32_t bits)
+{
+  for (uint32_t k = 0; k < n; k++)
+  {
+    const int32_t i = pIQ[k].i;
+    const int32_t q = pIQ[k].q;
+
+    bits |= (uint32_t)((i ^ (i >> 15)) | (q ^ (q >> 15)));
+  }
+
+  return bits;
+}
+
+/*********************************************************************
+* @fn      AOA_narrowRunScalar
+*
+* @brief   Shift n consecutive 16 bit samples into 8 bit samples
+*
+*          Rounded to nearest and saturated. Output sample k is written
+*          after input sample k was read and is half its size, so pOut may
+*          be pIn.
+*
+* @param   pIn - first 16 bit sample
+* @param   pOut - first 8 bit sample
+* @param   n - number of samples
+* @param   shift - right shift
+*
+* @return  none
+*/
+static inline void AOA_narrowRunScalar(const AoA_IQSample_Ext_t *pIn, AoA_IQSample_t *pOut, uint32_t n, uint8_t shift)
+{
+  const int32_t round = (shift == 0) ? 0 : (1 << (shift - 1));
+
+  for (uint32_t k = 0; k < n; k++)
+  {
+    const int32_t i = (pIn[k].i + round) >> shift;
+    const int32_t q = (pIn[k].q + round) >> shift;
+
+    pOut[k].i = (int8_t)((i > INT8_MAX) ? INT8_MAX : ((i < INT8_MIN) ? INT8_MIN : i));
+    pOut[k].q = (int8_t)((q > INT8_MAX) ? INT8_MAX : ((q < INT8_MIN) ? INT8_MIN : q));
+  }
+}
+
+#if (AOA_KERNEL_IMPL == AOA_KERNEL_IMPL_ARM_DSP)
+/*********************************************************************
+* @fn      AOA_cmacConjRun
+*
+* @brief   Cortex-M4 X*conj(Y) over n consecutive 8 bit samples
+*
+*          Two samples are loaded per word and split into I and Q
+*          half-word pairs with SXTB16, then multiplied with SMLAD.
+*/
+static inline void AOA_cmacConjRun(const AoA_IQSample_t *pX, const AoA_IQSample_t *pY, uint32_t n, int32_t *pRe, int32_t *pIm)
+{
+  int32_t re = *pRe;
+  int32_t imP = 0;
+  int32_t imN = 0;
+  uint32_t k;
+
+  for (k = 0; k + 2 <= n; k += 2)
+  {
+    uint32_t xw, yw;
+    int16x2_t xi, xq, yi, yq;
+
+    memcpy(&xw, &pX[k], sizeof(xw));
+    memcpy(&yw, &pY[k], sizeof(yw));
+
+    xi = __sxtb16(xw);
+    xq = __sxtb16(__ror(xw, 8));
+    yi = __sxtb16(yw);
+    yq = __sxtb16(__ror(yw, 8));
+
+    re  = __smlad(xi, yi, re);
+    re  = __smlad(xq, yq, re);
+    imP = __smlad(xq, yi, imP);
+    imN = __smlad(xi, yq, imN);
+  }
+
+  *pRe = re;
+  *pIm += imP - imN;
+
+  AOA_cmacConjRunScalar(&pX[k], &pY[k], n - k, pRe, pIm);
+}
+
+/*********************************************************************
+* @fn      AOA_cmacConjExtRun
+*
+* @brief   Cortex-M4 X*conj(Y) over n consecutive 16 bit samples
+*
+*          Every sample is one word, SMLALD gives the real part and
+*          SMLSLDX the imaginary part, both with a 64 bit accumulator.
+*/
+static inline void AOA_cmacConjExtRun(const AoA_IQSample_Ext_t *pX, const AoA_IQSample_Ext_t *pY, uint32_t n, int64_t *pRe, int64_t *pIm)
+{
+  int64_t re = *pRe;
+  int64_t im = *pIm;
+
+  for (uint32_t k = 0; k < n; k++)
+  {
+    int16x2_t xw, yw;
+
+    memcpy(&xw, &pX[k], sizeof(xw));
+    memcpy(&yw, &pY[k], sizeof(yw));
+
+    re = __smlald(xw, yw, re);
+#if AOA_KERNEL_EXT_Q_LOW
+    im = __smlsldx(xw, yw, im);
+#else
+    im = __smlsldx(yw, xw, im);
+#endif
+  }
+
+  *pRe = re;
+  *pIm = im;
+}
+
+/*********************************************************************
+* @fn      AOA_narrowRun
+*
+* @brief   Cortex-M4 narrowing of n consecutive 16 bit samples
+*
+*          One word load per sample, SSAT saturates the shifted half-words.
+*/
+static inline void AOA_narrowRun(const AoA_IQSample_Ext_t *pIn, AoA_IQSample_t *pOut, uint32_t n, uint8_t shift)
+{
+  const int32_t round = (shift == 0) ? 0 : (1 << (shift - 1));
+
+  for (uint32_t k = 0; k < n; k++)
+  {
+    int32_t w;
+    int32_t lo, hi;
+
+    memcpy(&w, &pIn[k], sizeof(w));
+
+    lo = __ssat(((int16_t)w + round) >> shift, 8);
+    hi = __ssat(((w >> 16) + round) >> shift, 8);
+
+#if AOA_KERNEL_EXT_Q_LOW
+    pOut[k].i = (int8_t)hi;
+    pOut[k].q = (int8_t)lo;
+#else
+    pOut[k].i = (int8_t)lo;
+    pOut[k].q = (int8_t)hi;
+#endif
+  }
+}
+
+// Cortex-M4 has no half-word shift, the scalar loop is as short
+#define AOA_magBitsRun        AOA_magBitsRunScalar
+
+#elif (AOA_KERNEL_IMPL == AOA_KERNEL_IMPL_SSE2) || (AOA_KERNEL_IMPL == AOA_KERNEL_IMPL_AVX2)
+/*********************************************************************
+* @fn      AOA_addWiden128
+*
+* @brief   Add the four 32 bit lanes of v to the two 64 bit lanes of acc
+*/
+static inline __m128i AOA_addWiden128(__m128i acc, __m128i v)
+{
+  __m128i sign = _mm_srai_epi32(v, 31);
+
+  acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(v, sign));
+  return _mm_add_epi64(acc, _mm_unpackhi_epi32(v, sign));
+}
+
+/*********************************************************************
+* @fn      AOA_sum32x4
+*
+* @brief   Horizontal sum of four 32 bit lanes
+*/
+static inline int32_t AOA_sum32x4(__m128i v)
+{
+  v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+  v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(v);
+}
+
+/*********************************************************************
+* @fn      AOA_sum64x2
+*
+* @brief   Horizontal sum of two 64 bit lanes
+*/
+static inline int64_t AOA_sum64x2(__m128i v)
+{
+  int64_t lanes[2];
+
+  _mm_storeu_si128((__m128i *)lanes, v);
+  return lanes[0] + lanes[1];
+}
+
+/*********************************************************************
+* @fn      AOA_cmacConjRun
+*
+* @brief   SSE2/AVX2 X*conj(Y) over n consecutive 8 bit samples
+*
+*          Samples are sign extended to 16 bit I/Q pairs. Every 32 bit lane
+*          of _mm_madd_epi16 then holds Xi*Yi + Xq*Yq of one sample, which
+*          can not overflow for 8 bit input.
+*/
+static inline void AOA_cmacConjRun(const AoA_IQSample_t *pX, const AoA_IQSample_t *pY, uint32_t n, int32_t *pRe, int32_t *pIm)
+{
+  const __m128i maskLo = _mm_set1_epi32(0x0000FFFF);
+  const __m128i maskHi = _mm_set1_epi32((int32_t)0xFFFF0000);
+  __m128i re = _mm_setzero_si128();
+  __m128i im = _mm_setzero_si128();
+  uint32_t k = 0;
+
+#if (AOA_KERNEL_IMPL == AOA_KERNEL_IMPL_AVX2)
+  {
+    const __m256i maskLo256 = _mm256_set1_epi32(0x0000FFFF);
+    const __m256i maskHi256 = _mm256_set1_epi32((int32_t)0xFFFF0000);
+    __m256i re256 = _mm256_setzero_si256();
+    __m256i im256 = _mm256_setzero_si256();
+
+    for (; k + 8 <= n; k += 8)
+    {
+      __m256i x = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)&pX[k]));
+      __m256i y = _mm256_cvtepi8_epi16(_mm_loadu_si128((const __m128i *)&pY[k]));
+      __m256i ys = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(y, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+
+      re256 = _mm256_add_epi32(re256, _mm256_madd_epi16(x, y));
+      im256 = _mm256_add_epi32(im256, _mm256_sub_epi32(_mm256_madd_epi16(_mm256_and_si256(x, maskHi256), ys),
+                                                       _mm256_madd_epi16(_mm256_and_si256(x, maskLo256), ys)));
+    }
+
+    re = _mm_add_epi32(_mm256_castsi256_si128(re256), _mm256_extracti128_si256(re256, 1));
+    im = _mm_add_epi32(_mm256_castsi256_si128(im256), _mm256_extracti128_si256(im256, 1));
+  }
+#endif
+
+  for (; k + 8 <= n; k += 8)
+  {
+    __m128i xv = _mm_loadu_si128((const __m128i *)&pX[k]);
+    __m128i yv = _mm_loadu_si128((const __m128i *)&pY[k]);
+
+    // Sign extend bytes into 16 bit lanes, I in the low half-word
+    __m128i x0 = _mm_srai_epi16(_mm_unpacklo_epi8(xv, xv), 8);
+    __m128i x1 = _mm_srai_epi16(_mm_unpackhi_epi8(xv, xv), 8);
+    __m128i y0 = _mm_srai_epi16(_mm_unpacklo_epi8(yv, yv), 8);
+    __m128i y1 = _mm_srai_epi16(_mm_unpackhi_epi8(yv, yv), 8);
+    __m128i ys0 = _mm_shufflehi_epi16(_mm_shufflelo_epi16(y0, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+    __m128i ys1 = _mm_shufflehi_epi16(_mm_shufflelo_epi16(y1, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+
+    re = _mm_add_epi32(re, _mm_add_epi32(_mm_madd_epi16(x0, y0), _mm_madd_epi16(x1, y1)));
+    im = _mm_add_epi32(im, _mm_sub_epi32(_mm_madd_epi16(_mm_and_si128(x0, maskHi), ys0),
+                                         _mm_madd_epi16(_mm_and_si128(x0, maskLo), ys0)));
+    im = _mm_add_epi32(im, _mm_sub_epi32(_mm_madd_epi16(_mm_and_si128(x1, maskHi), ys1),
+                                         _mm_madd_epi16(_mm_and_si128(x1, maskLo), ys1)));
+  }
+
+  *pRe += AOA_sum32x4(re);
+  *pIm += AOA_sum32x4(im);
+
+  AOA_cmacConjRunScalar(&pX[k], &pY[k], n - k, pRe, pIm);
+}
+
+/*********************************************************************
+* @fn      AOA_cmacConjExtRun
+*
+* @brief   SSE2/AVX2 X*conj(Y) over n consecutive 16 bit samples
+*
+*          One half of X is masked before _mm_madd_epi16, so every lane
+*          holds a single exact product. Lanes are widened to 64 bit
+*          before they are accumulated.
+*/
+static inline void AOA_cmacConjExtRun(const AoA_IQSample_Ext_t *pX, const AoA_IQSample_Ext_t *pY, uint32_t n, int64_t *pRe, int64_t *pIm)
+{
+  const __m128i maskLo = _mm_set1_epi32(0x0000FFFF);
+  const __m128i maskHi = _mm_set1_epi32((int32_t)0xFFFF0000);
+  __m128i re = _mm_setzero_si128();
+  __m128i im = _mm_setzero_si128();
+  uint32_t k = 0;
+
+#if (AOA_KERNEL_IMPL == AOA_KERNEL_IMPL_AVX2)
+  {
+    const __m256i maskLo256 = _mm256_set1_epi32(0x0000FFFF);
+    const __m256i maskHi256 = _mm256_set1_epi32((int32_t)0xFFFF0000);
+    __m256i re256 = _mm256_setzero_si256();
+    __m256i im256 = _mm256_setzero_si256();
+
+    for (; k + 8 <= n; k += 8)
+    {
+      __m256i x = _mm256_loadu_si256((const __m256i *)&pX[k]);
+      __m256i y = _mm256_loadu_si256((const __m256i *)&pY[k]);
+      __m256i ys = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(y, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+      __m256i xLo = _mm256_and_si256(x, maskLo256);
+      __m256i xHi = _mm256_and_si256(x, maskHi256);
+      __m256i v[4];
+
+      v[0] = _mm256_madd_epi16(xLo, y);    // Xlo*Ylo
+      v[1] = _mm256_madd_epi16(xHi, y);    // Xhi*Yhi
+      v[2] = _mm256_madd_epi16(xHi, ys);   // Xhi*Ylo
+      v[3] = _mm256_madd_epi16(xLo, ys);   // Xlo*Yhi
+
+      for (uint8_t j = 0; j < 2; j++)
+      {
+        re256 = _mm256_add_epi64(re256, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v[0], j)));
+        re256 = _mm256_add_epi64(re256, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v[1], j)));
+#if AOA_KERNEL_EXT_Q_LOW
+        im256 = _mm256_add_epi64(im256, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v[3], j)));
+        im256 = _mm256_sub_epi64(im256, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v[2], j)));
+#else
+        im256 = _mm256_add_epi64(im256, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v[2], j)));
+        im256 = _mm256_sub_epi64(im256, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v[3], j)));
+#endif
+      }
+    }
+
+    re = _mm_add_epi64(_mm256_castsi256_si128(re256), _mm256_extracti128_si256(re256, 1));
+    im = _mm_add_epi64(_mm256_castsi256_si128(im256), _mm256_extracti128_si256(im256, 1));
+  }
+#endif
+
+  for (; k + 4 <= n; k += 4)
+  {
+    __m128i x = _mm_loadu_si128((const __m128i *)&pX[k]);
+    __m128i y = _mm_loadu_si128((const __m128i *)&pY[k]);
+    __m128i ys = _mm_shufflehi_epi16(_mm_shufflelo_epi16(y, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+    __m128i xLo = _mm_and_si128(x, maskLo);
+    __m128i xHi = _mm_and_si128(x, maskHi);
+    __m128i zero = _mm_setzero_si128();
+
+    re = AOA_addWiden128(re, _mm_madd_epi16(xLo, y));
+    re = AOA_addWiden128(re, _mm_madd_epi16(xHi, y));
+#if AOA_KERNEL_EXT_Q_LOW
+    im = AOA_addWiden128(im, _mm_madd_epi16(xLo, ys));
+    im = AOA_addWiden128(im, _mm_sub_epi32(zero, _mm_madd_epi16(xHi, ys)));
+#else
+    im = AOA_addWiden128(im, _mm_madd_epi16(xHi, ys));
+    im = AOA_addWiden128(im, _mm_sub_epi32(zero, _mm_madd_epi16(xLo, ys)));
+#endif
+  }
+
+  *pRe += AOA_sum64x2(re);
+  *pIm += AOA_sum64x2(im);
+
+  AOA_cmacConjExtRunScalar(&pX[k], &pY[k], n - k, pRe, pIm);
+}
+
+/*********************************************************************
+* @fn      AOA_magBitsRun
+*
+* @brief   SSE2/AVX2 OR of the magnitudes of n consecutive 16 bit samples
+*/
+static inline uint32_t AOA_magBitsRun(const AoA_IQSample_Ext_t *pIQ, uint32_t n, uint32_t bits)
+{
+  __m128i acc = _mm_setzero_si128();
+  uint32_t k = 0;
+
+  for (; k + 4 <= n; k += 4)
+  {
+    __m128i v = _mm_loadu_si128((const __m128i *)&pIQ[k]);
+
+    acc = _mm_or_si128(acc, _mm_xor_si128(v, _mm_srai_epi16(v, 15)));
+  }
+
+  // Fold the eight half-words into the low one
+  acc = _mm_or_si128(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+  acc = _mm_or_si128(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+  acc = _mm_or_si128(acc, _mm_srli_epi32(acc, 16));
+  bits |= (uint32_t)_mm_cvtsi128_si32(acc) & 0xFFFF;
+
+  return AOA_magBitsRunScalar(&pIQ[k], n - k, bits);
+}
+
+/*********************************************************************
+* @fn      AOA_narrowRun
+*
+* @brief   SSE2/AVX2 narrowing of n consecutive 16 bit samples
+*
+*          Eight samples are loaded before their 16 output bytes are
+*          stored, which never reach the next eight input samples. The
+*          saturating add only clips where the result saturates anyway,
+*          _mm_packs_epi16 saturates to 8 bit.
+*/
+static inline void AOA_narrowRun(const AoA_IQSample_Ext_t *pIn, AoA_IQSample_t *pOut, uint32_t n, uint8_t shift)
+{
+  const __m128i round = _mm_set1_epi16((shift == 0) ? 0 : (int16_t)(1 << (shift - 1)));
+  const __m128i count = _mm_cvtsi32_si128(shift);
+  uint32_t k = 0;
+
+  for (; k + 8 <= n; k += 8)
+  {
+    __m128i v0 = _mm_loadu_si128((const __m128i *)&pIn[k]);
+    __m128i v1 = _mm_loadu_si128((const __m128i *)&pIn[k + 4]);
+
+    v0 = _mm_sra_epi16(_mm_adds_epi16(v0, round), count);
+    v1 = _mm_sra_epi16(_mm_adds_epi16(v1, round), count);
+#if AOA_KERNEL_EXT_Q_LOW
+    v0 = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v0, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+    v1 = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v1, _MM_SHUFFLE(2, 3, 0, 1)), _MM_SHUFFLE(2, 3, 0, 1));
+#endif
+
+    _mm_storeu_si128((__m128i *)&pOut[k], _mm_packs_epi16(v0, v1));
+  }
+
+  AOA_narrowRunScalar(&pIn[k], &pOut[k], n - k, shift);
+}
+
+#else
+#define AOA_cmacConjRun       AOA_cmacConjRunScalar
+#define AOA_cmacConjExtRun    AOA_cmacConjExtRunScalar
+#define AOA_magBitsRun        AOA_magBitsRunScalar
+#define AOA_narrowRun         AOA_narrowRunScalar
+#endif
+
+/*********************************************************************
+ * PUBLIC FUNCTIONS
+ */
+
+/*********************************************************************
+* @fn      AOA_cmacConj
+*
+* @brief   Accumulate X*conj(Y) over strided runs of 8 bit IQ samples
+*
+* @param   pX - first X sample
+* @param   pY - first Y sample
+* @param   runLen - consecutive samples per run
+* @param   numRuns - number of runs
+* @param   stride - samples from the start of one run to the start of the next
+* @param   pAcc - accumulator the sum is added to
+*
+* @return  none
+*/
+void AOA_cmacConj(const AoA_IQSample_t *pX, const AoA_IQSample_t *pY, uint16_t runLen, uint16_t numRuns, uint16_t stride, AoA_Phasor_t *pAcc)
+{
+  int32_t re = 0;
+  int32_t im = 0;
+
+  // Back to back runs are one long run
+  if (stride == runLen)
+  {
+    AOA_cmacConjRun(pX, pY, (uint32_t)runLen * numRuns, &re, &im);
+  }
+  else
+  {
+    for (uint16_t r = 0; r < numRuns; r++)
+    {
+      AOA_cmacConjRun(&pX[r * stride], &pY[r * stride], runLen, &re, &im);
+    }
+  }
+
+  pAcc->re += re;
+  pAcc->im += im;
+}
+
+/*********************************************************************
+* @fn      AOA_cmacConjExt
+*
+* @brief   Accumulate X*conj(Y) over strided runs of 16 bit IQ samples
+*
+* @param   pX - first X sample
+* @param   pY - first Y sample
+* @param   runLen - consecutive samples per run
+* @param   numRuns - number of runs
+* @param   stride - samples from the start of one run to the start of the next
+* @param   pAcc - accumulator the sum is added to
+*
+* @return  none
+*/
+void AOA_cmacConjExt(const AoA_IQSample_Ext_t *pX, const AoA_IQSample_Ext_t *pY, uint16_t runLen, uint16_t numRuns, uint16_t stride, AoA_Phasor_t *pAcc)
+{
+  if (stride == runLen)
+  {
+    AOA_cmacConjExtRun(pX, pY, (uint32_t)runLen * numRuns, &pAcc->re, &pAcc->im);
+  }
+  else
+  {
+    for (uint16_t r = 0; r < numRuns; r++)
+    {
+      AOA_cmacConjExtRun(&pX[r * stride], &pY[r * stride], runLen, &pAcc->re, &pAcc->im);
+    }
+  }
+}
+
+/*********************************************************************
+* @fn      AOA_cmacConjScalar
+*
+* @brief   Portable reference of AOA_cmacConj
+*/
+void AOA_cmacConjScalar(const AoA_IQSample_t *pX, const AoA_IQSample_t *pY, uint16_t runLen, uint16_t numRuns, uint16_t stride, AoA_Phasor_t *pAcc)
+{
+  int32_t re = 0;
+  int32_t im = 0;
+
+  for (uint16_t r = 0; r < numRuns; r++)
+  {
+    AOA_cmacConjRunScalar(&pX[r * stride], &pY[r * stride], runLen, &re, &im);
+  }
+
+  pAcc->re += re;
+  pAcc->im += im;
+}
+
+/*********************************************************************
+* @fn      AOA_cmacConjExtScalar
+*
+* @brief   Portable reference of AOA_cmacConjExt
+*/
+void AOA_cmacConjExtScalar(const AoA_IQSample_Ext_t *pX, const AoA_IQSample_Ext_t *pY, uint16_t runLen, uint16_t numRuns, uint16_t stride, AoA_Phasor_t *pAcc)
+{
+  for (uint16_t r = 0; r < numRuns; r++)
+  {
+    AOA_cmacConjExtRunScalar(&pX[r * stride], &pY[r * stride], runLen, &pAcc->re, &pAcc->im);
+  }
+}
+
+/*********************************************************************
+* @fn      AOA_clz32
+*
+* @brief   Count leading zeros of a non zero word
+*/
+static inline uint8_t AOA_clz32(uint32_t v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+  return (uint8_t)__builtin_clz(v);
+#else
+  uint8_t n = 0;
+
+  if (!(v & 0xFFFF0000u)) { n += 16; v <<= 16; }
+  if (!(v & 0xFF000000u)) { n += 8;  v <<= 8;  }
+  if (!(v & 0xF0000000u)) { n += 4;  v <<= 4;  }
+  if (!(v & 0xC0000000u)) { n += 2;  v <<= 2;  }
+  if (!(v & 0x80000000u)) { n += 1; }
+
+  return n;
+#endif
+}
+
+/*********************************************************************
+* @fn      AOA_magBitsToExponent
+*
+* @brief   Right shift that brings magnitudes of bits into 8 bit samples
+*/
+static inline uint8_t AOA_magBitsToExponent(uint32_t bits)
+{
+  const uint8_t magBits = (bits == 0) ? 0 : (uint8_t)(32 - AOA_clz32(bits));
+
+  return (magBits > AOA_NARROW_BITS) ? (magBits - AOA_NARROW_BITS) : 0;
+}
+
+/*********************************************************************
+* @fn      AOA_blockExponent
+*
+* @brief   Block exponent of 16 bit IQ samples
+*
+* @param   pIQ - first sample
+* @param   numSamples - number of samples
+*
+* @return  right shift, 0 if the samples already fit in 8 bits
+*/
+uint8_t AOA_blockExponent(const AoA_IQSample_Ext_t *pIQ, uint16_t numSamples)
+{
+  return AOA_magBitsToExponent(AOA_magBitsRun(pIQ, numSamples, 0));
+}
+
+/*********************************************************************
+* @fn      AOA_narrowSamples
+*
+* @brief   Narrow 16 bit IQ samples to 8 bit with a common exponent
+*
+* @param   pIn - first 16 bit sample
+* @param   pOut - first 8 bit sample, may be pIn
+* @param   numSamples - number of samples
+* @param   shift - exponent from AOA_blockExponent
+*
+* @return  none
+*/
+void AOA_narrowSamples(const AoA_IQSample_Ext_t *pIn, AoA_IQSample_t *pOut, uint16_t numSamples, uint8_t shift)
+{
+  AOA_narrowRun(pIn, pOut, numSamples, shift);
+}
+
+/*********************************************************************
+* @fn      AOA_blockExponentScalar
+*
+* @brief   Portable reference of AOA_blockExponent
+*/
+uint8_t AOA_blockExponentScalar(const AoA_IQSample_Ext_t *pIQ, uint16_t numSamples)
+{
+  return AOA_magBitsToExponent(AOA_magBitsRunScalar(pIQ, numSamples, 0));
+}
+
+/*********************************************************************
+* @fn      AOA_narrowSamplesScalar
+*
+* @brief   Portable reference of AOA_narrowSamples
+*/
+void AOA_narrowSamplesScalar(const AoA_IQSample_Ext_t *pIn, AoA_IQSample_t *pOut, uint16_t numSamples, uint8_t shift)
+{
+  AOA_narrowRunScalar(pIn, pOut, numSamples, shift);
+}
+
+/*********************************************************************
+* @fn      AOA_atan2Fixed
+*
+* @brief   Division free atan2 with selectable resolution
+*
+*          The ratio of the smaller to the larger component is formed with
+*          a table reciprocal, its atan is interpolated from a second table
+*          and the octant is restored from the signs.
+*
+* @param   y, x - coordinates
+* @param   bits - output resolution, 1 to AOA_ATAN_MAX_BITS
+*
+* @return  angle in 2^bits steps per turn
+*/
+int32_t AOA_atan2Fixed(int32_t y, int32_t x, uint8_t bits)
+{
+  const uint32_t absX = (x < 0) ? -(uint32_t)x : (uint32_t)x;
+  const uint32_t absY = (y < 0) ? -(uint32_t)y : (uint32_t)y;
+  const bool swapped = (absY > absX);
+  uint32_t num = swapped ? absX : absY;
+  uint32_t den = swapped ? absY : absX;
+  uint32_t idx, frac, recip, t;
+  int32_t angle;
+  uint8_t shift;
+
+  if (den == 0)
+  {
+    return 0;
+  }
+
+  if (bits > AOA_ATAN_MAX_BITS)
+  {
+    bits = AOA_ATAN_MAX_BITS;
+  }
+
+  // Scale den into [2^31, 2^32), num <= den keeps its ratio
+  shift = AOA_clz32(den);
+  den <<= shift;
+  num <<= shift;
+
+  // recip = 2^62/den in Q31, linear between table points
+  idx = (den >> (31 - AOA_RECIP_LUT_BITS)) & (AOA_RECIP_LUT_SIZE - 1);
+  frac = (den >> (15 - AOA_RECIP_LUT_BITS)) & 0xFFFF;
+  recip = aoaRecipLut[idx] - (uint32_t)(((uint64_t)(aoaRecipLut[idx] - aoaRecipLut[idx + 1]) * frac) >> 16);
+
+  // t = num/den in Q24
+  t = (uint32_t)(((uint64_t)num * recip) >> 38);
+
+  // First octant angle, linear between table points
+  idx = t >> (24 - AOA_ATAN_LUT_BITS);
+  if (idx >= AOA_ATAN_LUT_SIZE)
+  {
+    angle = AOA_ATAN_EIGHTH_TURN;
+  }
+  else
+  {
+    frac = t & ((1u << (24 - AOA_ATAN_LUT_BITS)) - 1);
+    angle = aoaAtanLut[idx] + (int32_t)(((aoaAtanLut[idx + 1] - aoaAtanLut[idx]) * frac) >> (24 - AOA_ATAN_LUT_BITS));
+  }
+
+  // Back to the full circle
+  if (swapped)
+  {
+    angle = 2 * AOA_ATAN_EIGHTH_TURN - angle;
+  }
+  if (x < 0)
+  {
+    angle = 4 * AOA_ATAN_EIGHTH_TURN - angle;
+  }
+  if (y < 0)
+  {
+    angle = -angle;
+  }
+
+  // Round to the output resolution, +half turn wraps to -half turn
+  angle = (angle + (1 << (AOA_ATAN_INT_BITS - bits - 1))) >> (AOA_ATAN_INT_BITS - bits);
+  if (angle >= (1 << (bits - 1)))
+  {
+    angle -= (1 << bits);
+  }
+
+  return angle;
+}
@@ -0,0 +1,233 @@
+/******************************************************************************
+
+ @file  AOA_kernel.h
+
+ @brief This file contains the vectorized sample kernels used by AOA.c
+ Group: WCS, BTS
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2018-2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+/**
+ *  @defgroup AOA_KERNEL AOA_KERNEL
+ *  @brief This module implements the sample kernels of the AoA angle path
+ *
+ *  @{
+ *  @file  AOA_kernel.h
+ *  @brief      AOA sample kernels interface
+ */
+
+#ifndef AOA_KERNEL_H_
+#define AOA_KERNEL_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*******************************************************************************
+ * INCLUDES
+ */
+
+#include <stdint.h>
+#include "AOA.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/// @brief Kernel implementations, AOA_KERNEL_IMPL reports the one that was built
+#define AOA_KERNEL_IMPL_SCALAR           0     //!< Portable C
+#define AOA_KERNEL_IMPL_ARM_DSP          1     //!< Cortex-M4 dual 16-bit MAC (SMLAD/SMLSDX)
+#define AOA_KERNEL_IMPL_SSE2             2     //!< Host SSE2
+#define AOA_KERNEL_IMPL_AVX2             3     //!< Host AVX2
+
+// AOA_KERNEL_FORCE_SCALAR selects the portable implementation on every target
+#if defined(AOA_KERNEL_FORCE_SCALAR)
+#define AOA_KERNEL_IMPL                  AOA_KERNEL_IMPL_SCALAR
+#elif defined(__ARM_FEATURE_DSP)
+#define AOA_KERNEL_IMPL                  AOA_KERNEL_IMPL_ARM_DSP
+#elif defined(__AVX2__)
+#define AOA_KERNEL_IMPL                  AOA_KERNEL_IMPL_AVX2
+#elif defined(__SSE2__)
+#define AOA_KERNEL_IMPL                  AOA_KERNEL_IMPL_SSE2
+#else
+#define AOA_KERNEL_IMPL                  AOA_KERNEL_IMPL_SCALAR
+#endif
+
+/// @brief Largest output resolution of AOA_atan2Fixed, in bits per turn
+#define AOA_ATAN_MAX_BITS                16
+
+// Resolution of the angle path atan2 in bits per turn. 0 keeps the legacy
+// 256 step AOA_iatan2sc, 8 to AOA_ATAN_MAX_BITS selects AOA_atan2Fixed.
+#ifndef AOA_ATAN_BITS
+#define AOA_ATAN_BITS                    0
+#endif
+
+/// @brief Magnitude bits of a sample narrowed by AOA_narrowSamples, the range of AoA_IQSample_t
+#define AOA_NARROW_BITS                  7
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+/// @brief Accumulated complex product
+typedef struct
+{
+  int64_t re;   //!< Real part
+  int64_t im;   //!< Imaginary part
+} AoA_Phasor_t;
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+
+/**
+* @brief   Accumulate X*conj(Y) over strided runs of 8 bit IQ samples
+*
+*          Samples are read from numRuns runs of runLen consecutive samples,
+*          the runs start stride samples apart. Y is read with the same
+*          pattern as X. The sum is exact for up to 65535 samples and every
+*          implementation returns the same bits.
+*
+* @param   pX - first X sample
+* @param   pY - first Y sample
+* @param   runLen - consecutive samples per run
+* @param   numRuns - number of runs
+* @param   stride - samples from the start of one run to the start of the next
+* @param   pAcc - accumulator the sum is added to
+*
+* @return  none
+*/
+void AOA_cmacConj(const AoA_IQSample_t *pX, const AoA_IQSample_t *pY, uint16_t runLen, uint16_t numRuns, uint16_t stride, AoA_Phasor_t *pAcc);
+
+/**
+* @brief   Accumulate X*conj(Y) over strided runs of 16 bit IQ samples
+*
+*          Same as AOA_cmacConj for AoA_IQSample_Ext_t samples. The sum is
+*          accumulated in 64 bits and is exact for any 16 bit input.
+*
+* @param   pX - first X sample
+* @param   pY - first Y sample
+* @param   runLen - consecutive samples per run
+* @param   numRuns - number of runs
+* @param   stride - samples from the start of one run to the start of the next
+* @param   pAcc - accumulator the sum is added to
+*
+* @return  none
+*/
+void AOA_cmacConjExt(const AoA_IQSample_Ext_t *pX, const AoA_IQSample_Ext_t *pY, uint16_t runLen, uint16_t numRuns, uint16_t stride, AoA_Phasor_t *pAcc);
+
+/**
+* @brief   Portable reference of AOA_cmacConj, used for tails and verification
+*/
+void AOA_cmacConjScalar(const AoA_IQSample_t *pX, const AoA_IQSample_t *pY, uint16_t runLen, uint16_t numRuns, uint16_t stride, AoA_Phasor_t *pAcc);
+
+/**
+* @brief   Portable reference of AOA_cmacConjExt, used for tails and verification
+*/
+void AOA_cmacConjExtScalar(const AoA_IQSample_Ext_t *pX, const AoA_IQSample_Ext_t *pY, uint16_t runLen, uint16_t numRuns, uint16_t stride, AoA_Phasor_t *pAcc);
+
+/**
+* @brief   Block exponent of 16 bit IQ samples
+*
+*          One pass over the samples. Shifting every I and Q right by the
+*          returned exponent brings the largest of them into the range of
+*          an 8 bit sample, with as little shift as possible.
+*
+* @param   pIQ - first sample
+* @param   numSamples - number of samples
+*
+* @return  right shift, 0 if the samples already fit in 8 bits
+*/
+uint8_t AOA_blockExponent(const AoA_IQSample_Ext_t *pIQ, uint16_t numSamples);
+
+/**
+* @brief   Narrow 16 bit IQ samples to 8 bit with a common exponent
+*
+*          Every I and Q is shifted right by shift, rounded to nearest
+*          and saturated. pOut may be the same buffer as pIn, the samples
+*          are then narrowed in place. Every implementation returns the
+*          same bits.
+*
+* @param   pIn - first 16 bit sample
+* @param   pOut - first 8 bit sample
+* @param   numSamples - number of samples
+* @param   shift - exponent from AOA_blockExponent
+*
+* @return  none
+*/
+void AOA_narrowSamples(const AoA_IQSample_Ext_t *pIn, AoA_IQSample_t *pOut, uint16_t numSamples, uint8_t shift);
+
+/**
+* @brief   Portable reference of AOA_blockExponent, used for verification
+*/
+uint8_t AOA_blockExponentScalar(const AoA_IQSample_Ext_t *pIQ, uint16_t numSamples);
+
+/**
+* @brief   Portable reference of AOA_narrowSamples, used for tails and verification
+*/
+void AOA_narrowSamplesScalar(const AoA_IQSample_Ext_t *pIn, AoA_IQSample_t *pOut, uint16_t numSamples, uint8_t shift);
+
+/**
+* @brief   Division free atan2 with selectable resolution
+*
+*          Table based, one table reciprocal replaces the division. The
+*          input is normalized first, so the accuracy does not depend on
+*          the magnitude of (x, y), and any int32 input is accepted. The
+*          result is rounded to the nearest step, the error is within one
+*          step for all inputs.
+*
+* @param   y, x - coordinates
+* @param   bits - output resolution, 1 to AOA_ATAN_MAX_BITS
+*
+* @return  angle in 2^bits steps per turn, [-2^(bits-1), 2^(bits-1)).
+*          0 for (0, 0).
+*/
+int32_t AOA_atan2Fixed(int32_t y, int32_t x, uint8_t bits);
+
+/*********************************************************************
+*********************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AOA_KERNEL_H_ */
+
+/** @} End AOA_KERNEL */
@@ -0,0 +1,386 @@
+/******************************************************************************
+
+ @file  AOA_raw.c
+
+ @brief AoA RAW sample packing
+ Group: WCS, BTS
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2018-2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <string.h>
+
+#include "rf_hal.h"
+#include "AOA.h"
+#include "AOA_raw.h"
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+// Little endian bit stream
+typedef struct
+{
+  uint8_t *pData;            // Next byte
+  uint32_t acc;              // Bits not yet written or read
+  uint8_t numBits;           // Bits in acc
+} AoA_RawStream_t;
+
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+/*********************************************************************
+* @fn      AOA_rawReadSample
+*
+* @brief   Read one IQ sample
+*
+* @param   pIQ - pointer to IQ samples
+* @param   sampleSize - sample size 1 = 8 bit, 2 = 16 bit
+* @param   idx - sample index
+* @param   pI, pQ - returned I and Q
+*
+* @return  none
+*/
+static void AOA_rawReadSample(const int8_t *pIQ, uint8_t sampleSize, uint16_t idx, int32_t *pI, int32_t *pQ)
+{
+  if (sampleSize == 1)
+  {
+    *pI = ((const AoA_IQSample_t *)pIQ)[idx].i;
+    *pQ = ((const AoA_IQSample_t *)pIQ)[idx].q;
+  }
+  else
+  {
+    *pI = ((const AoA_IQSample_Ext_t *)pIQ)[idx].i;
+    *pQ = ((const AoA_IQSample_Ext_t *)pIQ)[idx].q;
+  }
+}
+
+/*********************************************************************
+* @fn      AOA_rawZigZag
+*
+* @brief   Map a signed value to an unsigned one, small magnitudes of either sign to small values
+*
+* @param   value - signed value
+*
+* @return  0, -1, 1, -2, ... map to 0, 1, 2, 3, ...
+*/
+static uint32_t AOA_rawZigZag(int32_t value)
+{
+  return (value < 0) ? ~((uint32_t)value << 1) : ((uint32_t)value << 1);
+}
+
+/*********************************************************************
+* @fn      AOA_rawUnZigZag
+*
+* @brief   Inverse of AOA_rawZigZag
+*
+* @param   value - zig-zag value
+*
+* @return  signed value
+*/
+static int32_t AOA_rawUnZigZag(uint32_t value)
+{
+  return (value & 1) ? -(int32_t)(value >> 1) - 1 : (int32_t)(value >> 1);
+}
+
+/*********************************************************************
+* @fn      AOA_rawNumBits
+*
+* @brief   Bits needed to hold an unsigned value
+*
+* @param   value - unsigned value
+*
+* @return  0 for 0, else the position of the highest set bit plus one
+*/
+static uint8_t AOA_rawNumBits(uint32_t value)
+{
+  uint8_t numBits = 0;
+
+  while (value != 0)
+  {
+    numBits++;
+    value >>= 1;
+  }
+
+  return numBits;
+}
+
+/*********************************************************************
+* @fn      AOA_rawPut
+*
+* @brief   Write the low bits of a value to a stream
+*
+* @param   pStream - stream
+* @param   value - value, only the low numBits bits are written
+* @param   numBits - 0 - 17
+*
+* @return  none
+*/
+static void AOA_rawPut(AoA_RawStream_t *pStream, uint32_t value, uint8_t numBits)
+{
+  if (numBits == 0)
+  {
+    return;
+  }
+
+  // At most 7 bits are left over, 24 bits fit the accumulator
+  pStream->acc |= (value & ((1UL << numBits) - 1)) << pStream->numBits;
+  pStream->numBits += numBits;
+
+  while (pStream->numBits >= 8)
+  {
+    *pStream->pData++ = (uint8_t)pStream->acc;
+    pStream->acc >>= 8;
+    pStream->numBits -= 8;
+  }
+}
+
+/*********************************************************************
+* @fn      AOA_rawGet
+*
+* @brief   Read bits from a stream
+*
+* @param   pStream - stream, it holds the bits
+* @param   numBits - 0 - 17
+*
+* @return  the bits read
+*/
+static uint32_t AOA_rawGet(AoA_RawStream_t *pStream, uint8_t numBits)
+{
+  uint32_t value;
+
+  while (pStream->numBits < numBits)
+  {
+    pStream->acc |= (uint32_t)(*pStream->pData++) << pStream->numBits;
+    pStream->numBits += 8;
+  }
+
+  value = pStream->acc & ((1UL << numBits) - 1);
+  pStream->acc >>= numBits;
+  pStream->numBits -= numBits;
+
+  return value;
+}
+
+/*********************************************************************
+* @fn      AOA_rawGetSigned
+*
+* @brief   Read a two's complement value from a stream
+*
+* @param   pStream - stream, it holds the bits
+* @param   numBits - 8, 12 or 16
+*
+* @return  the value read
+*/
+static int32_t AOA_rawGetSigned(AoA_RawStream_t *pStream, uint8_t numBits)
+{
+  int32_t value = (int32_t)AOA_rawGet(pStream, numBits);
+
+  if (value & (1L << (numBits - 1)))
+  {
+    value -= (1L << numBits);
+  }
+
+  return value;
+}
+
+/*********************************************************************
+ * PUBLIC FUNCTIONS
+ */
+
+/*********************************************************************
+* @fn      AOA_rawPack
+*
+* @brief   Pack IQ samples
+*
+* @param   pIQ - AoA_IQSample_t or AoA_IQSample_Ext_t samples
+* @param   sampleSize - 1 = 8 bit, 2 = 16 bit
+* @param   numSamples - samples to pack, at least 1
+* @param   coding - AOA_RAW_CODING_NONE/AOA_RAW_CODING_DELTA
+* @param   pFormat - format the samples were packed in
+* @param   pOut - AOA_RAW_PACKED_MAX_SIZE(numSamples, sampleSize) bytes
+*
+* @return  bytes written to pOut
+*/
+uint16_t AOA_rawPack(const int8_t *pIQ, uint8_t sampleSize, uint16_t numSamples, uint8_t coding, AoA_RawFormat_t *pFormat, uint8_t *pOut)
+{
+  AoA_RawStream_t stream = {pOut, 0, 0};
+  int32_t re, im, prevRe, prevIm;
+  int32_t minValue = 0;
+  int32_t maxValue = 0;
+  uint32_t maxDelta = 0;           // OR of the zig-zag deltas, as wide as the widest of them
+  uint32_t plainBits, deltaBits;
+
+  // Range of the components and of the deltas between consecutive samples
+  AOA_rawReadSample(pIQ, sampleSize, 0, &prevRe, &prevIm);
+  for (uint16_t k = 0; k < numSamples; k++)
+  {
+    AOA_rawReadSample(pIQ, sampleSize, k, &re, &im);
+
+    minValue = (re < minValue) ? re : minValue;
+    minValue = (im < minValue) ? im : minValue;
+    maxValue = (re > maxValue) ? re : maxValue;
+    maxValue = (im > maxValue) ? im : maxValue;
+    maxDelta |= AOA_rawZigZag(re - prevRe) | AOA_rawZigZag(im - prevIm);
+
+    prevRe = re;
+    prevIm = im;
+  }
+
+  if (sampleSize == 1)
+  {
+    pFormat->sampleBits = 8;
+  }
+  else
+  {
+    // The radio hands out 16 bit samples, filtered captures rarely use more than 12 of them
+    pFormat->sampleBits = ((minValue >= -2048) && (maxValue <= 2047)) ? 12 : 16;
+  }
+
+  pFormat->deltaBits = AOA_rawNumBits(maxDelta);
+  plainBits = 2UL * numSamples * pFormat->sampleBits;
+  deltaBits = 2UL * pFormat->sampleBits + 2UL * (numSamples - 1) * pFormat->deltaBits;
+
+  // Consecutive samples of a fast turning tone can be as far apart as the components are large
+  pFormat->coding = ((coding == AOA_RAW_CODING_DELTA) && (deltaBits < plainBits)) ? AOA_RAW_CODING_DELTA : AOA_RAW_CODING_NONE;
+  if (pFormat->coding == AOA_RAW_CODING_NONE)
+  {
+    pFormat->deltaBits = 0;
+  }
+
+  for (uint16_t k = 0; k < numSamples; k++)
+  {
+    AOA_rawReadSample(pIQ, sampleSize, k, &re, &im);
+
+    if ((k == 0) || (pFormat->coding == AOA_RAW_CODING_NONE))
+    {
+      AOA_rawPut(&stream, (uint32_t)re, pFormat->sampleBits);
+      AOA_rawPut(&stream, (uint32_t)im, pFormat->sampleBits);
+    }
+    else
+    {
+      AOA_rawPut(&stream, AOA_rawZigZag(re - prevRe), pFormat->deltaBits);
+      AOA_rawPut(&stream, AOA_rawZigZag(im - prevIm), pFormat->deltaBits);
+    }
+
+    prevRe = re;
+    prevIm = im;
+  }
+
+  // Pad the last byte
+  AOA_rawPut(&stream, 0, (8 - stream.numBits) & 7);
+
+  return (uint16_t)(stream.pData - pOut);
+}
+
+/*********************************************************************
+* @fn      AOA_rawUnpack
+*
+* @brief   Unpack samples packed by AOA_rawPack
+*
+* @param   pIn - packed samples
+* @param   len - bytes in pIn
+* @param   numSamples - samples packed
+* @param   pFormat - format they were packed in
+* @param   pOut - 2 * numSamples components, I before Q
+*
+* @return  TRUE if the format is valid and len holds numSamples samples
+*/
+bool AOA_rawUnpack(const uint8_t *pIn, uint16_t len, uint16_t numSamples, const AoA_RawFormat_t *pFormat, int16_t *pOut)
+{
+  AoA_RawStream_t stream = {(uint8_t *)pIn, 0, 0};
+  uint32_t numBits;
+  int32_t re = 0;
+  int32_t im = 0;
+
+  if (((pFormat->sampleBits != 8) && (pFormat->sampleBits != 12) && (pFormat->sampleBits != 16)) ||
+      (pFormat->deltaBits > AOA_RAW_MAX_DELTA_BITS))
+  {
+    return FALSE;
+  }
+
+  if (numSamples == 0)
+  {
+    return TRUE;
+  }
+
+  if (pFormat->coding == AOA_RAW_CODING_NONE)
+  {
+    numBits = 2UL * numSamples * pFormat->sampleBits;
+  }
+  else if (pFormat->coding == AOA_RAW_CODING_DELTA)
+  {
+    numBits = 2UL * pFormat->sampleBits + 2UL * (numSamples - 1) * pFormat->deltaBits;
+  }
+  else
+  {
+    return FALSE;
+  }
+
+  if ((numBits + 7) / 8 > len)
+  {
+    return FALSE;
+  }
+
+  for (uint16_t k = 0; k < numSamples; k++)
+  {
+    if ((k == 0) || (pFormat->coding == AOA_RAW_CODING_NONE))
+    {
+      re = AOA_rawGetSigned(&stream, pFormat->sampleBits);
+      im = AOA_rawGetSigned(&stream, pFormat->sampleBits);
+    }
+    else
+    {
+      re += AOA_rawUnZigZag(AOA_rawGet(&stream, pFormat->deltaBits));
+      im += AOA_rawUnZigZag(AOA_rawGet(&stream, pFormat->deltaBits));
+    }
+
+    pOut[2 * k] = (int16_t)re;
+    pOut[2 * k + 1] = (int16_t)im;
+  }
+
+  return TRUE;
+}
@@ -0,0 +1,149 @@
+/******************************************************************************
+
+ @file  AOA_raw.h
+
+ @brief AoA RAW sample packing
+ Group: WCS, BTS
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2018-2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+
+
+/**
+ *  @defgroup AOA_RAW AOA_RAW
+ *  @brief This module packs RAW IQ samples for the host at the width they were captured at
+ *
+ *  @{
+ *  @file  AOA_raw.h
+ *  @brief      AOA RAW sample packing interface
+ */
+
+#ifndef AOA_RAW_H_
+#define AOA_RAW_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*******************************************************************************
+ * INCLUDES
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define AOA_RAW_CODING_NONE       0     //!< Every component as it is, sampleBits wide
+#define AOA_RAW_CODING_DELTA      1     //!< First sample as it is, then zig-zag deltas to the previous sample, deltaBits wide
+
+#define AOA_RAW_MAX_DELTA_BITS    17    //!< Widest zig-zag delta, that of two 16 bit components
+
+/*********************************************************************
+ * MACROS
+ */
+
+/// @brief Bytes AOA_rawPack may write for numSamples samples of sampleSize bytes per component,
+///        deltas are only used when they pack the samples into fewer bytes
+#define AOA_RAW_PACKED_MAX_SIZE(numSamples, sampleSize) (2 * (numSamples) * (sampleSize))
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+/// @brief Format of packed samples
+///
+/// Components are packed in a little endian bit stream, I before Q.
+/// Uncoded 8 and 16 bit samples are thus laid out as AoA_IQSample_t and
+/// a master AoA_IQSample_Ext_t, 12 bit samples take 3 bytes.
+typedef struct
+{
+  uint8_t sampleBits;        //!< Bits of a component as it is, 8, 12 or 16
+  uint8_t coding;            //!< AOA_RAW_CODING_NONE/AOA_RAW_CODING_DELTA
+  uint8_t deltaBits;         //!< Bits of a zig-zag delta, 0 - 17, AOA_RAW_CODING_DELTA only
+} AoA_RawFormat_t;
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+
+/**
+* @brief   Pack IQ samples
+*
+*          8 bit samples are packed as 8 bit and 16 bit samples as 12 bit
+*          if all of them fit. AOA_RAW_CODING_DELTA is only used if it
+*          packs the samples into fewer bytes, the format used is returned.
+*
+* @param   pIQ - AoA_IQSample_t or AoA_IQSample_Ext_t samples
+* @param   sampleSize - 1 = 8 bit, 2 = 16 bit
+* @param   numSamples - samples to pack, at least 1
+* @param   coding - AOA_RAW_CODING_NONE/AOA_RAW_CODING_DELTA
+* @param   pFormat - format the samples were packed in
+* @param   pOut - AOA_RAW_PACKED_MAX_SIZE(numSamples, sampleSize) bytes
+*
+* @return  bytes written to pOut
+*/
+uint16_t AOA_rawPack(const int8_t *pIQ, uint8_t sampleSize, uint16_t numSamples, uint8_t coding, AoA_RawFormat_t *pFormat, uint8_t *pOut);
+
+/**
+* @brief   Unpack samples packed by AOA_rawPack
+*
+* @param   pIn - packed samples
+* @param   len - bytes in pIn
+* @param   numSamples - samples packed
+* @param   pFormat - format they were packed in
+* @param   pOut - 2 * numSamples components, I before Q
+*
+* @return  TRUE if the format is valid and len holds numSamples samples
+*/
+bool AOA_rawUnpack(const uint8_t *pIn, uint16_t len, uint16_t numSamples, const AoA_RawFormat_t *pFormat, int16_t *pOut);
+
+/*********************************************************************
+*********************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AOA_RAW_H_ */
+
+/** @} End AOA_RAW */
@@ -0,0 +1,211 @@
+/******************************************************************************
+
+ @file  AOA_report.c
+
+ @brief AoA result fusion and reporting
+ Group: WCS, BTS
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2018-2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "rf_hal.h"
+#include "AOA_report.h"
+
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+/*********************************************************************
+* @fn      AOA_reportWrap
+*
+* @brief   Wrap an angle into one turn
+*
+* @param   angle - degrees
+* @param   minAngle - smallest angle of the turn
+*
+* @return  degrees, minAngle <= angle < minAngle + 360
+*/
+static int32_t AOA_reportWrap(int32_t angle, int32_t minAngle)
+{
+  while (angle >= minAngle + 360)
+  {
+    angle -= 360;
+  }
+  while (angle < minAngle)
+  {
+    angle += 360;
+  }
+
+  return angle;
+}
+
+/*********************************************************************
+* @fn      AOA_reportMean
+*
+* @brief   Mean of a sum, rounded half away from zero
+*
+* @param   sum - sum of the values
+* @param   count - number of values, at least 1
+*
+* @return  mean
+*/
+static int32_t AOA_reportMean(int32_t sum, int32_t count)
+{
+  return (sum >= 0) ? (sum + count / 2) / count : (sum - count / 2) / count;
+}
+
+/*********************************************************************
+ * PUBLIC FUNCTIONS
+ */
+
+/*********************************************************************
+* @fn      AOA_reportDefaultParams
+*
+* @brief   Default fusion parameters, every CTE is reported
+*
+* @param   pParams - parameters to fill
+*
+* @return  none
+*/
+void AOA_reportDefaultParams(AoA_ReportParams_t *pParams)
+{
+  pParams->window = AOA_REPORT_DEFAULT_WINDOW;
+  pParams->minChange = AOA_REPORT_DEFAULT_MIN_CHANGE;
+  pParams->maxHold = AOA_REPORT_DEFAULT_MAX_HOLD;
+}
+
+/*********************************************************************
+* @fn      AOA_reportCheckParams
+*
+* @brief   Check fusion parameters
+*
+* @param   pParams - parameters to check
+*
+* @return  TRUE if the parameters are valid
+*/
+bool AOA_reportCheckParams(const AoA_ReportParams_t *pParams)
+{
+  // A change beyond half a turn can never be seen
+  return (pParams->window != 0) && (pParams->minChange <= 180);
+}
+
+/*********************************************************************
+* @fn      AOA_reportReset
+*
+* @brief   Restart the fusion of a connection, the next result is reported whatever it is
+*
+* @param   pReport - fusion state
+*
+* @return  none
+*/
+void AOA_reportReset(AoA_Report_t *pReport)
+{
+  memset(pReport, 0, sizeof(AoA_Report_t));
+}
+
+/*********************************************************************
+* @fn      AOA_reportUpdate
+*
+* @brief   Add the result of a new CTE
+*
+* @param   pReport - fusion state
+* @param   pParams - fusion parameters
+* @param   angle - angle of the CTE in degrees
+* @param   elevation - elevation of the CTE in degrees, 0 if there is none
+* @param   rssi - rssi of the CTE
+* @param   minAngle - smallest angle of the turn angles are wrapped to
+* @param   pResult - fused result, written when TRUE is returned
+*
+* @return  TRUE if a result is to be reported
+*/
+bool AOA_reportUpdate(AoA_Report_t *pReport, const AoA_ReportParams_t *pParams, int16_t angle, int16_t elevation, int8_t rssi, int16_t minAngle, AoA_ReportResult_t *pResult)
+{
+  AoA_ReportResult_t fused;
+
+  if (pReport->numEntries == 0)
+  {
+    pReport->refAngle = angle;
+    pReport->sumAngle = 0;
+    pReport->sumElevation = 0;
+    pReport->sumRssi = 0;
+  }
+
+  // Distances to the first angle stay small across the +-180 seam, their mean does not flip sides
+  pReport->sumAngle += AOA_reportWrap((int32_t)angle - pReport->refAngle, -180);
+  pReport->sumElevation += elevation;
+  pReport->sumRssi += rssi;
+
+  if (++pReport->numEntries < pParams->window)
+  {
+    return FALSE;
+  }
+
+  fused.numCtes = pReport->numEntries;
+  fused.angle = (int16_t)AOA_reportWrap(pReport->refAngle + AOA_reportMean(pReport->sumAngle, fused.numCtes), minAngle);
+  fused.elevation = (int16_t)AOA_reportMean(pReport->sumElevation, fused.numCtes);
+  fused.rssi = (int8_t)AOA_reportMean(pReport->sumRssi, fused.numCtes);
+  pReport->numEntries = 0;
+
+  // A result that did not move is held back, unless it has been for maxHold windows
+  if (pReport->reported && (pParams->minChange != 0) &&
+      (abs(AOA_reportWrap((int32_t)fused.angle - pReport->lastAngle, -180)) < pParams->minChange) &&
+      (abs(fused.elevation - pReport->lastElevation) < pParams->minChange) &&
+      ((pParams->maxHold == 0) || (pReport->numHeld < pParams->maxHold)))
+  {
+    pReport->numHeld++;
+    return FALSE;
+  }
+
+  pReport->reported = TRUE;
+  pReport->numHeld = 0;
+  pReport->lastAngle = fused.angle;
+  pReport->lastElevation = fused.elevation;
+  *pResult = fused;
+
+  return TRUE;
+}
@@ -0,0 +1,190 @@
+/******************************************************************************
+
+ @file  AOA_report.h
+
+ @brief AoA result fusion and reporting
+ Group: WCS, BTS
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2018-2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+
+
+/**
+ *  @defgroup AOA_REPORT AOA_REPORT
+ *  @brief This module fuses the angles of one connection over the hopping channels and decides when to report them
+ *
+ *  @{
+ *  @file  AOA_report.h
+ *  @brief      AOA result fusion interface
+ */
+
+#ifndef AOA_REPORT_H_
+#define AOA_REPORT_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*******************************************************************************
+ * INCLUDES
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// CTEs fused into one result until the host sets other parameters, 1 reports every CTE
+#ifndef AOA_REPORT_DEFAULT_WINDOW
+#define AOA_REPORT_DEFAULT_WINDOW        1
+#endif
+
+// Degrees a fused result must move to be reported, 0 reports every window
+#ifndef AOA_REPORT_DEFAULT_MIN_CHANGE
+#define AOA_REPORT_DEFAULT_MIN_CHANGE    0
+#endif
+
+// Windows a result may be held back before it is reported anyway, 0 holds it for as long as it does not move
+#ifndef AOA_REPORT_DEFAULT_MAX_HOLD
+#define AOA_REPORT_DEFAULT_MAX_HOLD      0
+#endif
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+/// @brief Result fusion parameters
+///
+/// Consecutive CTEs of a connection hop channels, a window of CTEs sees
+/// as many channels and their multipath errors average out.
+typedef struct
+{
+  uint8_t window;            //!< CTEs fused into one result, at least 1
+  uint8_t minChange;         //!< Degrees the angle or elevation must move from the last reported result, 0 = report every window
+  uint8_t maxHold;           //!< Windows a result that did not move is held back at most, 0 = no limit
+} AoA_ReportParams_t;
+
+/// @brief A fused result
+typedef struct
+{
+  int16_t angle;             //!< Degrees
+  int16_t elevation;         //!< Degrees
+  int8_t  rssi;              //!< Mean rssi of the window
+  uint8_t numCtes;           //!< CTEs fused
+} AoA_ReportResult_t;
+
+/// @brief Result fusion state of one connection
+typedef struct
+{
+  int32_t sumAngle;          //!< Sum of the angles of the window less refAngle
+  int32_t sumElevation;
+  int16_t sumRssi;
+  int16_t refAngle;          //!< First angle of the window, the others are summed as their wrapped distance to it
+  uint8_t numEntries;        //!< CTEs of the window so far
+  uint8_t numHeld;           //!< Windows held back since the last report
+  bool    reported;          //!< A result was reported since the last restart
+  int16_t lastAngle;         //!< Last reported result
+  int16_t lastElevation;
+} AoA_Report_t;
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+
+/**
+* @brief   Default fusion parameters, every CTE is reported
+*
+* @param   pParams - parameters to fill
+*
+* @return  none
+*/
+void AOA_reportDefaultParams(AoA_ReportParams_t *pParams);
+
+/**
+* @brief   Check fusion parameters
+*
+* @param   pParams - parameters to check
+*
+* @return  TRUE if the parameters are valid
+*/
+bool AOA_reportCheckParams(const AoA_ReportParams_t *pParams);
+
+/**
+* @brief   Restart the fusion of a connection, the next result is reported whatever it is
+*
+* @param   pReport - fusion state
+*
+* @return  none
+*/
+void AOA_reportReset(AoA_Report_t *pReport);
+
+/**
+* @brief   Add the result of a new CTE
+*
+*          Once the window is full its angles are averaged over the
+*          circle, angles on both sides of the seam of the range average
+*          to the seam and the mean is wrapped back into the range. The
+*          fused result is returned if it moved by minChange or more from
+*          the last reported one, or was held back for maxHold windows.
+*
+* @param   pReport - fusion state
+* @param   pParams - fusion parameters
+* @param   angle - angle of the CTE in degrees, minAngle <= angle < minAngle + 360
+* @param   elevation - elevation of the CTE in degrees, 0 if there is none
+* @param   rssi - rssi of the CTE
+* @param   minAngle - smallest angle of the turn angles are wrapped to
+* @param   pResult - fused result, written when TRUE is returned
+*
+* @return  TRUE if a result is to be reported
+*/
+bool AOA_reportUpdate(AoA_Report_t *pReport, const AoA_ReportParams_t *pParams, int16_t angle, int16_t elevation, int8_t rssi, int16_t minAngle, AoA_ReportResult_t *pResult);
+
+/*********************************************************************
+*********************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AOA_REPORT_H_ */
+
+/** @} End AOA_REPORT */
@@ -0,0 +1,510 @@
+/******************************************************************************
+
+ @file  AOA_rfRam.c
+
+ @brief AoA RF RAM read-out
+ Group: WCS, BTS
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2018-2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <string.h>
+
+#include <ti/sysbios/hal/Hwi.h>
+
+#include "rf_hal.h"
+#include "AOA_rfRam.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// CTE RF registers
+#define RFC_CTE_MCE_RAM_DATA                           (RFC_RAM_BASE + 0x8000) //0x21008000
+#define RFC_CTE_RFE_RAM_DATA                           (RFC_RAM_BASE + 0xC000) //0x2100C000
+#define RFC_CTE_LAST_CAPTURE                           (RFC_RAM_BASE + 0x19)
+#define RFC_CTE_MCE_RAM_STATE                          (RFC_RAM_BASE + 0x1C)
+#define RFC_CTE_RFE_RAM_STATE                          (RFC_RAM_BASE + 0x20)
+
+// CTE RF ram types
+#define RFC_CTE_CAPTURE_RAM_MCE                        (0x00)
+#define RFC_CTE_CAPTURE_RAM_RFE                        (0x01)
+#define RFC_CTE_NO_CAPTURE                             (0xFF)
+
+// CTE RF ram states
+#define RFC_CTE_RAM_STATE_EMPTY                        (0x00)
+#define RFC_CTE_RAM_STATE_BUSY                         (0x01)
+#define RFC_CTE_RAM_STATE_DUAL_BUSY                    (0x02)
+#define RFC_CTE_RAM_STATE_READY                        (0x03)
+#define RFC_CTE_RAM_STATE_DUAL_READY                   (0x04)
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+typedef struct
+{
+  AoA_IQSample_Ext_t *pBufs;       // AOA_RF_RAM_NUM_BUFS buffers
+  pfnAoaRfRamDoneCb_t doneCb;
+  uint32_t start;                  // Ticks the read was armed at
+  volatile uint8_t fill;           // Buffer being read into, AOA_RF_RAM_NO_BUF if no read is on
+  uint8_t numRetries;
+  uint8_t ready[AOA_RF_RAM_NUM_BUFS];  // Buffers read and not taken yet, oldest first
+  uint8_t numReady;
+  uint8_t refCount[AOA_RF_RAM_NUM_BUFS];  // Holds on taken buffers
+  uint8_t seq;                     // Read the RF RAM commands are issued for, bumped when a read is armed or given up
+  uint8_t cmdSeq[AOA_RF_RAM_MAX_CMDS];  // Read of every RF RAM command in flight, in the order they are done
+  uint8_t numCmds;
+} AoA_RfRam_t;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static AoA_RfRam_t gAoaRfRam =
+{
+  .fill = AOA_RF_RAM_NO_BUF,
+};
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+/*********************************************************************
+* @fn      AOA_rfRamIsFree
+*
+* @brief   Check if a buffer is neither read into, waiting nor held
+*
+* @param   index - buffer
+*
+* @return  TRUE if the buffer is free
+*/
+static bool AOA_rfRamIsFree(uint8_t index)
+{
+  if ((index == gAoaRfRam.fill) || (gAoaRfRam.refCount[index] != 0))
+  {
+    return FALSE;
+  }
+
+  for (uint8_t k = 0; k < gAoaRfRam.numReady; k++)
+  {
+    if (gAoaRfRam.ready[k] == index)
+    {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+/*********************************************************************
+* @fn      AOA_rfRamCmdDone
+*
+* @brief   Take the read of the RF RAM command that is done
+*
+* @return  TRUE if the command belongs to the armed read, FALSE if its
+*          read was given up and the command is to be ignored
+*/
+static bool AOA_rfRamCmdDone(void)
+{
+  bool current = FALSE;
+  volatile uint32_t keyHwi;
+
+  keyHwi = Hwi_disable();
+
+  if (gAoaRfRam.numCmds != 0)
+  {
+    current = (gAoaRfRam.cmdSeq[0] == gAoaRfRam.seq) && (gAoaRfRam.fill != AOA_RF_RAM_NO_BUF);
+
+    gAoaRfRam.numCmds--;
+    memmove(&gAoaRfRam.cmdSeq[0], &gAoaRfRam.cmdSeq[1], gAoaRfRam.numCmds);
+  }
+
+  Hwi_restore(keyHwi);
+
+  return current;
+}
+
+/*********************************************************************
+* @fn      AOA_rfRamDone
+*
+* @brief   Release RF RAM for the next CTE and end the armed read, if any
+*
+* @param   state - outcome of the read
+*
+* @return  none
+*/
+static void AOA_rfRamDone(AoA_IQSampleState_t state)
+{
+  volatile uint32_t keyHwi;
+
+  HWREGB(RFC_CTE_MCE_RAM_STATE) = RFC_CTE_RAM_STATE_EMPTY;
+  HWREGB(RFC_CTE_RFE_RAM_STATE) = RFC_CTE_RAM_STATE_EMPTY;
+
+  keyHwi = Hwi_disable();
+
+  // Samples are handed over by index, a failed read leaves its buffer free
+  if (state == SAMPLES_READY)
+  {
+    gAoaRfRam.ready[gAoaRfRam.numReady++] = gAoaRfRam.fill;
+  }
+  gAoaRfRam.fill = AOA_RF_RAM_NO_BUF;
+
+  Hwi_restore(keyHwi);
+
+  if (gAoaRfRam.doneCb != NULL)
+  {
+    gAoaRfRam.doneCb();
+  }
+}
+
+/*********************************************************************
+* @fn      AOA_rfRamInit
+*
+* @brief   Hand the capture buffers over, all of them free
+*
+* @param   pBufs - AOA_RF_RAM_NUM_BUFS buffers of AOA_RES_MAX_SIZE samples, one after the other
+* @param   doneCb - called from the RF callback when a read is over
+*
+* @return  none
+*/
+void AOA_rfRamInit(AoA_IQSample_Ext_t *pBufs, pfnAoaRfRamDoneCb_t doneCb)
+{
+  volatile uint32_t keyHwi;
+
+  keyHwi = Hwi_disable();
+
+  memset(&gAoaRfRam, 0, sizeof(gAoaRfRam));
+  gAoaRfRam.pBufs = pBufs;
+  gAoaRfRam.doneCb = doneCb;
+  gAoaRfRam.fill = AOA_RF_RAM_NO_BUF;
+
+  Hwi_restore(keyHwi);
+}
+
+/*********************************************************************
+* @fn      AOA_rfRamArm
+*
+* @brief   Arm a read on a free buffer, the RF RAM clock enable command is issued next
+*
+* @param   now - current time in ticks
+* @param   pSeq - read the RF RAM commands are to be issued for
+*
+* @return  buffer the capture is read into, AOA_RF_RAM_NO_BUF if a read
+*          is already on or no buffer is free
+*/
+uint8_t AOA_rfRamArm(uint32_t now, uint8_t *pSeq)
+{
+  uint8_t index = AOA_RF_RAM_NO_BUF;
+  volatile uint32_t keyHwi;
+
+  keyHwi = Hwi_disable();
+
+  // RF RAM holds a single capture, it is read before the next one is armed
+  for (uint8_t k = 0; (k < AOA_RF_RAM_NUM_BUFS) && (gAoaRfRam.pBufs != NULL) && (gAoaRfRam.fill == AOA_RF_RAM_NO_BUF); k++)
+  {
+    if (AOA_rfRamIsFree(k))
+    {
+      index = k;
+      gAoaRfRam.fill = k;
+      gAoaRfRam.start = now;
+      gAoaRfRam.numRetries = 0;
+      *pSeq = ++gAoaRfRam.seq;
+    }
+  }
+
+  Hwi_restore(keyHwi);
+
+  return index;
+}
+
+/*********************************************************************
+* @fn      AOA_rfRamIssue
+*
+* @brief   Tag the RF RAM clock enable command about to be scheduled
+*          with the read it is issued for
+*
+* @param   seq - read from AOA_rfRamArm or AOA_rfRamRead
+*
+* @return  TRUE if the command can be scheduled, FALSE if too many are in flight
+*/
+bool AOA_rfRamIssue(uint8_t seq)
+{
+  bool status = FALSE;
+  volatile uint32_t keyHwi;
+
+  keyHwi = Hwi_disable();
+
+  if (gAoaRfRam.numCmds < AOA_RF_RAM_MAX_CMDS)
+  {
+    gAoaRfRam.cmdSeq[gAoaRfRam.numCmds++] = seq;
+    status = TRUE;
+  }
+
+  Hwi_restore(keyHwi);
+
+  return status;
+}
+
+/*********************************************************************
+* @fn      AOA_rfRamCancel
+*
+* @brief   Drop the tag of the last command issued, it could not be scheduled
+*
+* @return  none
+*/
+void AOA_rfRamCancel(void)
+{
+  volatile uint32_t keyHwi;
+
+  keyHwi = Hwi_disable();
+
+  if (gAoaRfRam.numCmds != 0)
+  {
+    gAoaRfRam.numCmds--;
+  }
+
+  Hwi_restore(keyHwi);
+}
+
+/*********************************************************************
+* @fn      AOA_rfRamRead
+*
+* @brief   Read the capture out of RF RAM, called from the RF callback
+*          once an RF RAM clock enable command is done. A command issued
+*          for a read that was given up only releases RF RAM, its capture
+*          belongs to the given up read and is not copied anywhere
+*
+* @param   pSeq - read the command is to be issued for again
+*
+* @return  TRUE if the RF core is still writing the capture and the
+*          command must be issued again, FALSE if the read is over
+*/
+bool AOA_rfRamRead(uint8_t *pSeq)
+{
+  uint8_t lastCapture = HWREGB(RFC_CTE_LAST_CAPTURE);
+  uint8_t fill = gAoaRfRam.fill;
+  uint8_t state;
+
+  if (!AOA_rfRamCmdDone())
+  {
+    HWREGB(RFC_CTE_MCE_RAM_STATE) = RFC_CTE_RAM_STATE_EMPTY;
+    HWREGB(RFC_CTE_RFE_RAM_STATE) = RFC_CTE_RAM_STATE_EMPTY;
+    return FALSE;
+  }
+
+  // check which RAM is capturing samples
+  if ((lastCapture != RFC_CTE_CAPTURE_RAM_MCE) && (lastCapture != RFC_CTE_CAPTURE_RAM_RFE))
+  {
+    AOA_rfRamDone(SAMPLES_NOT_VALID);
+    return FALSE;
+  }
+
+  state = (lastCapture == RFC_CTE_CAPTURE_RAM_MCE) ? HWREGB(RFC_CTE_MCE_RAM_STATE) : HWREGB(RFC_CTE_RFE_RAM_STATE);
+
+  // The buffer is busy, look again once the next command is done rather than spin in the callback
+  if ((state == RFC_CTE_RAM_STATE_BUSY) || (state == RFC_CTE_RAM_STATE_DUAL_BUSY))
+  {
+    if (gAoaRfRam.numRetries < AOA_RF_RAM_MAX_RETRIES)
+    {
+      gAoaRfRam.numRetries++;
+      *pSeq = gAoaRfRam.seq;
+      return TRUE;
+    }
+
+    AOA_rfRamDone(SAMPLES_NOT_VALID);
+    return FALSE;
+  }
+
+  // Only single captures in RFE RAM are read, MCE captures span both RAMs
+  if ((lastCapture == RFC_CTE_CAPTURE_RAM_RFE) &&
+      ((state == RFC_CTE_RAM_STATE_READY) || (state == RFC_CTE_RAM_STATE_DUAL_READY)))
+  {
+    memcpy(&gAoaRfRam.pBufs[fill * AOA_RES_MAX_SIZE], (const void *)RFC_CTE_RFE_RAM_DATA, AOA_RES_MAX_SIZE * sizeof(AoA_IQSample_Ext_t));
+    AOA_rfRamDone(SAMPLES_READY);
+    return FALSE;
+  }
+
+  AOA_rfRamDone(SAMPLES_NOT_VALID);
+  return FALSE;
+}
+
+/*********************************************************************
+* @fn      AOA_rfRamFail
+*
+* @brief   End the read without samples, called from the RF callback
+*          when an RF RAM clock enable command failed
+*
+* @return  none
+*/
+void AOA_rfRamFail(void)
+{
+  if (AOA_rfRamCmdDone())
+  {
+    AOA_rfRamDone(SAMPLES_NOT_VALID);
+  }
+}
+
+/*********************************************************************
+* @fn      AOA_rfRamCheck
+*
+* @brief   Take the oldest buffer read, a read not over within timeout
+*          ticks is given up and the RF callbacks of its commands ignore it
+*
+* @param   now - current time in ticks
+* @param   timeout - ticks from AOA_rfRamArm a read may take
+* @param   pWait - ticks left to wait while SAMPLES_NOT_READY is returned
+* @param   pIndex - buffer taken when SAMPLES_READY is returned, it is held
+*          until AOA_rfRamRelease
+*
+* @return  SAMPLES_READY if a buffer was taken, SAMPLES_NOT_READY while
+*          a read is on, SAMPLES_NOT_VALID if there is nothing to wait for
+*/
+AoA_IQSampleState_t AOA_rfRamCheck(uint32_t now, uint32_t timeout, uint32_t *pWait, uint8_t *pIndex)
+{
+  AoA_IQSampleState_t state = SAMPLES_NOT_VALID;
+  volatile uint32_t keyHwi;
+
+  keyHwi = Hwi_disable();
+
+  if (gAoaRfRam.numReady != 0)
+  {
+    *pIndex = gAoaRfRam.ready[0];
+    gAoaRfRam.refCount[*pIndex] = 1;
+
+    gAoaRfRam.numReady--;
+    memmove(&gAoaRfRam.ready[0], &gAoaRfRam.ready[1], gAoaRfRam.numReady);
+
+    state = SAMPLES_READY;
+  }
+  else if (gAoaRfRam.fill != AOA_RF_RAM_NO_BUF)
+  {
+    // Unsigned difference, the tick counter may wrap during the read
+    uint32_t elapsed = now - gAoaRfRam.start;
+
+    // Commands still in flight for the read no longer match it
+    if (elapsed >= timeout)
+    {
+      gAoaRfRam.fill = AOA_RF_RAM_NO_BUF;
+      gAoaRfRam.seq++;
+    }
+    else
+    {
+      *pWait = timeout - elapsed;
+      state = SAMPLES_NOT_READY;
+    }
+  }
+
+  Hwi_restore(keyHwi);
+
+  return state;
+}
+
+/*********************************************************************
+* @fn      AOA_rfRamGetBuf
+*
+* @brief   Samples of a buffer
+*
+* @param   index - buffer
+*
+* @return  AOA_RES_MAX_SIZE samples
+*/
+AoA_IQSample_Ext_t *AOA_rfRamGetBuf(uint8_t index)
+{
+  return &gAoaRfRam.pBufs[index * AOA_RES_MAX_SIZE];
+}
+
+/*********************************************************************
+* @fn      AOA_rfRamRetain
+*
+* @brief   Hold a buffer taken with AOA_rfRamCheck once more
+*
+* @param   index - buffer
+*
+* @return  TRUE on success, FALSE if the buffer is not held
+*/
+bool AOA_rfRamRetain(uint8_t index)
+{
+  bool status = FALSE;
+  volatile uint32_t keyHwi;
+
+  keyHwi = Hwi_disable();
+
+  if ((index < AOA_RF_RAM_NUM_BUFS) && (gAoaRfRam.refCount[index] != 0) && (gAoaRfRam.refCount[index] != UINT8_MAX))
+  {
+    gAoaRfRam.refCount[index]++;
+    status = TRUE;
+  }
+
+  Hwi_restore(keyHwi);
+
+  return status;
+}
+
+/*********************************************************************
+* @fn      AOA_rfRamRelease
+*
+* @brief   Give a hold on a buffer back, the last one frees it for another capture
+*
+* @param   index - buffer
+*
+* @return  TRUE on success, FALSE if the buffer is not held
+*/
+bool AOA_rfRamRelease(uint8_t index)
+{
+  bool status = FALSE;
+  volatile uint32_t keyHwi;
+
+  keyHwi = Hwi_disable();
+
+  if ((index < AOA_RF_RAM_NUM_BUFS) && (gAoaRfRam.refCount[index] != 0))
+  {
+    gAoaRfRam.refCount[index]--;
+    status = TRUE;
+  }
+
+  Hwi_restore(keyHwi);
+
+  return status;
+}
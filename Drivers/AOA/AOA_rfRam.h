@@ -0,0 +1,230 @@
+/******************************************************************************
+
+ @file  AOA_rfRam.h
+
+ @brief AoA RF RAM read-out
+ Group: WCS, BTS
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2018-2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+
+
+/**
+ *  @defgroup AOA_RF_RAM AOA_RF_RAM
+ *  @brief This module reads RTLS Passive captures out of RF RAM without blocking
+ *
+ *  Captures are read into one of AOA_RF_RAM_NUM_BUFS buffers, so RF RAM is
+ *  free for the next CTE while earlier captures are still being processed.
+ *  A read is armed on a free buffer, then the RF callback calls AOA_rfRamRead
+ *  every time the RF RAM clock enable command is done. While the RF core is
+ *  still writing the capture the read is retried on the next command instead
+ *  of spinning. Once the read is over, the done callback tells the task,
+ *  which takes the buffers read so far, oldest first, with AOA_rfRamCheck
+ *  and gives each back with AOA_rfRamRelease. A read the RF callback never
+ *  finishes is given up after a timeout.
+ *
+ *  Every RF RAM command is tagged with the sequence number of the read it is
+ *  issued for. The late callback of a read that was given up finds a tag
+ *  that no longer matches, so its capture is never copied into the buffer
+ *  of the read armed after it.
+ *
+ *  @{
+ *  @file  AOA_rfRam.h
+ *  @brief      AOA RF RAM read-out interface
+ */
+
+#ifndef AOA_RF_RAM_H_
+#define AOA_RF_RAM_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*******************************************************************************
+ * INCLUDES
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "AOA.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Capture buffers, one is read into while the others wait for or go through processing
+#ifndef AOA_RF_RAM_NUM_BUFS
+#define AOA_RF_RAM_NUM_BUFS       2
+#endif
+
+// RF RAM clock enable commands a read waits for the RF core to finish writing the capture
+#ifndef AOA_RF_RAM_MAX_RETRIES
+#define AOA_RF_RAM_MAX_RETRIES    8
+#endif
+
+// RF RAM commands in flight at most, the one of the armed read and late ones of given up reads
+#ifndef AOA_RF_RAM_MAX_CMDS
+#define AOA_RF_RAM_MAX_CMDS       4
+#endif
+
+#define AOA_RF_RAM_NO_BUF         0xFF  //!< No buffer was armed
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+/// @brief Called from the RF callback once a read is over, whatever its outcome
+typedef void (*pfnAoaRfRamDoneCb_t)(void);
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+
+/**
+* @brief   Hand the capture buffers over, all of them free
+*
+* @param   pBufs - AOA_RF_RAM_NUM_BUFS buffers of AOA_RES_MAX_SIZE samples, one after the other
+* @param   doneCb - called from the RF callback when a read is over
+*
+* @return  none
+*/
+void AOA_rfRamInit(AoA_IQSample_Ext_t *pBufs, pfnAoaRfRamDoneCb_t doneCb);
+
+/**
+* @brief   Arm a read on a free buffer, the RF RAM clock enable command is issued next
+*
+* @param   now - current time in ticks
+* @param   pSeq - read the RF RAM commands are to be issued for
+*
+* @return  buffer the capture is read into, AOA_RF_RAM_NO_BUF if a read
+*          is already on or no buffer is free
+*/
+uint8_t AOA_rfRamArm(uint32_t now, uint8_t *pSeq);
+
+/**
+* @brief   Tag the RF RAM clock enable command about to be scheduled
+*          with the read it is issued for
+*
+* @param   seq - read from AOA_rfRamArm or AOA_rfRamRead
+*
+* @return  TRUE if the command can be scheduled, FALSE if too many are in flight
+*/
+bool AOA_rfRamIssue(uint8_t seq);
+
+/**
+* @brief   Drop the tag of the last command issued, it could not be scheduled
+*
+* @return  none
+*/
+void AOA_rfRamCancel(void);
+
+/**
+* @brief   Read the capture out of RF RAM, called from the RF callback
+*          once an RF RAM clock enable command is done, a command of a
+*          read that was given up only releases RF RAM
+*
+* @param   pSeq - read the command is to be issued for again
+*
+* @return  TRUE if the RF core is still writing the capture and the
+*          command must be issued again, FALSE if the read is over
+*/
+bool AOA_rfRamRead(uint8_t *pSeq);
+
+/**
+* @brief   End the read without samples, called from the RF callback
+*          when an RF RAM clock enable command failed
+*
+* @return  none
+*/
+void AOA_rfRamFail(void);
+
+/**
+* @brief   Take the oldest buffer read, a read not over within timeout
+*          ticks is given up and the RF callbacks of its commands ignore it
+*
+* @param   now - current time in ticks
+* @param   timeout - ticks from AOA_rfRamArm a read may take
+* @param   pWait - ticks left to wait while SAMPLES_NOT_READY is returned
+* @param   pIndex - buffer taken when SAMPLES_READY is returned, it is held
+*          until AOA_rfRamRelease
+*
+* @return  SAMPLES_READY if a buffer was taken, SAMPLES_NOT_READY while
+*          a read is on, SAMPLES_NOT_VALID if there is nothing to wait for
+*/
+AoA_IQSampleState_t AOA_rfRamCheck(uint32_t now, uint32_t timeout, uint32_t *pWait, uint8_t *pIndex);
+
+/**
+* @brief   Samples of a buffer
+*
+* @param   index - buffer
+*
+* @return  AOA_RES_MAX_SIZE samples
+*/
+AoA_IQSample_Ext_t *AOA_rfRamGetBuf(uint8_t index);
+
+/**
+* @brief   Hold a buffer taken with AOA_rfRamCheck once more
+*
+* @param   index - buffer
+*
+* @return  TRUE on success, FALSE if the buffer is not held
+*/
+bool AOA_rfRamRetain(uint8_t index);
+
+/**
+* @brief   Give a hold on a buffer back, the last one frees it for another capture
+*
+* @param   index - buffer
+*
+* @return  TRUE on success, FALSE if the buffer is not held
+*/
+bool AOA_rfRamRelease(uint8_t index);
+
+/*********************************************************************
+*********************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AOA_RF_RAM_H_ */
+
+/** @} End AOA_RF_RAM */
@@ -0,0 +1,382 @@
+/******************************************************************************
+
+ @file  AOA_spectrum.c
+
+ @brief This file contains the spatial spectrum AoA estimator
+ Group: WCS, BTS
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2018-2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "rf_hal.h"
+#include "AOA_spectrum.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define AOA_SPECTRUM_PI                  3.14159265358979323846f
+
+// Steering vectors are stored in Q15
+#define AOA_SPECTRUM_STEER_ONE           32767
+#define AOA_SPECTRUM_STEER_SCALE         (1.0f / 32768.0f)
+
+// MVDR diagonal loading, relative to the unit trace covariance
+#define AOA_SPECTRUM_MVDR_LOADING        0.01f
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// Steering vector of every scanned angle, AOA_SPECTRUM_NUM_BINS rows of aoaSteerNumAnt elements
+static AoA_Steer_t *aoaSteer = NULL;
+
+// Number of elements aoaSteer was built for, 0 before AOA_spectrumInit
+static uint8_t aoaSteerNumAnt = 0;
+
+// Selected estimator
+static AoA_SpectrumMethod_t gSpectrumMethod = AOA_SPECTRUM_METHOD_DEFAULT;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+/*********************************************************************
+* @fn      AOA_spectrumBartlett
+*
+* @brief   Bartlett power of one scanned angle, a^H R a
+*
+* @param   pCov - array covariance
+* @param   pSteer - steering vector
+*
+* @return  power
+*/
+static float AOA_spectrumBartlett(const AoA_Covariance_t *pCov, const AoA_Steer_t *pSteer)
+{
+  const uint8_t numAnt = pCov->numAnt;
+  float cross = 0;
+  float diag = 0;
+
+  // R is Hermitian: the diagonal plus twice the real part of the upper triangle
+  for (uint8_t a = 0; a < numAnt; ++a)
+  {
+    float sumRe = 0;
+    float sumIm = 0;
+
+    for (uint8_t b = a + 1; b < numAnt; ++b)
+    {
+      // R[a][b] * w[b]
+      sumRe += AOA_COV_RE(pCov, a, b) * pSteer[b].re - AOA_COV_IM(pCov, a, b) * pSteer[b].im;
+      sumIm += AOA_COV_RE(pCov, a, b) * pSteer[b].im + AOA_COV_IM(pCov, a, b) * pSteer[b].re;
+    }
+
+    // Re(conj(w[a]) * sum)
+    cross += pSteer[a].re * sumRe + pSteer[a].im * sumIm;
+    diag += AOA_COV_RE(pCov, a, a);
+  }
+
+  return diag + 2 * cross * AOA_SPECTRUM_STEER_SCALE * AOA_SPECTRUM_STEER_SCALE;
+}
+
+/*********************************************************************
+* @fn      AOA_spectrumCholesky
+*
+* @brief   Cholesky factor of the diagonally loaded covariance, R + dI = L L^H
+*
+* @param   pCov - array covariance
+* @param   pL - lower triangular factor, same size as pCov
+*
+* @return  TRUE if R + dI is positive definite
+*/
+static bool AOA_spectrumCholesky(const AoA_Covariance_t *pCov, AoA_Covariance_t *pL)
+{
+  const uint8_t numAnt = pCov->numAnt;
+
+  for (uint8_t j = 0; j < numAnt; ++j)
+  {
+    float diag = AOA_COV_RE(pCov, j, j) + AOA_SPECTRUM_MVDR_LOADING;
+
+    for (uint8_t k = 0; k < j; ++k)
+    {
+      diag -= AOA_COV_RE(pL, j, k) * AOA_COV_RE(pL, j, k) + AOA_COV_IM(pL, j, k) * AOA_COV_IM(pL, j, k);
+    }
+
+    if (diag <= 0)
+    {
+      return FALSE;
+    }
+
+    AOA_COV_RE(pL, j, j) = sqrtf(diag);
+    AOA_COV_IM(pL, j, j) = 0;
+
+    for (uint8_t i = j + 1; i < numAnt; ++i)
+    {
+      float re = AOA_COV_RE(pCov, i, j);
+      float im = AOA_COV_IM(pCov, i, j);
+
+      // R[i][j] - sum L[i][k] * conj(L[j][k])
+      for (uint8_t k = 0; k < j; ++k)
+      {
+        re -= AOA_COV_RE(pL, i, k) * AOA_COV_RE(pL, j, k) + AOA_COV_IM(pL, i, k) * AOA_COV_IM(pL, j, k);
+        im -= AOA_COV_IM(pL, i, k) * AOA_COV_RE(pL, j, k) - AOA_COV_RE(pL, i, k) * AOA_COV_IM(pL, j, k);
+      }
+
+      AOA_COV_RE(pL, i, j) = re / AOA_COV_RE(pL, j, j);
+      AOA_COV_IM(pL, i, j) = im / AOA_COV_RE(pL, j, j);
+    }
+  }
+
+  return TRUE;
+}
+
+/*********************************************************************
+* @fn      AOA_spectrumMvdr
+*
+* @brief   MVDR power of one scanned angle, 1 / (a^H R^-1 a)
+*
+*          a^H R^-1 a = |L^-1 a|^2, L^-1 a is found by forward substitution.
+*
+* @param   pL - Cholesky factor of the covariance
+* @param   pSteer - steering vector
+*
+* @return  power
+*/
+static float AOA_spectrumMvdr(const AoA_Covariance_t *pL, const AoA_Steer_t *pSteer)
+{
+  float yRe[AOA_MAX_NUM_ANT];
+  float yIm[AOA_MAX_NUM_ANT];
+  float norm = 0;
+
+  for (uint8_t i = 0; i < pL->numAnt; ++i)
+  {
+    float re = pSteer[i].re * AOA_SPECTRUM_STEER_SCALE;
+    float im = pSteer[i].im * AOA_SPECTRUM_STEER_SCALE;
+
+    for (uint8_t k = 0; k < i; ++k)
+    {
+      re -= AOA_COV_RE(pL, i, k) * yRe[k] - AOA_COV_IM(pL, i, k) * yIm[k];
+      im -= AOA_COV_RE(pL, i, k) * yIm[k] + AOA_COV_IM(pL, i, k) * yRe[k];
+    }
+
+    yRe[i] = re / AOA_COV_RE(pL, i, i);
+    yIm[i] = im / AOA_COV_RE(pL, i, i);
+    norm += yRe[i] * yRe[i] + yIm[i] * yIm[i];
+  }
+
+  return (norm > 0) ? (1.0f / norm) : 0;
+}
+
+/*********************************************************************
+ * PUBLIC FUNCTIONS
+ */
+
+/*********************************************************************
+* @fn      AOA_spectrumInit
+*
+* @brief   Build the steering table for an antenna array
+*
+* @param   antConfig - antenna configuration provided from antenna files
+* @param   pSteer - table storage, AOA_SPECTRUM_STEER_SIZE(antConfig->numElements) bytes
+*
+* @return  none
+*/
+void AOA_spectrumInit(const AoA_AntennaConfig_t *antConfig, AoA_Steer_t *pSteer)
+{
+  const uint8_t numAnt = antConfig->numElements;
+
+  aoaSteer = pSteer;
+  aoaSteerNumAnt = 0;
+
+  if ((pSteer == NULL) || (numAnt > AOA_MAX_NUM_ANT))
+  {
+    return;
+  }
+
+  for (uint8_t bin = 0; bin < AOA_SPECTRUM_NUM_BINS; ++bin)
+  {
+    const float theta = (AOA_SPECTRUM_MIN_ANGLE + bin * AOA_SPECTRUM_STEP_ANGLE) * AOA_SPECTRUM_PI / 180;
+    // The wave reaches the element at position 0 first for positive angles
+    const float phase = -2 * AOA_SPECTRUM_PI * sinf(theta);
+
+    for (uint8_t k = 0; k < numAnt; ++k)
+    {
+      pSteer[bin * numAnt + k].re = (int16_t)lroundf(AOA_SPECTRUM_STEER_ONE * cosf(phase * antConfig->pPosition[k]));
+      pSteer[bin * numAnt + k].im = (int16_t)lroundf(AOA_SPECTRUM_STEER_ONE * sinf(phase * antConfig->pPosition[k]));
+    }
+  }
+
+  aoaSteerNumAnt = numAnt;
+}
+
+/*********************************************************************
+* @fn      AOA_spectrumSetMethod
+*
+* @brief   Select the spectrum estimator
+*
+* @param   method - AOA_SPECTRUM_BARTLETT/AOA_SPECTRUM_MVDR
+*
+* @return  none
+*/
+void AOA_spectrumSetMethod(AoA_SpectrumMethod_t method)
+{
+  gSpectrumMethod = method;
+}
+
+/*********************************************************************
+* @fn      AOA_spectrumGetMethod
+*
+* @brief   Get the selected spectrum estimator
+*
+* @return  AOA_SPECTRUM_BARTLETT/AOA_SPECTRUM_MVDR
+*/
+AoA_SpectrumMethod_t AOA_spectrumGetMethod(void)
+{
+  return gSpectrumMethod;
+}
+
+/*********************************************************************
+* @fn      AOA_spectrumUpdate
+*
+* @brief   Add a new covariance estimate to a running average
+*
+* @param   pAvg - running average
+* @param   pNew - estimate of the last capture
+* @param   alpha - weight of the new estimate, 0 < alpha <= 1
+*
+* @return  none
+*/
+void AOA_spectrumUpdate(AoA_Covariance_t *pAvg, const AoA_Covariance_t *pNew, float alpha)
+{
+  const uint16_t numElem = 2 * pNew->numAnt * pNew->numAnt;
+
+  if ((pAvg->numAnt != pNew->numAnt) || !pNew->valid)
+  {
+    return;
+  }
+
+  if (!pAvg->valid || (alpha >= 1))
+  {
+    memcpy(pAvg->elem, pNew->elem, numElem * sizeof(float));
+    pAvg->valid = TRUE;
+    return;
+  }
+
+  for (uint16_t k = 0; k < numElem; ++k)
+  {
+    pAvg->elem[k] += alpha * (pNew->elem[k] - pAvg->elem[k]);
+  }
+}
+
+/*********************************************************************
+* @fn      AOA_spectrumScan
+*
+* @brief   Scan the steering table and find the spectrum peak
+*
+* @param   pCov - array covariance
+* @param   pWork - scratch covariance of the same size for MVDR, NULL scans with Bartlett
+* @param   pResult - peak angle and spectrum
+*
+* @return  TRUE if a spectrum was computed
+*/
+bool AOA_spectrumScan(const AoA_Covariance_t *pCov, AoA_Covariance_t *pWork, AoA_SpectrumResult_t *pResult)
+{
+  // Kept off the RTLS task stack
+  static float power[AOA_SPECTRUM_NUM_BINS];
+  AoA_SpectrumMethod_t method = gSpectrumMethod;
+  uint8_t peak = 0;
+  float offset = 0;
+
+  if (!pCov->valid || (pCov->numAnt == 0) || (pCov->numAnt != aoaSteerNumAnt))
+  {
+    return FALSE;
+  }
+
+  // Fall back to Bartlett if the covariance can not be factored
+  if ((method == AOA_SPECTRUM_MVDR) &&
+      ((pWork == NULL) || (pWork->numAnt != pCov->numAnt) || !AOA_spectrumCholesky(pCov, pWork)))
+  {
+    method = AOA_SPECTRUM_BARTLETT;
+  }
+
+  for (uint8_t bin = 0; bin < AOA_SPECTRUM_NUM_BINS; ++bin)
+  {
+    const AoA_Steer_t *pSteer = &aoaSteer[bin * aoaSteerNumAnt];
+
+    if (method == AOA_SPECTRUM_MVDR)
+    {
+      power[bin] = AOA_spectrumMvdr(pWork, pSteer);
+    }
+    else
+    {
+      power[bin] = AOA_spectrumBartlett(pCov, pSteer);
+    }
+
+    if (power[bin] > power[peak])
+    {
+      peak = bin;
+    }
+  }
+
+  // Parabolic interpolation between the peak and its neighbours
+  if ((peak > 0) && (peak < AOA_SPECTRUM_NUM_BINS - 1))
+  {
+    const float denom = power[peak - 1] - 2 * power[peak] + power[peak + 1];
+
+    if (denom < 0)
+    {
+      offset = 0.5f * (power[peak - 1] - power[peak + 1]) / denom;
+    }
+  }
+
+  pResult->angle = (int16_t)lroundf(AOA_SPECTRUM_MIN_ANGLE + (peak + offset) * AOA_SPECTRUM_STEP_ANGLE);
+
+  for (uint8_t bin = 0; bin < AOA_SPECTRUM_NUM_BINS; ++bin)
+  {
+    pResult->power[bin] = (power[peak] > 0) ? (uint8_t)lroundf(255 * power[bin] / power[peak]) : 0;
+  }
+
+  return TRUE;
+}
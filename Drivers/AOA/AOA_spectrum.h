@@ -0,0 +1,189 @@
+/******************************************************************************
+
+ @file  AOA_spectrum.h
+
+ @brief This file contains the spatial spectrum AoA estimator interface
+ Group: WCS, BTS
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2018-2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+
+/**
+ *  @defgroup AOA_SPECTRUM AOA_SPECTRUM
+ *  @brief This module estimates the angle of arrival from the array covariance
+ *
+ *  @{
+ *  @file  AOA_spectrum.h
+ *  @brief      AOA spatial spectrum interface
+ */
+
+#ifndef AOA_SPECTRUM_H_
+#define AOA_SPECTRUM_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*******************************************************************************
+ * INCLUDES
+ */
+
+#include <stdint.h>
+#include "AOA.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/// @brief Scanned angles, degrees from broadside
+#define AOA_SPECTRUM_MIN_ANGLE           (-90)
+#define AOA_SPECTRUM_MAX_ANGLE           90
+
+// Degrees between two scanned angles
+#ifndef AOA_SPECTRUM_STEP_ANGLE
+#define AOA_SPECTRUM_STEP_ANGLE          3
+#endif
+
+/// @brief Number of scanned angles
+#define AOA_SPECTRUM_NUM_BINS            ((AOA_SPECTRUM_MAX_ANGLE - AOA_SPECTRUM_MIN_ANGLE) / AOA_SPECTRUM_STEP_ANGLE + 1)
+
+/// @brief Bytes of the steering table of an array of numElements
+#define AOA_SPECTRUM_STEER_SIZE(numElements)  (AOA_SPECTRUM_NUM_BINS * (numElements) * sizeof(AoA_Steer_t))
+
+// Default estimator, can be overridden by the project defines
+#ifndef AOA_SPECTRUM_METHOD_DEFAULT
+#define AOA_SPECTRUM_METHOD_DEFAULT      AOA_SPECTRUM_BARTLETT
+#endif
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+/// @brief Spatial spectrum estimator
+typedef enum
+{
+  AOA_SPECTRUM_BARTLETT,   //!< Delay and sum beamformer, a^H R a
+  AOA_SPECTRUM_MVDR        //!< Minimum variance distortionless response, 1 / (a^H R^-1 a)
+} AoA_SpectrumMethod_t;
+
+/// @brief Q15 steering vector element
+typedef struct
+{
+  int16_t re;
+  int16_t im;
+} AoA_Steer_t;
+
+/// @brief Spectrum of one estimate
+typedef struct
+{
+  int16_t angle;                           //!< Peak angle in degrees, interpolated between bins
+  uint8_t power[AOA_SPECTRUM_NUM_BINS];    //!< Power per scanned angle, 255 at the peak
+} AoA_SpectrumResult_t;
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+
+/**
+* @brief   Build the steering table for an antenna array
+*
+*          The array is treated as a linear array with the element positions
+*          of the antenna configuration. The table is kept until the next
+*          call, it is scanned for covariances of antConfig->numElements.
+*
+* @param   antConfig - antenna configuration provided from antenna files
+* @param   pSteer - table storage, AOA_SPECTRUM_STEER_SIZE(antConfig->numElements) bytes
+*
+* @return  none
+*/
+void AOA_spectrumInit(const AoA_AntennaConfig_t *antConfig, AoA_Steer_t *pSteer);
+
+/**
+* @brief   Select the spectrum estimator
+*
+* @param   method - AOA_SPECTRUM_BARTLETT/AOA_SPECTRUM_MVDR
+*
+* @return  none
+*/
+void AOA_spectrumSetMethod(AoA_SpectrumMethod_t method);
+
+/**
+* @brief   Get the selected spectrum estimator
+*
+* @return  AOA_SPECTRUM_BARTLETT/AOA_SPECTRUM_MVDR
+*/
+AoA_SpectrumMethod_t AOA_spectrumGetMethod(void);
+
+/**
+* @brief   Add a new covariance estimate to a running average
+*
+*          pAvg += alpha * (pNew - pAvg). An empty average is replaced by
+*          pNew. Both must be sized for the same array.
+*
+* @param   pAvg - running average
+* @param   pNew - estimate of the last capture
+* @param   alpha - weight of the new estimate, 0 < alpha <= 1
+*
+* @return  none
+*/
+void AOA_spectrumUpdate(AoA_Covariance_t *pAvg, const AoA_Covariance_t *pNew, float alpha);
+
+/**
+* @brief   Scan the steering table and find the spectrum peak
+*
+* @param   pCov - array covariance
+* @param   pWork - scratch covariance of the same size for MVDR, NULL scans with Bartlett
+* @param   pResult - peak angle and spectrum
+*
+* @return  TRUE if a spectrum was computed, FALSE if the covariance does not
+*          match the steering table
+*/
+bool AOA_spectrumScan(const AoA_Covariance_t *pCov, AoA_Covariance_t *pWork, AoA_SpectrumResult_t *pResult);
+
+/*********************************************************************
+*********************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AOA_SPECTRUM_H_ */
+
+/** @} End AOA_SPECTRUM */
@@ -0,0 +1,422 @@
+/******************************************************************************
+
+ @file  AOA_track.c
+
+ @brief AoA angle tracking filters
+ Group: WCS, BTS
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2018-2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <string.h>
+
+#include "rf_hal.h"
+#include "AOA_track.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define AOA_TRACK_GAIN_BITS              15
+#define AOA_TRACK_HALF                   (1 << (AOA_TRACK_FRAC_BITS - 1))
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+/*********************************************************************
+* @fn      AOA_trackToDeg
+*
+* @brief   Round a tracked angle to whole degrees
+*
+* @param   value - degrees, AOA_TRACK_FRAC_BITS fraction bits
+*
+* @return  degrees
+*/
+static int16_t AOA_trackToDeg(int32_t value)
+{
+  return (int16_t)((value + AOA_TRACK_HALF) >> AOA_TRACK_FRAC_BITS);
+}
+
+/*********************************************************************
+* @fn      AOA_trackGain
+*
+* @brief   Apply a Q15 gain
+*
+* @param   gain - Q15 gain
+* @param   value - value to scale
+*
+* @return  gain * value
+*/
+static int32_t AOA_trackGain(int32_t gain, int32_t value)
+{
+  return (int32_t)(((int64_t)gain * value) >> AOA_TRACK_GAIN_BITS);
+}
+
+/*********************************************************************
+* @fn      AOA_trackWrap
+*
+* @brief   Wrap an angle into one turn
+*
+* @param   angle - degrees
+* @param   minAngle - smallest angle of the turn
+*
+* @return  degrees, minAngle <= angle < minAngle + 360
+*/
+static int32_t AOA_trackWrap(int32_t angle, int32_t minAngle)
+{
+  while (angle >= minAngle + 360)
+  {
+    angle -= 360;
+  }
+  while (angle < minAngle)
+  {
+    angle += 360;
+  }
+
+  return angle;
+}
+
+/*********************************************************************
+* @fn      AOA_trackLast
+*
+* @brief   Last tracked angle, a tracker that has seen no angle returns 0
+*
+* @param   pTrack - tracker
+*
+* @return  degrees
+*/
+static int16_t AOA_trackLast(const AoA_Track_t *pTrack)
+{
+  if (pTrack->numEntries == 0)
+  {
+    return 0;
+  }
+
+  if (pTrack->params.type == AOA_TRACK_MOVING_AVG)
+  {
+    return (int16_t)(pTrack->state.avg.sum / pTrack->numEntries);
+  }
+
+  return AOA_trackToDeg(pTrack->state.kin.angle);
+}
+
+/*********************************************************************
+* @fn      AOA_trackShift
+*
+* @brief   Move every angle a tracker holds by whole turns, velocities are kept
+*
+* @param   pTrack - tracker
+* @param   shift - degrees, a multiple of 360
+*
+* @return  none
+*/
+static void AOA_trackShift(AoA_Track_t *pTrack, int16_t shift)
+{
+  if (pTrack->params.type == AOA_TRACK_MOVING_AVG)
+  {
+    for (uint8_t k = 0; k < pTrack->numEntries; k++)
+    {
+      pTrack->state.avg.history[k] += shift;
+    }
+    pTrack->state.avg.sum += (int32_t)shift * pTrack->numEntries;
+  }
+  else
+  {
+    pTrack->state.kin.angle += (int32_t)shift << AOA_TRACK_FRAC_BITS;
+  }
+}
+
+/*********************************************************************
+* @fn      AOA_trackMovingAvg
+*
+* @brief   Running sum over the window, the oldest angle leaves as the new one enters
+*/
+static int16_t AOA_trackMovingAvg(AoA_Track_t *pTrack, int16_t angle)
+{
+  const uint8_t window = pTrack->params.window;
+
+  if (pTrack->numEntries < window)
+  {
+    pTrack->numEntries++;
+  }
+  else
+  {
+    pTrack->state.avg.sum -= pTrack->state.avg.history[pTrack->state.avg.idx];
+  }
+
+  pTrack->state.avg.history[pTrack->state.avg.idx] = angle;
+  pTrack->state.avg.sum += angle;
+
+  if (++pTrack->state.avg.idx >= window)
+  {
+    pTrack->state.avg.idx = 0;
+  }
+
+  return (int16_t)(pTrack->state.avg.sum / pTrack->numEntries);
+}
+
+/*********************************************************************
+* @fn      AOA_trackAlphaBeta
+*
+* @brief   Predict with the last velocity, correct angle and velocity by fixed gains
+*/
+static int16_t AOA_trackAlphaBeta(AoA_Track_t *pTrack, int16_t angle)
+{
+  const int32_t measured = (int32_t)angle << AOA_TRACK_FRAC_BITS;
+  int32_t predicted;
+  int32_t residual;
+
+  if (pTrack->numEntries == 0)
+  {
+    pTrack->state.kin.angle = measured;
+    pTrack->state.kin.velocity = 0;
+    pTrack->numEntries = 1;
+    return angle;
+  }
+
+  predicted = pTrack->state.kin.angle + pTrack->state.kin.velocity;
+  residual = measured - predicted;
+
+  pTrack->state.kin.angle = predicted + AOA_trackGain(pTrack->params.alpha, residual);
+  pTrack->state.kin.velocity += AOA_trackGain(pTrack->params.beta, residual);
+
+  return AOA_trackToDeg(pTrack->state.kin.angle);
+}
+
+/*********************************************************************
+* @fn      AOA_trackKalman
+*
+* @brief   Constant velocity Kalman filter, one CTE per step
+*
+*          The covariance is kept in deg^2 with AOA_TRACK_FRAC_BITS fraction
+*          bits. The process noise is a white angular acceleration, which
+*          adds q * [1/4 1/2; 1/2 1] per step.
+*/
+static int16_t AOA_trackKalman(AoA_Track_t *pTrack, int16_t angle)
+{
+  const int32_t measured = (int32_t)angle << AOA_TRACK_FRAC_BITS;
+  const int32_t r = (int32_t)pTrack->params.measVar << AOA_TRACK_FRAC_BITS;
+  const int32_t q = pTrack->params.accelVar;
+  int32_t p00, p01, p11;
+  int32_t k0, k1;
+  int32_t predicted;
+  int32_t residual;
+
+  if (pTrack->numEntries == 0)
+  {
+    // The velocity is unknown, give it the spread of one measurement
+    pTrack->state.kin.angle = measured;
+    pTrack->state.kin.velocity = 0;
+    pTrack->state.kin.p00 = r;
+    pTrack->state.kin.p01 = 0;
+    pTrack->state.kin.p11 = r;
+    pTrack->numEntries = 1;
+    return angle;
+  }
+
+  // Predict
+  predicted = pTrack->state.kin.angle + pTrack->state.kin.velocity;
+  p00 = pTrack->state.kin.p00 + 2 * pTrack->state.kin.p01 + pTrack->state.kin.p11 + q / 4;
+  p01 = pTrack->state.kin.p01 + pTrack->state.kin.p11 + q / 2;
+  p11 = pTrack->state.kin.p11 + q;
+
+  // Gains of the angle measurement, Q15
+  k0 = (int32_t)(((int64_t)p00 << AOA_TRACK_GAIN_BITS) / (p00 + r));
+  k1 = (int32_t)(((int64_t)p01 << AOA_TRACK_GAIN_BITS) / (p00 + r));
+
+  // Correct
+  residual = measured - predicted;
+  pTrack->state.kin.angle = predicted + AOA_trackGain(k0, residual);
+  pTrack->state.kin.velocity += AOA_trackGain(k1, residual);
+
+  pTrack->state.kin.p00 = p00 - AOA_trackGain(k0, p00);
+  pTrack->state.kin.p01 = p01 - AOA_trackGain(k0, p01);
+  pTrack->state.kin.p11 = p11 - AOA_trackGain(k1, p01);
+
+  return AOA_trackToDeg(pTrack->state.kin.angle);
+}
+
+/*********************************************************************
+ * PUBLIC FUNCTIONS
+ */
+
+/*********************************************************************
+* @fn      AOA_trackDefaultParams
+*
+* @brief   Default tracker parameters, the legacy moving average
+*
+* @param   pParams - parameters to fill
+*
+* @return  none
+*/
+void AOA_trackDefaultParams(AoA_TrackParams_t *pParams)
+{
+  memset(pParams, 0, sizeof(AoA_TrackParams_t));
+
+  pParams->type = AOA_TRACK_MOVING_AVG;
+  pParams->window = AOA_TRACK_DEFAULT_WINDOW;
+}
+
+/*********************************************************************
+* @fn      AOA_trackInit
+*
+* @brief   Select the filter of a tracker and restart it
+*
+* @param   pTrack - tracker
+* @param   pParams - filter and parameters
+*
+* @return  TRUE if the parameters are valid, the tracker is left untouched otherwise
+*/
+bool AOA_trackInit(AoA_Track_t *pTrack, const AoA_TrackParams_t *pParams)
+{
+  switch (pParams->type)
+  {
+    case AOA_TRACK_MOVING_AVG:
+      if ((pParams->window == 0) || (pParams->window > AOA_TRACK_MAX_WINDOW))
+      {
+        return FALSE;
+      }
+      break;
+
+    case AOA_TRACK_ALPHA_BETA:
+      if ((pParams->alpha == 0) || (pParams->alpha > AOA_TRACK_GAIN_ONE) || (pParams->beta > AOA_TRACK_GAIN_ONE))
+      {
+        return FALSE;
+      }
+      break;
+
+    case AOA_TRACK_KALMAN:
+      if (pParams->measVar == 0)
+      {
+        return FALSE;
+      }
+      break;
+
+    default:
+      return FALSE;
+  }
+
+  pTrack->params = *pParams;
+  AOA_trackReset(pTrack);
+
+  return TRUE;
+}
+
+/*********************************************************************
+* @fn      AOA_trackReset
+*
+* @brief   Restart a tracker, the next angle is taken as is
+*
+* @param   pTrack - tracker
+*
+* @return  none
+*/
+void AOA_trackReset(AoA_Track_t *pTrack)
+{
+  memset(&pTrack->state, 0, sizeof(pTrack->state));
+  pTrack->numEntries = 0;
+}
+
+/*********************************************************************
+* @fn      AOA_trackUpdate
+*
+* @brief   Add the angle of a new CTE
+*
+* @param   pTrack - tracker
+* @param   angle - measured angle in degrees
+*
+* @return  tracked angle in degrees
+*/
+int16_t AOA_trackUpdate(AoA_Track_t *pTrack, int16_t angle)
+{
+  switch (pTrack->params.type)
+  {
+    case AOA_TRACK_ALPHA_BETA:
+      return AOA_trackAlphaBeta(pTrack, angle);
+
+    case AOA_TRACK_KALMAN:
+      return AOA_trackKalman(pTrack, angle);
+
+    case AOA_TRACK_MOVING_AVG:
+    default:
+      return AOA_trackMovingAvg(pTrack, angle);
+  }
+}
+
+/*********************************************************************
+* @fn      AOA_trackUpdateCircular
+*
+* @brief   Add the angle of a new CTE to a tracker of angles over the full circle
+*
+* @param   pTrack - tracker
+* @param   angle - measured angle in degrees, minAngle <= angle < minAngle + 360
+* @param   minAngle - smallest angle of the turn
+*
+* @return  tracked angle in degrees, minAngle <= angle < minAngle + 360
+*/
+int16_t AOA_trackUpdateCircular(AoA_Track_t *pTrack, int16_t angle, int16_t minAngle)
+{
+  int32_t tracked;
+  int32_t wrapped;
+
+  // The filters run on the nearest turn of the new angle, -134 after 224 is 226
+  if (pTrack->numEntries != 0)
+  {
+    const int32_t last = AOA_trackLast(pTrack);
+
+    angle = (int16_t)(last + AOA_trackWrap((int32_t)angle - last, -180));
+  }
+
+  tracked = AOA_trackUpdate(pTrack, angle);
+  wrapped = AOA_trackWrap(tracked, minAngle);
+
+  // A tag that keeps circling must not run the filter state out of range
+  if (wrapped != tracked)
+  {
+    AOA_trackShift(pTrack, (int16_t)(wrapped - tracked));
+  }
+
+  return (int16_t)wrapped;
+}
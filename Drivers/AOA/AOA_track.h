@@ -0,0 +1,208 @@
+/******************************************************************************
+
+ @file  AOA_track.h
+
+ @brief AoA angle tracking filters
+ Group: WCS, BTS
+ Target Device: cc13x2_26x2
+
+ ******************************************************************************
+ 
+ Copyright (c) 2018-2020, Texas Instruments Incorporated
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+
+ *  Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+
+ *  Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+
+ *  Neither the name of Texas Instruments Incorporated nor the names of
+    its contributors may be used to endorse or promote products derived
+    from this software without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+ ******************************************************************************
+ 
+ 
+ *****************************************************************************/
+
+
+
+/**
+ *  @defgroup AOA_TRACK AOA_TRACK
+ *  @brief This module smooths the angles of one connection over its CTEs
+ *
+ *  @{
+ *  @file  AOA_track.h
+ *  @brief      AOA angle tracking interface
+ */
+
+#ifndef AOA_TRACK_H_
+#define AOA_TRACK_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*******************************************************************************
+ * INCLUDES
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+/// @brief Largest moving average window
+#define AOA_TRACK_MAX_WINDOW             16
+
+// Window of the default tracker, the legacy moving average
+#ifndef AOA_TRACK_DEFAULT_WINDOW
+#define AOA_TRACK_DEFAULT_WINDOW         6
+#endif
+
+/// @brief Fraction bits of the tracked angle and velocity
+#define AOA_TRACK_FRAC_BITS              8
+
+/// @brief Alpha-beta gains are Q15, AOA_TRACK_GAIN_ONE is a gain of 1
+#define AOA_TRACK_GAIN_ONE               32768
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+/// @brief Tracking filter
+typedef enum
+{
+  AOA_TRACK_MOVING_AVG,    //!< Mean of the last window angles
+  AOA_TRACK_ALPHA_BETA,    //!< Alpha-beta filter on angle and angular velocity
+  AOA_TRACK_KALMAN         //!< Constant velocity Kalman filter
+} AoA_TrackType_t;
+
+/// @brief Tracking filter parameters
+///
+/// The filters step once per CTE, velocities are in degrees per CTE.
+typedef struct
+{
+  uint8_t  type;             //!< AoA_TrackType_t
+  uint8_t  window;           //!< AOA_TRACK_MOVING_AVG: angles averaged, 1 - AOA_TRACK_MAX_WINDOW
+  uint16_t alpha;            //!< AOA_TRACK_ALPHA_BETA: angle gain, Q15, 1 - AOA_TRACK_GAIN_ONE
+  uint16_t beta;             //!< AOA_TRACK_ALPHA_BETA: velocity gain, Q15, 0 - AOA_TRACK_GAIN_ONE
+  uint16_t measVar;          //!< AOA_TRACK_KALMAN: angle measurement variance in deg^2, at least 1
+  uint16_t accelVar;         //!< AOA_TRACK_KALMAN: angular acceleration variance in 1/256 deg^2 per CTE^4
+} AoA_TrackParams_t;
+
+/// @brief Tracking filter state of one connection
+typedef struct
+{
+  AoA_TrackParams_t params;
+  uint8_t numEntries;        //!< Angles seen, up to the window for AOA_TRACK_MOVING_AVG
+  union
+  {
+    struct
+    {
+      int16_t history[AOA_TRACK_MAX_WINDOW];
+      int32_t sum;
+      uint8_t idx;
+    } avg;                   //!< AOA_TRACK_MOVING_AVG
+    struct
+    {
+      int32_t angle;         //!< Degrees, AOA_TRACK_FRAC_BITS fraction bits
+      int32_t velocity;      //!< Degrees per CTE, AOA_TRACK_FRAC_BITS fraction bits
+      int32_t p00;           //!< Angle variance (AOA_TRACK_KALMAN)
+      int32_t p01;           //!< Angle and velocity covariance (AOA_TRACK_KALMAN)
+      int32_t p11;           //!< Velocity variance (AOA_TRACK_KALMAN)
+    } kin;                   //!< AOA_TRACK_ALPHA_BETA, AOA_TRACK_KALMAN
+  } state;
+} AoA_Track_t;
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+
+/**
+* @brief   Default tracker parameters, the legacy moving average
+*
+* @param   pParams - parameters to fill
+*
+* @return  none
+*/
+void AOA_trackDefaultParams(AoA_TrackParams_t *pParams);
+
+/**
+* @brief   Select the filter of a tracker and restart it
+*
+* @param   pTrack - tracker
+* @param   pParams - filter and parameters
+*
+* @return  TRUE if the parameters are valid, the tracker is left untouched otherwise
+*/
+bool AOA_trackInit(AoA_Track_t *pTrack, const AoA_TrackParams_t *pParams);
+
+/**
+* @brief   Restart a tracker, the next angle is taken as is
+*
+* @param   pTrack - tracker
+*
+* @return  none
+*/
+void AOA_trackReset(AoA_Track_t *pTrack);
+
+/**
+* @brief   Add the angle of a new CTE
+*
+*          Constant time for every filter.
+*
+* @param   pTrack - tracker
+* @param   angle - measured angle in degrees
+*
+* @return  tracked angle in degrees
+*/
+int16_t AOA_trackUpdate(AoA_Track_t *pTrack, int16_t angle);
+
+/**
+* @brief   Add the angle of a new CTE to a tracker of angles over the full circle
+*
+*          Every angle is taken on the turn nearest to the tracked angle, so
+*          angles on both sides of the seam of the range are tracked as
+*          neighbours. The tracked angle is wrapped back into the range.
+*          A tracker is either circular or not from its last restart on.
+*
+* @param   pTrack - tracker
+* @param   angle - measured angle in degrees, minAngle <= angle < minAngle + 360
+* @param   minAngle - smallest angle of the turn
+*
+* @return  tracked angle in degrees, minAngle <= angle < minAngle + 360
+*/
+int16_t AOA_trackUpdateCircular(AoA_Track_t *pTrack, int16_t angle, int16_t minAngle);
+
+/*********************************************************************
+*********************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AOA_TRACK_H_ */
+
+/** @} End AOA_TRACK */
@@ -57,35 +57,42 @@ AoA_AntennaPair_t pair_A2[] =
     .b = 1,         // Second antenna in pair
     .sign = 1,     // Sign for the result
     .offset = 10,  // Measurement offset compensation
-    .gain = 0.95,   // Measurement gain compensation
+    .gain = AOA_PAIR_GAIN(0.95),   // Measurement gain compensation
    },
    {// v23
     .a = 1,
     .b = 2,
     .sign = 1,
     .offset = -5,
-    .gain = 0.9,
+    .gain = AOA_PAIR_GAIN(0.9),
    },
    {// v13
     .a = 0,
     .b = 2,
     .sign = 1,
     .offset = 20,
-    .gain = 0.50,
+    .gain = AOA_PAIR_GAIN(0.50),
    },
 };
 
+// Uniform linear array, element k is k spacings from element 0
+float position_A2[BOOSTXL_AOA_NUM_ANT] = {0, BOOSTXL_AOA_ANT_SPACING, 2 * BOOSTXL_AOA_ANT_SPACING};
+
 AoA_AntennaConfig_t BOOSTXL_AoA_Config_ArrayA2 =
 {
  .numAntennas = BOOSTXL_AOA_NUM_ANT,
  .numPairs = sizeof(pair_A2) / sizeof(pair_A2[0]),
- .pairs = pair_A2
+ .pairs = pair_A2,
+ .numElements = BOOSTXL_AOA_NUM_ANT,
+ .pElement = NULL,
+ .pPosition = position_A2,
 };
 
 // Channel offset compensation array.
 // This is one point compensation for variation over frequency
 // Compensation values are found when incoming signal is coming straight at antenna array 1 (0 degree to antenna array 1)
-// Better accuracy and linearity can be achieved by adding compensation values for more angles
+// Better accuracy and linearity can be achieved by adding compensation values for more angles,
+// the host can load such a table at runtime (see AOA_cal.h), this table is its single bin default
 int8_t channelOffset_A2[40] = {0, // Channel 0
                                1, // Channel 1
                                1, // Channel 2
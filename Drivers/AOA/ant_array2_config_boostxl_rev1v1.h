@@ -60,9 +60,13 @@ extern "C"
 #define ANT_ARRAY_A1x 1
 #define ANT_ARRAY_A2x 2
 #define BOOSTXL_AOA_NUM_ANT 3
+#define BOOSTXL_AOA_ANT_SPACING 0.5f // Element spacing in wavelengths
 
 #define CALC_NUM_ANT_PAIRS(numAnt) ((1 + (numAnt - 1)) * (numAnt - 1)/2)
 
+#define AOA_PAIR_GAIN_ONE 32768 // Pair gain of 1.0 in Q15
+#define AOA_PAIR_GAIN(g) ((uint16_t)((g) * AOA_PAIR_GAIN_ONE + 0.5)) // Q15 pair gain of a constant, converted at build time
+
 /// @brief Antenna Pair Structure
 typedef struct
 {
@@ -71,7 +75,7 @@ typedef struct
   float d;       //!< Variable used in antenna pairs
   int8_t sign;   //!< Sign for the result
   int8_t offset; //!< Measurement offset compensation
-  float gain;    //!< Measurement gain compensation
+  uint16_t gain; //!< Measurement gain compensation, Q15
 } AoA_AntennaPair_t;
 
 /// @brief Antenna Configurations structure
@@ -81,6 +85,9 @@ typedef struct
   uint8_t numPairs;         //!< Number of antenna pairs
   AoA_AntennaPair_t *pairs; //!< antenna pair information array
   int8_t *channelOffset;    //!< RF Channel offset
+  uint8_t numElements;      //!< Number of array elements, a pattern may switch to an element more than once
+  uint8_t *pElement;        //!< Array element of every pattern slot, NULL if slot k is element k
+  float *pPosition;         //!< Element position along the array axis in wavelengths
 } AoA_AntennaConfig_t;
 
 AoA_AntennaConfig_t *getAntennaArray2Config(void);
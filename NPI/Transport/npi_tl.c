@@ -537,6 +537,73 @@ uint8_t NPITL_writeTL(uint8_t *buf, uint16_t len)
     return NPI_SUCCESS;
 }
 
+// -----------------------------------------------------------------------------
+//! \brief      This routine returns the transmit buffer so a frame can be
+//!             built in place.
+//!
+//! \param[out] pMaxLen - Largest frame the buffer holds, framing bytes of the
+//!                       serial port excluded
+//!
+//! \return     uint8_t* - Pointer to the first byte of the frame
+// -----------------------------------------------------------------------------
+uint8_t *NPITL_getTxBuf(uint16_t *pMaxLen)
+{
+    // The serial port adds SOF in front of the frame and FCS behind it
+    *pMaxLen = (npiBufSize > 2) ? (npiBufSize - 2) : 0;
+
+    return &npiTxBuf[1];
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      This routine writes a frame built in place with NPITL_getTxBuf
+//!             to the transport layer.
+//!
+//! \param[in]  len - Number of bytes of the frame.
+//!
+//! \return     uint8_t - NPI error code value
+// -----------------------------------------------------------------------------
+uint8_t NPITL_writeTxBufTL(uint16_t len)
+{
+#if (NPI_FLOW_CTRL == 1)
+    _npiCSKey_t key;
+    key = NPIUtil_EnterCS();
+#endif // NPI_FLOW_CTRL = 1
+
+    // Check to make sure NPI is not currently in a transaction
+    if (NPITL_checkNpiBusy())
+    {
+#if (NPI_FLOW_CTRL == 1)
+        NPIUtil_ExitCS(key);
+#endif // NPI_FLOW_CTRL = 1
+
+        return NPI_BUSY;
+    }
+
+    // Check to make sure there is room for SOF and FCS as well
+    if (len + 2 > npiBufSize)
+    {
+#if (NPI_FLOW_CTRL == 1)
+        NPIUtil_ExitCS(key);
+#endif // NPI_FLOW_CTRL = 1
+
+        return NPI_TX_MSG_OVERSIZE;
+    }
+
+    // The frame is already at the second byte of npiTxBuf
+    npiTxBufLen = len;
+    npiTxActive = TRUE;
+    txPktCount++;
+
+    transportWrite(npiTxBufLen);
+
+#if (NPI_FLOW_CTRL == 1)
+    LocRDY_ENABLE();
+    NPIUtil_ExitCS(key);
+#endif // NPI_FLOW_CTRL = 1
+
+    return NPI_SUCCESS;
+}
+
 // -----------------------------------------------------------------------------
 //! \brief      This routine writes data from the buffer to the transport layer
 //!             and bypasses flow control and len check. Used for emergency
@@ -155,6 +155,29 @@ uint16_t NPITL_readTL(uint8_t *buf, uint16_t len);
 // -----------------------------------------------------------------------------
 uint8_t NPITL_writeTL(uint8_t *buf, uint16_t len);
 
+// -----------------------------------------------------------------------------
+//! \brief      This routine returns the transmit buffer so a frame can be
+//!             built in place, [ Len1 ][ Len0 ][ Cmd0 ][ Cmd 1 ][ Data Payload ].
+//!             It may only be written while NPI is not busy, the frame is then
+//!             sent with NPITL_writeTxBufTL.
+//!
+//! \param[out] pMaxLen - Largest frame the buffer holds, framing bytes of the
+//!                       serial port excluded
+//!
+//! \return     uint8_t* - Pointer to the first byte of the frame
+// -----------------------------------------------------------------------------
+uint8_t *NPITL_getTxBuf(uint16_t *pMaxLen);
+
+// -----------------------------------------------------------------------------
+//! \brief      This routine writes a frame built in place with NPITL_getTxBuf
+//!             to the transport layer.
+//!
+//! \param[in]  len - Number of bytes of the frame.
+//!
+//! \return     uint8_t - NPI Error Code value
+// -----------------------------------------------------------------------------
+uint8_t NPITL_writeTxBufTL(uint16_t len);
+
 // -----------------------------------------------------------------------------
 //! \brief      This routine writes data from the buffer to the transport layer
 //!             and bypasses flow control and len check. Used for emergency
@@ -137,6 +137,12 @@
 
 #define NPI_ASSERT_MSG_LEN                  5
 
+//! \brief Number of ASYNC frames sent while a stream waits before one frame of
+//         the stream is let through
+#ifndef NPI_STREAM_MAX_ASYNC_FRAMES
+#define NPI_STREAM_MAX_ASYNC_FRAMES         4
+#endif
+
 // ****************************************************************************
 // typedefs
 // ****************************************************************************
@@ -177,6 +183,15 @@ static Queue_Handle npiSyncTxQueue;
 //! \brief Handle for the SYNC RX Queue
 static Queue_Handle npiSyncRxQueue;
 
+//! \brief Handle for the stream TX Queue
+static Queue_Handle npiStreamTxQueue;
+
+//! \brief Stream whose frames are being sent, NULL if none
+static _npiStream_t *npiTxStream;
+
+//! \brief ASYNC frames sent since a frame of a waiting stream was last sent
+static uint8_t npiStreamAsyncFrames = 0;
+
 //! \brief Flag/Counter indicating a Synchronous REQ/RSP is currently being
 //!        processed.
 static int8_t syncTransactionInProgress = 0;
@@ -275,6 +290,12 @@ const npiTLCallBacks transportCBs = {
 //! \brief ASYNC TX Q Processing function.
 static void NPITask_ProcessTXQ(Queue_Handle txQ);
 
+//! \brief Stream TX Q Processing function.
+static void NPITask_processStreamTXQ(void);
+
+//! \brief Whether a frame of any TX Q is waiting to be sent.
+static bool NPITask_txPending(void);
+
 //! \brief ASYNC RX Q Processing function.
 static void NPITask_processRXQ(void);
 
@@ -388,12 +409,32 @@ void NPITask_Fxn(UArg a0, UArg a1)
                         // Prioritize Synchronous traffic
                         NPITask_ProcessTXQ(npiSyncTxQueue);
                     }
+                    else if (!(NPITask_events & NPITASK_SYNC_FRAME_RX_EVENT) &&
+                                 syncTransactionInProgress == 0 &&
+                                   (npiTxStream != NULL ||
+                                    !Queue_empty(npiStreamTxQueue)) &&
+                                     (Queue_empty(npiTxQueue) ||
+                                      npiStreamAsyncFrames >=
+                                        NPI_STREAM_MAX_ASYNC_FRAMES))
+                    {
+                        // No ASYNC message is waiting, or the stream has
+                        // waited for NPI_STREAM_MAX_ASYNC_FRAMES of them,
+                        // build the next frame of the stream.
+                        npiStreamAsyncFrames = 0;
+                        NPITask_processStreamTXQ();
+                    }
                     else if (!(NPITask_events & NPITASK_SYNC_FRAME_RX_EVENT) &&
                                  syncTransactionInProgress == 0 &&
                                    !Queue_empty(npiTxQueue))
                     {
                         // No outstanding SYNC REQ/RSP transactions, process
-                        // ASYNC messages.
+                        // ASYNC messages. A waiting stream holds on to its
+                        // buffers, so count the frames it waits for.
+                        if (npiTxStream != NULL ||
+                            !Queue_empty(npiStreamTxQueue))
+                        {
+                            npiStreamAsyncFrames++;
+                        }
                         NPITask_ProcessTXQ(npiTxQueue);
                     }
                 }
@@ -573,6 +614,8 @@ uint8_t NPITask_open(NPI_Params *params)
     npiRxQueue = Queue_create(NULL, NULL);
     npiSyncRxQueue = Queue_create(NULL, NULL);
     npiSyncTxQueue = Queue_create(NULL, NULL);
+    npiStreamTxQueue = Queue_create(NULL, NULL);
+    npiTxStream = NULL;
 
     // Initialize Transport Layer
     transportParams.npiTLBufSize = params->bufSize;
@@ -641,6 +684,20 @@ uint8_t NPITask_close(void)
     Queue_delete(&npiSyncRxQueue);
     Queue_delete(&npiSyncTxQueue);
 
+    // Hand streams still waiting back to their owners
+    if (npiTxStream != NULL)
+    {
+      npiTxStream->doneCB(npiTxStream);
+      npiTxStream = NULL;
+    }
+    while (!Queue_empty(npiStreamTxQueue))
+    {
+      _npiStream_t *pStream = (_npiStream_t *) Queue_get(npiStreamTxQueue);
+
+      pStream->doneCB(pStream);
+    }
+    Queue_delete(&npiStreamTxQueue);
+
     // Free any message buffers for in-flight messages
     if (lastQueuedTxMsg != NULL)
     {
@@ -710,6 +767,43 @@ uint8_t NPITask_sendToHost(_npiFrame_t *pMsg)
     return status;
 }
 
+// -----------------------------------------------------------------------------
+//! \brief      API for application task to stream a message to the Host.
+//!
+//! \param[in]  pStream Pointer to stream, owned by NPI Task until its done
+//!                     call back
+//!
+//! \return     uint8_t Status NPI_SUCCESS, or NPI_INVALID_PKT
+// -----------------------------------------------------------------------------
+uint8_t NPITask_sendStreamToHost(_npiStream_t *pStream)
+{
+    _npiCSKey_t key;
+
+    // Frames of a stream are not tracked as SYNC REQ/RSP transactions
+    if (NPI_GET_MSG_TYPE(pStream) != NPI_MSG_TYPE_ASYNC)
+    {
+        return NPI_INVALID_PKT;
+    }
+
+    // Must block task pre-emption so that the higher priority NPI task
+    // does not clear the NPITask_events flag before pStream is enqueued.
+    key = NPIUtil_EnterCS();
+
+    // The stream carries its own queue element, nothing is allocated
+    Queue_put(npiStreamTxQueue, &pStream->_elem);
+
+#ifdef ICALL_EVENTS
+    Event_post(syncEvent, NPITASK_TX_READY_EVENT);
+#else //!ICALL_EVENTS
+    NPITask_events |= NPITASK_TX_READY_EVENT;
+    Semaphore_post(npiSem);
+#endif //ICALL_EVENTS
+
+    NPIUtil_ExitCS(key);
+
+    return NPI_SUCCESS;
+}
+
 // -----------------------------------------------------------------------------
 //! \brief      API for subsystems to register for NPI messages received with
 //!             the specific ssID. All NPI messages will be passed to callback
@@ -991,6 +1085,98 @@ static void NPITask_ProcessTXQ(Queue_Handle txQ)
     }
 }
 
+// -----------------------------------------------------------------------------
+//! \brief      Build the next frame of the current stream in the Transport
+//!             Layer TX buffer and send it. The stream is handed back to its
+//!             owner once its last frame is written.
+//!
+//! \return     void
+// -----------------------------------------------------------------------------
+static void NPITask_processStreamTXQ(void)
+{
+    _npiStream_t *pStream;
+    _npiCSKey_t key;
+    uint8_t *pBuf;
+    uint16_t maxLen;
+    uint16_t len = 0;
+    bool more;
+
+    if (npiTxStream == NULL)
+    {
+        // Must block task pre-emption so that the higher priority tasks
+        // are not also manipulating the queue at the same time
+        key = NPIUtil_EnterCS();
+        if (!Queue_empty(npiStreamTxQueue))
+        {
+            npiTxStream = (_npiStream_t *) Queue_get(npiStreamTxQueue);
+        }
+        NPIUtil_ExitCS(key);
+
+        if (npiTxStream == NULL)
+        {
+            return;
+        }
+    }
+
+    pStream = npiTxStream;
+
+    // Packet Format [ Len1 ][ Len0 ][ Cmd0 ][ Cmd 1 ][ Data Payload ]
+    // The payload is written by the owner of the stream, in place
+    pBuf = NPITL_getTxBuf(&maxLen);
+    if (maxLen > NPI_MSG_HDR_LENGTH)
+    {
+        more = pStream->fillCB(pStream, &pBuf[NPI_MSG_HDR_LENGTH],
+                               maxLen - NPI_MSG_HDR_LENGTH, &len);
+    }
+    else
+    {
+        more = FALSE;
+    }
+
+    if (len != 0)
+    {
+        pBuf[0] = (uint8)(len & 0xFF);
+        pBuf[1] = (uint8)(len >> 8);
+        pBuf[2] = pStream->cmd0;
+        pBuf[3] = pStream->cmd1;
+
+        // We have already checked if TL is busy so we assume write succeeds
+        NPITL_writeTxBufTL(len + NPI_MSG_HDR_LENGTH);
+    }
+
+    if (!more)
+    {
+        npiTxStream = NULL;
+        pStream->doneCB(pStream);
+    }
+
+    // Nothing was written so the transport will not call back, check for
+    // the next frame right away. The event flag of this pass is cleared once
+    // it is processed, the flag is set as if from the call back instead.
+    if (len == 0 && NPITask_txPending())
+    {
+#ifdef ICALL_EVENTS
+        Event_post(syncEvent, NPITASK_TX_READY_EVENT);
+#else //!ICALL_EVENTS
+        key = NPIUtil_EnterCS();
+        tlDoneISRFlag |= NPITASK_TX_READY_EVENT;
+        NPIUtil_ExitCS(key);
+        Semaphore_post(npiSem);
+#endif //ICALL_EVENTS
+    }
+}
+
+// -----------------------------------------------------------------------------
+//! \brief      Whether a frame of any TX Q is waiting to be sent.
+//!
+//! \return     bool    TRUE if a SYNC, ASYNC or stream frame is waiting
+// -----------------------------------------------------------------------------
+static bool NPITask_txPending(void)
+{
+    return (!Queue_empty(npiSyncTxQueue) || !Queue_empty(npiTxQueue) ||
+            npiTxStream != NULL || !Queue_empty(npiStreamTxQueue));
+}
+
 // -----------------------------------------------------------------------------
 //! \brief      Dequeue next message in the RX Queue and process it.
 //!
@@ -1132,7 +1318,7 @@ static void NPITask_transportDoneCallBack(uint16_t sizeRx, uint16_t sizeTx)
 
     // Check to see if there pending messages waiting to be sent
     // If there are then notify NPI Task by setting TX READY event flag
-    if (!Queue_empty(npiSyncTxQueue) || !Queue_empty(npiTxQueue))
+    if (NPITask_txPending())
     {
         // There are pending SYNC RSP or ASYNC messages waiting to
         // be sent to the host. Set the appropriate flag and post to
@@ -1177,7 +1363,7 @@ static void NPITask_RemRdyEventCB(uint8_t state)
   {
     // There could be pending TX messages that are waiting for Remote Ready
     // signal to be deasserted so that NPI is no longer busy
-    if (!Queue_empty(npiSyncTxQueue) || !Queue_empty(npiTxQueue))
+    if (NPITask_txPending())
     {
 #ifdef ICALL_EVENTS
         Event_post(syncEvent, NPITASK_TX_READY_EVENT);
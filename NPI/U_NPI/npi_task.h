@@ -55,6 +55,10 @@ extern "C"
 // ****************************************************************************
 // includes
 // ****************************************************************************
+#include <stdbool.h>
+
+#include <ti/sysbios/knl/Queue.h>
+
 #include "npi_data.h"
 
 // ****************************************************************************
@@ -73,6 +77,33 @@ typedef void (*npiFromHostCBack_t)(_npiFrame_t *pNPIMsg);
 //         receive forwarded messages from ICall
 typedef void (*npiFromICallCBack_t)(uint8_t *pGenMsg);
 
+struct _npiStream_t;
+
+//! \brief Call back that writes the payload of the next frame of a stream
+//         straight into the Transport Layer TX buffer. Called from NPI Task.
+//         Returns TRUE while more frames follow, *pLen is the payload length.
+typedef bool (*npiStreamFillCBack_t)(struct _npiStream_t *pStream,
+                                     uint8_t *pBuf, uint16_t maxLen,
+                                     uint16_t *pLen);
+
+//! \brief Call back that hands a stream back to its owner once its last frame
+//         was written to the Transport Layer, or it was dropped. Called from
+//         NPI Task.
+typedef void (*npiStreamDoneCBack_t)(struct _npiStream_t *pStream);
+
+//! \brief Message sent to the Host as a series of frames that are built in the
+//         Transport Layer TX buffer, so the payload is never copied into an NPI
+//         frame first. The owner embeds it in its own state and keeps it, and
+//         whatever the fill call back reads, until the done call back.
+typedef struct _npiStream_t
+{
+    Queue_Elem            _elem;        //!< Used by NPI Task while queued
+    uint8_t               cmd0;         //!< cmd0 of every frame, ASYNC only
+    uint8_t               cmd1;         //!< cmd1 of every frame
+    npiStreamFillCBack_t  fillCB;       //!< Writes the payload of a frame
+    npiStreamDoneCBack_t  doneCB;       //!< Releases the stream
+} _npiStream_t;
+
 typedef struct
 {
   uint16_t              stackSize;      //!< Configurable size of stack for NPI Task
@@ -131,6 +162,20 @@ extern uint8_t NPITask_close(void);
 // -----------------------------------------------------------------------------
 extern uint8_t NPITask_sendToHost(_npiFrame_t *pMsg);
 
+// -----------------------------------------------------------------------------
+//! \brief      API for application task to stream a message to the Host.
+//!             Frames of a stream are sent when no ASYNC frame is waiting, so
+//!             bulk data does not hold back other traffic. A stream waits for
+//!             at most NPI_STREAM_MAX_ASYNC_FRAMES ASYNC frames before one of
+//!             its frames is let through.
+//!
+//! \param[in]  pStream Pointer to stream, owned by NPI Task until its done
+//!                     call back
+//!
+//! \return     uint8_t Status NPI_SUCCESS, or NPI_INVALID_PKT
+// -----------------------------------------------------------------------------
+extern uint8_t NPITask_sendStreamToHost(_npiStream_t *pStream);
+
 // -----------------------------------------------------------------------------
 //! \brief      API for subsystems to register for NPI messages received with
 //!             the specific ssID. All NPI messages will be passed to callback
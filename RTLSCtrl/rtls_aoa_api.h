@@ -132,7 +132,7 @@ typedef struct __attribute__((packed))
  * @param sampleCtrl - RAW RF mode, 1 = RAW RF, 0 = Filtered (switching omitted)
  * @param slotDuration - Slot duration (1/2 us)
  * @param numAnt - Number of Antennas that were used for the run
- * @param pIQ - Pointer to IQ samples
+ * @param pIQ - Pointer to IQ samples, RTLS Control takes them over and frees them once done
  *
  * @return none
  */
@@ -273,15 +273,16 @@ char *rtlsCmd_BleLogStrings[] = {
   "RTLS_CMD_CONN_INFO             ",
   "RTLS_CMD_SET_RTLS_PARAM        ",
   "RTLS_CMD_GET_RTLS_PARAM        ",
-  "RTLS_CMD_UNKNOWN_0x2A          ",
-  "RTLS_CMD_UNKNOWN_0x2B          ",
-  "RTLS_CMD_UNKNOWN_0x2C          ",
-  "RTLS_CMD_UNKNOWN_0x2D          ",
-  "RTLS_CMD_UNKNOWN_0x2E          ",
-  "RTLS_CMD_UNKNOWN_0x2F          ",
+  "RTLS_CMD_AOA_RESULT_SPECTRUM   ",
+  "RTLS_CMD_AOA_RESULT_AZ_EL      ",
+  "RTLS_CMD_AOA_SET_CALIBRATION   ",
+  "RTLS_CMD_AOA_CALIBRATE         ",
+  "RTLS_CMD_AOA_CALIBRATION_RESULT",
+  "RTLS_CMD_AOA_RESULT_EXT        ",
   "RTLS_CMD_TOF_CALIB_NV_READ     ",
   "RTLS_CMD_TOF_SWITCH_ROLE       ",
   "RTLS_CMD_GET_ACTIVE_CONN_INFO  ",
+  "RTLS_CMD_AOA_RESULT_RAW_PACKED ",
 };
 
 /*********************************************************************
@@ -306,7 +307,7 @@ Char rtlsTaskStack[RTLS_CTRL_TASK_STACK_SIZE];
 void RTLSCtrl_createTask(void);
 void RTLSCtrl_taskFxn(UArg a0, UArg a1);
 void RTLSCtrl_processMessage(rtlsEvt_t *pMsg);
-void RTLSCtrl_enqueueMsg(uint16_t eventId, uint8_t *pMsg);
+uint8_t RTLSCtrl_enqueueMsg(uint16_t eventId, uint8_t *pMsg);
 
 // Host Command Handlers
 void RTLSCtrl_getActiveConnInfoCmd(rtlsGetActiveConnInfo_t *pReq);
@@ -315,7 +316,7 @@ void RTLSCtrl_scanReqCmd(void);
 void RTLSCtrl_sendRtlsRemoteCmd(uint16_t connHandle, uint8_t cmdOp, uint8_t *pData, uint16_t dataLen);
 void RTLSCtrl_terminateLinkCmd(uint8_t *connHandle);
 void RTLSCtrl_enableConnInfoCmd(rtlsEnableSync_t *enableConnInfoCmd);
-void RTLSCtrl_setAoaParamsCmd(uint8_t *pParams);
+void RTLSCtrl_setAoaParamsCmd(uint8_t *pParams, uint16_t dataLen);
 void RTLSCtrl_sendSlaveAoaParamsCmd(uint8_t pendingParams);
 void RTLSCtrl_enableAoaCmd(uint8_t *enableAoaCmd);
 
@@ -334,6 +335,14 @@ void RTLSCtrl_initAntenna(uint8_t pin, uint8_t pinState);
 // RSSI Trigger specific
 void RTLSCtrl_calculateRSSI(int lastRssi);
 
+#ifdef RTLS_PASSIVE
+void RTLSCtrl_iqReadyCb(void);
+#endif
+
+#ifdef RTLS_MASTER
+void RTLSCtrl_freeIq(int8_t *pIQ);
+#endif
+
 /*********************************************************************
  * EXTERN FUNCTIONS
  */
@@ -423,6 +432,7 @@ void RTLSCtrl_scanResultEvt(rtlsStatus_e status, uint8_t *scanResult, uint8_t si
 void RTLSCtrl_connResultEvt(uint16_t connHandle, uint8_t status)
 {
   rtlsConnStatusEvt_t connStatus;
+  volatile uint32 keyHwi;
 
   connStatus.connHandle = connHandle;
   connStatus.status = status;
@@ -433,7 +443,9 @@ void RTLSCtrl_connResultEvt(uint16_t connHandle, uint8_t status)
   {
     if (status == RTLS_SUCCESS)
     {
+      keyHwi = Hwi_disable();
       gRtlsData.connStateBm[connHandle] |= RTLS_STATE_CONNECTED;
+      Hwi_restore(keyHwi);
       gRtlsData.numActiveConns++;
 
     }
@@ -448,7 +460,9 @@ void RTLSCtrl_connResultEvt(uint16_t connHandle, uint8_t status)
         RTLSCtrl_updateConnState((rtlsConnState_e)RTLS_STATE_CONNECTED, RTLS_FALSE, connHandle);
       }
 
+      keyHwi = Hwi_disable();
       gRtlsData.connStateBm[connHandle] = (rtlsConnState_e)0;
+      Hwi_restore(keyHwi);
     }
   }
 
@@ -491,6 +505,29 @@ void RTLSCtrl_syncNotifyEvt(uint16_t connHandle, rtlsStatus_e status, uint32_t t
 {
   rtlsRunEvt_t *pMsg;
 
+#if defined(RTLS_PASSIVE)
+  volatile uint32 keyHwi;
+  uint8_t aoaEnabled;
+  uint8_t resultMode;
+  uint8_t sampleCtrl;
+
+  // This runs in the caller's context, the RTLS Control task changes the state and
+  // configuration under the same lock
+  keyHwi = Hwi_disable();
+  aoaEnabled = (gRtlsData.connStateBm[connHandle] & RTLS_STATE_AOA_ENABLED) != 0;
+  resultMode = gRtlsData.aoaControlBlock.resultMode;
+  sampleCtrl = gRtlsData.aoaControlBlock.sampleCtrl;
+  Hwi_restore(keyHwi);
+
+  // Only RTLS Passive does AoA post process from the sync event, once the samples are read out of RF RAM.
+  // The read starts right away so that RF RAM is free for the next CTE while RTLS Control
+  // still post processes the previous capture out of another buffer
+  if (aoaEnabled && (gRtlsData.rtlsCapab.capab & RTLS_CAP_AOA_RX) && (status == RTLS_SUCCESS))
+  {
+    RTLSCtrl_readAoaSamples(connHandle, resultMode, rssi, channel, sampleCtrl);
+  }
+#endif
+
   if ((pMsg = (rtlsRunEvt_t *)RTLSCtrl_malloc(sizeof(rtlsRunEvt_t))) == NULL)
   {
     // We failed to allocate, host was already notified, just exit
@@ -527,6 +564,8 @@ void RTLSCtrl_dataSentEvt(uint16_t connHandle, uint8_t status)
  *
  * RTLS Control I/Q samples processing function
  * Results will be output to RTLS Node Manager after processing
+ * The samples are used where RTLS Services allocated them, pIQ is freed once the
+ * last reference to its IQ handle is given back
  *
  * @param connHandle - connection handle
  * @param rssi - rssi for this CTE
@@ -535,17 +574,27 @@ void RTLSCtrl_dataSentEvt(uint16_t connHandle, uint8_t status)
  * @param sampleRate - Sampling rate that was used for the run
  * @param sampleCtrl - RAW RF mode, 1 = RAW RF, 0 = Filtered (switching omitted)
  * @param numAnt - Number of Antennas that were used for the run
- * @param pIQ - Pointer to IQ samples
+ * @param pIQ - Pointer to IQ samples, allocated by RTLS Services
  */
 void RTLSCtrl_aoaResultEvt(uint16_t connHandle, int8_t rssi, uint8_t channel, uint16_t numIqSamples,
                            uint8_t sampleRate, uint8_t sampleSize, uint8_t sampleCtrl, uint8_t slotDuration,
                            uint8_t numAnt, int8_t *pIQ)
 {
+#ifdef RTLS_MASTER
   rtlsAoaIqEvt_t *pEvt;
+  AoA_IqHandle_t iqHandle;
+
+  // RTLS Services' buffer is wrapped as it is, a capture with no handle free is dropped
+  if ((iqHandle = AOA_iqWrap(pIQ, RTLSCtrl_freeIq)) == AOA_IQ_NO_HANDLE)
+  {
+    RTLSUTIL_FREE(pIQ);
+    return;
+  }
 
   // Allocate event
   if ((pEvt = (rtlsAoaIqEvt_t *)RTLSCtrl_malloc(sizeof(rtlsAoaIqEvt_t))) == NULL)
   {
+    AOA_iqRelease(iqHandle);
     return;
   }
 
@@ -560,11 +609,36 @@ void RTLSCtrl_aoaResultEvt(uint16_t connHandle, int8_t rssi, uint8_t channel, ui
   pEvt->slotDuration = slotDuration;
   pEvt->numAnt = numAnt;
   pEvt->pIQ = pIQ;
+  pEvt->iqHandle = iqHandle;
 
-  // Enqueue the event
-  RTLSCtrl_enqueueMsg(AOA_RESULTS_EVENT, (uint8_t *)pEvt);
+  // Enqueue the event, it holds the reference to the capture
+  if (!RTLSCtrl_enqueueMsg(AOA_RESULTS_EVENT, (uint8_t *)pEvt))
+  {
+    AOA_iqRelease(iqHandle);
+    RTLSUTIL_FREE(pEvt);
+  }
+#else
+  // RTLS Passive reads its captures out of RF RAM
+  RTLSUTIL_FREE(pIQ);
+#endif
 }
 
+#ifdef RTLS_MASTER
+/*********************************************************************
+ * @fn      RTLSCtrl_freeIq
+ *
+ * @brief   Free a capture of RTLS Services once the last reference to it is given back
+ *
+ * @param   pIQ - IQ samples
+ *
+ * @return  none
+ */
+void RTLSCtrl_freeIq(int8_t *pIQ)
+{
+  RTLSUTIL_FREE(pIQ);
+}
+#endif
+
 /*********************************************************************
  * @fn      RTLSCtrl_processSyncEvent
  *
@@ -601,14 +675,6 @@ rtlsStatus_e RTLSCtrl_processSyncEvent(uint8_t *pMsg)
     }
   }
 
-#if defined(RTLS_PASSIVE)
-  // Only RTLS Passive does AoA post process at this point
-  if ((gRtlsData.connStateBm[runEvt->connHandle] & RTLS_STATE_AOA_ENABLED) && (gRtlsData.rtlsCapab.capab & RTLS_CAP_AOA_RX) && (runEvt->status == RTLS_SUCCESS))
-  {
-    RTLSCtrl_postProcessAoa(runEvt->connHandle, gRtlsData.aoaControlBlock.resultMode, runEvt->rssi, runEvt->channel, gRtlsData.aoaControlBlock.sampleCtrl);
-  }
-#endif
-
     return (RTLS_SUCCESS);
 }
 
@@ -815,6 +881,10 @@ void RTLSCtrl_getActiveConnInfoCmd(rtlsGetActiveConnInfo_t *pReq)
 rtlsStatus_e RTLSCtrl_updateConnState(rtlsConnState_e connState, uint8_t enableDisableFlag, uint16_t connHandle)
 {
   rtlsEnableSync_t *syncReq;
+  volatile uint32 keyHwi;
+
+  // RTLSCtrl_syncNotifyEvt reads the state from the caller's context
+  keyHwi = Hwi_disable();
 
   // Enable RTLS control state
   if (enableDisableFlag == RTLS_TRUE)
@@ -827,6 +897,8 @@ rtlsStatus_e RTLSCtrl_updateConnState(rtlsConnState_e connState, uint8_t enableD
     gRtlsData.connStateBm[connHandle] &= ~(connState);
   }
 
+  Hwi_restore(keyHwi);
+
   if (gRtlsData.syncEnabled != RTLS_TRUE)
   {
     // Ask the RTLS Application to trigger RTLS Control module periodically
@@ -871,16 +943,20 @@ void RTLSCtrl_resetDevice(void)
  *
  * @brief   Handle configuring AoA parameters
  *
- * @param   pParams - AoA parameters
+ * @param   pParams - AoA parameters, optionally followed by an rtlsAoaArrayDesc_t
+ * @param   dataLen - length of pParams
  *
  * @return  none
  */
-void RTLSCtrl_setAoaParamsCmd(uint8_t *pParams)
+void RTLSCtrl_setAoaParamsCmd(uint8_t *pParams, uint16_t dataLen)
 {
   rtlsAoaParams_t *pAoaParams;
   rtlsStatus_e status = RTLS_SUCCESS;
   rtlsAoaConfigReq_t *pSetAoaConfigReq;
+  rtlsAoaArrayDesc_t *pArrayDesc = NULL;
+  uint16_t paramsLen;
   uint8_t numAnt;
+  volatile uint32 keyHwi;
 
   // Set RTLS Ctrl parameters
   pAoaParams = (rtlsAoaParams_t *)pParams;
@@ -888,10 +964,30 @@ void RTLSCtrl_setAoaParamsCmd(uint8_t *pParams)
   // Get number of antennas
   pSetAoaConfigReq = (rtlsAoaConfigReq_t *)&pAoaParams->config;
   numAnt = pSetAoaConfigReq->numAnt;
+  paramsLen = sizeof(rtlsAoaParams_t) + sizeof(uint8_t)*numAnt;
+
+  // The host describes its own array after the antenna pattern
+  if (dataLen > paramsLen)
+  {
+    pArrayDesc = (rtlsAoaArrayDesc_t *)&pParams[paramsLen];
+
+    // numElements is only read once the message is known to hold it
+    if ((dataLen < paramsLen + sizeof(rtlsAoaArrayDesc_t)) ||
+        (dataLen < paramsLen + sizeof(rtlsAoaArrayDesc_t) + sizeof(uint8_t)*numAnt + sizeof(int16_t)*pArrayDesc->numElements))
+    {
+      status = RTLS_CONFIG_NOT_SUPPORTED;
+      RTLSCtrl_sendDebugEvt("AoA array description too short, status = ", status);
+      RTLSHost_sendMsg(RTLS_CMD_AOA_SET_PARAMS, HOST_SYNC_RSP, (uint8_t *)&status, sizeof(rtlsStatus_e));
+      return;
+    }
+  }
 
+  // RTLSCtrl_syncNotifyEvt reads the configuration from the caller's context
+  keyHwi = Hwi_disable();
   gRtlsData.aoaControlBlock.aoaRole = pAoaParams->aoaRole;
   gRtlsData.aoaControlBlock.resultMode = pAoaParams->resultMode;
   gRtlsData.aoaControlBlock.sampleCtrl = pSetAoaConfigReq->sampleCtrl;
+  Hwi_restore(keyHwi);
 
   // Allocate parameters to send to application
   if ((pSetAoaConfigReq = (rtlsAoaConfigReq_t *)RTLSCtrl_malloc(sizeof(rtlsAoaConfigReq_t) + sizeof(uint8_t)*numAnt)) == NULL)
@@ -903,9 +999,11 @@ void RTLSCtrl_setAoaParamsCmd(uint8_t *pParams)
   memcpy(pSetAoaConfigReq, &pAoaParams->config, sizeof(rtlsAoaConfigReq_t) + sizeof(uint8_t)*numAnt);
 
   // Initialize AoA post processing module
-  status = RTLSCtrl_initAoa(gRtlsData.rtlsCapab.maxNumConns, gRtlsData.aoaControlBlock.sampleCtrl, pSetAoaConfigReq->numAnt, pSetAoaConfigReq->pAntPattern, gRtlsData.aoaControlBlock.resultMode);
-  if (status == RTLS_CONFIG_NOT_SUPPORTED)
+  status = RTLSCtrl_initAoa(gRtlsData.rtlsCapab.maxNumConns, gRtlsData.aoaControlBlock.sampleCtrl, pSetAoaConfigReq->numAnt, pSetAoaConfigReq->pAntPattern, gRtlsData.aoaControlBlock.resultMode,
+                            pSetAoaConfigReq->sampleRate, pSetAoaConfigReq->sampleSize, pSetAoaConfigReq->slotDurations, pArrayDesc);
+  if (status != RTLS_SUCCESS)
   {
+    RTLSUTIL_FREE(pSetAoaConfigReq);
     RTLSCtrl_sendDebugEvt("AoA failed to init, status = ", status);
     RTLSHost_sendMsg(RTLS_CMD_AOA_SET_PARAMS, HOST_SYNC_RSP, (uint8_t *)&status, sizeof(rtlsStatus_e));
     return;
@@ -1112,7 +1210,7 @@ void RTLSCtrl_processHostMessage(rtlsHostMsg_t *pHostMsg)
 
       case RTLS_CMD_AOA_SET_PARAMS:
       {
-        RTLSCtrl_setAoaParamsCmd(pHostMsg->pData);
+        RTLSCtrl_setAoaParamsCmd(pHostMsg->pData, pHostMsg->dataLen);
 
         RTLSUTIL_FREE(pHostMsg->pData);
       }
@@ -1124,6 +1222,32 @@ void RTLSCtrl_processHostMessage(rtlsHostMsg_t *pHostMsg)
       }
       break;
 
+      case RTLS_CMD_AOA_SET_CALIBRATION:
+      {
+        rtlsStatus_e status = RTLSCtrl_setAoaCalibration(pHostMsg->dataLen, pHostMsg->pData);
+
+        RTLSHost_sendMsg(RTLS_CMD_AOA_SET_CALIBRATION, HOST_SYNC_RSP, (uint8_t *)&status, sizeof(rtlsStatus_e));
+
+        if (pHostMsg->pData)
+        {
+          RTLSUTIL_FREE(pHostMsg->pData);
+        }
+      }
+      break;
+
+      case RTLS_CMD_AOA_CALIBRATE:
+      {
+        rtlsStatus_e status = RTLSCtrl_startAoaCalibration(pHostMsg->dataLen, pHostMsg->pData);
+
+        RTLSHost_sendMsg(RTLS_CMD_AOA_CALIBRATE, HOST_SYNC_RSP, (uint8_t *)&status, sizeof(rtlsStatus_e));
+
+        if (pHostMsg->pData)
+        {
+          RTLSUTIL_FREE(pHostMsg->pData);
+        }
+      }
+      break;
+
       case RTLS_CMD_CONN_INFO:
       {
         RTLSCtrl_enableConnInfoCmd((rtlsEnableSync_t *)pHostMsg->pData);
@@ -1154,6 +1278,48 @@ void RTLSCtrl_processHostMessage(rtlsHostMsg_t *pHostMsg)
           }
           break;
 
+          case RTLS_PARAM_AOA_TRACK:
+          {
+            status = RTLSCtrl_setAoaTrackParams(req->connHandle, req->dataLen, req->data);
+          }
+          break;
+
+          case RTLS_PARAM_AOA_SCREEN:
+          {
+            status = RTLSCtrl_setAoaScreenParams(req->dataLen, req->data);
+          }
+          break;
+
+          case RTLS_PARAM_AOA_QUALITY:
+          {
+            status = RTLSCtrl_setAoaQualityParams(req->dataLen, req->data);
+          }
+          break;
+
+          case RTLS_PARAM_AOA_DECIMATION:
+          {
+            status = RTLSCtrl_setAoaDecimationParams(req->dataLen, req->data);
+          }
+          break;
+
+          case RTLS_PARAM_AOA_REPORT:
+          {
+            status = RTLSCtrl_setAoaReportParams(req->dataLen, req->data);
+          }
+          break;
+
+          case RTLS_PARAM_AOA_RAW_FORMAT:
+          {
+            status = RTLSCtrl_setAoaRawFormatParams(req->dataLen, req->data);
+          }
+          break;
+
+          case RTLS_PARAM_AOA_AVG_MODE:
+          {
+            status = RTLSCtrl_setAoaAvgModeParams(req->dataLen, req->data);
+          }
+          break;
+
           default:
           {
             status = RTLS_ILLEGAL_CMD;
@@ -1260,9 +1426,9 @@ void RTLSCtrl_hostMsgCB(rtlsHostMsg_t *pMsg)
  * @param   pMsg - pointer to a message
  * @param   eventId - needed to send message to correct handler
  *
- * @return  none
+ * @return  TRUE if queued, else the caller keeps pMsg
  */
-void RTLSCtrl_enqueueMsg(uint16_t eventId, uint8_t *pMsg)
+uint8_t RTLSCtrl_enqueueMsg(uint16_t eventId, uint8_t *pMsg)
 {
   rtlsEvt_t *qMsg;
   uint8_t enqueueStatus;
@@ -1272,7 +1438,7 @@ void RTLSCtrl_enqueueMsg(uint16_t eventId, uint8_t *pMsg)
   // Here we allocate the RTLS Event itself
   if ((qMsg = (rtlsEvt_t *)RTLSCtrl_malloc(sizeof(rtlsEvt_t))) == NULL)
   {
-    return;
+    return FALSE;
   }
 
   qMsg->event = (rtlsEvtType_e)eventId;
@@ -1287,9 +1453,29 @@ void RTLSCtrl_enqueueMsg(uint16_t eventId, uint8_t *pMsg)
   // Util failed to enqueue, report to host
   if (enqueueStatus == FALSE)
   {
+    RTLSUTIL_FREE(qMsg);
     RTLSHost_sendMsg(RTLS_EVT_ERROR, HOST_ASYNC_RSP, (uint8_t *)&status, sizeof(rtlsStatus_e));
   }
+
+  return enqueueStatus;
+}
+
+#ifdef RTLS_PASSIVE
+/*********************************************************************
+ * @fn      RTLSCtrl_iqReadyCb
+ *
+ * @brief   Called from the RF callback once the I/Q samples were read out
+ *          of RF RAM, or could not be, wakes up the RTLS Control task
+ *
+ * @param   none
+ *
+ * @return  none
+ */
+void RTLSCtrl_iqReadyCb(void)
+{
+  Event_post(syncRtlsEvent, RTLS_IQ_READY_EVT);
 }
+#endif
 
 /*********************************************************************
  * @fn      RTLSCtrl_processMessage
@@ -1323,8 +1509,8 @@ void RTLSCtrl_processMessage(rtlsEvt_t *pMsg)
 #ifdef RTLS_MASTER
       RTLSCtrl_postProcessAoa((rtlsAoaIqEvt_t *)pMsg->pData);
 
-      // Free I/Q array
-      RTLSUTIL_FREE(((rtlsAoaIqEvt_t *)pMsg->pData)->pIQ);
+      // Give back the event's reference, a RAW stream may still hold the capture
+      AOA_iqRelease(((rtlsAoaIqEvt_t *)pMsg->pData)->iqHandle);
 #endif
     }
     break;
@@ -1379,6 +1565,9 @@ void RTLSCtrl_createTask(void)
  */
 void RTLSCtrl_taskFxn(UArg a0, UArg a1)
 {
+  // Ticks a read of RF RAM has left, 0 if none is in flight
+  uint32_t iqReadTimeout = 0;
+
   // Create an RTOS event used to wake up this application to process events.
   syncRtlsEvent = Event_create(NULL, NULL);
 
@@ -1390,6 +1579,11 @@ void RTLSCtrl_taskFxn(UArg a0, UArg a1)
   // Create an RTOS queue for messages
   rtlsCtrlMsgQueue = Util_constructQueue(&rtlsCtrlMsg);
 
+#ifdef RTLS_PASSIVE
+  // Captures are read out of RF RAM into ping-pong buffers, the task is woken up once one is read
+  RTLSCtrl_initAoaSamples(RTLSCtrl_iqReadyCb);
+#endif
+
   // Initialize internal rssi alpha filter
   gRtlsData.rssiFilter.alphaValue = RTLS_CTRL_ALPHA_FILTER_VALUE;
   gRtlsData.rssiFilter.currentRssi = RTLS_CTRL_FILTER_INITIAL_RSSI;
@@ -1404,7 +1598,9 @@ void RTLSCtrl_taskFxn(UArg a0, UArg a1)
   for(;;)
   {
     volatile uint32 keyHwi;
-    uint32_t events = Event_pend(syncRtlsEvent, Event_Id_NONE, RTLS_CTRL_ALL_EVENTS, BIOS_WAIT_FOREVER);
+
+    // Wake up to give a read of RF RAM up if its samples do not come
+    uint32_t events = Event_pend(syncRtlsEvent, Event_Id_NONE, RTLS_CTRL_ALL_EVENTS, iqReadTimeout ? iqReadTimeout : BIOS_WAIT_FOREVER);
 
     // If RTOS queue is not empty, process npi message.
     while(!Queue_empty(rtlsCtrlMsgQueue))
@@ -1421,6 +1617,11 @@ void RTLSCtrl_taskFxn(UArg a0, UArg a1)
         RTLSUTIL_FREE(pMsg);
       }
     }
+
+#ifdef RTLS_PASSIVE
+    // Samples read out of RF RAM, or a read started by a sync event above
+    iqReadTimeout = RTLSCtrl_processAoaSamples();
+#endif
   }
 }
 
@@ -89,8 +89,9 @@ extern "C"
 #define RTLS_CTRL_TASK_STACK_SIZE 752     //!< RTLS Task configuration variable
 
 #define RTLS_QUEUE_EVT            UTIL_QUEUE_EVENT_ID   //!< Event_Id_30
+#define RTLS_IQ_READY_EVT         Event_Id_00           //!< RTLS Passive I/Q samples read out of RF RAM
 
-#define RTLS_CTRL_ALL_EVENTS      (RTLS_QUEUE_EVT)      //!< RTLS Task configuration
+#define RTLS_CTRL_ALL_EVENTS      (RTLS_QUEUE_EVT | RTLS_IQ_READY_EVT)  //!< RTLS Task configuration
 
 
 #define RTLS_CMD_IDENTIFY                 0x00          //!< RTLS Node Manager command
@@ -117,11 +118,18 @@ extern "C"
 #define RTLS_CMD_CONN_INFO                0x27          //!< RTLS Node Manager command
 #define RTLS_CMD_SET_RTLS_PARAM           0x28          //!< RTLS Node Manager command
 #define RTLS_CMD_GET_RTLS_PARAM           0x29          //!< RTLS Node Manager command
+#define RTLS_CMD_AOA_RESULT_SPECTRUM      0x2A          //!< RTLS Node Manager command
+#define RTLS_CMD_AOA_RESULT_AZ_EL         0x2B          //!< RTLS Node Manager command
+#define RTLS_CMD_AOA_SET_CALIBRATION      0x2C          //!< RTLS Node Manager command
+#define RTLS_CMD_AOA_CALIBRATE            0x2D          //!< RTLS Node Manager command
+#define RTLS_CMD_AOA_CALIBRATION_RESULT   0x2E          //!< RTLS Node Manager command
+#define RTLS_CMD_AOA_RESULT_EXT           0x2F          //!< RTLS Node Manager command
 #define RTLS_CMD_RESERVED9                0x30          //!< RTLS Node Manager command
 #define RTLS_CMD_RESERVED10               0x31          //!< RTLS Node Manager command
 #define RTLS_CMD_GET_ACTIVE_CONN_INFO     0x32          //!< RTLS Node Manager command
+#define RTLS_CMD_AOA_RESULT_RAW_PACKED    0x33          //!< RTLS Node Manager command
 
-#define RTLS_CMD_BLE_LOG_STRINGS_MAX 0x32
+#define RTLS_CMD_BLE_LOG_STRINGS_MAX 0x33
 extern char *rtlsCmd_BleLogStrings[];
 
 // RTLS async event
@@ -134,6 +142,13 @@ extern char *rtlsCmd_BleLogStrings[];
 #define RTLS_PARAM_CONNECTION_INTERVAL    0x01          //!< RTLS Param type RTLS_CMD_SET_RTLS_PARAM command
 #define RTLS_PARAM_2                      0x02          //!< RTLS Param type RTLS_CMD_SET_RTLS_PARAM command
 #define RTLS_PARAM_3                      0x03          //!< RTLS Param type RTLS_CMD_SET_RTLS_PARAM command
+#define RTLS_PARAM_AOA_TRACK              0x04          //!< RTLS Param type RTLS_CMD_SET_RTLS_PARAM command
+#define RTLS_PARAM_AOA_SCREEN             0x05          //!< RTLS Param type RTLS_CMD_SET_RTLS_PARAM command
+#define RTLS_PARAM_AOA_QUALITY            0x06          //!< RTLS Param type RTLS_CMD_SET_RTLS_PARAM command
+#define RTLS_PARAM_AOA_DECIMATION         0x07          //!< RTLS Param type RTLS_CMD_SET_RTLS_PARAM command
+#define RTLS_PARAM_AOA_REPORT             0x08          //!< RTLS Param type RTLS_CMD_SET_RTLS_PARAM command
+#define RTLS_PARAM_AOA_RAW_FORMAT         0x09          //!< RTLS Param type RTLS_CMD_SET_RTLS_PARAM command
+#define RTLS_PARAM_AOA_AVG_MODE           0x0A          //!< RTLS Param type RTLS_CMD_SET_RTLS_PARAM command
 
 /*********************************************************************
  * MACROS
@@ -54,6 +54,7 @@
 #include "rtls_host.h"
 #include <ti/sysbios/hal/Hwi.h>
 #include <ti/sysbios/knl/Swi.h>
+#include <ti/sysbios/knl/Clock.h>
 #include <string.h>
 #include <ti/drivers/pin/PINCC26XX.h>
 
@@ -64,11 +65,55 @@
  * MACROS
  */
 
+// The active array was described by the host, it has no board frame and no channel calibration
+#define AOA_IS_HOST_ARRAY()  (gAoaCb.antArrayConfig == &gAoaCb.hostArrayConfig)
+
+// Both BOOSTXL-AOA arrays are in the pattern, A1 first
+#define AOA_IS_DUAL_ARRAY()  (gAoaCb.antArrayConfig == &gAoaCb.dualArrayConfig)
+
+// Calibration table of a BOOSTXL-AOA array
+#define AOA_CAL_TABLE(antenna)  (&gAoaCb.cal[(antenna) - ANT_ARRAY_A1x])
 
 /*********************************************************************
  * CONSTANTS
  */
 
+// Pattern slots and pairs of both BOOSTXL-AOA arrays, the A2 pairs follow the A1 pairs
+#define AOA_DUAL_NUM_ANT     (2 * BOOSTXL_AOA_NUM_ANT)
+#define AOA_DUAL_NUM_PAIRS   (2 * CALC_NUM_ANT_PAIRS(BOOSTXL_AOA_NUM_ANT))
+#define AOA_DUAL_A2_PAIR     CALC_NUM_ANT_PAIRS(BOOSTXL_AOA_NUM_ANT)
+
+// Handling of unusable captures until the host sets RTLS_PARAM_AOA_SCREEN
+#ifndef AOA_SCREEN_ACTION_DEFAULT
+#define AOA_SCREEN_ACTION_DEFAULT AOA_SCREEN_DISCARD
+#endif
+
+// Samples of an oversampled capture averaged into one until the host sets RTLS_PARAM_AOA_DECIMATION
+#ifndef AOA_DECIMATION_DEFAULT
+#define AOA_DECIMATION_DEFAULT 1
+#endif
+
+// Largest decimation factor, a 4 MHz capture averaged down to 1 MHz
+#define AOA_MAX_DECIMATION   4
+
+// RTLS Passive gives up reading a capture out of RF RAM after this long
+#ifndef AOA_IQ_READ_TIMEOUT_MS
+#define AOA_IQ_READ_TIMEOUT_MS   10
+#endif
+
+// Single array angles are fused as angles of the turn from -180, dual array azimuths of the turn from AOA_AZIMUTH_MIN
+#define AOA_ANGLE_MIN        -180
+
+// AOA_MODE_RAW sends the legacy rtlsAoaResultRaw_t until the host selects rtlsAoaResultRawPacked_t with RTLS_PARAM_AOA_RAW_FORMAT
+#ifndef AOA_RAW_PACKED_DEFAULT
+#define AOA_RAW_PACKED_DEFAULT 0
+#endif
+
+// Weight of a new capture in the per connection covariance average
+#ifndef AOA_SPECTRUM_ALPHA
+#define AOA_SPECTRUM_ALPHA 0.25f
+#endif
+
 /*********************************************************************
  * TYPEDEFS
  */
@@ -78,35 +123,101 @@ typedef struct
 {
   int16_t angle;
   int16_t currentangle;
+  int16_t elevation;
   int8_t  rssi;
   uint8_t channel;
   uint8_t antenna;
 } AoA_Sample_t;
 
-// Moving average structure
+// Angle tracking of one connection
 typedef struct
 {
-  int16_t array[6];
-  uint8_t idx;
-  uint8_t numEntries;
+  AoA_Track_t track;
+  AoA_Track_t elevationTrack;     // Both arrays only
   uint8_t currentAntennaArray;
   int16_t currentAoA;
   int8_t  currentRssi;
   uint8_t currentCh;
-  int32_t AoAsum;
-  int16_t AoA;
-} AoA_movingAverage_t;
+} AoA_angleTrack_t;
+
+// RAW result streamed to the host straight out of the capture
+typedef struct
+{
+  int8_t *pIQ;                     // Capture, the stream holds a reference to it
+  uint16_t numIqSamples;
+  uint16_t offset;                 // First sample of the next message
+  uint16_t connHandle;
+  int8_t  rssi;
+  uint8_t antenna;
+  uint8_t channel;
+  uint8_t sampleSize;
+  uint8_t packed;                  // rtlsAoaResultRawPacked_t, else rtlsAoaResultRaw_t
+  uint8_t coding;                  // AOA_RAW_CODING_NONE/AOA_RAW_CODING_DELTA
+#ifdef RTLS_MASTER
+  AoA_IqHandle_t iqHandle;         // IQ handle of pIQ
+#else // RTLS_PASSIVE
+  uint8_t bufIndex;                // RF RAM buffer of pIQ
+#endif
+} AoA_rawStream_t;
+
+#ifdef RTLS_PASSIVE
+// Connection event whose capture is read into an RF RAM buffer
+typedef struct
+{
+  uint8_t connHandle;
+  uint8_t resultMode;
+  int8_t  rssi;
+  uint8_t channel;
+  uint8_t sampleCtrl;
+} AoA_iqRead_t;
+#endif
 
 typedef struct
 {
-  AoA_movingAverage_t AoA_ma;
+  AoA_angleTrack_t AoA_track;
   AoA_AntennaResult_t aoaResults;
+  AoA_Covariance_t *pCovariance;   // Allocated on the first AOA_MODE_SPECTRUM capture
+  AoA_CaptureQuality_t quality;    // Measures of the last screened capture
+  AoA_Report_t report;             // Results fused since the last one sent
 } AoA_connInfo_t;
 
 typedef struct
 {
   AoA_connInfo_t *connResInfo;
   AoA_AntennaConfig_t *antArrayConfig;
+  AoA_AntennaConfig_t hostArrayConfig;   // Array of rtlsAoaArrayDesc_t, its tables are allocated
+  AoA_AntennaConfig_t dualArrayConfig;   // A1 and A2 in one pattern
+  AoA_AntennaPair_t dualArrayPairs[AOA_DUAL_NUM_PAIRS];
+  AoA_Covariance_t *pCovScratch;         // Covariance of the capture being processed, AOA_MODE_SPECTRUM
+  AoA_Covariance_t *pCovWork;            // MVDR factorization, AOA_MODE_SPECTRUM
+  AoA_Steer_t *pSteer;                   // Steering table of the active array, AOA_MODE_SPECTRUM
+  AoA_CalTable_t cal[2];                 // Calibration of A1 and A2, the built-in tables until the host loads one
+  AoA_CalCapture_t *pCalCapture;         // Running calibration capture, NULL if none
+  uint16_t calConnHandle;                // Connection of the reference tag
+  uint16_t calNumCtes;                   // CTEs the capture ends at
+  uint8_t calAntenna;                    // Array being calibrated
+  uint8_t calFlags;                      // AOA_CALIBRATE_APPLY_OFFSETS/AOA_CALIBRATE_APPLY_GAINS
+  AoA_ScreenParams_t screenParams;       // Limits of a usable capture
+  uint8_t screenAction;                  // AOA_SCREEN_OFF/AOA_SCREEN_DISCARD/AOA_SCREEN_FLAG
+  uint8_t resultExt;                     // RTLS_PARAM_AOA_QUALITY, report rtlsAoaResultExt_t
+  AoA_PairQuality_t *pPairQuality;       // Spread of the pairs of the capture being processed, AOA_MODE_ANGLE/AOA_MODE_PAIR_ANGLES
+  uint8_t decimation;                    // RTLS_PARAM_AOA_DECIMATION, samples averaged into one
+  AoA_ReportParams_t reportParams;       // RTLS_PARAM_AOA_REPORT, fusion of AOA_MODE_ANGLE results
+  uint8_t rawPacked;                     // RTLS_PARAM_AOA_RAW_FORMAT, send rtlsAoaResultRawPacked_t
+  uint8_t rawCoding;                     // AOA_RAW_CODING_NONE/AOA_RAW_CODING_DELTA
+#ifdef RTLS_PASSIVE
+  AoA_iqRead_t iqRead[AOA_RF_RAM_NUM_BUFS];  // Connection event of every RF RAM buffer
+  uint8_t bufIndex;                      // RF RAM buffer being post processed
+#endif
+#ifdef RTLS_MASTER
+  AoA_IqHandle_t iqHandle;               // Capture being post processed
+  uint8_t sampleRate;                    // Capture configuration the angle kernel is selected for
+  uint8_t sampleSize;
+  uint8_t slotDuration;
+  uint8_t numAnt;
+#endif
+  uint8_t maxConnections;
+  uint8_t numPairs;                      // Size of the per connection pairAngle arrays
   uint8_t sampleCtrl;
   uint8_t resultMode;
 } AoA_controlBlock_t;
@@ -129,15 +240,125 @@ extern void AssertHandler(uint8 assertCause, uint8 assertSubcause);
  */
 
 #ifdef RTLS_PASSIVE
-AoA_IQSample_Ext_t samplesBuff[AOA_RES_MAX_SIZE];
+AoA_IQSample_Ext_t samplesBuff[AOA_RF_RAM_NUM_BUFS][AOA_RES_MAX_SIZE];
 #endif
 
-AoA_controlBlock_t gAoaCb = {0};
+AoA_controlBlock_t gAoaCb =
+{
+  .screenParams = {AOA_SCREEN_MAX_PEAK_DB, AOA_SCREEN_MIN_POWER_DB, AOA_SCREEN_MIN_LINEARITY},
+  .screenAction = AOA_SCREEN_ACTION_DEFAULT,
+  .decimation = AOA_DECIMATION_DEFAULT,
+  .reportParams = {AOA_REPORT_DEFAULT_WINDOW, AOA_REPORT_DEFAULT_MIN_CHANGE, AOA_REPORT_DEFAULT_MAX_HOLD},
+  .rawPacked = AOA_RAW_PACKED_DEFAULT,
+  .rawCoding = AOA_RAW_CODING_NONE,
+};
 
 /*********************************************************************
  * LOCAL FUNCTIONS
  */
-AoA_Sample_t RTLSCtrl_estimateAngle(uint16_t connHandle, uint8_t sampleCtrl);
+AoA_Sample_t RTLSCtrl_estimateAngle(uint16_t connHandle, uint8_t sampleCtrl, bool usable);
+bool RTLSCtrl_fuseAoaResult(uint16_t connHandle, AoA_Sample_t *pAngle, int8_t *pRssi, bool usable);
+rtlsStatus_e RTLSCtrl_initHostArray(uint8_t numAnt, rtlsAoaArrayDesc_t *pArrayDesc);
+rtlsStatus_e RTLSCtrl_initDualArray(uint8_t numAnt, uint8_t *pAntPattern, aoaResultMode_e resultMode);
+void RTLSCtrl_freeHostArray(AoA_AntennaConfig_t *pConfig);
+rtlsStatus_e RTLSCtrl_allocAoaResults(void);
+rtlsStatus_e RTLSCtrl_loadCalibration(uint8_t antenna, uint8_t numBins, int16_t startAngle, uint8_t stepAngle, const int8_t *pOffsets);
+int16_t RTLSCtrl_getCalOffset(uint8_t antenna, uint8_t channel, int16_t angle);
+void RTLSCtrl_addAoaCalibration(uint16_t connHandle, uint8_t channel);
+void RTLSCtrl_finishAoaCalibration(void);
+void RTLSCtrl_stopAoaCalibration(void);
+void RTLSCtrl_sendAoaResultExt(uint16_t connHandle, int8_t rssi, uint8_t channel, uint8_t antenna, const AoA_Sample_t *pAngle, bool usable);
+bool RTLSCtrl_streamAoaResultRaw(uint16_t connHandle, int8_t rssi, uint8_t channel, uint8_t antenna, int8_t *pIQ, uint8_t sampleSize, uint16_t numIqSamples);
+bool RTLSCtrl_fillAoaRawStream(void *pArg, uint8_t *pBuf, uint16_t maxLen, uint16_t *pLen);
+void RTLSCtrl_doneAoaRawStream(void *pArg);
+#ifdef RTLS_MASTER
+void RTLSCtrl_selectAoaKernel(void);
+void RTLSCtrl_getPairAngles(rtlsAoaIqEvt_t *pEvt);
+bool RTLSCtrl_getCovariance(rtlsAoaIqEvt_t *pEvt);
+#endif
+
+#ifdef RTLS_PASSIVE
+/*********************************************************************
+* @fn      RTLSCtrl_initAoaSamples
+*
+* @brief   Hand the capture buffers over to the RF RAM read-out
+*
+* @param   samplesReadyCb - called from the RF callback once a read is over
+*
+* @return  none
+*/
+void RTLSCtrl_initAoaSamples(pfnAoaRfRamDoneCb_t samplesReadyCb)
+{
+  AOA_rfRamInit(&samplesBuff[0][0], samplesReadyCb);
+}
+
+/*********************************************************************
+* @fn      RTLSCtrl_readAoaSamples
+*
+* @brief   Start reading the capture of a connection event out of RF RAM,
+*          RTLSCtrl_processAoaSamples post processes it once it is read
+*
+* @param   connHandle - connection handle
+* @param   resultMode - AoA information saved by RTLS Control
+* @param   rssi - rssi to be reported to RTLS Host
+* @param   channel - channel that was used for this AoA run
+* @param   sampleCtrl - sample control configs
+*
+* @return  none
+*/
+void RTLSCtrl_readAoaSamples(uint8_t connHandle, uint8_t resultMode, int8_t rssi, uint8_t channel, uint8_t sampleCtrl)
+{
+  uint8_t seq;
+  uint8_t index = AOA_rfRamArm(Clock_getTicks(), &seq);
+
+  // The previous capture is still being read, or every buffer waits for or goes through post processing: the capture is dropped
+  if (index == AOA_RF_RAM_NO_BUF)
+  {
+    return;
+  }
+
+  // The buffer is not handed to RTLS Control before its read is over
+  gAoaCb.iqRead[index].connHandle = connHandle;
+  gAoaCb.iqRead[index].resultMode = resultMode;
+  gAoaCb.iqRead[index].rssi = rssi;
+  gAoaCb.iqRead[index].channel = channel;
+  gAoaCb.iqRead[index].sampleCtrl = sampleCtrl;
+
+  AOA_postProcess(seq);
+}
+
+/*********************************************************************
+* @fn      RTLSCtrl_processAoaSamples
+*
+* @brief   Post process every capture read out of RF RAM so far, oldest first,
+*          or give a read up once it took AOA_IQ_READ_TIMEOUT_MS
+*
+* @return  ticks until the read in flight times out, 0 if none is
+*/
+uint32_t RTLSCtrl_processAoaSamples(void)
+{
+  const uint32_t timeout = (AOA_IQ_READ_TIMEOUT_MS * 1000 + Clock_tickPeriod - 1) / Clock_tickPeriod;
+  AoA_IQSampleState_t state;
+  uint32_t wait = 0;
+  uint8_t index;
+
+  // The next capture is read into another buffer while this one is processed
+  while ((state = AOA_rfRamCheck(Clock_getTicks(), timeout, &wait, &index)) == SAMPLES_READY)
+  {
+    AoA_iqRead_t *pRead = &gAoaCb.iqRead[index];
+
+    AOA_setSamples(AOA_rfRamGetBuf(index));
+    gAoaCb.bufIndex = index;
+
+    RTLSCtrl_postProcessAoa(pRead->connHandle, pRead->resultMode, pRead->rssi, pRead->channel, pRead->sampleCtrl);
+
+    // A RAW stream keeps its own hold on the buffer
+    AOA_rfRamRelease(index);
+  }
+
+  return (state == SAMPLES_NOT_READY) ? wait : 0;
+}
+#endif
 
 /*********************************************************************
 * @fn      RTLSCtrl_postProcessAoa
@@ -158,31 +379,16 @@ void RTLSCtrl_postProcessAoa(rtlsAoaIqEvt_t *pEvt)
 #endif
 {
   uint8_t antenna;
+  bool usable = TRUE;
 
-#ifdef RTLS_PASSIVE
-
-  AOA_postProcess(rssi, channel, samplesBuff);
-
-  // Poll until we have samples to work with
-  while(AOA_getSampleState() == SAMPLES_NOT_READY);
-
-  // If samples are not valid, nothing to do here
-  if (AOA_getSampleState() == SAMPLES_NOT_VALID)
-  {
-    return;
-  }
-
-#else // RTLS_MASTER
+#ifdef RTLS_MASTER
   uint16_t connHandle = pEvt->connHandle;
   uint8_t sampleCtrl = pEvt->sampleCtrl;
   int8_t rssi = pEvt->rssi;
   uint8_t channel = pEvt->channel;
 
-  if (IS_AOA_CONFIG_RF_RAW(sampleCtrl) && gAoaCb.resultMode != AOA_MODE_RAW)
-  {
-    RTLSCtrl_sendDebugEvt("RAW RF only in AOA_MODE_RAW", RTLS_FAIL);
-    return;
-  }
+  // A RAW stream takes its own reference to the capture
+  gAoaCb.iqHandle = pEvt->iqHandle;
 #endif
 
   if (IS_AOA_CONFIG_ONLY_ANT_1(gAoaCb.sampleCtrl))
@@ -194,6 +400,47 @@ void RTLSCtrl_postProcessAoa(rtlsAoaIqEvt_t *pEvt)
     antenna = ANT_ARRAY_A2x;
   }
 
+  // Saturated, empty and collided captures are caught before the pair loop, on the samples as captured.
+  // Extended results report the measures even when captures are not screened.
+  if ((gAoaCb.resultMode != AOA_MODE_RAW) && ((gAoaCb.screenAction != AOA_SCREEN_OFF) || gAoaCb.resultExt))
+  {
+#ifdef RTLS_MASTER
+    usable = AOA_screenCapture(&gAoaCb.screenParams, &gAoaCb.connResInfo[connHandle].quality,
+                               pEvt->numIqSamples, pEvt->sampleRate, pEvt->sampleSize, pEvt->numAnt, pEvt->pIQ);
+#elif RTLS_PASSIVE
+    usable = AOA_screenCapture(&gAoaCb.screenParams, &gAoaCb.connResInfo[connHandle].quality);
+#endif
+
+    if (gAoaCb.screenAction == AOA_SCREEN_OFF)
+    {
+      usable = TRUE;
+    }
+    else if (!usable && (gAoaCb.screenAction == AOA_SCREEN_DISCARD))
+    {
+      return;
+    }
+  }
+
+  // The pair spread is only worked out for extended results
+  gAoaCb.connResInfo[connHandle].aoaResults.pPairQuality = gAoaCb.resultExt ? gAoaCb.pPairQuality : NULL;
+
+  // 16 bit captures are narrowed with a block exponent, so strong tags do not overflow the angle path
+  if (gAoaCb.resultMode != AOA_MODE_RAW)
+  {
+#ifdef RTLS_MASTER
+    // Oversampled captures are averaged down before, the 16 bit sums keep their precision.
+    // RAW RF captures keep every sample, their switching transients are masked per sample.
+    if (!IS_AOA_CONFIG_RF_RAW(sampleCtrl))
+    {
+      AOA_decimateSamples(pEvt->pIQ, &pEvt->numIqSamples, &pEvt->sampleRate, pEvt->sampleSize, gAoaCb.decimation);
+    }
+
+    AOA_normalizeSamples(pEvt->pIQ, pEvt->numIqSamples, &pEvt->sampleSize);
+#elif RTLS_PASSIVE
+    AOA_normalizeSamples();
+#endif
+  }
+
   switch (gAoaCb.resultMode)
   {
     case AOA_MODE_ANGLE:
@@ -202,19 +449,45 @@ void RTLSCtrl_postProcessAoa(rtlsAoaIqEvt_t *pEvt)
       rtlsAoaResultAngle_t aoaResult;
 
 #ifdef RTLS_MASTER
-      AOA_getPairAngles(gAoaCb.antArrayConfig,
-                        &gAoaCb.connResInfo[pEvt->connHandle].aoaResults,
-                        pEvt->numIqSamples,
-                        pEvt->sampleRate,
-                        pEvt->sampleSize,
-                        pEvt->slotDuration,
-                        pEvt->numAnt,
-                        pEvt->pIQ);
+      RTLSCtrl_getPairAngles(pEvt);
 #elif RTLS_PASSIVE
       AOA_getPairAngles(gAoaCb.antArrayConfig, &gAoaCb.connResInfo[connHandle].aoaResults);
 #endif
 
-      aoaTempResult = RTLSCtrl_estimateAngle(connHandle, sampleCtrl);
+      if (usable)
+      {
+        RTLSCtrl_addAoaCalibration(connHandle, channel);
+      }
+
+      aoaTempResult = RTLSCtrl_estimateAngle(connHandle, sampleCtrl, usable);
+
+      // Results are fused over the hopping channels, nothing is sent until a fused result is due
+      if (!RTLSCtrl_fuseAoaResult(connHandle, &aoaTempResult, &rssi, usable))
+      {
+        break;
+      }
+
+      if (gAoaCb.resultExt)
+      {
+        RTLSCtrl_sendAoaResultExt(connHandle, rssi, channel, AOA_IS_DUAL_ARRAY() ? aoaTempResult.antenna : antenna, &aoaTempResult, usable);
+        break;
+      }
+
+      // Both arrays add the elevation, the antenna is the array that resolved the angle better
+      if (AOA_IS_DUAL_ARRAY())
+      {
+        rtlsAoaResultAzEl_t azElResult;
+
+        azElResult.connHandle = connHandle;
+        azElResult.azimuth = aoaTempResult.angle;
+        azElResult.elevation = aoaTempResult.elevation;
+        azElResult.antenna = aoaTempResult.antenna;
+        azElResult.rssi = rssi;
+        azElResult.channel = channel;
+
+        RTLSHost_sendMsg(RTLS_CMD_AOA_RESULT_AZ_EL, HOST_ASYNC_RSP, (uint8_t *)&azElResult, sizeof(rtlsAoaResultAzEl_t));
+        break;
+      }
 
       aoaResult.connHandle = connHandle;
       aoaResult.angle = aoaTempResult.angle;
@@ -228,132 +501,148 @@ void RTLSCtrl_postProcessAoa(rtlsAoaIqEvt_t *pEvt)
 
     case AOA_MODE_PAIR_ANGLES:
     {
-      rtlsAoaResultPairAngles_t aoaResult;
+      rtlsAoaResultPairAngles_t *aoaResult;
       int16_t *pairAngle;
+      uint16_t resultLen;
 
 #ifdef RTLS_MASTER
-      AOA_getPairAngles(gAoaCb.antArrayConfig,
-                        &gAoaCb.connResInfo[connHandle].aoaResults,
-                        pEvt->numIqSamples,
-                        pEvt->sampleRate,
-                        pEvt->sampleSize,
-                        pEvt->slotDuration,
-                        pEvt->numAnt,
-                        pEvt->pIQ);
+      RTLSCtrl_getPairAngles(pEvt);
 #elif RTLS_PASSIVE
       AOA_getPairAngles(gAoaCb.antArrayConfig, &gAoaCb.connResInfo[connHandle].aoaResults);
 #endif
 
+      if (usable)
+      {
+        RTLSCtrl_addAoaCalibration(connHandle, channel);
+      }
+
+      if (gAoaCb.resultExt)
+      {
+        RTLSCtrl_sendAoaResultExt(connHandle, rssi, channel, antenna, NULL, usable);
+        break;
+      }
+
       pairAngle = gAoaCb.connResInfo[connHandle].aoaResults.pairAngle;
+      resultLen = sizeof(rtlsAoaResultPairAngles_t) + gAoaCb.antArrayConfig->numPairs * sizeof(int16_t);
 
-      aoaResult.connHandle = connHandle;
-      aoaResult.rssi = rssi;
-      aoaResult.channel = channel;
-      aoaResult.antenna = antenna;
+      if ((aoaResult = RTLSCtrl_malloc(resultLen)) == NULL)
+      {
+        return;
+      }
 
-      for (int i = 0; i < CALC_NUM_ANT_PAIRS(BOOSTXL_AOA_NUM_ANT); i++)
+      aoaResult->connHandle = connHandle;
+      aoaResult->rssi = rssi;
+      aoaResult->channel = channel;
+      aoaResult->antenna = antenna;
+
+      for (int i = 0; i < gAoaCb.antArrayConfig->numPairs; i++)
       {
-        aoaResult.pairAngle[i] = pairAngle[i];
+        aoaResult->pairAngle[i] = pairAngle[i];
       }
 
-      RTLSHost_sendMsg(RTLS_CMD_AOA_RESULT_PAIR_ANGLES, HOST_ASYNC_RSP, (uint8_t *)&aoaResult, sizeof(rtlsAoaResultPairAngles_t));
+      RTLSHost_sendMsg(RTLS_CMD_AOA_RESULT_PAIR_ANGLES, HOST_ASYNC_RSP, (uint8_t *)aoaResult, resultLen);
+
+      RTLSUTIL_FREE(aoaResult);
     }
     break;
 
-    case AOA_MODE_RAW:
+    case AOA_MODE_SPECTRUM:
     {
-      rtlsAoaResultRaw_t *aoaResult;
-      uint16_t samplesToOutput;
-
-#ifdef RTLS_PASSIVE
-      AoA_IQSample_Ext_t *pIterExt;
+      rtlsAoaResultSpectrum_t *aoaResult;
+      AoA_SpectrumResult_t spectrum;
+      AoA_Covariance_t *pAvg;
+      int16_t channelOffset;
+      bool status;
 
-      // Sanity check
-      if ((aoaResult = RTLSCtrl_malloc(sizeof(rtlsAoaResultRaw_t) + (MAX_SAMPLES_SINGLE_CHUNK * sizeof(AoA_IQSample_Ext_t)))) == NULL)
+      if (gAoaCb.connResInfo[connHandle].pCovariance == NULL)
       {
-        return;
+        const uint8_t numElements = gAoaCb.antArrayConfig->numElements;
+
+        if ((gAoaCb.connResInfo[connHandle].pCovariance = RTLSCtrl_malloc(AOA_COV_SIZE(numElements))) == NULL)
+        {
+          RTLSCtrl_sendDebugEvt("AoA spectrum out of memory", RTLS_OUT_OF_MEMORY);
+          return;
+        }
+
+        gAoaCb.connResInfo[connHandle].pCovariance->numAnt = numElements;
+        gAoaCb.connResInfo[connHandle].pCovariance->valid = FALSE;
       }
 
-      // Passive only supports samples of size int16
-      pIterExt = AOA_getRawSamples();
+      pAvg = gAoaCb.connResInfo[connHandle].pCovariance;
 
-      aoaResult->samplesLength = AOA_RES_MAX_SIZE;
-#else // RTLS_MASTER
+#ifdef RTLS_MASTER
+      status = RTLSCtrl_getCovariance(pEvt);
+#elif RTLS_PASSIVE
+      status = AOA_getCovariance(gAoaCb.antArrayConfig, gAoaCb.pCovScratch);
+#endif
+
+      // Nothing to report for a capture without signal
+      if (status == FALSE)
+      {
+        return;
+      }
 
-      // The samples may be of either type, depending on sampleSize
-      // For the sake of simplicity, just set both to point to the samples and decide the output format later
-      AoA_IQSample_Ext_t *pIterExt = (AoA_IQSample_Ext_t *)pEvt->pIQ;
-      AoA_IQSample_t *pIter = (AoA_IQSample_t *)pEvt->pIQ;
+      // A flagged capture is scanned on its own, the average keeps only usable captures
+      if (usable)
+      {
+        AOA_spectrumUpdate(pAvg, gAoaCb.pCovScratch, AOA_SPECTRUM_ALPHA);
+      }
+      else
+      {
+        pAvg = gAoaCb.pCovScratch;
+      }
 
-      // Allocate result structure to consider both options of sampleSize
-      aoaResult = RTLSCtrl_malloc(sizeof(rtlsAoaResultRaw_t) + (MAX_SAMPLES_SINGLE_CHUNK * sizeof(AoA_IQSample_Ext_t)));
+      if (AOA_spectrumScan(pAvg, gAoaCb.pCovWork, &spectrum) == FALSE)
+      {
+        return;
+      }
 
-      // Sanity check
-      if (aoaResult == NULL)
+      if ((aoaResult = RTLSCtrl_malloc(sizeof(rtlsAoaResultSpectrum_t) + (AOA_SPECTRUM_REPORT_BINS ? AOA_SPECTRUM_NUM_BINS : 0))) == NULL)
       {
         return;
       }
 
-      aoaResult->samplesLength = pEvt->numIqSamples;
-#endif
+      // Same frame as AOA_MODE_ANGLE: the array angle is turned by 45 degrees to the board
+      channelOffset = AOA_IS_HOST_ARRAY() ? 0 : RTLSCtrl_getCalOffset(antenna, channel, spectrum.angle);
+
+      if (AOA_IS_HOST_ARRAY())
+      {
+        aoaResult->angle = spectrum.angle;
+      }
+      else if (antenna == ANT_ARRAY_A1x)
+      {
+        aoaResult->angle = spectrum.angle + 45 + channelOffset;
+      }
+      else
+      {
+        aoaResult->angle = spectrum.angle - 45 - channelOffset;
+      }
 
-      // Set various parameters
       aoaResult->connHandle = connHandle;
-      aoaResult->channel = channel;
       aoaResult->rssi = rssi;
       aoaResult->antenna = antenna;
+      aoaResult->channel = channel;
+      aoaResult->method = AOA_spectrumGetMethod();
+      aoaResult->startAngle = AOA_SPECTRUM_MIN_ANGLE;
+      aoaResult->stepAngle = AOA_SPECTRUM_STEP_ANGLE;
+      aoaResult->numBins = AOA_SPECTRUM_REPORT_BINS ? AOA_SPECTRUM_NUM_BINS : 0;
 
-      // Set offset of the result set within the total bulk of samples
-      aoaResult->offset = 0;
+      memcpy(aoaResult->spectrum, spectrum.power, aoaResult->numBins);
 
-      do
-      {
-        // If the remainder is larger than buff size, tx maximum buff size
-        if (aoaResult->samplesLength - aoaResult->offset > MAX_SAMPLES_SINGLE_CHUNK)
-        {
-          samplesToOutput = MAX_SAMPLES_SINGLE_CHUNK;
-        }
-        else
-        {
-          // If not, then output the remaining data
-          samplesToOutput = aoaResult->samplesLength - aoaResult->offset;
-        }
+      RTLSHost_sendMsg(RTLS_CMD_AOA_RESULT_SPECTRUM, HOST_ASYNC_RSP, (uint8_t *)aoaResult, sizeof(rtlsAoaResultSpectrum_t) + aoaResult->numBins);
 
-        // Copy the samples to output buffer
-        for (int i = 0; i < samplesToOutput; i++)
-        {
+      RTLSUTIL_FREE(aoaResult);
+    }
+    break;
+
+    case AOA_MODE_RAW:
+    {
 #ifdef RTLS_PASSIVE
-            aoaResult->samples[i].i = pIterExt[i].i;
-            aoaResult->samples[i].q = pIterExt[i].q;
+      // Passive only supports samples of size int16
+      RTLSCtrl_streamAoaResultRaw(connHandle, rssi, channel, antenna, (int8_t *)AOA_getRawSamples(), 2, AOA_RES_MAX_SIZE);
 #else // RTLS_MASTER
-            if (pEvt->sampleSize == 2)
-            {
-              aoaResult->samples[i].i = pIterExt[i].i;
-              aoaResult->samples[i].q = pIterExt[i].q;
-            }
-            else // sampleSize = 1
-            {
-              aoaResult->samples[i].i = pIter[i].i;
-              aoaResult->samples[i].q = pIter[i].q;
-            }
-#endif
-        }
-
-        RTLSHost_sendMsg(RTLS_CMD_AOA_RESULT_RAW, HOST_ASYNC_RSP, (uint8_t *)aoaResult, sizeof(rtlsAoaResultRaw_t) + (sizeof(AoA_IQSample_Ext_t) * samplesToOutput));
-
-        // Update offset
-        aoaResult->offset += samplesToOutput;
-#ifdef RTLS_MASTER
-        pIter += MAX_SAMPLES_SINGLE_CHUNK;
+      RTLSCtrl_streamAoaResultRaw(connHandle, rssi, channel, antenna, pEvt->pIQ, pEvt->sampleSize, pEvt->numIqSamples);
 #endif
-        pIterExt += MAX_SAMPLES_SINGLE_CHUNK;
-      }
-      while (aoaResult->offset < aoaResult->samplesLength);
-
-      if (aoaResult)
-      {
-        RTLSUTIL_FREE(aoaResult);
-      }
     }
     break;
 
@@ -362,6 +651,85 @@ void RTLSCtrl_postProcessAoa(rtlsAoaIqEvt_t *pEvt)
   } // Switch
 }
 
+#ifdef RTLS_MASTER
+/*********************************************************************
+* @fn      RTLSCtrl_getPairAngles
+*
+* @brief   Pair angles of a capture, RAW RF captures have their switching transients masked
+*
+* @param   pEvt - capture to process
+*
+* @return  none
+*/
+void RTLSCtrl_getPairAngles(rtlsAoaIqEvt_t *pEvt)
+{
+  AoA_AntennaResult_t *pResults = &gAoaCb.connResInfo[pEvt->connHandle].aoaResults;
+
+  if (IS_AOA_CONFIG_RF_RAW(pEvt->sampleCtrl))
+  {
+    AOA_getPairAnglesRaw(gAoaCb.antArrayConfig, pResults, pEvt->numIqSamples, pEvt->sampleRate,
+                         pEvt->sampleSize, pEvt->slotDuration, pEvt->numAnt, pEvt->pIQ);
+  }
+  else
+  {
+    AOA_getPairAngles(gAoaCb.antArrayConfig, pResults, pEvt->numIqSamples, pEvt->sampleRate,
+                      pEvt->sampleSize, pEvt->slotDuration, pEvt->numAnt, pEvt->pIQ);
+  }
+}
+
+/*********************************************************************
+* @fn      RTLSCtrl_selectAoaKernel
+*
+* @brief   Select the angle kernel for captures as they reach the angle path
+*
+*          16 bit captures reach the angle path normalized, decimated
+*          captures at the sample rate they were averaged down to.
+*
+* @param   none
+*
+* @return  none
+*/
+void RTLSCtrl_selectAoaKernel(void)
+{
+  uint8_t sampleRate = gAoaCb.sampleRate;
+  uint8_t sampleSize = (gAoaCb.sampleSize == 2) ? AOA_NORM_SAMPLE_SIZE : gAoaCb.sampleSize;
+
+  if (gAoaCb.resultMode == AOA_MODE_RAW)
+  {
+    return;
+  }
+
+  // Factors that do not divide the sample rate leave the capture as it is
+  if ((gAoaCb.decimation > 1) && ((sampleRate % gAoaCb.decimation) == 0))
+  {
+    sampleRate /= gAoaCb.decimation;
+  }
+
+  AOA_selectKernel(sampleRate, sampleSize, gAoaCb.slotDuration, gAoaCb.numAnt);
+}
+
+/*********************************************************************
+* @fn      RTLSCtrl_getCovariance
+*
+* @brief   Covariance of a capture into the scratch covariance, RAW RF captures have their switching transients masked
+*
+* @param   pEvt - capture to process
+*
+* @return  TRUE if the capture held a usable signal
+*/
+bool RTLSCtrl_getCovariance(rtlsAoaIqEvt_t *pEvt)
+{
+  if (IS_AOA_CONFIG_RF_RAW(pEvt->sampleCtrl))
+  {
+    return AOA_getCovarianceRaw(gAoaCb.antArrayConfig, gAoaCb.pCovScratch, pEvt->numIqSamples, pEvt->sampleRate,
+                                pEvt->sampleSize, pEvt->slotDuration, pEvt->numAnt, pEvt->pIQ);
+  }
+
+  return AOA_getCovariance(gAoaCb.antArrayConfig, gAoaCb.pCovScratch, pEvt->numIqSamples, pEvt->sampleRate,
+                           pEvt->sampleSize, pEvt->slotDuration, pEvt->numAnt, pEvt->pIQ);
+}
+#endif
+
 /*********************************************************************
 * @fn      RTLSCtrl_estimateAngle
 *
@@ -369,98 +737,1165 @@ void RTLSCtrl_postProcessAoa(rtlsAoaIqEvt_t *pEvt)
 *
 * @param   connHandle - connection handle
 * @param   sampleCtrl - sample control configs: 0x01 = RAW RF, 0x00 = Filtered results (switching period omitted), bit 4,5 0x10 - ONLY_ANT_1, 0x20 - ONLY_ANT_2
+* @param   usable - FALSE to report the angle of the capture without feeding it to the tracking filter
 *
 * @return  AoA Sample struct filled with calculated angles
 */
-AoA_Sample_t RTLSCtrl_estimateAngle(uint16_t connHandle, uint8_t sampleCtrl)
+AoA_Sample_t RTLSCtrl_estimateAngle(uint16_t connHandle, uint8_t sampleCtrl, bool usable)
 {
   AoA_Sample_t AoA;
+  AoA_angleTrack_t *pTrack = &gAoaCb.connResInfo[connHandle].AoA_track;
 
-  int8_t channelOffset;
   uint8_t channel;
-  uint8_t AoA_ma_size;
   int16_t AoA_A1;
   int16_t AoA_A2;
+  int16_t elevation = 0;
   uint8_t selectedAntenna;
 
-  AoA_ma_size = sizeof(gAoaCb.connResInfo[connHandle].AoA_ma.array) / sizeof(gAoaCb.connResInfo[connHandle].AoA_ma.array[0]);
-
   channel = gAoaCb.connResInfo[connHandle].aoaResults.ch;
-  channelOffset = gAoaCb.antArrayConfig->channelOffset[channel];
 
   // Calculate AoA for each antenna array
-  if (IS_AOA_CONFIG_ONLY_ANT_1(gAoaCb.sampleCtrl))
+  if (AOA_IS_HOST_ARRAY())
   {
-    AoA_A1 = ((gAoaCb.connResInfo[connHandle].aoaResults.pairAngle[0] + gAoaCb.connResInfo[connHandle].aoaResults.pairAngle[1]) / 2) + 45 + channelOffset;
-    selectedAntenna = ANT_ARRAY_A1x;
+    // Angle from broadside, the last angle is kept if no pair resolves it
+    AoA_A1 = pTrack->currentAoA;
+    AOA_getArrayAngle(gAoaCb.antArrayConfig, &gAoaCb.connResInfo[connHandle].aoaResults, &AoA_A1);
+    AoA_A2 = AoA_A1;
+    selectedAntenna = IS_AOA_CONFIG_ONLY_ANT_2(gAoaCb.sampleCtrl) ? ANT_ARRAY_A2x : ANT_ARRAY_A1x;
+  }
+  else if (AOA_IS_DUAL_ARRAY())
+  {
+    const int16_t *pairAngle = gAoaCb.connResInfo[connHandle].aoaResults.pairAngle;
+    int16_t azimuth;
+
+    // Angles from the broadside of each array, calibrated as for the single array modes
+    AoA_A1 = (pairAngle[0] + pairAngle[1]) / 2;
+    AoA_A2 = (pairAngle[AOA_DUAL_A2_PAIR] + pairAngle[AOA_DUAL_A2_PAIR + 1]) / 2;
+    AoA_A1 += RTLSCtrl_getCalOffset(ANT_ARRAY_A1x, channel, AoA_A1);
+    AoA_A2 -= RTLSCtrl_getCalOffset(ANT_ARRAY_A2x, channel, AoA_A2);
+
+    AOA_fuseArrayAngles(AoA_A1, AoA_A2, &azimuth, &elevation);
+
+    // The angle resolution of an array is best at its broadside
+    selectedAntenna = (abs(AoA_A1) <= abs(AoA_A2)) ? ANT_ARRAY_A1x : ANT_ARRAY_A2x;
+    AoA_A1 = azimuth;
+    AoA_A2 = azimuth;
+  }
+  else if (IS_AOA_CONFIG_ONLY_ANT_1(gAoaCb.sampleCtrl))
+  {
+    AoA_A1 = (gAoaCb.connResInfo[connHandle].aoaResults.pairAngle[0] + gAoaCb.connResInfo[connHandle].aoaResults.pairAngle[1]) / 2;
+    AoA_A1 += 45 + RTLSCtrl_getCalOffset(ANT_ARRAY_A1x, channel, AoA_A1);
+    selectedAntenna = ANT_ARRAY_A1x;
   }
   else if (IS_AOA_CONFIG_ONLY_ANT_2(gAoaCb.sampleCtrl))
   {
-    AoA_A2 = ((gAoaCb.connResInfo[connHandle].aoaResults.pairAngle[0] + gAoaCb.connResInfo[connHandle].aoaResults.pairAngle[1]) / 2) - 45 - channelOffset;
-    selectedAntenna = ANT_ARRAY_A2x;
+    AoA_A2 = (gAoaCb.connResInfo[connHandle].aoaResults.pairAngle[0] + gAoaCb.connResInfo[connHandle].aoaResults.pairAngle[1]) / 2;
+    AoA_A2 -= 45 + RTLSCtrl_getCalOffset(ANT_ARRAY_A2x, channel, AoA_A2);
+    selectedAntenna = ANT_ARRAY_A2x;
+  }
+
+  // Antenna array is selected according to sampleCtrl
+  // 1. Either A1 or A2 are selected constantly according to configuration
+  if (selectedAntenna == ANT_ARRAY_A1x)
+  {
+    // Use AoA from Antenna Array A1
+    pTrack->currentAoA = AoA_A1;
+    pTrack->currentAntennaArray = ANT_ARRAY_A1x;
+    AoA.currentangle = AoA_A1;
+  }
+  // Signal strength is higher on A2 vs A1
+  else
+  {
+    // Use AoA from Antenna Array A2
+    pTrack->currentAoA = AoA_A2;
+    pTrack->currentAntennaArray = ANT_ARRAY_A2x;
+    AoA.currentangle = AoA_A2;
+  }
+
+  pTrack->currentRssi = gAoaCb.connResInfo[connHandle].aoaResults.rssi;
+  pTrack->currentCh = gAoaCb.connResInfo[connHandle].aoaResults.ch;
+
+  // Return results, smoothed by the tracking filter of the connection
+  if (usable)
+  {
+    // Azimuths cover the full circle, -134 and 225 are neighbours
+    if (AOA_IS_DUAL_ARRAY())
+    {
+      AoA.angle = AOA_trackUpdateCircular(&pTrack->track, pTrack->currentAoA, AOA_AZIMUTH_MIN);
+      AoA.elevation = AOA_trackUpdate(&pTrack->elevationTrack, elevation);
+    }
+    else
+    {
+      AoA.angle = AOA_trackUpdate(&pTrack->track, pTrack->currentAoA);
+      AoA.elevation = 0;
+    }
+  }
+  else
+  {
+    AoA.angle = pTrack->currentAoA;
+    AoA.elevation = elevation;
+  }
+  AoA.rssi = pTrack->currentRssi;
+  AoA.channel = pTrack->currentCh;
+  AoA.antenna = pTrack->currentAntennaArray;
+
+  return AoA;
+}
+
+/*********************************************************************
+* @fn      RTLSCtrl_fuseAoaResult
+*
+* @brief   Fuse the result of a CTE with the results of the connection before it
+*
+* @param   connHandle - connection the capture belongs to
+* @param   pAngle - result of the CTE, the fused result afterwards
+* @param   pRssi - rssi of the CTE, the fused rssi afterwards
+* @param   usable - FALSE if the capture failed screening
+*
+* @return  TRUE if a result is to be sent
+*/
+bool RTLSCtrl_fuseAoaResult(uint16_t connHandle, AoA_Sample_t *pAngle, int8_t *pRssi, bool usable)
+{
+  const AoA_ReportParams_t *pParams = &gAoaCb.reportParams;
+  AoA_ReportResult_t fused;
+
+  // Every CTE is sent as it is, flagged ones included
+  if ((pParams->window == 1) && (pParams->minChange == 0))
+  {
+    return TRUE;
+  }
+
+  // A flagged capture would pull the whole window
+  if (!usable ||
+      !AOA_reportUpdate(&gAoaCb.connResInfo[connHandle].report, pParams, pAngle->angle, pAngle->elevation, *pRssi,
+                        AOA_IS_DUAL_ARRAY() ? AOA_AZIMUTH_MIN : AOA_ANGLE_MIN, &fused))
+  {
+    return FALSE;
+  }
+
+  pAngle->angle = fused.angle;
+  pAngle->elevation = fused.elevation;
+  *pRssi = fused.rssi;
+
+  return TRUE;
+}
+
+/*********************************************************************
+* @fn      RTLSCtrl_setAoaTrackParams
+*
+* @brief   Select the angle tracking filter of a connection
+*
+* @param   connHandle - connection handle
+* @param   dataLen - length of pData
+* @param   pData - rtlsAoaTrackParams_t
+*
+* @return  status - RTLS_FAIL/RTLS_CONFIG_NOT_SUPPORTED/RTLS_SUCCESS
+*/
+rtlsStatus_e RTLSCtrl_setAoaTrackParams(uint16_t connHandle, uint8_t dataLen, uint8_t *pData)
+{
+  rtlsAoaTrackParams_t *pReq = (rtlsAoaTrackParams_t *)pData;
+  AoA_TrackParams_t params;
+
+  // Trackers exist once AoA parameters were set
+  if ((gAoaCb.connResInfo == NULL) || (connHandle >= gAoaCb.maxConnections) || (pData == NULL) || (dataLen < sizeof(rtlsAoaTrackParams_t)))
+  {
+    return RTLS_FAIL;
+  }
+
+  params.type = pReq->type;
+  params.window = pReq->window;
+  params.alpha = pReq->alpha;
+  params.beta = pReq->beta;
+  params.measVar = pReq->measVar;
+  params.accelVar = pReq->accelVar;
+
+  if (AOA_trackInit(&gAoaCb.connResInfo[connHandle].AoA_track.track, &params) == FALSE)
+  {
+    return RTLS_CONFIG_NOT_SUPPORTED;
+  }
+
+  // The elevation of both arrays is smoothed the same way
+  AOA_trackInit(&gAoaCb.connResInfo[connHandle].AoA_track.elevationTrack, &params);
+
+  return RTLS_SUCCESS;
+}
+
+/*********************************************************************
+* @fn      RTLSCtrl_setAoaScreenParams
+*
+* @brief   Set how captures are screened before the angle path
+*
+* @param   dataLen - length of pData
+* @param   pData - rtlsAoaScreenParams_t
+*
+* @return  status - RTLS_FAIL/RTLS_CONFIG_NOT_SUPPORTED/RTLS_SUCCESS
+*/
+rtlsStatus_e RTLSCtrl_setAoaScreenParams(uint8_t dataLen, uint8_t *pData)
+{
+  rtlsAoaScreenParams_t *pReq = (rtlsAoaScreenParams_t *)pData;
+
+  if ((pData == NULL) || (dataLen < sizeof(rtlsAoaScreenParams_t)))
+  {
+    return RTLS_FAIL;
+  }
+
+  if (pReq->action > AOA_SCREEN_FLAG)
+  {
+    return RTLS_CONFIG_NOT_SUPPORTED;
+  }
+
+  gAoaCb.screenAction = pReq->action;
+  gAoaCb.screenParams.maxPeakDb = pReq->maxPeakDb;
+  gAoaCb.screenParams.minPowerDb = pReq->minPowerDb;
+  gAoaCb.screenParams.minLinearity = pReq->minLinearity;
+
+  return RTLS_SUCCESS;
+}
+
+/*********************************************************************
+* @fn      RTLSCtrl_setAoaQualityParams
+*
+* @brief   Select the extended results with the spread of every pair angle
+*
+* @param   dataLen - length of pData
+* @param   pData - rtlsAoaQualityParams_t
+*
+* @return  status - RTLS_FAIL/RTLS_SUCCESS
+*/
+rtlsStatus_e RTLSCtrl_setAoaQualityParams(uint8_t dataLen, uint8_t *pData)
+{
+  rtlsAoaQualityParams_t *pReq = (rtlsAoaQualityParams_t *)pData;
+
+  if ((pData == NULL) || (dataLen < sizeof(rtlsAoaQualityParams_t)))
+  {
+    return RTLS_FAIL;
+  }
+
+  gAoaCb.resultExt = (pReq->enable != 0);
+
+  return RTLS_SUCCESS;
+}
+
+/*********************************************************************
+* @fn      RTLSCtrl_setAoaDecimationParams
+*
+* @brief   Set the factor oversampled captures are decimated by
+*
+* @param   dataLen - length of pData
+* @param   pData - rtlsAoaDecimationParams_t
+*
+* @return  status - RTLS_FAIL/RTLS_CONFIG_NOT_SUPPORTED/RTLS_SUCCESS
+*/
+rtlsStatus_e RTLSCtrl_setAoaDecimationParams(uint8_t dataLen, uint8_t *pData)
+{
+  rtlsAoaDecimationParams_t *pReq = (rtlsAoaDecimationParams_t *)pData;
+
+  if ((pData == NULL) || (dataLen < sizeof(rtlsAoaDecimationParams_t)))
+  {
+    return RTLS_FAIL;
+  }
+
+#ifdef RTLS_PASSIVE
+  // Passive captures have a fixed layout with a single valid sample per slot
+  if (pReq->factor != 1)
+  {
+    return RTLS_CONFIG_NOT_SUPPORTED;
+  }
+#else // RTLS_MASTER
+  if ((pReq->factor == 0) || (pReq->factor > AOA_MAX_DECIMATION))
+  {
+    return RTLS_CONFIG_NOT_SUPPORTED;
+  }
+#endif
+
+  gAoaCb.decimation = pReq->factor;
+
+#ifdef RTLS_MASTER
+  // The angle path now sees captures at another sample rate
+  if (gAoaCb.connResInfo != NULL)
+  {
+    RTLSCtrl_selectAoaKernel();
+  }
+#endif
+
+  return RTLS_SUCCESS;
+}
+
+/*********************************************************************
+* @fn      RTLSCtrl_setAoaReportParams
+*
+* @brief   Set how AOA_MODE_ANGLE results are fused and how often they are sent
+*
+* @param   dataLen - length of pData
+* @param   pData - rtlsAoaReportParams_t
+*
+* @return  status - RTLS_FAIL/RTLS_CONFIG_NOT_SUPPORTED/RTLS_SUCCESS
+*/
+rtlsStatus_e RTLSCtrl_setAoaReportParams(uint8_t dataLen, uint8_t *pData)
+{
+  rtlsAoaReportParams_t *pReq = (rtlsAoaReportParams_t *)pData;
+  AoA_ReportParams_t params;
+
+  if ((pData == NULL) || (dataLen < sizeof(rtlsAoaReportParams_t)))
+  {
+    return RTLS_FAIL;
+  }
+
+  params.window = pReq->window;
+  params.minChange = pReq->minChange;
+  params.maxHold = pReq->maxHold;
+
+  if (!AOA_reportCheckParams(&params))
+  {
+    return RTLS_CONFIG_NOT_SUPPORTED;
+  }
+
+  gAoaCb.reportParams = params;
+
+  // Windows in progress were counted against the old parameters
+  if (gAoaCb.connResInfo != NULL)
+  {
+    for (int i = 0; i < gAoaCb.maxConnections; i++)
+    {
+      AOA_reportReset(&gAoaCb.connResInfo[i].report);
+    }
+  }
+
+  return RTLS_SUCCESS;
+}
+
+/*********************************************************************
+* @fn      RTLSCtrl_setAoaRawFormatParams
+*
+* @brief   Set the format AOA_MODE_RAW results are sent in
+*
+* @param   dataLen - length of pData
+* @param   pData - rtlsAoaRawFormatParams_t
+*
+* @return  status - RTLS_FAIL/RTLS_CONFIG_NOT_SUPPORTED/RTLS_SUCCESS
+*/
+rtlsStatus_e RTLSCtrl_setAoaRawFormatParams(uint8_t dataLen, uint8_t *pData)
+{
+  rtlsAoaRawFormatParams_t *pReq = (rtlsAoaRawFormatParams_t *)pData;
+
+  if ((pData == NULL) || (dataLen < sizeof(rtlsAoaRawFormatParams_t)))
+  {
+    return RTLS_FAIL;
+  }
+
+  if ((pReq->coding != AOA_RAW_CODING_NONE) && (pReq->coding != AOA_RAW_CODING_DELTA))
+  {
+    return RTLS_CONFIG_NOT_SUPPORTED;
+  }
+
+  gAoaCb.rawPacked = (pReq->packed != 0);
+  gAoaCb.rawCoding = pReq->coding;
+
+  return RTLS_SUCCESS;
+}
+
+/*********************************************************************
+* @fn      RTLSCtrl_setAoaAvgModeParams
+*
+* @brief   Select how the pair angles of a capture are averaged
+*
+* @param   dataLen - length of pData
+* @param   pData - rtlsAoaAvgModeParams_t
+*
+* @return  status - RTLS_FAIL/RTLS_CONFIG_NOT_SUPPORTED/RTLS_SUCCESS
+*/
+rtlsStatus_e RTLSCtrl_setAoaAvgModeParams(uint8_t dataLen, uint8_t *pData)
+{
+  rtlsAoaAvgModeParams_t *pReq = (rtlsAoaAvgModeParams_t *)pData;
+
+  if ((pData == NULL) || (dataLen < sizeof(rtlsAoaAvgModeParams_t)))
+  {
+    return RTLS_FAIL;
+  }
+
+  if ((pReq->mode != AOA_AVG_MODE_ANGLE) && (pReq->mode != AOA_AVG_MODE_PHASOR))
+  {
+    return RTLS_CONFIG_NOT_SUPPORTED;
+  }
+
+  AOA_setAvgMode((AoA_AvgMode_t)pReq->mode);
+
+  return RTLS_SUCCESS;
+}
+
+/*********************************************************************
+* @fn      RTLSCtrl_sendAoaResultExt
+*
+* @brief   Send the pair angles of a capture with their spread and the capture measures
+*
+* @param   connHandle - connection the capture belongs to
+* @param   rssi - rssi to be reported to RTLS Host
+* @param   channel - channel that was used for this AoA run
+* @param   antenna - antenna to be reported to RTLS Host
+* @param   pAngle - angle of the capture, NULL in AOA_MODE_PAIR_ANGLES
+* @param   usable - FALSE if the capture failed screening
+*
+* @return  none
+*/
+void RTLSCtrl_sendAoaResultExt(uint16_t connHandle, int8_t rssi, uint8_t channel, uint8_t antenna, const AoA_Sample_t *pAngle, bool usable)
+{
+  const AoA_AntennaResult_t *pResults = &gAoaCb.connResInfo[connHandle].aoaResults;
+  const AoA_CaptureQuality_t *pQuality = &gAoaCb.connResInfo[connHandle].quality;
+  const uint8_t numPairs = gAoaCb.antArrayConfig->numPairs;
+  const uint16_t resultLen = sizeof(rtlsAoaResultExt_t) + numPairs * sizeof(rtlsAoaResultPair_t);
+  rtlsAoaResultExt_t *pResult;
+
+  if ((pResults->pPairQuality == NULL) || ((pResult = RTLSCtrl_malloc(resultLen)) == NULL))
+  {
+    return;
+  }
+
+  pResult->connHandle = connHandle;
+  pResult->angle = pAngle ? pAngle->angle : 0;
+  pResult->elevation = (pAngle && AOA_IS_DUAL_ARRAY()) ? pAngle->elevation : 0;
+  pResult->rssi = rssi;
+  pResult->antenna = antenna;
+  pResult->channel = channel;
+  pResult->flags = ((pQuality->peakDb >= gAoaCb.screenParams.maxPeakDb) ? AOA_RESULT_SATURATED : 0) |
+                   (usable ? 0 : AOA_RESULT_UNUSABLE);
+  pResult->peakDb = pQuality->peakDb;
+  pResult->powerDb = pQuality->powerDb;
+  pResult->linearity = pQuality->linearity;
+  pResult->numSamples = pResults->numSamples;
+  pResult->numPairs = numPairs;
+
+  for (uint8_t i = 0; i < numPairs; i++)
+  {
+    pResult->pair[i].angle = pResults->pairAngle[i];
+    pResult->pair[i].coherence = pResults->pPairQuality[i].coherence;
+    pResult->pair[i].phaseVar = pResults->pPairQuality[i].phaseVar;
+  }
+
+  RTLSHost_sendMsg(RTLS_CMD_AOA_RESULT_EXT, HOST_ASYNC_RSP, (uint8_t *)pResult, resultLen);
+
+  RTLSUTIL_FREE(pResult);
+}
+
+/*********************************************************************
+* @fn      RTLSCtrl_streamAoaResultRaw
+*
+* @brief   Stream the samples of a capture to the host, every message is built
+*          in the host interface TX buffer straight out of the capture
+*
+* @param   connHandle - connection the capture belongs to
+* @param   rssi - rssi to be reported to RTLS Host
+* @param   channel - channel that was used for this AoA run
+* @param   antenna - antenna to be reported to RTLS Host
+* @param   pIQ - AoA_IQSample_t or AoA_IQSample_Ext_t samples
+* @param   sampleSize - 1 = 8 bit, 2 = 16 bit
+* @param   numIqSamples - samples of the capture
+*
+* @return  TRUE if the capture is being streamed, FALSE if it was dropped
+*/
+bool RTLSCtrl_streamAoaResultRaw(uint16_t connHandle, int8_t rssi, uint8_t channel, uint8_t antenna, int8_t *pIQ, uint8_t sampleSize, uint16_t numIqSamples)
+{
+  AoA_rawStream_t *pStream;
+
+  if ((numIqSamples == 0) || ((pStream = RTLSCtrl_malloc(sizeof(AoA_rawStream_t))) == NULL))
+  {
+    return FALSE;
+  }
+
+#ifdef RTLS_MASTER
+  // The capture is not freed until the stream is out, RTLS Control keeps its own reference
+  if (!AOA_iqRetain(gAoaCb.iqHandle))
+  {
+    RTLSUTIL_FREE(pStream);
+
+    return FALSE;
+  }
+
+  pStream->iqHandle = gAoaCb.iqHandle;
+#else // RTLS_PASSIVE
+  // The capture stays in its RF RAM buffer until the stream is out
+  if (!AOA_rfRamRetain(gAoaCb.bufIndex))
+  {
+    RTLSUTIL_FREE(pStream);
+
+    return FALSE;
+  }
+
+  pStream->bufIndex = gAoaCb.bufIndex;
+#endif
+
+  pStream->pIQ = pIQ;
+  pStream->numIqSamples = numIqSamples;
+  pStream->offset = 0;
+  pStream->connHandle = connHandle;
+  pStream->rssi = rssi;
+  pStream->antenna = antenna;
+  pStream->channel = channel;
+  pStream->sampleSize = sampleSize;
+  pStream->packed = gAoaCb.rawPacked;
+  pStream->coding = gAoaCb.rawCoding;
+
+  if (RTLSHost_sendStream(pStream->packed ? RTLS_CMD_AOA_RESULT_RAW_PACKED : RTLS_CMD_AOA_RESULT_RAW, HOST_ASYNC_RSP,
+                          RTLSCtrl_fillAoaRawStream, RTLSCtrl_doneAoaRawStream, pStream) != 0)
+  {
+#ifdef RTLS_MASTER
+    AOA_iqRelease(pStream->iqHandle);
+#else // RTLS_PASSIVE
+    AOA_rfRamRelease(pStream->bufIndex);
+#endif
+
+    RTLSUTIL_FREE(pStream);
+
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/*********************************************************************
+* @fn      RTLSCtrl_fillAoaRawStream
+*
+* @brief   Write the next RAW result of a stream, with as many samples as fit
+*
+* @param   pArg - AoA_rawStream_t
+* @param   pBuf - result to write
+* @param   maxLen - room in pBuf
+* @param   pLen - length of the result written
+*
+* @return  TRUE while more results follow
+*/
+bool RTLSCtrl_fillAoaRawStream(void *pArg, uint8_t *pBuf, uint16_t maxLen, uint16_t *pLen)
+{
+  AoA_rawStream_t *pStream = (AoA_rawStream_t *)pArg;
+  const int8_t *pIQ = pStream->pIQ + pStream->offset * 2 * pStream->sampleSize;
+  uint16_t numSamples = pStream->numIqSamples - pStream->offset;
+  uint16_t maxSamples;
+
+  *pLen = 0;
+
+  if (pStream->packed)
+  {
+    rtlsAoaResultRawPacked_t *pResult = (rtlsAoaResultRawPacked_t *)pBuf;
+    AoA_RawFormat_t format;
+
+    maxSamples = (maxLen > sizeof(rtlsAoaResultRawPacked_t)) ?
+                 (maxLen - sizeof(rtlsAoaResultRawPacked_t)) / AOA_RAW_PACKED_MAX_SIZE(1, pStream->sampleSize) : 0;
+    maxSamples = (maxSamples > UINT8_MAX) ? UINT8_MAX : maxSamples;
+    numSamples = (numSamples > maxSamples) ? maxSamples : numSamples;
+
+    if (numSamples != 0)
+    {
+      pResult->connHandle = pStream->connHandle;
+      pResult->rssi = pStream->rssi;
+      pResult->antenna = pStream->antenna;
+      pResult->channel = pStream->channel;
+      pResult->offset = pStream->offset;
+      pResult->samplesLength = pStream->numIqSamples;
+      pResult->numSamples = numSamples;
+
+      *pLen = sizeof(rtlsAoaResultRawPacked_t) +
+              AOA_rawPack(pIQ, pStream->sampleSize, numSamples, pStream->coding, &format, pResult->data);
+
+      pResult->sampleBits = format.sampleBits;
+      pResult->coding = format.coding;
+      pResult->deltaBits = format.deltaBits;
+    }
+  }
+  else
+  {
+    rtlsAoaResultRaw_t *pResult = (rtlsAoaResultRaw_t *)pBuf;
+
+    maxSamples = (maxLen > sizeof(rtlsAoaResultRaw_t)) ?
+                 (maxLen - sizeof(rtlsAoaResultRaw_t)) / sizeof(AoA_IQSample_Ext_t) : 0;
+    numSamples = (numSamples > maxSamples) ? maxSamples : numSamples;
+
+    if (numSamples != 0)
+    {
+      pResult->connHandle = pStream->connHandle;
+      pResult->rssi = pStream->rssi;
+      pResult->antenna = pStream->antenna;
+      pResult->channel = pStream->channel;
+      pResult->offset = pStream->offset;
+      pResult->samplesLength = pStream->numIqSamples;
+
+      // 16 bit samples are sent as they are, 8 bit samples are widened on the way
+      if (pStream->sampleSize == 2)
+      {
+        memcpy(pResult->samples, pIQ, numSamples * sizeof(AoA_IQSample_Ext_t));
+      }
+      else
+      {
+        for (uint16_t i = 0; i < numSamples; i++)
+        {
+          pResult->samples[i].i = ((const AoA_IQSample_t *)pIQ)[i].i;
+          pResult->samples[i].q = ((const AoA_IQSample_t *)pIQ)[i].q;
+        }
+      }
+
+      *pLen = sizeof(rtlsAoaResultRaw_t) + numSamples * sizeof(AoA_IQSample_Ext_t);
+    }
+  }
+
+  // A TX buffer too small for a single sample ends the stream
+  if (numSamples == 0)
+  {
+    return FALSE;
+  }
+
+  pStream->offset += numSamples;
+
+  return (pStream->offset < pStream->numIqSamples);
+}
+
+/*********************************************************************
+* @fn      RTLSCtrl_doneAoaRawStream
+*
+* @brief   Release a RAW stream once its last result is out
+*
+* @param   pArg - AoA_rawStream_t
+*
+* @return  none
+*/
+void RTLSCtrl_doneAoaRawStream(void *pArg)
+{
+  AoA_rawStream_t *pStream = (AoA_rawStream_t *)pArg;
+
+#ifdef RTLS_MASTER
+  AOA_iqRelease(pStream->iqHandle);
+#else // RTLS_PASSIVE
+  AOA_rfRamRelease(pStream->bufIndex);
+#endif
+
+  RTLSUTIL_FREE(pStream);
+}
+
+/*********************************************************************
+* @fn      RTLSCtrl_setAoaCalibration
+*
+* @brief   Load the calibration table of a BOOSTXL-AOA array
+*
+* @param   dataLen - length of pData
+* @param   pData - rtlsAoaCalibration_t
+*
+* @return  status - RTLS_FAIL/RTLS_CONFIG_NOT_SUPPORTED/RTLS_OUT_OF_MEMORY/RTLS_SUCCESS
+*/
+rtlsStatus_e RTLSCtrl_setAoaCalibration(uint16_t dataLen, uint8_t *pData)
+{
+  rtlsAoaCalibration_t *pReq = (rtlsAoaCalibration_t *)pData;
+
+  if ((pData == NULL) || (dataLen < sizeof(rtlsAoaCalibration_t)))
+  {
+    return RTLS_FAIL;
+  }
+
+  if ((pReq->antenna != ANT_ARRAY_A1x && pReq->antenna != ANT_ARRAY_A2x) ||
+      (pReq->numBins == 0) || (pReq->numBins > AOA_CAL_MAX_BINS))
+  {
+    return RTLS_CONFIG_NOT_SUPPORTED;
+  }
+
+  if (dataLen < sizeof(rtlsAoaCalibration_t) + AOA_CAL_NUM_CHANNELS * pReq->numBins)
+  {
+    return RTLS_FAIL;
+  }
+
+  return RTLSCtrl_loadCalibration(pReq->antenna, pReq->numBins, pReq->startAngle, pReq->stepAngle, pReq->offset);
+}
+
+/*********************************************************************
+* @fn      RTLSCtrl_startAoaCalibration
+*
+* @brief   Start or stop the calibration capture of a BOOSTXL-AOA array
+*
+* @param   dataLen - length of pData
+* @param   pData - rtlsAoaCalibrate_t
+*
+* @return  status - RTLS_FAIL/RTLS_CONFIG_NOT_SUPPORTED/RTLS_OUT_OF_MEMORY/RTLS_SUCCESS
+*/
+rtlsStatus_e RTLSCtrl_startAoaCalibration(uint16_t dataLen, uint8_t *pData)
+{
+  rtlsAoaCalibrate_t *pReq = (rtlsAoaCalibrate_t *)pData;
+  bool arrayActive;
+
+  if ((pData == NULL) || (dataLen < sizeof(rtlsAoaCalibrate_t)))
+  {
+    return RTLS_FAIL;
+  }
+
+  // A new capture starts over
+  RTLSCtrl_stopAoaCalibration();
+
+  if (pReq->numCtes == 0)
+  {
+    return RTLS_SUCCESS;
+  }
+
+  if ((gAoaCb.connResInfo == NULL) || (pReq->connHandle >= gAoaCb.maxConnections))
+  {
+    return RTLS_FAIL;
+  }
+
+  // The array must be in the pattern, and its pair angles must be computed
+  arrayActive = AOA_IS_DUAL_ARRAY() ||
+                ((pReq->antenna == ANT_ARRAY_A1x) && IS_AOA_CONFIG_ONLY_ANT_1(gAoaCb.sampleCtrl)) ||
+                ((pReq->antenna == ANT_ARRAY_A2x) && IS_AOA_CONFIG_ONLY_ANT_2(gAoaCb.sampleCtrl));
+
+  if ((pReq->antenna != ANT_ARRAY_A1x && pReq->antenna != ANT_ARRAY_A2x) || AOA_IS_HOST_ARRAY() || !arrayActive ||
+      (gAoaCb.resultMode != AOA_MODE_ANGLE && gAoaCb.resultMode != AOA_MODE_PAIR_ANGLES))
+  {
+    return RTLS_CONFIG_NOT_SUPPORTED;
+  }
+
+  if ((gAoaCb.pCalCapture = RTLSCtrl_malloc(sizeof(AoA_CalCapture_t))) == NULL)
+  {
+    return RTLS_OUT_OF_MEMORY;
+  }
+
+  // The array angle is the mean of the two pairs of neighbouring elements, as in RTLSCtrl_estimateAngle
+  AOA_calCaptureInit(gAoaCb.pCalCapture, CALC_NUM_ANT_PAIRS(BOOSTXL_AOA_NUM_ANT), 2, pReq->angle);
+
+  gAoaCb.calConnHandle = pReq->connHandle;
+  gAoaCb.calNumCtes = pReq->numCtes;
+  gAoaCb.calAntenna = pReq->antenna;
+  gAoaCb.calFlags = pReq->flags;
+
+  return RTLS_SUCCESS;
+}
+
+/*********************************************************************
+* @fn      RTLSCtrl_addAoaCalibration
+*
+* @brief   Add the pair angles of a CTE to the calibration capture
+*
+* @param   connHandle - connection handle of the CTE
+* @param   channel - channel of the CTE
+*
+* @return  none
+*/
+void RTLSCtrl_addAoaCalibration(uint16_t connHandle, uint8_t channel)
+{
+  const int16_t *pairAngle;
+
+  if ((gAoaCb.pCalCapture == NULL) || (connHandle != gAoaCb.calConnHandle))
+  {
+    return;
   }
 
-  // Antenna array is selected according to sampleCtrl
-  // 1. Either A1 or A2 are selected constantly according to configuration
-  if (selectedAntenna == ANT_ARRAY_A1x)
+  // The A2 pairs follow the A1 pairs when both arrays are in the pattern
+  pairAngle = gAoaCb.connResInfo[connHandle].aoaResults.pairAngle;
+
+  if (AOA_IS_DUAL_ARRAY() && (gAoaCb.calAntenna == ANT_ARRAY_A2x))
   {
-    // Use AoA from Antenna Array A1
-    gAoaCb.connResInfo[connHandle].AoA_ma.array[gAoaCb.connResInfo[connHandle].AoA_ma.idx] = AoA_A1;
-    gAoaCb.connResInfo[connHandle].AoA_ma.currentAoA = AoA_A1;
-    gAoaCb.connResInfo[connHandle].AoA_ma.currentAntennaArray = ANT_ARRAY_A1x;
-    AoA.currentangle = AoA_A1;
+    pairAngle += AOA_DUAL_A2_PAIR;
   }
-  // Signal strength is higher on A2 vs A1
-  else
+
+  AOA_calCaptureAdd(gAoaCb.pCalCapture, channel, pairAngle);
+
+  if (gAoaCb.pCalCapture->numCtes >= gAoaCb.calNumCtes)
   {
-    // Use AoA from Antenna Array A2
-    gAoaCb.connResInfo[connHandle].AoA_ma.array[gAoaCb.connResInfo[connHandle].AoA_ma.idx] = AoA_A2;
-    gAoaCb.connResInfo[connHandle].AoA_ma.currentAoA = AoA_A2;
-    gAoaCb.connResInfo[connHandle].AoA_ma.currentAntennaArray = ANT_ARRAY_A2x;
-    AoA.currentangle = AoA_A2;
+    RTLSCtrl_finishAoaCalibration();
   }
+}
+
+/*********************************************************************
+* @fn      RTLSCtrl_finishAoaCalibration
+*
+* @brief   Learn the calibration of the capture, report it and apply it if requested
+*
+* @return  none
+*/
+void RTLSCtrl_finishAoaCalibration(void)
+{
+  const AoA_CalCapture_t *pCap = gAoaCb.pCalCapture;
+  const uint8_t antenna = gAoaCb.calAntenna;
+  AoA_AntennaConfig_t *pBoardConfig = (antenna == ANT_ARRAY_A1x) ? getAntennaArray1Config() : getAntennaArray2Config();
+  rtlsAoaCalibrationResult_t *pResult;
+  uint16_t gain[AOA_CAL_CAPTURE_MAX_PAIRS];
+  uint16_t resultLen;
+
+  resultLen = sizeof(rtlsAoaCalibrationResult_t) + pCap->numPairs * sizeof(uint16_t);
 
-  gAoaCb.connResInfo[connHandle].AoA_ma.currentRssi = gAoaCb.connResInfo[connHandle].aoaResults.rssi;
-  gAoaCb.connResInfo[connHandle].AoA_ma.currentCh = gAoaCb.connResInfo[connHandle].aoaResults.ch;
+  if ((pResult = RTLSCtrl_malloc(resultLen)) == NULL)
+  {
+    RTLSCtrl_stopAoaCalibration();
+    return;
+  }
 
-  // Add new AoA to moving average
-  gAoaCb.connResInfo[connHandle].AoA_ma.array[gAoaCb.connResInfo[connHandle].AoA_ma.idx] = gAoaCb.connResInfo[connHandle].AoA_ma.currentAoA;
+  // Channels without enough CTEs keep the offset they have at the reference angle
+  for (uint8_t ch = 0; ch < AOA_CAL_NUM_CHANNELS; ch++)
+  {
+    pResult->offset[ch] = (int8_t)RTLSCtrl_getCalOffset(antenna, ch, pCap->refAngle);
+    pResult->count[ch] = (pCap->count[ch] > UINT8_MAX) ? UINT8_MAX : pCap->count[ch];
+  }
 
-  if (gAoaCb.connResInfo[connHandle].AoA_ma.numEntries < AoA_ma_size)
+  for (uint8_t p = 0; p < pCap->numPairs; p++)
   {
-    gAoaCb.connResInfo[connHandle].AoA_ma.numEntries++;
+    gain[p] = pBoardConfig->pairs[p].gain;
   }
-  else
+
+  // A2 subtracts its offsets
+  AOA_calCaptureSolve(pCap, gain, (antenna == ANT_ARRAY_A1x) ? 1 : -1, pResult->offset);
+
+  pResult->connHandle = gAoaCb.calConnHandle;
+  pResult->antenna = antenna;
+  pResult->angle = pCap->refAngle;
+  pResult->flags = gAoaCb.calFlags;
+  pResult->numPairs = pCap->numPairs;
+
+  for (uint8_t p = 0; p < pCap->numPairs; p++)
+  {
+    pResult->gain[p] = gain[p];
+  }
+
+  if ((gAoaCb.calFlags & AOA_CALIBRATE_APPLY_GAINS) != 0)
+  {
+    for (uint8_t p = 0; p < pCap->numPairs; p++)
+    {
+      pBoardConfig->pairs[p].gain = gain[p];
+
+      // Both arrays use a copy of the pairs
+      gAoaCb.dualArrayPairs[((antenna == ANT_ARRAY_A1x) ? 0 : AOA_DUAL_A2_PAIR) + p].gain = gain[p];
+    }
+  }
+
+  if (((gAoaCb.calFlags & AOA_CALIBRATE_APPLY_OFFSETS) != 0) &&
+      (RTLSCtrl_loadCalibration(antenna, 1, 0, 0, pResult->offset) != RTLS_SUCCESS))
   {
-    gAoaCb.connResInfo[connHandle].AoA_ma.numEntries = AoA_ma_size;
+    pResult->flags &= ~AOA_CALIBRATE_APPLY_OFFSETS;
   }
 
-  // Calculate new moving average
-  gAoaCb.connResInfo[connHandle].AoA_ma.AoAsum = 0;
+  RTLSHost_sendMsg(RTLS_CMD_AOA_CALIBRATION_RESULT, HOST_ASYNC_RSP, (uint8_t *)pResult, resultLen);
 
-  for (uint8_t i = 0; i < gAoaCb.connResInfo[connHandle].AoA_ma.numEntries; i++)
+  RTLSUTIL_FREE(pResult);
+  RTLSCtrl_stopAoaCalibration();
+}
+
+/*********************************************************************
+* @fn      RTLSCtrl_stopAoaCalibration
+*
+* @brief   Drop the calibration capture
+*
+* @return  none
+*/
+void RTLSCtrl_stopAoaCalibration(void)
+{
+  if (gAoaCb.pCalCapture)
   {
-    gAoaCb.connResInfo[connHandle].AoA_ma.AoAsum += gAoaCb.connResInfo[connHandle].AoA_ma.array[i];
+    RTLSUTIL_FREE(gAoaCb.pCalCapture);
   }
-  gAoaCb.connResInfo[connHandle].AoA_ma.AoA = gAoaCb.connResInfo[connHandle].AoA_ma.AoAsum / gAoaCb.connResInfo[connHandle].AoA_ma.numEntries;
+}
+
+/*********************************************************************
+* @fn      RTLSCtrl_loadCalibration
+*
+* @brief   Convert offsets to the calibration table of an array and replace its table
+*
+* @param   antenna - ANT_ARRAY_A1x/ANT_ARRAY_A2x
+* @param   numBins - angle bins per channel
+* @param   startAngle - angle of the first bin in degrees
+* @param   stepAngle - degrees between two bins
+* @param   pOffsets - AOA_CAL_NUM_CHANNELS rows of numBins offsets
+*
+* @return  status - RTLS_CONFIG_NOT_SUPPORTED/RTLS_OUT_OF_MEMORY/RTLS_SUCCESS
+*/
+rtlsStatus_e RTLSCtrl_loadCalibration(uint8_t antenna, uint8_t numBins, int16_t startAngle, uint8_t stepAngle, const int8_t *pOffsets)
+{
+  AoA_CalTable_t *pCal = AOA_CAL_TABLE(antenna);
+  AoA_CalPoint_t *pOldPoints = pCal->pPoints;
+  AoA_CalTable_t cal;
 
-  // Update moving average index
-  if (gAoaCb.connResInfo[connHandle].AoA_ma.idx >= (AoA_ma_size - 1))
+  if ((cal.pPoints = RTLSCtrl_malloc(AOA_CAL_SIZE(numBins))) == NULL)
   {
-    gAoaCb.connResInfo[connHandle].AoA_ma.idx = 0;
+    return RTLS_OUT_OF_MEMORY;
   }
-  else
+
+  // Slopes are computed here, angles are corrected without a division
+  if (AOA_calInit(&cal, cal.pPoints, numBins, startAngle, stepAngle, pOffsets) == FALSE)
   {
-    gAoaCb.connResInfo[connHandle].AoA_ma.idx++;
+    RTLSUTIL_FREE(cal.pPoints);
+    return RTLS_CONFIG_NOT_SUPPORTED;
   }
 
-  // Return results
-  AoA.angle = gAoaCb.connResInfo[connHandle].AoA_ma.AoA;
-  AoA.rssi = gAoaCb.connResInfo[connHandle].AoA_ma.currentRssi;
-  AoA.channel = gAoaCb.connResInfo[connHandle].AoA_ma.currentCh;
-  AoA.antenna =  gAoaCb.connResInfo[connHandle].AoA_ma.currentAntennaArray;
+  // Angles are estimated in the task the host commands run in, no capture sees half a table
+  *pCal = cal;
 
-  return AoA;
+  if (pOldPoints)
+  {
+    RTLSUTIL_FREE(pOldPoints);
+  }
+
+  return RTLS_SUCCESS;
+}
+
+/*********************************************************************
+* @fn      RTLSCtrl_getCalOffset
+*
+* @brief   Calibration offset of a BOOSTXL-AOA array angle
+*
+* @param   antenna - ANT_ARRAY_A1x/ANT_ARRAY_A2x
+* @param   channel - channel the angle was measured on
+* @param   angle - array angle before the board rotation
+*
+* @return  offset in degrees, 0 without a table
+*/
+int16_t RTLSCtrl_getCalOffset(uint8_t antenna, uint8_t channel, int16_t angle)
+{
+  const AoA_CalTable_t *pCal = AOA_CAL_TABLE(antenna);
+
+  if (pCal->pPoints == NULL)
+  {
+    return 0;
+  }
+
+  return AOA_calGetOffset(pCal, channel, angle);
+}
+
+/*********************************************************************
+* @fn      RTLSCtrl_initHostArray
+*
+* @brief   Build the antenna configuration of an array described by the host
+*
+* @param   numAnt - number of antennas in the pattern
+* @param   pArrayDesc - array description following the pattern
+*
+* @return  status - RTLS_CONFIG_NOT_SUPPORTED/RTLS_OUT_OF_MEMORY/RTLS_SUCCESS
+*/
+rtlsStatus_e RTLSCtrl_initHostArray(uint8_t numAnt, rtlsAoaArrayDesc_t *pArrayDesc)
+{
+#ifdef RTLS_PASSIVE
+  // The passive capture and antenna switching are laid out for the BOOSTXL-AOA arrays
+  return RTLS_CONFIG_NOT_SUPPORTED;
+#else // RTLS_MASTER
+  const uint8_t numElements = pArrayDesc->numElements;
+  AoA_AntennaConfig_t config;
+  AoA_AntennaPair_t *pairs;
+  uint8_t *pElement;
+  float *pPosition;
+
+  if ((numAnt > AOA_MAX_NUM_ANT) || (numElements < 2) || (numElements > numAnt))
+  {
+    return RTLS_CONFIG_NOT_SUPPORTED;
+  }
+
+  // The previous array stays active until the new one is complete
+  pairs = (AoA_AntennaPair_t *)RTLSCtrl_malloc(sizeof(AoA_AntennaPair_t) * CALC_NUM_ANT_PAIRS(numElements));
+  pElement = (uint8_t *)RTLSCtrl_malloc(sizeof(uint8_t) * numAnt);
+  pPosition = (float *)RTLSCtrl_malloc(sizeof(float) * numElements);
+
+  config.pairs = pairs;
+  config.pElement = pElement;
+  config.pPosition = pPosition;
+
+  if ((pairs == NULL) || (pElement == NULL) || (pPosition == NULL))
+  {
+    RTLSCtrl_freeHostArray(&config);
+    return RTLS_OUT_OF_MEMORY;
+  }
+
+  memcpy(pElement, pArrayDesc->data, numAnt);
+
+  for (uint8_t i = 0; i < numElements; i++)
+  {
+    int16_t position;
+
+    // Positions are not aligned in the host message
+    memcpy(&position, &pArrayDesc->data[numAnt + i * sizeof(int16_t)], sizeof(int16_t));
+    pPosition[i] = (float)position / AOA_ARRAY_POSITION_SCALE;
+  }
+
+  // Every element has to be in the pattern
+  if (AOA_initArrayConfig(&config, numAnt, numElements, pElement, pPosition, pairs) == FALSE)
+  {
+    RTLSCtrl_freeHostArray(&config);
+    return RTLS_CONFIG_NOT_SUPPORTED;
+  }
+
+  RTLSCtrl_freeHostArray(&gAoaCb.hostArrayConfig);
+  gAoaCb.hostArrayConfig = config;
+
+  return RTLS_SUCCESS;
+#endif
+}
+
+/*********************************************************************
+* @fn      RTLSCtrl_initDualArray
+*
+* @brief   Build the antenna configuration of both BOOSTXL-AOA arrays in one pattern
+*
+*          The pattern switches through A1 and then A2, so one pass of
+*          AOA_getPairAngles over the capture gives the pairs of both arrays.
+*
+* @param   numAnt - number of antennas in pAntPattern
+* @param   pAntPattern - antenna pattern provided by the user
+* @param   resultMode - AOA_MODE_ANGLE/AOA_MODE_PAIR_ANGLES
+*
+* @return  status - RTLS_CONFIG_NOT_SUPPORTED/RTLS_SUCCESS
+*/
+rtlsStatus_e RTLSCtrl_initDualArray(uint8_t numAnt, uint8_t *pAntPattern, aoaResultMode_e resultMode)
+{
+#ifdef RTLS_PASSIVE
+  // The passive antenna switching stays on the array selected by AOA_init
+  return RTLS_CONFIG_NOT_SUPPORTED;
+#else // RTLS_MASTER
+  const AoA_AntennaConfig_t *pConfigA1 = getAntennaArray1Config();
+  const AoA_AntennaConfig_t *pConfigA2 = getAntennaArray2Config();
+
+  // The arrays lie on different axes, there is no linear steering vector for the spectrum
+  if ((numAnt != AOA_DUAL_NUM_ANT) || (resultMode == AOA_MODE_SPECTRUM))
+  {
+    return RTLS_CONFIG_NOT_SUPPORTED;
+  }
+
+  // Antennas 0, 1, 2 are A1 and 3, 4, 5 are A2, in this exact order
+  for (int i = 0; i < numAnt; i++)
+  {
+    if (pAntPattern[i] != i)
+    {
+      return RTLS_CONFIG_NOT_SUPPORTED;
+    }
+  }
+
+  // A1 pairs as they are, A2 pairs moved to the slots of A2
+  for (int i = 0; i < AOA_DUAL_A2_PAIR; i++)
+  {
+    gAoaCb.dualArrayPairs[i] = pConfigA1->pairs[i];
+    gAoaCb.dualArrayPairs[AOA_DUAL_A2_PAIR + i] = pConfigA2->pairs[i];
+    gAoaCb.dualArrayPairs[AOA_DUAL_A2_PAIR + i].a += BOOSTXL_AOA_NUM_ANT;
+    gAoaCb.dualArrayPairs[AOA_DUAL_A2_PAIR + i].b += BOOSTXL_AOA_NUM_ANT;
+  }
+
+  gAoaCb.dualArrayConfig.numAntennas = AOA_DUAL_NUM_ANT;
+  gAoaCb.dualArrayConfig.numPairs = AOA_DUAL_NUM_PAIRS;
+  gAoaCb.dualArrayConfig.pairs = gAoaCb.dualArrayPairs;
+  gAoaCb.dualArrayConfig.channelOffset = NULL;
+  gAoaCb.dualArrayConfig.numElements = AOA_DUAL_NUM_ANT;
+  gAoaCb.dualArrayConfig.pElement = NULL;
+  gAoaCb.dualArrayConfig.pPosition = NULL;
+
+  return RTLS_SUCCESS;
+#endif
+}
+
+/*********************************************************************
+* @fn      RTLSCtrl_freeHostArray
+*
+* @brief   Free the tables of an array described by the host
+*
+* @param   pConfig - antenna configuration built by RTLSCtrl_initHostArray
+*
+* @return  none
+*/
+void RTLSCtrl_freeHostArray(AoA_AntennaConfig_t *pConfig)
+{
+  if (pConfig->pairs)
+  {
+    RTLSUTIL_FREE(pConfig->pairs);
+  }
+
+  if (pConfig->pElement)
+  {
+    RTLSUTIL_FREE(pConfig->pElement);
+  }
+
+  if (pConfig->pPosition)
+  {
+    RTLSUTIL_FREE(pConfig->pPosition);
+  }
+}
+
+/*********************************************************************
+* @fn      RTLSCtrl_allocAoaResults
+*
+* @brief   Size the result storage for the active antenna configuration
+*
+* @return  status - RTLS_OUT_OF_MEMORY/RTLS_SUCCESS
+*/
+rtlsStatus_e RTLSCtrl_allocAoaResults(void)
+{
+  const uint8_t numPairs = gAoaCb.antArrayConfig->numPairs;
+  const uint8_t numElements = gAoaCb.antArrayConfig->numElements;
+
+  for (int i = 0; i < gAoaCb.maxConnections; i++)
+  {
+    // Pair Angles result arrays for each connection
+    if (numPairs != gAoaCb.numPairs)
+    {
+      if (gAoaCb.connResInfo[i].aoaResults.pairAngle)
+      {
+        RTLSUTIL_FREE(gAoaCb.connResInfo[i].aoaResults.pairAngle);
+      }
+
+      gAoaCb.connResInfo[i].aoaResults.pairAngle = (int16_t *)RTLSCtrl_malloc(sizeof(int16_t) * numPairs);
+
+      if (gAoaCb.connResInfo[i].aoaResults.pairAngle == NULL)
+      {
+        AssertHandler(RTLS_CTRL_ASSERT_CAUSE_OUT_OF_MEMORY, 0);
+      }
+    }
+
+    memset(gAoaCb.connResInfo[i].aoaResults.pairAngle, 0, sizeof(int16_t) * numPairs);
+
+    // The covariance average belongs to the previous array, restart it on the next capture
+    if (gAoaCb.connResInfo[i].pCovariance)
+    {
+      RTLSUTIL_FREE(gAoaCb.connResInfo[i].pCovariance);
+    }
+  }
+
+  gAoaCb.numPairs = numPairs;
+
+  if (gAoaCb.pCovScratch)
+  {
+    RTLSUTIL_FREE(gAoaCb.pCovScratch);
+  }
+
+  if (gAoaCb.pCovWork)
+  {
+    RTLSUTIL_FREE(gAoaCb.pCovWork);
+  }
+
+  if (gAoaCb.pSteer)
+  {
+    RTLSUTIL_FREE(gAoaCb.pSteer);
+  }
+
+  if (gAoaCb.pPairQuality)
+  {
+    RTLSUTIL_FREE(gAoaCb.pPairQuality);
+  }
+
+  // Shared by all connections, the extended result is sent before the next capture is processed
+  if ((gAoaCb.resultMode == AOA_MODE_ANGLE) || (gAoaCb.resultMode == AOA_MODE_PAIR_ANGLES))
+  {
+    if ((gAoaCb.pPairQuality = (AoA_PairQuality_t *)RTLSCtrl_malloc(sizeof(AoA_PairQuality_t) * numPairs)) == NULL)
+    {
+      return RTLS_OUT_OF_MEMORY;
+    }
+  }
+
+  if (gAoaCb.resultMode != AOA_MODE_SPECTRUM)
+  {
+    return RTLS_SUCCESS;
+  }
+
+  // Sized by the array, too large for the RTLS task stack
+  gAoaCb.pCovScratch = (AoA_Covariance_t *)RTLSCtrl_malloc(AOA_COV_SIZE(numElements));
+  gAoaCb.pCovWork = (AoA_Covariance_t *)RTLSCtrl_malloc(AOA_COV_SIZE(numElements));
+  gAoaCb.pSteer = (AoA_Steer_t *)RTLSCtrl_malloc(AOA_SPECTRUM_STEER_SIZE(numElements));
+
+  if ((gAoaCb.pCovScratch == NULL) || (gAoaCb.pCovWork == NULL) || (gAoaCb.pSteer == NULL))
+  {
+    return RTLS_OUT_OF_MEMORY;
+  }
+
+  gAoaCb.pCovScratch->numAnt = numElements;
+  gAoaCb.pCovScratch->valid = FALSE;
+  gAoaCb.pCovWork->numAnt = numElements;
+  gAoaCb.pCovWork->valid = FALSE;
+
+  // The steering table follows the selected array
+  AOA_spectrumInit(gAoaCb.antArrayConfig, gAoaCb.pSteer);
+
+  return RTLS_SUCCESS;
 }
 
 /*********************************************************************
@@ -472,21 +1907,44 @@ AoA_Sample_t RTLSCtrl_estimateAngle(uint16_t connHandle, uint8_t sampleCtrl)
 * @param   maxConnections - number of connections we need to keep results for
 * @param   numAnt - number of antennas in pAntPattern
 * @param   pAntPattern - antenna pattern provided by the user
-* @param   resultMode - AOA_MODE_ANGLE/AOA_MODE_PAIR_ANGLES/AOA_MODE_RAW
+* @param   resultMode - AOA_MODE_ANGLE/AOA_MODE_PAIR_ANGLES/AOA_MODE_RAW/AOA_MODE_SPECTRUM
+* @param   sampleRate - sample rate the captures will use (1,2,3 or 4 Mhz)
+* @param   sampleSize - sample size 1 = 8 bit, 2 = 16 bit
+* @param   slotDuration - slot duration 1 = 1us, 2 = 2us
+* @param   pArrayDesc - array described by the host, NULL for the BOOSTXL-AOA arrays
 *
-* @return  status - RTLS_AOA_CONFIG_NOT_SUPPORTED/RTLS_SUCCESS
+* @return  status - RTLS_AOA_CONFIG_NOT_SUPPORTED/RTLS_OUT_OF_MEMORY/RTLS_SUCCESS
 */
-rtlsStatus_e RTLSCtrl_initAoa(uint8_t maxConnections, uint8_t sampleCtrl, uint8_t numAnt, uint8_t *pAntPattern, aoaResultMode_e resultMode)
+rtlsStatus_e RTLSCtrl_initAoa(uint8_t maxConnections, uint8_t sampleCtrl, uint8_t numAnt, uint8_t *pAntPattern, aoaResultMode_e resultMode,
+                              uint8_t sampleRate, uint8_t sampleSize, uint8_t slotDuration, rtlsAoaArrayDesc_t *pArrayDesc)
 {
-  // Set result mode
-  gAoaCb.resultMode = resultMode;
+  rtlsStatus_e status;
+  bool hostArray = (pArrayDesc != NULL) && (resultMode != AOA_MODE_RAW);
+  bool dualArray = !hostArray && (resultMode != AOA_MODE_RAW) &&
+                   !IS_AOA_CONFIG_ONLY_ANT_1(sampleCtrl) && !IS_AOA_CONFIG_ONLY_ANT_2(sampleCtrl);
 
   // Check that a correct configuration was provided
   // The current configuration supported by rtls_ctrl_aoa post process module is either:
-  // 1. sampleCtrl defines antenna array 1 && pAntPattern contains antenna ID's 0, 1, 2 (in this exact order)
-  // 2. sampleCtrl defines antenna array 2 && pAntPattern contains antenna ID's 3, 4, 5 (in this exact order)
+  // 1. pArrayDesc describes the array the pattern switches through (up to AOA_MAX_NUM_ANT antennas)
+  // 2. sampleCtrl defines antenna array 1 && pAntPattern contains antenna ID's 0, 1, 2 (in this exact order)
+  // 3. sampleCtrl defines antenna array 2 && pAntPattern contains antenna ID's 3, 4, 5 (in this exact order)
+  // 4. sampleCtrl defines both antenna arrays && pAntPattern contains antenna ID's 0, 1, 2, 3, 4, 5 (in this exact order)
   // Note: Result mode is AOA_MODE_RAW (post processing done by the user) is allowed with any antenna pattern
-  if (gAoaCb.resultMode != AOA_MODE_RAW)
+  if (hostArray)
+  {
+    if ((status = RTLSCtrl_initHostArray(numAnt, pArrayDesc)) != RTLS_SUCCESS)
+    {
+      return status;
+    }
+  }
+  else if (dualArray)
+  {
+    if ((status = RTLSCtrl_initDualArray(numAnt, pAntPattern, resultMode)) != RTLS_SUCCESS)
+    {
+      return status;
+    }
+  }
+  else if (resultMode != AOA_MODE_RAW)
   {
     for (int i = 0; i < numAnt; i++)
     {
@@ -511,6 +1969,12 @@ rtlsStatus_e RTLSCtrl_initAoa(uint8_t maxConnections, uint8_t sampleCtrl, uint8_
     }
   }
 
+  // A calibration capture of the previous configuration would mix its angles with the new ones
+  RTLSCtrl_stopAoaCalibration();
+
+  // Set result mode
+  gAoaCb.resultMode = resultMode;
+
   // Check if we are already initialized
   if (gAoaCb.connResInfo == NULL)
   {
@@ -524,26 +1988,64 @@ rtlsStatus_e RTLSCtrl_initAoa(uint8_t maxConnections, uint8_t sampleCtrl, uint8_
 
     memset(gAoaCb.connResInfo, 0, sizeof(AoA_connInfo_t) * maxConnections);
 
-    // Initialize Pair Angles result arrays for each connection
-    for (int i = 0; i < maxConnections; i ++)
-    {
-      gAoaCb.connResInfo[i].aoaResults.pairAngle = (int16_t *)RTLSCtrl_malloc(sizeof(int16_t) * CALC_NUM_ANT_PAIRS(BOOSTXL_AOA_NUM_ANT));
+    gAoaCb.maxConnections = maxConnections;
 
-      if (gAoaCb.connResInfo[i].aoaResults.pairAngle == NULL)
-      {
-        AssertHandler(RTLS_CTRL_ASSERT_CAUSE_OUT_OF_MEMORY, 0);
-      }
+    // Connections start with the legacy moving average until the host selects a filter
+    for (int i = 0; i < maxConnections; i++)
+    {
+      AoA_TrackParams_t params;
 
-      memset(gAoaCb.connResInfo[i].aoaResults.pairAngle, 0, sizeof(int16_t) * BOOSTXL_AOA_NUM_ANT);
+      AOA_trackDefaultParams(&params);
+      AOA_trackInit(&gAoaCb.connResInfo[i].AoA_track.track, &params);
+      AOA_trackInit(&gAoaCb.connResInfo[i].AoA_track.elevationTrack, &params);
+    }
+  }
+  else
+  {
+    // Angles of the previous configuration may be in another frame, keep the filters but restart them
+    for (int i = 0; i < gAoaCb.maxConnections; i++)
+    {
+      AOA_trackReset(&gAoaCb.connResInfo[i].AoA_track.track);
+      AOA_trackReset(&gAoaCb.connResInfo[i].AoA_track.elevationTrack);
+      AOA_reportReset(&gAoaCb.connResInfo[i].report);
     }
   }
 
   // Save sampleCtrl flags
   gAoaCb.sampleCtrl = sampleCtrl;
 
+  // Arrays without a table from the host use their built-in channel offsets, measured at 0 degrees
+  if (!hostArray)
+  {
+    if ((AOA_CAL_TABLE(ANT_ARRAY_A1x)->pPoints == NULL) &&
+        ((status = RTLSCtrl_loadCalibration(ANT_ARRAY_A1x, 1, 0, 0, getAntennaArray1ChannelOffsets())) != RTLS_SUCCESS))
+    {
+      return status;
+    }
+
+    if ((AOA_CAL_TABLE(ANT_ARRAY_A2x)->pPoints == NULL) &&
+        ((status = RTLSCtrl_loadCalibration(ANT_ARRAY_A2x, 1, 0, 0, getAntennaArray2ChannelOffsets())) != RTLS_SUCCESS))
+    {
+      return status;
+    }
+  }
+
   // Configurations included from antenna array files
-  if (IS_AOA_CONFIG_ONLY_ANT_1(gAoaCb.sampleCtrl))
+  if (hostArray)
+  {
+    gAoaCb.antArrayConfig = &gAoaCb.hostArrayConfig;
+  }
+  else if (dualArray)
   {
+    RTLSCtrl_freeHostArray(&gAoaCb.hostArrayConfig);
+
+    // Pairs of both arrays, each keeps the calibration of its own array
+    gAoaCb.antArrayConfig = &gAoaCb.dualArrayConfig;
+  }
+  else if (IS_AOA_CONFIG_ONLY_ANT_1(gAoaCb.sampleCtrl))
+  {
+    RTLSCtrl_freeHostArray(&gAoaCb.hostArrayConfig);
+
     // Set BOOSTXL-AOA A1.x config
     gAoaCb.antArrayConfig = getAntennaArray1Config();
 
@@ -557,6 +2059,8 @@ rtlsStatus_e RTLSCtrl_initAoa(uint8_t maxConnections, uint8_t sampleCtrl, uint8_
   }
   else
   {
+    RTLSCtrl_freeHostArray(&gAoaCb.hostArrayConfig);
+
     // Set BOOSTXL-AOA A2.x config
     gAoaCb.antArrayConfig = getAntennaArray2Config();
 
@@ -569,5 +2073,21 @@ rtlsStatus_e RTLSCtrl_initAoa(uint8_t maxConnections, uint8_t sampleCtrl, uint8_
 #endif
   }
 
+  // Pair angles, covariances and the steering table are sized by the array
+  if ((status = RTLSCtrl_allocAoaResults()) != RTLS_SUCCESS)
+  {
+    return status;
+  }
+
+#ifdef RTLS_MASTER
+  // The capture configuration is fixed from here on, pick the angle kernel built for it once
+  gAoaCb.sampleRate = sampleRate;
+  gAoaCb.sampleSize = sampleSize;
+  gAoaCb.slotDuration = slotDuration;
+  gAoaCb.numAnt = numAnt;
+
+  RTLSCtrl_selectAoaKernel();
+#endif
+
   return RTLS_SUCCESS;
 }
@@ -67,6 +67,13 @@ extern "C"
 
 #include "rtls_aoa_api.h"
 #include "AOA.h"
+#include "AOA_spectrum.h"
+#include "AOA_track.h"
+#include "AOA_report.h"
+#include "AOA_raw.h"
+#include "AOA_iq.h"
+#include "AOA_rfRam.h"
+#include "AOA_cal.h"
 #include "rtls_ctrl_api.h"
 #include "rtls_ctrl.h"
 
@@ -78,7 +85,12 @@ extern "C"
  * CONSTANTS
  */
 
-#define MAX_SAMPLES_SINGLE_CHUNK 32    //!< Max number of samples reported in a single chunk when using RAW mode
+// Report the spectrum bins along with the peak angle in AOA_MODE_SPECTRUM
+#ifndef AOA_SPECTRUM_REPORT_BINS
+#define AOA_SPECTRUM_REPORT_BINS 1
+#endif
+
+#define AOA_ARRAY_POSITION_SCALE 1024  //!< Units of rtlsAoaArrayDesc_t positions per wavelength
 
 /*********************************************************************
  * MACROS
@@ -97,18 +109,168 @@ typedef enum
 {
   AOA_MODE_ANGLE,
   AOA_MODE_PAIR_ANGLES,
-  AOA_MODE_RAW
+  AOA_MODE_RAW,
+  AOA_MODE_SPECTRUM
 } aoaResultMode_e;
 
+/// @brief Handling of a capture AOA_screenCapture finds unusable
+typedef enum
+{
+  AOA_SCREEN_OFF,             //!< Captures are not screened
+  AOA_SCREEN_DISCARD,         //!< Unusable captures are dropped before the angle path
+  AOA_SCREEN_FLAG             //!< Unusable captures are reported but kept out of the tracking, averaging and calibration state
+} aoaScreenAction_e;
+
 // AoA Parameters - Received from RTLS Node Manager
 /// @brief List of AoA parameters
 typedef struct __attribute__((packed))
 {
   AoA_Role_t aoaRole;         //!< AOA_MASTER, AOA_SLAVE, AOA_PASSIVE
-  aoaResultMode_e resultMode; //!< AOA_MODE_ANGLE, AOD_MODE_PAIR_ANGLES, AOA_MODE_RAW
+  aoaResultMode_e resultMode; //!< AOA_MODE_ANGLE, AOD_MODE_PAIR_ANGLES, AOA_MODE_RAW, AOA_MODE_SPECTRUM
   rtlsAoaConfigReq_t config;  //!< Configuration that will be passed to RTLS Application
 } rtlsAoaParams_t;
 
+/// @brief Array description, optionally follows pAntPattern[numAnt] of rtlsAoaParams_t
+///
+/// data[] holds, in this order:
+///  - uint8_t element[numAnt]: array element of every pattern slot, an element may be switched to more than once
+///  - int16_t position[numElements]: element position along the array axis in 1/AOA_ARRAY_POSITION_SCALE wavelengths
+///
+/// Without a description the pattern must select one of the BOOSTXL-AOA arrays.
+typedef struct __attribute__((packed))
+{
+  uint8_t numElements;        //!< Number of array elements, 2 - AOA_MAX_NUM_ANT
+  uint8_t data[];             //!< Element of every pattern slot followed by the element positions
+} rtlsAoaArrayDesc_t;
+
+/// @brief Angle tracking filter of a connection, data of RTLS_PARAM_AOA_TRACK
+///
+/// Filters step once per CTE. Fields that do not belong to the selected filter are ignored.
+typedef struct __attribute__((packed))
+{
+  uint8_t  type;              //!< AOA_TRACK_MOVING_AVG/AOA_TRACK_ALPHA_BETA/AOA_TRACK_KALMAN
+  uint8_t  window;            //!< Moving average: number of angles, 1 - AOA_TRACK_MAX_WINDOW
+  uint16_t alpha;             //!< Alpha-beta: angle gain, Q15, 1 - 32768
+  uint16_t beta;              //!< Alpha-beta: velocity gain, Q15, 0 - 32768
+  uint16_t measVar;           //!< Kalman: angle measurement variance in deg^2
+  uint16_t accelVar;          //!< Kalman: angular acceleration variance in 1/256 deg^2 per CTE^4
+} rtlsAoaTrackParams_t;
+
+/// @brief Capture screening, data of RTLS_PARAM_AOA_SCREEN
+///
+/// Applies to all connections, the connection handle of the request is ignored.
+typedef struct __attribute__((packed))
+{
+  uint8_t action;             //!< AOA_SCREEN_OFF/AOA_SCREEN_DISCARD/AOA_SCREEN_FLAG
+  int8_t  maxPeakDb;          //!< Captures with a peak at or above this many dB of full scale are saturated
+  int8_t  minPowerDb;         //!< Captures with a reference power below this many dB of full scale are noise
+  uint8_t minLinearity;       //!< Captures with a less coherent reference tone are corrupted, 0 - 255
+} rtlsAoaScreenParams_t;
+
+/// @brief Extended results, data of RTLS_PARAM_AOA_QUALITY
+///
+/// Applies to all connections, the connection handle of the request is ignored.
+typedef struct __attribute__((packed))
+{
+  uint8_t enable;             //!< 1: AOA_MODE_ANGLE and AOA_MODE_PAIR_ANGLES report rtlsAoaResultExt_t, 0: their own results
+} rtlsAoaQualityParams_t;
+
+/// @brief Oversampling decimation, data of RTLS_PARAM_AOA_DECIMATION
+///
+/// Applies to all connections, the connection handle of the request is ignored.
+/// Filtered captures of RTLS Master are averaged down to sampleRate / factor
+/// before the angle path, factors that do not divide the sample rate are not used.
+typedef struct __attribute__((packed))
+{
+  uint8_t factor;             //!< Samples averaged into one, 1 - 4, 1 = off
+} rtlsAoaDecimationParams_t;
+
+/// @brief Result fusion, data of RTLS_PARAM_AOA_REPORT
+///
+/// Applies to all connections, the connection handle of the request is ignored.
+/// AOA_MODE_ANGLE results of a connection are averaged over window CTEs, which
+/// hop channels, and one result is sent per window. With minChange it is only
+/// sent when the angle or elevation moved that far since the last result sent.
+/// The angle, elevation and rssi of a sent result are fused, the channel is that
+/// of the last CTE. Flagged captures are left out unless every CTE is reported.
+typedef struct __attribute__((packed))
+{
+  uint8_t window;             //!< CTEs fused into one result, 1 - 255, 1 = every CTE
+  uint8_t minChange;          //!< Degrees, 0 - 180, 0 = send every window
+  uint8_t maxHold;            //!< Windows a result that did not move is held back at most, 0 = no limit
+} rtlsAoaReportParams_t;
+
+/// @brief RAW result format, data of RTLS_PARAM_AOA_RAW_FORMAT
+///
+/// Applies to all connections, the connection handle of the request is ignored.
+/// Packed AOA_MODE_RAW results are sent as rtlsAoaResultRawPacked_t with
+/// RTLS_CMD_AOA_RESULT_RAW_PACKED, every chunk describes its own format.
+typedef struct __attribute__((packed))
+{
+  uint8_t packed;             //!< 1: rtlsAoaResultRawPacked_t, 0: rtlsAoaResultRaw_t
+  uint8_t coding;             //!< AOA_RAW_CODING_NONE/AOA_RAW_CODING_DELTA, packed results only
+} rtlsAoaRawFormatParams_t;
+
+/// @brief Pair angle averaging, data of RTLS_PARAM_AOA_AVG_MODE
+///
+/// Applies to all connections, the connection handle of the request is ignored.
+/// AOA_AVG_MODE_PHASOR takes one angle per pair from the summed sample products,
+/// which holds up better than the mean of the angles at low SNR.
+typedef struct __attribute__((packed))
+{
+  uint8_t mode;               //!< AOA_AVG_MODE_ANGLE/AOA_AVG_MODE_PHASOR
+} rtlsAoaAvgModeParams_t;
+
+/// @brief Calibration table of a BOOSTXL-AOA array, data of RTLS_CMD_AOA_SET_CALIBRATION
+///
+/// offset[] holds AOA_CAL_NUM_CHANNELS rows of numBins offsets, row n is channel n.
+/// Offsets are in degrees with the sign of the built-in channel offsets of the array
+/// and are indexed by the array angle before the board rotation. The table replaces
+/// the built-in table of the array until the device is reset.
+typedef struct __attribute__((packed))
+{
+  uint8_t antenna;            //!< ANT_ARRAY_A1x/ANT_ARRAY_A2x
+  int8_t  startAngle;         //!< Angle of the first bin in degrees
+  uint8_t stepAngle;          //!< Degrees between two bins, ignored for a single bin
+  uint8_t numBins;            //!< Angle bins per channel, 1 - AOA_CAL_MAX_BINS
+  int8_t  offset[];           //!< Offsets by channel and angle bin
+} rtlsAoaCalibration_t;
+
+/// @brief Calibration capture flags of rtlsAoaCalibrate_t
+#define AOA_CALIBRATE_APPLY_OFFSETS  0x01  //!< Replace the calibration table of the array with the learned offsets
+#define AOA_CALIBRATE_APPLY_GAINS    0x02  //!< Replace the pair gains of the array with the learned gains
+
+/// @brief Start of a calibration capture, data of RTLS_CMD_AOA_CALIBRATE
+///
+/// A reference tag on connHandle sits at angle from the broadside of the array.
+/// Its CTEs in AOA_MODE_ANGLE or AOA_MODE_PAIR_ANGLES are added to the capture
+/// until numCtes CTEs were seen, then RTLS_CMD_AOA_CALIBRATION_RESULT is sent.
+/// numCtes 0 stops a running capture without a result.
+typedef struct __attribute__((packed))
+{
+  uint16_t connHandle;        //!< Connection of the reference tag
+  uint8_t  antenna;           //!< ANT_ARRAY_A1x/ANT_ARRAY_A2x
+  int8_t   angle;             //!< Angle of the reference tag from broadside in degrees
+  uint16_t numCtes;           //!< CTEs to capture on all channels
+  uint8_t  flags;             //!< AOA_CALIBRATE_APPLY_OFFSETS/AOA_CALIBRATE_APPLY_GAINS
+} rtlsAoaCalibrate_t;
+
+/// @brief Learned calibration, data of RTLS_CMD_AOA_CALIBRATION_RESULT
+///
+/// Offsets have the sign and layout of a single bin rtlsAoaCalibration_t. Channels
+/// with fewer than AOA_CAL_MIN_CTES CTEs keep the offset the array had at angle.
+typedef struct __attribute__((packed))
+{
+  uint16_t connHandle;                     //!< Connection of the reference tag
+  uint8_t  antenna;                        //!< ANT_ARRAY_A1x/ANT_ARRAY_A2x
+  int8_t   angle;                          //!< Angle of the reference tag from broadside in degrees
+  uint8_t  flags;                          //!< Flags of the request, the learned values they select are in use
+  int8_t   offset[AOA_CAL_NUM_CHANNELS];   //!< Offset per channel in degrees
+  uint8_t  count[AOA_CAL_NUM_CHANNELS];    //!< CTEs captured per channel, at most 255 are reported
+  uint8_t  numPairs;                       //!< Number of pair gains
+  uint16_t gain[];                         //!< Q15 gain per pair
+} rtlsAoaCalibrationResult_t;
+
 /// @brief AoA Angle Result
 typedef struct __attribute__((packed))
 {
@@ -119,6 +281,17 @@ typedef struct __attribute__((packed))
   uint8_t channel;           //!< The channel the samples were taken on
 } rtlsAoaResultAngle_t;
 
+/// @brief AoA Azimuth and Elevation Result, AOA_MODE_ANGLE with both BOOSTXL-AOA arrays
+typedef struct __attribute__((packed))
+{
+  uint16_t connHandle;       //!< Connection handle
+  int16_t azimuth;           //!< Azimuth in the frame of rtlsAoaResultAngle_t angles, -134 to 225, tracked and fused over the full circle
+  int16_t elevation;         //!< Elevation from the board plane, 0 to 90, either side of the board
+  int8_t  rssi;              //!< RSSI for the reported samples
+  uint8_t antenna;           //!< Array closer to broadside of the tag, ANT_ARRAY_A1x/ANT_ARRAY_A2x
+  uint8_t channel;           //!< The channel the samples were taken on
+} rtlsAoaResultAzEl_t;
+
 /// @brief AoA Antenna Pairs Result
 typedef struct __attribute__((packed))
 {
@@ -126,9 +299,57 @@ typedef struct __attribute__((packed))
   int8_t  rssi;                                                 //!< RSSI for the reported samples
   uint8_t antenna;                                              //!< Antenna the rssi was taken on
   uint8_t channel;                                              //!< The channel the samples were taken on
-  int16_t pairAngle[CALC_NUM_ANT_PAIRS(BOOSTXL_AOA_NUM_ANT)];   //!< AoA Antenna Pairs Result
+  int16_t pairAngle[];                                          //!< AoA Antenna Pairs Result, one per pair of the array
 } rtlsAoaResultPairAngles_t;
 
+/// @brief Capture flags of rtlsAoaResultExt_t
+#define AOA_RESULT_SATURATED         0x01  //!< The capture peak reached maxPeakDb of RTLS_PARAM_AOA_SCREEN
+#define AOA_RESULT_UNUSABLE          0x02  //!< The capture failed screening, the angle is not tracked
+
+/// @brief Pair angle and spread of rtlsAoaResultExt_t
+typedef struct __attribute__((packed))
+{
+  int16_t  angle;            //!< Pair angle as in rtlsAoaResultPairAngles_t
+  uint8_t  coherence;        //!< Length of the mean sample product over its bound, 255 if every product had the same phase
+  uint16_t phaseVar;         //!< Phase variance of one sample product in deg^2, 65535 for noise
+} rtlsAoaResultPair_t;
+
+/// @brief AoA Extended Result, AOA_MODE_ANGLE and AOA_MODE_PAIR_ANGLES with RTLS_PARAM_AOA_QUALITY
+///
+/// The spread of a pair angle is roughly sqrt(phaseVar / numSamples) degrees of phase.
+/// peakDb, powerDb and linearity are those of AOA_screenCapture.
+typedef struct __attribute__((packed))
+{
+  uint16_t connHandle;       //!< Connection handle
+  int16_t  angle;            //!< Angle or azimuth as in rtlsAoaResultAngle_t/rtlsAoaResultAzEl_t, 0 in AOA_MODE_PAIR_ANGLES
+  int16_t  elevation;        //!< Elevation as in rtlsAoaResultAzEl_t, 0 unless both BOOSTXL-AOA arrays are used
+  int8_t   rssi;             //!< RSSI for the reported samples
+  uint8_t  antenna;          //!< Antenna as in rtlsAoaResultAngle_t/rtlsAoaResultAzEl_t
+  uint8_t  channel;          //!< The channel the samples were taken on
+  uint8_t  flags;            //!< AOA_RESULT_SATURATED/AOA_RESULT_UNUSABLE
+  int8_t   peakDb;           //!< Largest I or Q magnitude in dB of full scale
+  int8_t   powerDb;          //!< Reference period power in dB of full scale
+  uint8_t  linearity;        //!< Coherence of the reference tone, 255 for a clean tone
+  uint16_t numSamples;       //!< Sample products every pair angle was averaged over
+  uint8_t  numPairs;         //!< Size of pair[]
+  rtlsAoaResultPair_t pair[];//!< Angle and spread of every pair of the array
+} rtlsAoaResultExt_t;
+
+/// @brief AoA Spectrum Result
+typedef struct __attribute__((packed))
+{
+  uint16_t connHandle;       //!< Connection handle
+  int16_t angle;             //!< Angle of the spectrum peak
+  int8_t  rssi;              //!< RSSI for the reported samples
+  uint8_t antenna;           //!< Antenna the rssi was taken on
+  uint8_t channel;           //!< The channel the samples were taken on
+  uint8_t method;            //!< AOA_SPECTRUM_BARTLETT/AOA_SPECTRUM_MVDR
+  int8_t  startAngle;        //!< Angle of spectrum[0], array frame
+  uint8_t stepAngle;         //!< Degrees between two bins
+  uint8_t numBins;           //!< Size of spectrum[], 0 if bins are not reported
+  uint8_t spectrum[];        //!< Power per angle, 255 at the peak
+} rtlsAoaResultSpectrum_t;
+
 /// @brief AoA Raw Result
 typedef struct __attribute__((packed))
 {
@@ -141,6 +362,26 @@ typedef struct __attribute__((packed))
   AoA_IQSample_Ext_t samples[]; //!< The data itself
 } rtlsAoaResultRaw_t;
 
+/// @brief AoA packed Raw Result
+///
+/// data[] holds numSamples samples packed by AOA_rawPack: sampleBits wide I and Q
+/// in a little endian bit stream, or with AOA_RAW_CODING_DELTA the first sample
+/// followed by the deltaBits wide zig-zag deltas to the sample before.
+typedef struct __attribute__((packed))
+{
+  uint16_t connHandle;          //!< Connection handle
+  int8_t  rssi;                 //!< Rssi for this antenna
+  uint8_t antenna;              //!< Antenna array used for this result
+  uint8_t channel;              //!< BLE data channel for this measurement
+  uint16_t offset;              //!< Offset of the first sample of data[] in the RAW result
+  uint16_t samplesLength;       //!< Expected length of entire RAW sample
+  uint8_t numSamples;           //!< Samples in data[]
+  uint8_t sampleBits;           //!< Bits of a component, 8, 12 or 16
+  uint8_t coding;               //!< AOA_RAW_CODING_NONE/AOA_RAW_CODING_DELTA
+  uint8_t deltaBits;            //!< Bits of a zig-zag delta, AOA_RAW_CODING_DELTA only
+  uint8_t data[];               //!< The packed samples
+} rtlsAoaResultRawPacked_t;
+
 // AoA post process event
 typedef struct
 {
@@ -153,13 +394,14 @@ typedef struct
   uint8_t sampleCtrl;          //!< 1 = RAW RF, 0 = Filtered results (switching period omitted)
   uint8_t slotDuration;        //!< Duration 1 = 1us, 2 = 2us
   uint8_t numAnt;              //!< Number of Antennas that were used for the run
-  int8_t *pIQ;                 //!< Pointer to IQ samples
+  int8_t *pIQ;                 //!< IQ samples, allocated by RTLS Services
+  AoA_IqHandle_t iqHandle;     //!< References to pIQ, the event holds one until AOA_RESULTS_EVENT is processed
 } rtlsAoaIqEvt_t;
 
 typedef struct
 {
   AoA_Role_t aoaRole;          //!< AOA_MASTER, AOA_SLAVE, AOA_PASSIVE
-  aoaResultMode_e resultMode;  //!< AOA_MODE_ANGLE, AOD_MODE_PAIR_ANGLES, AOA_MODE_RAW
+  aoaResultMode_e resultMode;  //!< AOA_MODE_ANGLE, AOD_MODE_PAIR_ANGLES, AOA_MODE_RAW, AOA_MODE_SPECTRUM
   uint8_t sampleCtrl;          //!< 0x01 = RAW RF, 0x00 = Filtered results (switching period omitted), bit 4,5 0x10 - ONLY_ANT_1, 0x20 - ONLY_ANT_2
 } rtlsAoa_t;
 /** @} End RTLS_CTRL_Structs */
@@ -181,7 +423,40 @@ void RTLSCtrl_postProcessAoa(rtlsAoaIqEvt_t *pEvt);
 #else
 
 /**
-* @brief   Called at the end of each connection event to extract I/Q samples
+* @brief   Hand the capture buffers over to the RF RAM read-out, has to be
+*          called before RTLSCtrl_readAoaSamples
+*
+* @param   samplesReadyCb - called from the RF callback once a read is over,
+*          RTLSCtrl_processAoaSamples is to be called after it
+*
+* @return  none
+*/
+void RTLSCtrl_initAoaSamples(pfnAoaRfRamDoneCb_t samplesReadyCb);
+
+/**
+* @brief   Called at the end of each connection event to start reading its
+*          I/Q samples out of RF RAM into a free buffer, without waiting for them
+*
+* @param   connHandle - connection handle
+* @param   resultMode - AoA information saved by RTLS Control
+* @param   rssi - rssi to be reported to RTLS Host
+* @param   channel - channel that was used for this AoA run
+* @param   sampleCtrl - sample control configs: 0x01 = RAW RF, 0x00 = Filtered results (switching period omitted), bit 4,5 0x10 - ONLY_ANT_1, 0x20 - ONLY_ANT_2
+*
+* @return  none
+*/
+void RTLSCtrl_readAoaSamples(uint8_t connHandle, uint8_t resultMode, int8_t rssi, uint8_t channel, uint8_t sampleCtrl);
+
+/**
+* @brief   Post process every buffer read out of RF RAM so far, oldest first,
+*          or give the read in flight up once it took too long
+*
+* @return  ticks until the read in flight times out, 0 if none is
+*/
+uint32_t RTLSCtrl_processAoaSamples(void);
+
+/**
+* @brief   Called once the I/Q samples of a connection event were read out of RF RAM
 *
 * @param   connHandle - connection handle
 * @param   resultMode - AoA information saved by RTLS Control
@@ -203,11 +478,125 @@ void RTLSCtrl_postProcessAoa(uint8_t connHandle, uint8_t resultMode, int8_t rssi
 * @param   maxConnections - number of connections we need to keep results for
 * @param   numAnt - number of antennas in pAntPattern
 * @param   pAntPattern - antenna pattern provided by the user
-* @param   resultMode - AOA_MODE_ANGLE/AOA_MODE_PAIR_ANGLES/AOA_MODE_RAW
+* @param   resultMode - AOA_MODE_ANGLE/AOA_MODE_PAIR_ANGLES/AOA_MODE_RAW/AOA_MODE_SPECTRUM
+* @param   sampleRate - sample rate the captures will use (1,2,3 or 4 Mhz)
+* @param   sampleSize - sample size 1 = 8 bit, 2 = 16 bit
+* @param   slotDuration - slot duration 1 = 1us, 2 = 2us
+* @param   pArrayDesc - array described by the host, NULL for the BOOSTXL-AOA arrays
+*
+* @return  status - RTLS_AOA_CONFIG_NOT_SUPPORTED/RTLS_OUT_OF_MEMORY/RTLS_SUCCESS
+*/
+rtlsStatus_e RTLSCtrl_initAoa(uint8_t maxConnections, uint8_t sampleCtrl, uint8_t numAnt, uint8_t *pAntPattern, aoaResultMode_e resultMode,
+                              uint8_t sampleRate, uint8_t sampleSize, uint8_t slotDuration, rtlsAoaArrayDesc_t *pArrayDesc);
+
+/**
+* @fn      RTLSCtrl_setAoaTrackParams
+*
+* @brief   Select the angle tracking filter of a connection, AOA_MODE_ANGLE
+*
+* @param   connHandle - connection handle
+* @param   dataLen - length of pData
+* @param   pData - rtlsAoaTrackParams_t
+*
+* @return  status - RTLS_FAIL/RTLS_CONFIG_NOT_SUPPORTED/RTLS_SUCCESS
+*/
+rtlsStatus_e RTLSCtrl_setAoaTrackParams(uint16_t connHandle, uint8_t dataLen, uint8_t *pData);
+
+/**
+* @fn      RTLSCtrl_setAoaScreenParams
+*
+* @brief   Set how captures are screened before the angle path
+*
+* @param   dataLen - length of pData
+* @param   pData - rtlsAoaScreenParams_t
+*
+* @return  status - RTLS_FAIL/RTLS_CONFIG_NOT_SUPPORTED/RTLS_SUCCESS
+*/
+rtlsStatus_e RTLSCtrl_setAoaScreenParams(uint8_t dataLen, uint8_t *pData);
+
+/**
+* @fn      RTLSCtrl_setAoaQualityParams
+*
+* @brief   Select the extended results with the spread of every pair angle
+*
+* @param   dataLen - length of pData
+* @param   pData - rtlsAoaQualityParams_t
+*
+* @return  status - RTLS_FAIL/RTLS_SUCCESS
+*/
+rtlsStatus_e RTLSCtrl_setAoaQualityParams(uint8_t dataLen, uint8_t *pData);
+
+/**
+* @fn      RTLSCtrl_setAoaDecimationParams
+*
+* @brief   Set the factor oversampled captures are decimated by
+*
+* @param   dataLen - length of pData
+* @param   pData - rtlsAoaDecimationParams_t
+*
+* @return  status - RTLS_FAIL/RTLS_CONFIG_NOT_SUPPORTED/RTLS_SUCCESS
+*/
+rtlsStatus_e RTLSCtrl_setAoaDecimationParams(uint8_t dataLen, uint8_t *pData);
+
+/**
+* @fn      RTLSCtrl_setAoaReportParams
+*
+* @brief   Set how AOA_MODE_ANGLE results are fused and how often they are sent
+*
+* @param   dataLen - length of pData
+* @param   pData - rtlsAoaReportParams_t
+*
+* @return  status - RTLS_FAIL/RTLS_CONFIG_NOT_SUPPORTED/RTLS_SUCCESS
+*/
+rtlsStatus_e RTLSCtrl_setAoaReportParams(uint8_t dataLen, uint8_t *pData);
+
+/**
+* @fn      RTLSCtrl_setAoaRawFormatParams
+*
+* @brief   Set the format AOA_MODE_RAW results are sent in
+*
+* @param   dataLen - length of pData
+* @param   pData - rtlsAoaRawFormatParams_t
+*
+* @return  status - RTLS_FAIL/RTLS_CONFIG_NOT_SUPPORTED/RTLS_SUCCESS
+*/
+rtlsStatus_e RTLSCtrl_setAoaRawFormatParams(uint8_t dataLen, uint8_t *pData);
+
+/**
+* @fn      RTLSCtrl_setAoaAvgModeParams
+*
+* @brief   Select how the pair angles of a capture are averaged
+*
+* @param   dataLen - length of pData
+* @param   pData - rtlsAoaAvgModeParams_t
+*
+* @return  status - RTLS_FAIL/RTLS_CONFIG_NOT_SUPPORTED/RTLS_SUCCESS
+*/
+rtlsStatus_e RTLSCtrl_setAoaAvgModeParams(uint8_t dataLen, uint8_t *pData);
+
+/**
+* @fn      RTLSCtrl_setAoaCalibration
+*
+* @brief   Load the calibration table of a BOOSTXL-AOA array
+*
+* @param   dataLen - length of pData
+* @param   pData - rtlsAoaCalibration_t
+*
+* @return  status - RTLS_FAIL/RTLS_CONFIG_NOT_SUPPORTED/RTLS_OUT_OF_MEMORY/RTLS_SUCCESS
+*/
+rtlsStatus_e RTLSCtrl_setAoaCalibration(uint16_t dataLen, uint8_t *pData);
+
+/**
+* @fn      RTLSCtrl_startAoaCalibration
+*
+* @brief   Start or stop the calibration capture of a BOOSTXL-AOA array
+*
+* @param   dataLen - length of pData
+* @param   pData - rtlsAoaCalibrate_t
 *
-* @return  status - RTLS_AOA_CONFIG_NOT_SUPPORTED/RTLS_SUCCESS
+* @return  status - RTLS_FAIL/RTLS_CONFIG_NOT_SUPPORTED/RTLS_OUT_OF_MEMORY/RTLS_SUCCESS
 */
-rtlsStatus_e RTLSCtrl_initAoa(uint8_t maxConnections, uint8_t sampleCtrl, uint8_t numAnt, uint8_t *pAntPattern, aoaResultMode_e resultMode);
+rtlsStatus_e RTLSCtrl_startAoaCalibration(uint16_t dataLen, uint8_t *pData);
 
 /*********************************************************************
 *********************************************************************/
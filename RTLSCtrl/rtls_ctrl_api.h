@@ -294,7 +294,7 @@ void RTLSCtrl_dataSentEvt(uint16_t connHandle, uint8_t status);
  * @param sampleSize - Sample Size 1 = 8 bit, 2 = 16 bit
  * @param sampleCtrl - Sampling control flags
  * @param numAnt - Number of Antennas that were used for the run
- * @param pIQ - Pointer to IQ samples
+ * @param pIQ - Pointer to IQ samples, RTLS Control takes them over and frees them once done
  */
 void RTLSCtrl_aoaResultEvt(uint16_t connHandle, int8_t rssi, uint8_t channel, uint16_t numIqSamples, uint8_t sampleRate, uint8_t sampleSize, uint8_t sampleCtrl, uint8_t slotDuration, uint8_t numAnt, int8_t *pIQ);
 
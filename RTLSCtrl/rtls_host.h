@@ -63,6 +63,8 @@ extern "C"
 /*********************************************************************
  * INCLUDES
  */
+#include <stdint.h>
+#include <stdbool.h>
 
 /*********************************************************************
 *  EXTERNAL VARIABLES
@@ -104,6 +106,13 @@ typedef struct
 
 /// @brief RTLS Host application callback
 typedef void (*pfnRtlsCtrlProcessMsgCb)(rtlsHostMsg_t *pMsg);
+
+/// @brief Writes the data of the next message of a stream into pBuf, at most maxLen bytes,
+///        and its length into pLen. Returns TRUE while more messages follow.
+typedef bool (*pfnRtlsHostStreamFillCb)(void *pArg, uint8_t *pBuf, uint16_t maxLen, uint16_t *pLen);
+
+/// @brief Releases what a stream reads once its last message is out or it was dropped
+typedef void (*pfnRtlsHostStreamDoneCb)(void *pArg);
 /** @} End RTLS_CTRL_Structs */
 
 /*********************************************************************
@@ -132,6 +141,22 @@ void RTLSHost_openHostIf(pfnRtlsCtrlProcessMsgCb rtlsHostMsgCb);
  */
 uint8_t RTLSHost_sendMsg(uint8_t cmdId, uint8_t cmdType, uint8_t *pData, uint16_t dataLen);
 
+/**
+ * @brief   Send a series of messages whose data is written straight into the
+ *          host interface TX buffer, as large as it allows, so it is never
+ *          copied into a message first. The callbacks are called from the
+ *          host interface task, doneCb may be called before this returns.
+ *
+ * @param   cmdId - RTLS Cmd Id of every message
+ * @param   cmdType - Async only
+ * @param   fillCb - Writes the data of a message
+ * @param   doneCb - Called once, after the last message
+ * @param   pArg - Passed to the callbacks, must stay valid until doneCb
+ *
+ * @return  status - 0 = success, 1 = failed and doneCb will not be called
+ */
+uint8_t RTLSHost_sendStream(uint8_t cmdId, uint8_t cmdType, pfnRtlsHostStreamFillCb fillCb, pfnRtlsHostStreamDoneCb doneCb, void *pArg);
+
 /*********************************************************************
 *********************************************************************/
 
@@ -111,6 +111,15 @@ typedef struct
   _npiFrame_t *pNpiMsg;  // Message Received from the Application processor
 } uNpiEvt_t;
 
+// RTLS Host stream
+typedef struct
+{
+  _npiStream_t            npiStream;  // Must be first, NPI hands it back to the callbacks
+  pfnRtlsHostStreamFillCb fillCb;
+  pfnRtlsHostStreamDoneCb doneCb;
+  void                    *pArg;
+} rtlsHostStream_t;
+
 /*********************************************************************
  * GLOBAL VARIABLES
  */
@@ -138,6 +147,8 @@ pfnRtlsCtrlProcessMsgCb gRtlsCtrlProcessMsgCb = NULL;
  */
 
 void RTLSHost_processNpiMessage(_npiFrame_t *pNpiMsg);
+bool RTLSHost_fillNpiStream(_npiStream_t *pNpiStream, uint8_t *pBuf, uint16_t maxLen, uint16_t *pLen);
+void RTLSHost_doneNpiStream(_npiStream_t *pNpiStream);
 
 /*********************************************************************
  * PUBLIC FUNCTIONS
@@ -260,6 +271,67 @@ uint8_t RTLSHost_sendMsg(uint8_t cmdId, uint8_t cmdType, uint8_t *pData, uint16_
 #endif
 }
 
+/*********************************************************************
+ * @fn      RTLSHost_sendStream
+ *
+ * @brief   Send a series of uNPI commands built in the NPI TX buffer
+ *
+ * @param   cmdId - Command Id of every message
+ * @param   cmdType - Async only
+ * @param   fillCb - Writes the data of a message
+ * @param   doneCb - Called once, after the last message
+ * @param   pArg - Passed to the callbacks
+ *
+ * @return  status - 0 = success, 1 = failed and doneCb will not be called
+ */
+uint8_t RTLSHost_sendStream(uint8_t cmdId, uint8_t cmdType, pfnRtlsHostStreamFillCb fillCb, pfnRtlsHostStreamDoneCb doneCb, void *pArg)
+{
+#ifdef RTLS_HOST_EXTERNAL
+  rtlsHostStream_t *pStream;
+
+  // Frames of a stream are not tracked as sync transactions
+  if (cmdType != HOST_ASYNC_RSP)
+  {
+    return FAILURE;
+  }
+
+  if (cmdId <= RTLS_CMD_BLE_LOG_STRINGS_MAX)
+  {
+    BLE_LOG_INT_STR(0, BLE_LOG_MODULE_APP, "APP : RTLS host stream cmdType=%d, cmdId=%s\n", cmdType, rtlsCmd_BleLogStrings[cmdId]);
+  }
+
+  pStream = (rtlsHostStream_t *)NPIUtil_malloc(sizeof(rtlsHostStream_t));
+
+  if (pStream == NULL)
+  {
+    return FAILURE;
+  }
+
+  pStream->npiStream.cmd0 = NPI_ASYNC_RSP;
+  pStream->npiStream.cmd1 = cmdId;
+  pStream->npiStream.fillCB = RTLSHost_fillNpiStream;
+  pStream->npiStream.doneCB = RTLSHost_doneNpiStream;
+  pStream->fillCb = fillCb;
+  pStream->doneCb = doneCb;
+  pStream->pArg = pArg;
+
+  // Forward the stream to uNPI, it is handed back through RTLSHost_doneNpiStream
+  if (NPITask_sendStreamToHost(&pStream->npiStream) != NPI_SUCCESS)
+  {
+    NPIUtil_free((uint8_t *)pStream);
+
+    return FAILURE;
+  }
+
+  return SUCCESS;
+#else
+  // Nothing to send to, the stream is done
+  doneCb(pArg);
+
+  return SUCCESS;
+#endif
+}
+
 /*********************************************************************
  * @fn      RTLSHost_processNpiMessage
  *
@@ -327,3 +399,40 @@ void RTLSHost_processNpiMessage(_npiFrame_t *pNpiMsg)
   gRtlsCtrlProcessMsgCb(pHostMsg);
 #endif
 }
+
+/*********************************************************************
+ * @fn      RTLSHost_fillNpiStream
+ *
+ * @brief   Write the data of the next message of a stream into the NPI TX buffer
+ *
+ * @param   pNpiStream - stream
+ * @param   pBuf - data of the message
+ * @param   maxLen - room in pBuf
+ * @param   pLen - length of the data written
+ *
+ * @return  TRUE while more messages follow
+ */
+bool RTLSHost_fillNpiStream(_npiStream_t *pNpiStream, uint8_t *pBuf, uint16_t maxLen, uint16_t *pLen)
+{
+  rtlsHostStream_t *pStream = (rtlsHostStream_t *)pNpiStream;
+
+  return pStream->fillCb(pStream->pArg, pBuf, maxLen, pLen);
+}
+
+/*********************************************************************
+ * @fn      RTLSHost_doneNpiStream
+ *
+ * @brief   Hand a stream back once its last message is out
+ *
+ * @param   pNpiStream - stream
+ *
+ * @return  none
+ */
+void RTLSHost_doneNpiStream(_npiStream_t *pNpiStream)
+{
+  rtlsHostStream_t *pStream = (rtlsHostStream_t *)pNpiStream;
+
+  pStream->doneCb(pStream->pArg);
+
+  NPIUtil_free((uint8_t *)pStream);
+}
@@ -0,0 +1,749 @@
+/******************************************************************************
+
+ @file  aoa_bench.c
+
+ @brief Host-native throughput bench for the AoA angle path.
+
+        Builds Drivers/AOA/AOA.c (RTLS_MASTER) against the stubs in
+        ./stubs and drives AOA_getPairAngles with synthetic captures for
+        every sampleRate (1-4 MHz), sampleSize (8/16 bit), slotDuration
+        (1/2 us) and cteLength (2-20) combination.
+
+        Usage: aoa_bench [-n iterations] [-r sampleRate] [-s sampleSize]
+                         [-d slotDuration] [-l cteLength] [-m angle|phasor]
+                         [-e bartlett|mvdr] [-A numAnt] [-c cfoKHz] [-w] [-k] [-a] [-g]
+               aoa_bench -x [-r sampleRate] [-s sampleSize] [-d slotDuration]
+                         [-l cteLength] [-A numAnt] [-b 1|2] [-T trials]
+                         [-N snrDb] [-c cfoKHz] [-P phaseNoiseDeg]
+                         [-G glitchProb] [-M angle,gainDb,phaseDeg]...
+
+        Filters default to "all". For every configuration the bench prints
+        ns/CTE and CTEs/sec for the full pair-angle path followed by the
+        per-stage breakdown. "other" is the part of the full path that is
+        not covered by a timed stage (indexing, averaging, write back).
+
+        The specialized angle kernel of every configuration is selected
+        with AOA_selectKernel, as RTLSCtrl_initAoa does. -g keeps the
+        generic loop.
+
+        -e times the spatial spectrum path instead of the pair angles:
+        AOA_getCovariance followed by AOA_spectrumScan with the selected
+        estimator. The peak angle is printed for every configuration.
+
+        -A replaces the BOOSTXL-AOA array 1 configuration with a uniform
+        linear array of numAnt (2-16) elements described at runtime, as a
+        host does through RTLS_CMD_AOA_SET_PARAMS: every element is paired
+        with every other element.
+
+        -c sets the carrier frequency offset of the synthetic captures.
+
+        16 bit captures are normalized to 8 bit with AOA_normalizeSamples,
+        as RTLSCtrl_postProcessAoa does, and the full path includes that
+        stage. -w keeps them 16 bit wide on the generic loop instead.
+
+        -k runs the self checks of ./test instead, one test_<module>.c per
+        Drivers/AOA module. Every failed assertion prints its file, line
+        and condition, every check its number of failures.
+
+        -a compares AOA_iatan2sc with AOA_atan2Fixed at several output
+        resolutions: ns per call and the largest error in degrees over
+        the full circle at small and large input magnitudes.
+
+        -x runs the accuracy sweep of aoa_eval instead: the true angle is
+        swept from -80 to 80 degrees and every estimator variant is run on
+        the same captures of the channel model. -N sets the SNR, -P the
+        phase noise, -G the probability of a switching transient and -M
+        adds a reflection (up to four). -b selects BOOSTXL-AOA array 1 or
+        2, -A a uniform linear array instead. One configuration is swept,
+        r4 s1 d2 l20 unless given with -r/-s/-d/-l.
+
+ *****************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <math.h>
+
+#include "rf_hal.h"
+#include "AOA.h"
+#include "AOA_kernel.h"
+#include "AOA_spectrum.h"
+#include "ant_array1_config_boostxl_rev1v1.h"
+#include "aoa_synth.h"
+#include "aoa_eval.h"
+#include "aoa_test.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define BENCH_DEFAULT_ITERATIONS   2000
+#define BENCH_ANGLE_DEG            20.0
+#define BENCH_AMPLITUDE_8BIT       100.0
+#define BENCH_AMPLITUDE_16BIT      1500.0
+#define BENCH_ATAN_TABLE_SIZE      256
+#define BENCH_MIN_REPS             2
+#define BENCH_ATAN_ERR_STEPS       36000
+#define BENCH_ATAN_TIME_CALLS      1000000
+#define BENCH_ARRAY_SPACING        0.5f
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+// One capture configuration under test
+typedef struct
+{
+  uint8_t  sampleRate;
+  uint8_t  sampleSize;
+  uint8_t  slotDuration;
+  uint8_t  cteLength;
+  uint16_t numIqSamples;
+  uint16_t numReps;
+  double   cfoKHz;
+} benchCfg_t;
+
+// State shared by all stages of one configuration
+typedef struct
+{
+  benchCfg_t cfg;
+  AoA_AvgMode_t avgMode;
+  bool spectrum;
+  AoA_Covariance_t *pCov;
+  AoA_Covariance_t *pWork;
+  AoA_SpectrumResult_t spectrumResult;
+  AoA_AntennaConfig_t *antConfig;
+  uint8_t numAnt;
+  AoA_AntennaResult_t antResult;
+  int8_t *pCapture;
+  int8_t *pIQ;
+  uint8_t sampleSize;
+  bool normalize;
+  int32_t atanY[BENCH_ATAN_TABLE_SIZE];
+  int32_t atanX[BENCH_ATAN_TABLE_SIZE];
+  volatile int32_t sink;
+} benchCtx_t;
+
+// Storage of an array described at runtime
+typedef struct
+{
+  AoA_AntennaConfig_t config;
+  AoA_AntennaPair_t pairs[AOA_MAX_NUM_PAIRS];
+  uint8_t element[AOA_MAX_NUM_ANT];
+  float position[AOA_MAX_NUM_ANT];
+} benchArray_t;
+
+// A stage of the angle path that can be timed in isolation
+typedef struct
+{
+  const char *name;
+  void (*run)(benchCtx_t *pCtx);
+} benchStage_t;
+
+/*********************************************************************
+ * EXTERNAL FUNCTIONS
+ */
+
+// Not exported through AOA.h
+extern int16_t AOA_iatan2sc(int32_t y, int32_t x);
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+static void Bench_stagePairAngles(benchCtx_t *pCtx);
+static void Bench_stageNormalize(benchCtx_t *pCtx);
+static void Bench_stageCmac(benchCtx_t *pCtx);
+static void Bench_stageAtan2(benchCtx_t *pCtx);
+static void Bench_stageScan(benchCtx_t *pCtx);
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// The first stage is the full path, the remaining stages are its breakdown
+static const benchStage_t benchStages[] =
+{
+  {"pair_angles", Bench_stagePairAngles},
+  {"normalize",   Bench_stageNormalize},
+  {"cmac",        Bench_stageCmac},
+  {"atan2",       Bench_stageAtan2},
+  {"scan",        Bench_stageScan},
+};
+
+#define BENCH_NUM_STAGES  (sizeof(benchStages) / sizeof(benchStages[0]))
+
+// Runtime array of -A
+static benchArray_t benchArray;
+
+// Steering table of the array under test
+static AoA_Steer_t benchSteer[AOA_SPECTRUM_NUM_BINS * AOA_MAX_NUM_ANT];
+
+/*********************************************************************
+ * STAGES
+ */
+
+static void Bench_stagePairAngles(benchCtx_t *pCtx)
+{
+  Bench_stageNormalize(pCtx);
+
+  if (pCtx->spectrum)
+  {
+    AOA_getCovariance(pCtx->antConfig,
+                      pCtx->pCov,
+                      pCtx->cfg.numIqSamples,
+                      pCtx->cfg.sampleRate,
+                      pCtx->sampleSize,
+                      pCtx->cfg.slotDuration,
+                      pCtx->numAnt,
+                      pCtx->pIQ);
+    AOA_spectrumScan(pCtx->pCov, pCtx->pWork, &pCtx->spectrumResult);
+
+    pCtx->sink += pCtx->spectrumResult.angle;
+    return;
+  }
+
+  AOA_getPairAngles(pCtx->antConfig,
+                    &pCtx->antResult,
+                    pCtx->cfg.numIqSamples,
+                    pCtx->cfg.sampleRate,
+                    pCtx->sampleSize,
+                    pCtx->cfg.slotDuration,
+                    pCtx->numAnt,
+                    pCtx->pIQ);
+
+  pCtx->sink += pCtx->antResult.pairAngle[0];
+}
+
+// AOA_normalizeSamples of the capture, narrowed from the untouched copy so every run does the same work
+static void Bench_stageNormalize(benchCtx_t *pCtx)
+{
+  const AoA_IQSample_Ext_t *pIn = (const AoA_IQSample_Ext_t *)pCtx->pCapture;
+  uint8_t shift;
+
+  if (!pCtx->normalize)
+  {
+    return;
+  }
+
+  shift = AOA_blockExponent(pIn, pCtx->cfg.numIqSamples);
+  AOA_narrowSamples(pIn, (AoA_IQSample_t *)pCtx->pIQ, pCtx->cfg.numIqSamples, shift);
+}
+
+// The AOA_kernel calls the phasor and covariance paths make for this capture
+static void Bench_stageCmac(benchCtx_t *pCtx)
+{
+  const uint16_t rate = pCtx->cfg.sampleRate;
+  const uint8_t numAnt = pCtx->numAnt;
+  const uint16_t repStride = numAnt * rate;
+  const uint16_t numReps = pCtx->cfg.numReps;
+  AoA_Phasor_t acc = {0};
+
+  // The covariance takes every antenna pair including the diagonal
+  const uint8_t numPairs = pCtx->spectrum ? CALC_NUM_ANT_PAIRS(numAnt + 1) : pCtx->antConfig->numPairs;
+
+  // The carrier frequency offset estimate runs in every mode
+  const uint16_t numRef = 2;
+
+  for (uint16_t n = 0; n < numRef + numPairs; n++)
+  {
+    // Reference period lags first (1 us and 4 us), then one call per pair
+    const uint16_t lag = ((n == 0) ? 1 : 4) * rate;
+    const uint16_t a = (n < numRef) ? 0 : pCtx->spectrum ? 0 : pCtx->antConfig->pairs[n - numRef].a;
+    const uint16_t b = (n < numRef) ? 0 : pCtx->spectrum ? 0 : pCtx->antConfig->pairs[n - numRef].b;
+    const uint16_t xOffset = (n < numRef) ? lag : 8 * rate + a * rate;
+    const uint16_t yOffset = (n < numRef) ? 0 : 8 * rate + b * rate;
+    const uint16_t runLen = (n < numRef) ? 8 * rate - lag : rate;
+    const uint16_t runs = (n < numRef) ? 1 : numReps;
+
+    // The angle path has no phasor pairs
+    if ((n >= numRef) && (pCtx->avgMode != AOA_AVG_MODE_PHASOR) && !pCtx->spectrum)
+    {
+      break;
+    }
+
+    if (pCtx->sampleSize == 1)
+    {
+      const AoA_IQSample_t *pIQ = (const AoA_IQSample_t *)pCtx->pIQ;
+      AOA_cmacConj(&pIQ[xOffset], &pIQ[yOffset], runLen, runs, repStride, &acc);
+    }
+    else
+    {
+      const AoA_IQSample_Ext_t *pIQ = (const AoA_IQSample_Ext_t *)pCtx->pIQ;
+      AOA_cmacConjExt(&pIQ[xOffset], &pIQ[yOffset], runLen, runs, repStride, &acc);
+    }
+  }
+
+  pCtx->sink += (int32_t)(acc.re ^ acc.im);
+}
+
+// Same number of AOA_iatan2sc calls as AOA_getPairAngles makes for this capture
+static void Bench_stageAtan2(benchCtx_t *pCtx)
+{
+  uint32_t numCalls;
+  int32_t acc = 0;
+
+  // The carrier frequency offset uses atan2f twice per capture, the covariance path nothing else
+  if (pCtx->spectrum)
+  {
+    return;
+  }
+
+  if (pCtx->avgMode == AOA_AVG_MODE_PHASOR)
+  {
+    numCalls = pCtx->antConfig->numPairs;
+  }
+  else
+  {
+    numCalls = (uint32_t)pCtx->antConfig->numPairs * pCtx->cfg.numReps * pCtx->cfg.sampleRate;
+  }
+
+  for (uint32_t n = 0; n < numCalls; n++)
+  {
+    uint32_t k = n % BENCH_ATAN_TABLE_SIZE;
+#if (AOA_ATAN_BITS == 0)
+    acc += AOA_iatan2sc(pCtx->atanY[k], pCtx->atanX[k]);
+#else
+    acc += AOA_atan2Fixed(pCtx->atanY[k], pCtx->atanX[k], AOA_ATAN_BITS);
+#endif
+  }
+
+  pCtx->sink += acc;
+}
+
+// Spectrum scan of the covariance the full path estimated
+static void Bench_stageScan(benchCtx_t *pCtx)
+{
+  if (!pCtx->spectrum)
+  {
+    return;
+  }
+
+  AOA_spectrumScan(pCtx->pCov, pCtx->pWork, &pCtx->spectrumResult);
+  pCtx->sink += pCtx->spectrumResult.angle;
+}
+
+/*********************************************************************
+ * HELPERS
+ */
+
+static double Bench_nowNs(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static double Bench_timeStage(const benchStage_t *pStage, benchCtx_t *pCtx, uint32_t iterations)
+{
+  double start;
+
+  // Warm up caches and branch predictors
+  for (uint32_t n = 0; n < iterations / 10 + 1; n++)
+  {
+    pStage->run(pCtx);
+  }
+
+  start = Bench_nowNs();
+  for (uint32_t n = 0; n < iterations; n++)
+  {
+    pStage->run(pCtx);
+  }
+
+  return (Bench_nowNs() - start) / iterations;
+}
+
+// BOOSTXL-AOA array 1 for numAnt 0, else a uniform linear array of numAnt elements built at runtime
+static AoA_AntennaConfig_t *Bench_getArray(uint8_t numAnt)
+{
+  if (numAnt == 0)
+  {
+    return getAntennaArray1Config();
+  }
+
+  for (uint8_t k = 0; k < numAnt; k++)
+  {
+    benchArray.element[k] = k;
+    benchArray.position[k] = k * BENCH_ARRAY_SPACING;
+  }
+
+  if (!AOA_initArrayConfig(&benchArray.config, numAnt, numAnt, benchArray.element, benchArray.position, benchArray.pairs))
+  {
+    return NULL;
+  }
+
+  return &benchArray.config;
+}
+
+static AoA_Covariance_t *Bench_allocCov(uint8_t numElements)
+{
+  AoA_Covariance_t *pCov = calloc(1, AOA_COV_SIZE(numElements));
+
+  pCov->numAnt = numElements;
+
+  return pCov;
+}
+
+static void Bench_initCtx(benchCtx_t *pCtx, const benchCfg_t *pCfg, AoA_AvgMode_t avgMode, bool spectrum, bool normalize, AoA_AntennaConfig_t *antConfig, int16_t *pairAngle)
+{
+  aoaSynthParams_t synth = {0};
+  double amplitude = (pCfg->sampleSize == 1) ? BENCH_AMPLITUDE_8BIT : BENCH_AMPLITUDE_16BIT;
+
+  memset(pCtx, 0, sizeof(*pCtx));
+  pCtx->cfg = *pCfg;
+  pCtx->avgMode = avgMode;
+  pCtx->spectrum = spectrum;
+  pCtx->antConfig = antConfig;
+  pCtx->numAnt = antConfig->numAntennas;
+  pCtx->antResult.pairAngle = pairAngle;
+  pCtx->pCov = Bench_allocCov(antConfig->numElements);
+  pCtx->pWork = Bench_allocCov(antConfig->numElements);
+
+  synth.sampleRate = pCfg->sampleRate;
+  synth.sampleSize = pCfg->sampleSize;
+  synth.slotDuration = pCfg->slotDuration;
+  synth.numAnt = pCtx->numAnt;
+  synth.numIqSamples = pCfg->numIqSamples;
+  synth.angleDeg = BENCH_ANGLE_DEG;
+  synth.amplitude = amplitude;
+  synth.spacingWl = BENCH_ARRAY_SPACING;
+  synth.cfoKHz = pCfg->cfoKHz;
+
+  pCtx->pCapture = malloc(AOA_SYNTH_MAX_IQ_SAMPLES * 2 * sizeof(int16_t));
+  pCtx->pIQ = malloc(AOA_SYNTH_MAX_IQ_SAMPLES * 2 * sizeof(int16_t));
+  AoaSynth_generate(&synth, pCtx->pCapture);
+  memcpy(pCtx->pIQ, pCtx->pCapture, AOA_SYNTH_MAX_IQ_SAMPLES * 2 * sizeof(int16_t));
+
+  // The angle path sees the capture as RTLSCtrl_postProcessAoa hands it over
+  pCtx->sampleSize = pCfg->sampleSize;
+  pCtx->normalize = normalize && (pCfg->sampleSize == 2);
+  if (pCtx->normalize)
+  {
+    amplitude /= (1 << AOA_normalizeSamples(pCtx->pIQ, pCfg->numIqSamples, &pCtx->sampleSize));
+  }
+
+  // The scan stage needs a covariance before the full path has run
+  if (spectrum)
+  {
+    Bench_stagePairAngles(pCtx);
+  }
+
+  // Products of two samples span the full circle
+  for (uint32_t k = 0; k < BENCH_ATAN_TABLE_SIZE; k++)
+  {
+    double phase = 6.283185307179586 * k / BENCH_ATAN_TABLE_SIZE;
+
+    pCtx->atanX[k] = (int32_t)(amplitude * amplitude * cos(phase));
+    pCtx->atanY[k] = (int32_t)(amplitude * amplitude * sin(phase));
+  }
+}
+
+static void Bench_usage(const char *prog)
+{
+  fprintf(stderr, "usage: %s [-n iterations] [-r sampleRate] [-s sampleSize] [-d slotDuration] [-l cteLength] [-m angle|phasor] [-e bartlett|mvdr] [-A numAnt] [-c cfoKHz] [-w] [-k] [-a] [-g]\n"
+                  "       %s -x [-r sampleRate] [-s sampleSize] [-d slotDuration] [-l cteLength] [-A numAnt] [-b 1|2] [-T trials]\n"
+                  "                [-N snrDb] [-c cfoKHz] [-P phaseNoiseDeg] [-G glitchProb] [-M angle,gainDb,phaseDeg]...\n", prog, prog);
+}
+
+static const char *Bench_kernelName(void)
+{
+  switch (AOA_KERNEL_IMPL)
+  {
+    case AOA_KERNEL_IMPL_ARM_DSP: return "arm_dsp";
+    case AOA_KERNEL_IMPL_SSE2:    return "sse2";
+    case AOA_KERNEL_IMPL_AVX2:    return "avx2";
+    default:                      return "scalar";
+  }
+}
+
+// atan2 under comparison, bits 0 is AOA_iatan2sc. Returns degrees.
+static double Bench_atan2Deg(int32_t y, int32_t x, uint8_t bits)
+{
+  if (bits == 0)
+  {
+    return AOA_iatan2sc(y, x) * 360.0 / 256;
+  }
+
+  return AOA_atan2Fixed(y, x, bits) * 360.0 / (1u << bits);
+}
+
+// Print ns per call and the largest error of every atan2 resolution
+static void Bench_compareAtan2(void)
+{
+  static const uint8_t bitsList[] = {0, 8, 10, 12, 14, 16};
+  // AOA_iatan2sc needs inputs below 2^25
+  static const double magnitudes[] = {100.0, 1e4, 1e6, 3.0e7};
+  static int32_t tableY[BENCH_ATAN_TABLE_SIZE];
+  static int32_t tableX[BENCH_ATAN_TABLE_SIZE];
+
+  for (uint32_t k = 0; k < BENCH_ATAN_TABLE_SIZE; k++)
+  {
+    double phase = 6.283185307179586 * k / BENCH_ATAN_TABLE_SIZE;
+
+    tableX[k] = (int32_t)(1e6 * cos(phase));
+    tableY[k] = (int32_t)(1e6 * sin(phase));
+  }
+
+  printf("%8s %10s", "bits", "ns/call");
+  for (uint32_t m = 0; m < sizeof(magnitudes) / sizeof(magnitudes[0]); m++)
+  {
+    printf("   maxErr@%-7.0e", magnitudes[m]);
+  }
+  printf("\n");
+
+  for (uint32_t b = 0; b < sizeof(bitsList) / sizeof(bitsList[0]); b++)
+  {
+    const uint8_t bits = bitsList[b];
+    volatile int32_t sink;
+    int32_t acc = 0;
+    double start = Bench_nowNs();
+    double ns;
+
+    for (uint32_t n = 0; n < BENCH_ATAN_TIME_CALLS; n++)
+    {
+      uint32_t k = n % BENCH_ATAN_TABLE_SIZE;
+      acc += (bits == 0) ? AOA_iatan2sc(tableY[k], tableX[k]) : AOA_atan2Fixed(tableY[k], tableX[k], bits);
+    }
+    ns = (Bench_nowNs() - start) / BENCH_ATAN_TIME_CALLS;
+    sink = acc;
+    (void)sink;
+
+    if (bits == 0)
+    {
+      printf("%8s %10.2f", "iatan2sc", ns);
+    }
+    else
+    {
+      printf("%8u %10.2f", bits, ns);
+    }
+
+    for (uint32_t m = 0; m < sizeof(magnitudes) / sizeof(magnitudes[0]); m++)
+    {
+      double maxErr = 0;
+
+      for (uint32_t k = 0; k < BENCH_ATAN_ERR_STEPS; k++)
+      {
+        double phase = 6.283185307179586 * k / BENCH_ATAN_ERR_STEPS;
+        int32_t x = (int32_t)lround(magnitudes[m] * cos(phase));
+        int32_t y = (int32_t)lround(magnitudes[m] * sin(phase));
+        double err = Bench_atan2Deg(y, x, bits) - atan2(y, x) * 180.0 / 3.141592653589793;
+
+        // Compare on the circle
+        err = fabs(fmod(err + 540.0, 360.0) - 180.0);
+        if (err > maxErr)
+        {
+          maxErr = err;
+        }
+      }
+
+      printf("   %15.4f", maxErr);
+    }
+    printf("\n");
+  }
+}
+
+/*********************************************************************
+ * MAIN
+ */
+
+int main(int argc, char *argv[])
+{
+  uint32_t iterations = BENCH_DEFAULT_ITERATIONS;
+  int onlyRate = 0, onlySize = 0, onlySlot = 0, onlyCte = 0;
+  int16_t pairAngle[AOA_MAX_NUM_PAIRS];
+  AoA_AntennaConfig_t *antConfig;
+  int numAnt = 0;
+  double cfoKHz = 0;
+  double totalNs = 0;
+  uint32_t numCfgs = 0;
+  AoA_AvgMode_t avgMode = AOA_AVG_MODE_ANGLE;
+  int checkKernels = 0;
+  int compareAtan2 = 0;
+  int genericLoop = 0;
+  bool normalize = true;
+  bool spectrum = false;
+  bool evaluate = false;
+  aoaEvalParams_t eval = {.boardArray = 1, .trials = AOA_EVAL_DEFAULT_TRIALS, .minAngleDeg = -80, .maxAngleDeg = 80,
+                          .stepDeg = 5, .snrDb = AOA_EVAL_NO_NOISE_DB};
+  int opt;
+
+  while ((opt = getopt(argc, argv, "n:r:s:d:l:m:e:A:c:wkagxb:T:N:P:G:M:h")) != -1)
+  {
+    switch (opt)
+    {
+      case 'n': iterations = (uint32_t)atoi(optarg); break;
+      case 'r': onlyRate = atoi(optarg); break;
+      case 's': onlySize = atoi(optarg); break;
+      case 'd': onlySlot = atoi(optarg); break;
+      case 'l': onlyCte = atoi(optarg); break;
+      case 'm': avgMode = (strcmp(optarg, "phasor") == 0) ? AOA_AVG_MODE_PHASOR : AOA_AVG_MODE_ANGLE; break;
+      case 'e':
+        spectrum = true;
+        AOA_spectrumSetMethod((strcmp(optarg, "mvdr") == 0) ? AOA_SPECTRUM_MVDR : AOA_SPECTRUM_BARTLETT);
+        break;
+      case 'A': numAnt = atoi(optarg); break;
+      case 'c': cfoKHz = atof(optarg); break;
+      case 'w': normalize = false; break;
+      case 'k': checkKernels = 1; break;
+      case 'a': compareAtan2 = 1; break;
+      case 'g': genericLoop = 1; break;
+      case 'x': evaluate = true; break;
+      case 'b': eval.boardArray = (uint8_t)atoi(optarg); break;
+      case 'T': eval.trials = (uint32_t)atoi(optarg); break;
+      case 'N': eval.snrDb = atof(optarg); break;
+      case 'P': eval.channel.phaseNoiseDeg = atof(optarg); break;
+      case 'G': eval.channel.glitchProb = atof(optarg); break;
+      case 'M':
+      {
+        aoaSynthTap_t *pTap = &eval.channel.taps[eval.channel.numTaps];
+
+        if ((eval.channel.numTaps == AOA_SYNTH_MAX_TAPS) ||
+            (sscanf(optarg, "%lf,%lf,%lf", &pTap->angleDeg, &pTap->gainDb, &pTap->phaseDeg) != 3))
+        {
+          Bench_usage(argv[0]);
+          return 1;
+        }
+        eval.channel.numTaps++;
+        break;
+      }
+      default:
+        Bench_usage(argv[0]);
+        return (opt == 'h') ? 0 : 1;
+    }
+  }
+
+  if ((iterations == 0) || (numAnt == 1) || (numAnt < 0) || (numAnt > AOA_MAX_NUM_ANT))
+  {
+    Bench_usage(argv[0]);
+    return 1;
+  }
+
+  if (evaluate)
+  {
+    eval.sampleRate = onlyRate ? onlyRate : 4;
+    eval.sampleSize = onlySize ? onlySize : 1;
+    eval.slotDuration = onlySlot ? onlySlot : 2;
+    eval.cteLength = onlyCte ? onlyCte : 20;
+    eval.numAnt = (uint8_t)numAnt;
+    eval.channel.cfoKHz = cfoKHz;
+    return AoaEval_run(&eval);
+  }
+
+  if (checkKernels)
+  {
+    return (AoaTest_run() == 0) ? 0 : 1;
+  }
+
+  if (compareAtan2)
+  {
+    Bench_compareAtan2();
+    return 0;
+  }
+
+  antConfig = Bench_getArray((uint8_t)numAnt);
+  AOA_setAvgMode(avgMode);
+  AOA_spectrumInit(antConfig, benchSteer);
+  if (spectrum)
+  {
+    printf("spectrum: %s, kernel: %s, %u bins\n", (AOA_spectrumGetMethod() == AOA_SPECTRUM_MVDR) ? "mvdr" : "bartlett",
+           Bench_kernelName(), AOA_SPECTRUM_NUM_BINS);
+    printf("antennas: %u, elements: %u\n", antConfig->numAntennas, antConfig->numElements);
+  }
+  else
+  {
+    printf("avgMode: %s, kernel: %s, atan bits: %u, angle kernels: %s, 16 bit: %s\n", (avgMode == AOA_AVG_MODE_PHASOR) ? "phasor" : "angle",
+           Bench_kernelName(), AOA_ATAN_BITS, genericLoop ? "generic" : "specialized", normalize ? "normalized" : "wide");
+    printf("antennas: %u, pairs: %u\n", antConfig->numAntennas, antConfig->numPairs);
+  }
+
+  printf("%4s %4s %4s %4s %5s %4s %12s %12s", "rate", "size", "slot", "cte", "numIQ", "reps", "ns/CTE", "CTE/s");
+  for (uint32_t s = 1; s < BENCH_NUM_STAGES; s++)
+  {
+    printf(" %12s", benchStages[s].name);
+  }
+  printf(" %12s%s\n", "other", spectrum ? "  peak" : "");
+
+  for (uint8_t sampleRate = 1; sampleRate <= 4; sampleRate++)
+  {
+    for (uint8_t sampleSize = 1; sampleSize <= 2; sampleSize++)
+    {
+      for (uint8_t slotDuration = 1; slotDuration <= 2; slotDuration++)
+      {
+        for (uint8_t cteLength = 2; cteLength <= 20; cteLength++)
+        {
+          benchCfg_t cfg;
+          benchCtx_t ctx;
+          double stageNs[BENCH_NUM_STAGES];
+          double otherNs;
+
+          if ((onlyRate && onlyRate != sampleRate) || (onlySize && onlySize != sampleSize) ||
+              (onlySlot && onlySlot != slotDuration) || (onlyCte && onlyCte != cteLength))
+          {
+            continue;
+          }
+
+          cfg.sampleRate = sampleRate;
+          cfg.sampleSize = sampleSize;
+          cfg.slotDuration = slotDuration;
+          cfg.cteLength = cteLength;
+          cfg.numIqSamples = AoaSynth_numIqSamples(cteLength, slotDuration, sampleRate);
+          cfg.numReps = AoaSynth_numReps(cfg.numIqSamples, sampleRate, antConfig->numAntennas);
+          cfg.cfoKHz = cfoKHz;
+
+          // A single repetition carries no pair information
+          if (cfg.numReps < BENCH_MIN_REPS)
+          {
+            printf("%4u %4u %4u %4u %5u %4u %12s\n", sampleRate, sampleSize, slotDuration, cteLength,
+                   cfg.numIqSamples, cfg.numReps, "skipped");
+            continue;
+          }
+
+          Bench_initCtx(&ctx, &cfg, avgMode, spectrum, normalize, antConfig, pairAngle);
+          AOA_selectKernel(sampleRate, ctx.sampleSize, slotDuration, genericLoop ? 0 : antConfig->numAntennas);
+
+          for (uint32_t s = 0; s < BENCH_NUM_STAGES; s++)
+          {
+            stageNs[s] = Bench_timeStage(&benchStages[s], &ctx, iterations);
+          }
+
+          printf("%4u %4u %4u %4u %5u %4u %12.1f %12.0f", sampleRate, sampleSize, slotDuration, cteLength,
+                 cfg.numIqSamples, cfg.numReps, stageNs[0], 1e9 / stageNs[0]);
+          otherNs = stageNs[0];
+          for (uint32_t s = 1; s < BENCH_NUM_STAGES; s++)
+          {
+            printf(" %12.1f", stageNs[s]);
+            otherNs -= stageNs[s];
+          }
+          printf(" %12.1f", otherNs);
+          if (spectrum)
+          {
+            printf("  %4d", ctx.spectrumResult.angle);
+          }
+          printf("\n");
+
+          totalNs += stageNs[0];
+          numCfgs++;
+
+          free(ctx.pCapture);
+          free(ctx.pIQ);
+          free(ctx.pCov);
+          free(ctx.pWork);
+        }
+      }
+    }
+  }
+
+  if (numCfgs)
+  {
+    printf("mean over %u configurations: %.1f ns/CTE, %.0f CTE/s\n", numCfgs, totalNs / numCfgs, 1e9 * numCfgs / totalNs);
+  }
+
+  return 0;
+}
@@ -0,0 +1,523 @@
+/******************************************************************************
+
+ @file  aoa_eval.c
+
+ @brief Accuracy versus cost runner of the host-side AoA bench.
+
+        Every variant sees the same captures. A variant runs the path
+        RTLSCtrl_postProcessAoa runs for one CTE: 16 bit captures are
+        normalized first, then the pair angles are turned into an angle
+        with AOA_getArrayAngle, or the covariance of the capture is
+        scanned. The spectrum variants scan every capture on its own,
+        without the covariance averaging over CTEs RTLSCtrl applies.
+        angle_1mhz averages the capture down to 1 MHz with
+        AOA_decimateSamples first, as RTLS_PARAM_AOA_DECIMATION does.
+
+        The BOOSTXL-AOA arrays are used with their geometry only, the
+        pair calibration of the boards is for real antennas and is left
+        out.
+
+ *****************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <stdbool.h>
+
+#include "AOA.h"
+#include "AOA_kernel.h"
+#include "AOA_spectrum.h"
+#include "ant_array1_config_boostxl_rev1v1.h"
+#include "aoa_eval.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define EVAL_AMPLITUDE_8BIT        100.0
+#define EVAL_AMPLITUDE_16BIT       1500.0
+#define EVAL_ULA_SPACING           0.5f
+#define EVAL_MAX_ANGLES            181
+#define EVAL_CAPTURE_BYTES         (AOA_SYNTH_MAX_IQ_SAMPLES * sizeof(AoA_IQSample_Ext_t))
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+// Array under test and the scratch of one sweep
+typedef struct
+{
+  AoA_AntennaConfig_t config;
+  AoA_AntennaPair_t pairs[AOA_MAX_NUM_PAIRS];
+  uint8_t element[AOA_MAX_NUM_ANT];
+  float position[AOA_MAX_NUM_ANT];
+  float slotPosition[AOA_MAX_NUM_ANT];
+  AoA_Covariance_t *pCov;
+  AoA_Covariance_t *pWork;
+  int16_t pairAngle[AOA_MAX_NUM_PAIRS];
+  int8_t *pNorm;
+  const aoaEvalParams_t *pParams;
+  uint16_t numIqSamples;
+} evalCtx_t;
+
+// An estimator variant of the angle path
+typedef struct
+{
+  const char *name;
+  void (*setup)(evalCtx_t *pCtx);
+  bool (*estimate)(evalCtx_t *pCtx, const int8_t *pCapture, int16_t *pAngle);
+} evalVariant_t;
+
+// Errors and cost of one variant
+typedef struct
+{
+  float *pErr;              // Error of every estimate, in sweep order
+  uint32_t numEst;
+  uint32_t numMiss;
+  double totalNs;
+  uint32_t numRuns;
+} evalStats_t;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+static void AoaEval_setupAngle(evalCtx_t *pCtx);
+static void AoaEval_setupAngleGeneric(evalCtx_t *pCtx);
+static void AoaEval_setupAngleDecimated(evalCtx_t *pCtx);
+static void AoaEval_setupPhasor(evalCtx_t *pCtx);
+static void AoaEval_setupBartlett(evalCtx_t *pCtx);
+static void AoaEval_setupMvdr(evalCtx_t *pCtx);
+static bool AoaEval_estimatePairs(evalCtx_t *pCtx, const int8_t *pCapture, int16_t *pAngle);
+static bool AoaEval_estimateDecimated(evalCtx_t *pCtx, const int8_t *pCapture, int16_t *pAngle);
+static bool AoaEval_estimateSpectrum(evalCtx_t *pCtx, const int8_t *pCapture, int16_t *pAngle);
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+static const evalVariant_t evalVariants[] =
+{
+  {"angle",         AoaEval_setupAngle,        AoaEval_estimatePairs},
+  {"angle_generic", AoaEval_setupAngleGeneric, AoaEval_estimatePairs},
+  {"angle_1mhz",    AoaEval_setupAngleDecimated, AoaEval_estimateDecimated},
+  {"phasor",        AoaEval_setupPhasor,       AoaEval_estimatePairs},
+  {"bartlett",      AoaEval_setupBartlett,     AoaEval_estimateSpectrum},
+  {"mvdr",          AoaEval_setupMvdr,         AoaEval_estimateSpectrum},
+};
+
+#define EVAL_NUM_VARIANTS  (sizeof(evalVariants) / sizeof(evalVariants[0]))
+
+// Steering table of the array under test
+static AoA_Steer_t evalSteer[AOA_SPECTRUM_NUM_BINS * AOA_MAX_NUM_ANT];
+
+// RMSE per true angle and variant
+static float angleRmse[EVAL_MAX_ANGLES][EVAL_NUM_VARIANTS];
+
+/*********************************************************************
+ * VARIANTS
+ */
+
+static void AoaEval_setupAngle(evalCtx_t *pCtx)
+{
+  const aoaEvalParams_t *pParams = pCtx->pParams;
+
+  AOA_setAvgMode(AOA_AVG_MODE_ANGLE);
+  AOA_selectKernel(pParams->sampleRate, AOA_NORM_SAMPLE_SIZE, pParams->slotDuration, pCtx->config.numAntennas);
+}
+
+static void AoaEval_setupAngleGeneric(evalCtx_t *pCtx)
+{
+  AOA_setAvgMode(AOA_AVG_MODE_ANGLE);
+  AOA_selectKernel(0, 0, 0, 0);
+}
+
+static void AoaEval_setupAngleDecimated(evalCtx_t *pCtx)
+{
+  AOA_setAvgMode(AOA_AVG_MODE_ANGLE);
+  AOA_selectKernel(1, AOA_NORM_SAMPLE_SIZE, pCtx->pParams->slotDuration, pCtx->config.numAntennas);
+}
+
+static void AoaEval_setupPhasor(evalCtx_t *pCtx)
+{
+  AOA_setAvgMode(AOA_AVG_MODE_PHASOR);
+}
+
+static void AoaEval_setupBartlett(evalCtx_t *pCtx)
+{
+  AOA_spectrumSetMethod(AOA_SPECTRUM_BARTLETT);
+}
+
+static void AoaEval_setupMvdr(evalCtx_t *pCtx)
+{
+  AOA_spectrumSetMethod(AOA_SPECTRUM_MVDR);
+}
+
+/*********************************************************************
+* @fn      AoaEval_prepare
+*
+* @brief   The capture as RTLSCtrl_postProcessAoa hands it to the angle path
+*
+*          16 bit captures are narrowed into the scratch buffer, the
+*          capture itself stays untouched for the next variant.
+*
+* @param   pCtx - sweep context
+* @param   pCapture - synthetic capture
+* @param   pSampleSize - returns the sample size of the returned samples
+*
+* @return  samples to estimate from
+*/
+static const int8_t *AoaEval_prepare(evalCtx_t *pCtx, const int8_t *pCapture, uint8_t *pSampleSize)
+{
+  const AoA_IQSample_Ext_t *pExt = (const AoA_IQSample_Ext_t *)pCapture;
+
+  *pSampleSize = pCtx->pParams->sampleSize;
+
+  if (*pSampleSize != 2)
+  {
+    return pCapture;
+  }
+
+  AOA_narrowSamples(pExt, (AoA_IQSample_t *)pCtx->pNorm, pCtx->numIqSamples, AOA_blockExponent(pExt, pCtx->numIqSamples));
+  *pSampleSize = AOA_NORM_SAMPLE_SIZE;
+
+  return pCtx->pNorm;
+}
+
+static bool AoaEval_estimatePairs(evalCtx_t *pCtx, const int8_t *pCapture, int16_t *pAngle)
+{
+  const aoaEvalParams_t *pParams = pCtx->pParams;
+  AoA_AntennaResult_t result = {.pairAngle = pCtx->pairAngle};
+  uint8_t sampleSize;
+  const int8_t *pIQ = AoaEval_prepare(pCtx, pCapture, &sampleSize);
+
+  AOA_getPairAngles(&pCtx->config, &result, pCtx->numIqSamples, pParams->sampleRate, sampleSize,
+                    pParams->slotDuration, pCtx->config.numAntennas, (int8_t *)pIQ);
+
+  return AOA_getArrayAngle(&pCtx->config, &result, pAngle);
+}
+
+// The capture averaged down to 1 MHz in the scratch buffer, the copy is counted in the cost
+static bool AoaEval_estimateDecimated(evalCtx_t *pCtx, const int8_t *pCapture, int16_t *pAngle)
+{
+  const aoaEvalParams_t *pParams = pCtx->pParams;
+  AoA_AntennaResult_t result = {.pairAngle = pCtx->pairAngle};
+  uint16_t numIqSamples = pCtx->numIqSamples;
+  uint8_t sampleRate = pParams->sampleRate;
+  uint8_t sampleSize = pParams->sampleSize;
+
+  memcpy(pCtx->pNorm, pCapture, numIqSamples * ((sampleSize == 2) ? sizeof(AoA_IQSample_Ext_t) : sizeof(AoA_IQSample_t)));
+  AOA_decimateSamples(pCtx->pNorm, &numIqSamples, &sampleRate, sampleSize, sampleRate);
+  AOA_normalizeSamples(pCtx->pNorm, numIqSamples, &sampleSize);
+
+  AOA_getPairAngles(&pCtx->config, &result, numIqSamples, sampleRate, sampleSize,
+                    pParams->slotDuration, pCtx->config.numAntennas, pCtx->pNorm);
+
+  return AOA_getArrayAngle(&pCtx->config, &result, pAngle);
+}
+
+static bool AoaEval_estimateSpectrum(evalCtx_t *pCtx, const int8_t *pCapture, int16_t *pAngle)
+{
+  const aoaEvalParams_t *pParams = pCtx->pParams;
+  AoA_SpectrumResult_t result;
+  uint8_t sampleSize;
+  const int8_t *pIQ = AoaEval_prepare(pCtx, pCapture, &sampleSize);
+
+  if (!AOA_getCovariance(&pCtx->config, pCtx->pCov, pCtx->numIqSamples, pParams->sampleRate, sampleSize,
+                         pParams->slotDuration, pCtx->config.numAntennas, (int8_t *)pIQ) ||
+      !AOA_spectrumScan(pCtx->pCov, pCtx->pWork, &result))
+  {
+    return false;
+  }
+
+  *pAngle = result.angle;
+
+  return true;
+}
+
+/*********************************************************************
+ * HELPERS
+ */
+
+static double AoaEval_nowNs(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static int AoaEval_cmpFloat(const void *a, const void *b)
+{
+  const float x = *(const float *)a;
+  const float y = *(const float *)b;
+
+  return (x > y) - (x < y);
+}
+
+/*********************************************************************
+* @fn      AoaEval_initArray
+*
+* @brief   Ideal configuration of the array under test
+*
+*          The BOOSTXL-AOA arrays keep their pattern and element positions,
+*          every element is paired with every other element as for an array
+*          described by the host.
+*
+* @param   pCtx - sweep context
+*
+* @return  true if the array could be built
+*/
+static bool AoaEval_initArray(evalCtx_t *pCtx)
+{
+  const aoaEvalParams_t *pParams = pCtx->pParams;
+  uint8_t numAnt = pParams->numAnt;
+  uint8_t numElements = pParams->numAnt;
+
+  if (numAnt == 0)
+  {
+    const AoA_AntennaConfig_t *pBoard = (pParams->boardArray == 2) ? getAntennaArray2Config() : getAntennaArray1Config();
+
+    numAnt = pBoard->numAntennas;
+    numElements = pBoard->numElements;
+
+    for (uint8_t k = 0; k < numAnt; k++)
+    {
+      pCtx->element[k] = (pBoard->pElement != NULL) ? pBoard->pElement[k] : k;
+    }
+
+    for (uint8_t e = 0; e < numElements; e++)
+    {
+      pCtx->position[e] = pBoard->pPosition[e];
+    }
+  }
+  else
+  {
+    for (uint8_t k = 0; k < numAnt; k++)
+    {
+      pCtx->element[k] = k;
+      pCtx->position[k] = k * EVAL_ULA_SPACING;
+    }
+  }
+
+  if (!AOA_initArrayConfig(&pCtx->config, numAnt, numElements, pCtx->element, pCtx->position, pCtx->pairs))
+  {
+    return false;
+  }
+
+  // The generator places every pattern slot at the position of its element
+  for (uint8_t k = 0; k < numAnt; k++)
+  {
+    pCtx->slotPosition[k] = pCtx->position[pCtx->element[k]];
+  }
+
+  return true;
+}
+
+/*********************************************************************
+* @fn      AoaEval_printChannel
+*
+* @brief   Print the sweep configuration
+*/
+static void AoaEval_printChannel(const evalCtx_t *pCtx)
+{
+  const aoaEvalParams_t *pParams = pCtx->pParams;
+  const aoaSynthParams_t *pChannel = &pParams->channel;
+
+  if (pParams->numAnt == 0)
+  {
+    printf("array: BOOSTXL-AOA A%u, %u antennas, %u pairs\n", (pParams->boardArray == 2) ? 2 : 1,
+           pCtx->config.numAntennas, pCtx->config.numPairs);
+  }
+  else
+  {
+    printf("array: linear, %u antennas, %u pairs\n", pCtx->config.numAntennas, pCtx->config.numPairs);
+  }
+
+  printf("capture: rate %u, size %u, slot %u, cte %u, %u IQ samples, %u trials per angle, angles %.0f to %.0f step %.0f\n",
+         pParams->sampleRate, pParams->sampleSize, pParams->slotDuration, pParams->cteLength, pCtx->numIqSamples,
+         pParams->trials, pParams->minAngleDeg, pParams->maxAngleDeg, pParams->stepDeg);
+
+  printf("channel: snr ");
+  if (pParams->snrDb >= AOA_EVAL_NO_NOISE_DB)
+  {
+    printf("inf");
+  }
+  else
+  {
+    printf("%.1f dB", pParams->snrDb);
+  }
+  printf(", cfo %.0f kHz, phase noise %.2f deg/sqrt(us), glitch %.3f", pChannel->cfoKHz, pChannel->phaseNoiseDeg, pChannel->glitchProb);
+  for (uint8_t t = 0; t < pChannel->numTaps; t++)
+  {
+    printf(", tap %.0f deg %.1f dB %.0f deg", pChannel->taps[t].angleDeg, pChannel->taps[t].gainDb, pChannel->taps[t].phaseDeg);
+  }
+  printf("\n");
+}
+
+/*********************************************************************
+ * PUBLIC FUNCTIONS
+ */
+
+int AoaEval_run(const aoaEvalParams_t *pParams)
+{
+  static evalCtx_t ctx;
+  evalStats_t stats[EVAL_NUM_VARIANTS];
+  const double amplitude = (pParams->sampleSize == 1) ? EVAL_AMPLITUDE_8BIT : EVAL_AMPLITUDE_16BIT;
+  const uint32_t numAngles = (uint32_t)floor((pParams->maxAngleDeg - pParams->minAngleDeg) / pParams->stepDeg + 1e-9) + 1;
+  aoaSynthParams_t synth = pParams->channel;
+  int8_t *pBatch;
+  int16_t *pEst;
+  bool *pOk;
+
+  memset(&ctx, 0, sizeof(ctx));
+  ctx.pParams = pParams;
+  ctx.numIqSamples = AoaSynth_numIqSamples(pParams->cteLength, pParams->slotDuration, pParams->sampleRate);
+
+  if ((pParams->trials == 0) || (pParams->stepDeg <= 0) || (numAngles > EVAL_MAX_ANGLES) || !AoaEval_initArray(&ctx) ||
+      (AoaSynth_numReps(ctx.numIqSamples, pParams->sampleRate, ctx.config.numAntennas) < 1))
+  {
+    fprintf(stderr, "eval: configuration not usable\n");
+    return 1;
+  }
+
+  AoaEval_printChannel(&ctx);
+
+  ctx.pCov = calloc(1, AOA_COV_SIZE(ctx.config.numElements));
+  ctx.pWork = calloc(1, AOA_COV_SIZE(ctx.config.numElements));
+  ctx.pCov->numAnt = ctx.config.numElements;
+  ctx.pWork->numAnt = ctx.config.numElements;
+  ctx.pNorm = malloc(EVAL_CAPTURE_BYTES);
+  pBatch = malloc((size_t)pParams->trials * EVAL_CAPTURE_BYTES);
+  pEst = malloc(pParams->trials * sizeof(int16_t));
+  pOk = malloc(pParams->trials * sizeof(bool));
+  AOA_spectrumInit(&ctx.config, evalSteer);
+
+  for (uint32_t v = 0; v < EVAL_NUM_VARIANTS; v++)
+  {
+    memset(&stats[v], 0, sizeof(stats[v]));
+    stats[v].pErr = malloc((size_t)numAngles * pParams->trials * sizeof(float));
+  }
+
+  synth.sampleRate = pParams->sampleRate;
+  synth.sampleSize = pParams->sampleSize;
+  synth.slotDuration = pParams->slotDuration;
+  synth.numAnt = ctx.config.numAntennas;
+  synth.numIqSamples = ctx.numIqSamples;
+  synth.amplitude = amplitude;
+  synth.spacingWl = EVAL_ULA_SPACING;
+  synth.pPosition = ctx.slotPosition;
+  synth.noiseRms = (pParams->snrDb >= AOA_EVAL_NO_NOISE_DB) ? 0 : AoaSynth_noiseRms(amplitude, pParams->snrDb);
+
+  for (uint32_t a = 0; a < numAngles; a++)
+  {
+    const double angle = pParams->minAngleDeg + a * pParams->stepDeg;
+
+    // Every variant estimates from the same captures
+    synth.angleDeg = angle;
+    for (uint32_t t = 0; t < pParams->trials; t++)
+    {
+      synth.seed = 1 + a * pParams->trials + t;
+      AoaSynth_generate(&synth, &pBatch[t * EVAL_CAPTURE_BYTES]);
+    }
+
+    for (uint32_t v = 0; v < EVAL_NUM_VARIANTS; v++)
+    {
+      double sumSq = 0;
+      uint32_t numEst = 0;
+      double start;
+
+      evalVariants[v].setup(&ctx);
+
+      // Only the estimator is timed, errors are evaluated afterwards
+      start = AoaEval_nowNs();
+      for (uint32_t t = 0; t < pParams->trials; t++)
+      {
+        pOk[t] = evalVariants[v].estimate(&ctx, &pBatch[t * EVAL_CAPTURE_BYTES], &pEst[t]);
+      }
+      stats[v].totalNs += AoaEval_nowNs() - start;
+      stats[v].numRuns += pParams->trials;
+
+      for (uint32_t t = 0; t < pParams->trials; t++)
+      {
+        if (!pOk[t])
+        {
+          stats[v].numMiss++;
+          continue;
+        }
+
+        stats[v].pErr[stats[v].numEst++] = (float)(pEst[t] - angle);
+        sumSq += (pEst[t] - angle) * (pEst[t] - angle);
+        numEst++;
+      }
+
+      angleRmse[a][v] = numEst ? (float)sqrt(sumSq / numEst) : NAN;
+    }
+  }
+
+  printf("%8s", "angle");
+  for (uint32_t v = 0; v < EVAL_NUM_VARIANTS; v++)
+  {
+    printf(" %14s", evalVariants[v].name);
+  }
+  printf("\n");
+
+  for (uint32_t a = 0; a < numAngles; a++)
+  {
+    printf("%8.1f", pParams->minAngleDeg + a * pParams->stepDeg);
+    for (uint32_t v = 0; v < EVAL_NUM_VARIANTS; v++)
+    {
+      printf(" %14.2f", angleRmse[a][v]);
+    }
+    printf("\n");
+  }
+  printf("\n");
+
+  printf("%-14s %8s %8s %8s %8s %8s %10s\n", "variant", "rmse", "bias", "p99", "max", "misses", "ns/CTE");
+
+  for (uint32_t v = 0; v < EVAL_NUM_VARIANTS; v++)
+  {
+    evalStats_t *pStats = &stats[v];
+    double sum = 0, sumSq = 0;
+    float p99 = 0, max = 0;
+
+    for (uint32_t k = 0; k < pStats->numEst; k++)
+    {
+      sum += pStats->pErr[k];
+      sumSq += (double)pStats->pErr[k] * pStats->pErr[k];
+      pStats->pErr[k] = fabsf(pStats->pErr[k]);
+    }
+
+    if (pStats->numEst != 0)
+    {
+      qsort(pStats->pErr, pStats->numEst, sizeof(float), AoaEval_cmpFloat);
+      p99 = pStats->pErr[(uint32_t)ceil(0.99 * pStats->numEst) - 1];
+      max = pStats->pErr[pStats->numEst - 1];
+    }
+
+    printf("%-14s %8.2f %8.2f %8.1f %8.1f %8u %10.1f\n", evalVariants[v].name,
+           pStats->numEst ? sqrt(sumSq / pStats->numEst) : 0.0, pStats->numEst ? sum / pStats->numEst : 0.0,
+           p99, max, pStats->numMiss, pStats->totalNs / pStats->numRuns);
+
+    free(pStats->pErr);
+  }
+
+  AOA_setAvgMode(AOA_AVG_MODE_ANGLE);
+  AOA_selectKernel(0, 0, 0, 0);
+  AOA_spectrumSetMethod(AOA_SPECTRUM_METHOD_DEFAULT);
+
+  free(pBatch);
+  free(pEst);
+  free(pOk);
+  free(ctx.pNorm);
+  free(ctx.pCov);
+  free(ctx.pWork);
+
+  return 0;
+}
@@ -0,0 +1,64 @@
+/******************************************************************************
+
+ @file  aoa_eval.h
+
+ @brief Accuracy versus cost runner of the host-side AoA bench.
+
+        Sweeps the true angle over synthetic captures from aoa_synth and
+        runs every estimator variant of the angle path on the same
+        captures. For every variant the RMSE, bias, 99th percentile and
+        largest absolute error are reported next to the host time per
+        CTE, so a faster variant can be judged by what it costs in
+        accuracy.
+
+ *****************************************************************************/
+
+#ifndef AOA_EVAL_H_
+#define AOA_EVAL_H_
+
+#include <stdint.h>
+
+#include "aoa_synth.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define AOA_EVAL_DEFAULT_TRIALS     200     //!< Captures per true angle
+#define AOA_EVAL_NO_NOISE_DB        200.0   //!< SNR at or above which no AWGN is added
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+/// @brief Parameters of one sweep
+typedef struct
+{
+  uint8_t  sampleRate;      //!< 1-4 MHz
+  uint8_t  sampleSize;      //!< 1 = 8 bit, 2 = 16 bit
+  uint8_t  slotDuration;    //!< 1 = 1us, 2 = 2us
+  uint8_t  cteLength;       //!< CTE length in 8us units (2-20)
+  uint8_t  numAnt;          //!< 0 for a BOOSTXL-AOA array, else a uniform linear array of numAnt elements
+  uint8_t  boardArray;      //!< BOOSTXL-AOA array 1 or 2 for numAnt 0
+  uint32_t trials;          //!< Captures per true angle
+  double   minAngleDeg;     //!< First true angle
+  double   maxAngleDeg;     //!< Last true angle
+  double   stepDeg;         //!< True angle step
+  double   snrDb;           //!< Direct path to AWGN power ratio
+  aoaSynthParams_t channel; //!< Channel model: cfoKHz, phaseNoiseDeg, glitchProb and taps are used
+} aoaEvalParams_t;
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+
+/**
+* @brief   Run the sweep and print the accuracy and cost of every estimator variant
+*
+* @param   pParams - sweep parameters
+*
+* @return  0 on success, 1 if the configuration is not usable
+*/
+int AoaEval_run(const aoaEvalParams_t *pParams);
+
+#endif /* AOA_EVAL_H_ */
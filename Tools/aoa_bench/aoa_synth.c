@@ -0,0 +1,274 @@
+/******************************************************************************
+
+ @file  aoa_synth.c
+
+ @brief Synthetic CTE IQ capture generator used by the host-side AoA bench.
+
+ *****************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "aoa_synth.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define SYNTH_PI    3.14159265358979323846
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+// Complex channel gain of one pattern slot
+typedef struct
+{
+  double re;
+  double im;
+} aoaSynthGain_t;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+/*********************************************************************
+* @fn      AoaSynth_sampleTime
+*
+* @brief   Time of a sample relative to the start of the CTE
+*
+* @param   pParams - capture parameters
+* @param   k - sample index
+* @param   pAnt - returns the antenna index the sample was taken on
+*
+* @return  time in us
+*/
+static double AoaSynth_sampleTime(const aoaSynthParams_t *pParams, uint16_t k, uint8_t *pAnt)
+{
+  const uint16_t refSamples = AOA_SYNTH_REF_PERIOD_US * pParams->sampleRate;
+
+  if (k < refSamples)
+  {
+    *pAnt = 0;
+    return AOA_SYNTH_GUARD_US + (double)k / pParams->sampleRate;
+  }
+  else if (pParams->rawRf)
+  {
+    const uint16_t slotSamples = 2 * pParams->slotDuration * pParams->sampleRate;
+    uint16_t slot = (k - refSamples) / slotSamples;
+    uint16_t i = (k - refSamples) % slotSamples;
+
+    // The antenna is switched at the start of the switch slot
+    *pAnt = slot % pParams->numAnt;
+    return AOA_SYNTH_GUARD_US + AOA_SYNTH_REF_PERIOD_US +
+           2 * slot * pParams->slotDuration +
+           (double)i / pParams->sampleRate;
+  }
+  else
+  {
+    uint16_t slot = (k - refSamples) / pParams->sampleRate;
+    uint16_t i = (k - refSamples) % pParams->sampleRate;
+
+    // Switch slot precedes every sample slot
+    *pAnt = slot % pParams->numAnt;
+    return AOA_SYNTH_GUARD_US + AOA_SYNTH_REF_PERIOD_US +
+           (2 * slot + 1) * pParams->slotDuration +
+           (double)i / pParams->sampleRate;
+  }
+}
+
+/*********************************************************************
+* @fn      AoaSynth_uniform
+*
+* @brief   Uniform draw in (0, 1) from a xorshift32 state
+*/
+static double AoaSynth_uniform(uint32_t *pState)
+{
+  uint32_t x = *pState;
+
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *pState = x;
+
+  return ((x >> 8) + 0.5) / (double)(1u << 24);
+}
+
+/*********************************************************************
+* @fn      AoaSynth_gauss
+*
+* @brief   Standard normal draw (Box-Muller)
+*/
+static double AoaSynth_gauss(uint32_t *pState)
+{
+  const double u1 = AoaSynth_uniform(pState);
+  const double u2 = AoaSynth_uniform(pState);
+
+  return sqrt(-2.0 * log(u1)) * cos(2.0 * SYNTH_PI * u2);
+}
+
+/*********************************************************************
+* @fn      AoaSynth_slotGain
+*
+* @brief   Channel gain of a pattern slot, the direct path plus all multipath taps
+*
+* @param   pParams - capture parameters
+* @param   slot - pattern slot
+*
+* @return  complex gain, 1 for the direct path alone at position 0
+*/
+static aoaSynthGain_t AoaSynth_slotGain(const aoaSynthParams_t *pParams, uint8_t slot)
+{
+  const double pos = (pParams->pPosition != NULL) ? pParams->pPosition[slot] : slot * pParams->spacingWl;
+  aoaSynthGain_t gain = {0, 0};
+
+  for (uint8_t p = 0; p <= pParams->numTaps; p++)
+  {
+    // Path 0 is the direct path
+    const double angleDeg = (p == 0) ? pParams->angleDeg : pParams->taps[p - 1].angleDeg;
+    const double mag = (p == 0) ? 1.0 : pow(10.0, pParams->taps[p - 1].gainDb / 20.0);
+    const double phase = ((p == 0) ? 0.0 : pParams->taps[p - 1].phaseDeg * SYNTH_PI / 180.0) -
+                         2.0 * SYNTH_PI * pos * sin(angleDeg * SYNTH_PI / 180.0);
+
+    gain.re += mag * cos(phase);
+    gain.im += mag * sin(phase);
+  }
+
+  return gain;
+}
+
+/*********************************************************************
+* @fn      AoaSynth_clamp
+*
+* @brief   Round and saturate a sample to the capture sample size
+*/
+static int32_t AoaSynth_clamp(double v, uint8_t sampleSize)
+{
+  const int32_t maxVal = (sampleSize == 1) ? INT8_MAX : INT16_MAX;
+  const int32_t minVal = (sampleSize == 1) ? INT8_MIN : INT16_MIN;
+  long r = lround(v);
+
+  if (r > maxVal)
+  {
+    return maxVal;
+  }
+  if (r < minVal)
+  {
+    return minVal;
+  }
+  return (int32_t)r;
+}
+
+/*********************************************************************
+ * PUBLIC FUNCTIONS
+ */
+
+uint16_t AoaSynth_numIqSamples(uint8_t cteLength, uint8_t slotDuration, uint8_t sampleRate)
+{
+  int32_t slotTime = cteLength * 8 - AOA_SYNTH_GUARD_US - AOA_SYNTH_REF_PERIOD_US;
+  int32_t numSlots = (slotTime > 0) ? slotTime / (2 * slotDuration) : 0;
+
+  return (uint16_t)((AOA_SYNTH_REF_PERIOD_US + numSlots) * sampleRate);
+}
+
+uint16_t AoaSynth_numRawIqSamples(uint8_t cteLength, uint8_t slotDuration, uint8_t sampleRate)
+{
+  int32_t slotTime = cteLength * 8 - AOA_SYNTH_GUARD_US - AOA_SYNTH_REF_PERIOD_US;
+  int32_t numSlots = (slotTime > 0) ? slotTime / (2 * slotDuration) : 0;
+
+  return (uint16_t)((AOA_SYNTH_REF_PERIOD_US + numSlots * 2 * slotDuration) * sampleRate);
+}
+
+uint16_t AoaSynth_numReps(uint16_t numIqSamples, uint8_t sampleRate, uint8_t numAnt)
+{
+  return (numIqSamples - AOA_SYNTH_REF_PERIOD_US * sampleRate) / (numAnt * sampleRate);
+}
+
+double AoaSynth_noiseRms(double amplitude, double snrDb)
+{
+  // The noise power is split evenly between I and Q
+  return amplitude / sqrt(2.0 * pow(10.0, snrDb / 10.0));
+}
+
+void AoaSynth_generate(const aoaSynthParams_t *pParams, int8_t *pIQ)
+{
+  const uint16_t refSamples = AOA_SYNTH_REF_PERIOD_US * pParams->sampleRate;
+  const double phaseNoise = pParams->phaseNoiseDeg * SYNTH_PI / 180.0;
+  aoaSynthGain_t gain[AOA_SYNTH_MAX_ANT];
+  uint32_t state = (pParams->seed != 0) ? pParams->seed : 1;
+  double walk = 0;
+  double tPrev = AOA_SYNTH_GUARD_US;
+
+  for (uint8_t slot = 0; (slot < pParams->numAnt) && (slot < AOA_SYNTH_MAX_ANT); slot++)
+  {
+    gain[slot] = AoaSynth_slotGain(pParams, slot);
+  }
+
+  for (uint16_t k = 0; k < pParams->numIqSamples; k++)
+  {
+    uint8_t ant;
+    const double t = AoaSynth_sampleTime(pParams, k, &ant);
+    const bool slotStart = (k >= refSamples) && !pParams->rawRf && (((k - refSamples) % pParams->sampleRate) == 0);
+    const bool transient = (k >= refSamples) && pParams->rawRf &&
+                           ((double)((k - refSamples) % (2 * pParams->slotDuration * pParams->sampleRate)) / pParams->sampleRate < pParams->transientUs);
+    double phase;
+    double re, im;
+    int32_t i, q;
+
+    // The phase noise walks on between the samples, also through the switch slots
+    if (phaseNoise > 0)
+    {
+      walk += AoaSynth_gauss(&state) * phaseNoise * sqrt(t - tPrev);
+      tPrev = t;
+    }
+
+    phase = 2.0 * SYNTH_PI * (AOA_SYNTH_TONE_MHZ + pParams->cfoKHz / 1000.0) * t + walk;
+    re = pParams->amplitude * (gain[ant].re * cos(phase) - gain[ant].im * sin(phase));
+    im = pParams->amplitude * (gain[ant].re * sin(phase) + gain[ant].im * cos(phase));
+
+    // A transient right after the switch leaves a sample of any phase
+    if (slotStart && (pParams->glitchProb > 0) && (AoaSynth_uniform(&state) < pParams->glitchProb))
+    {
+      phase = 2.0 * SYNTH_PI * AoaSynth_uniform(&state);
+      re = pParams->amplitude * cos(phase);
+      im = pParams->amplitude * sin(phase);
+    }
+
+    // While the switch settles the level rings as well
+    if (transient)
+    {
+      const double level = 2.0 * AoaSynth_uniform(&state);
+
+      phase = 2.0 * SYNTH_PI * AoaSynth_uniform(&state);
+      re = pParams->amplitude * level * cos(phase);
+      im = pParams->amplitude * level * sin(phase);
+    }
+
+    if (pParams->noiseRms > 0)
+    {
+      re += AoaSynth_gauss(&state) * pParams->noiseRms;
+      im += AoaSynth_gauss(&state) * pParams->noiseRms;
+    }
+
+    i = AoaSynth_clamp(re, pParams->sampleSize);
+    q = AoaSynth_clamp(im, pParams->sampleSize);
+
+    if (pParams->sampleSize == 1)
+    {
+      pIQ[2 * k]     = (int8_t)i;
+      pIQ[2 * k + 1] = (int8_t)q;
+    }
+    else
+    {
+      int16_t *pIQExt = (int16_t *)pIQ;
+
+      pIQExt[2 * k]     = (int16_t)i;
+      pIQExt[2 * k + 1] = (int16_t)q;
+    }
+  }
+}
@@ -0,0 +1,128 @@
+/******************************************************************************
+
+ @file  aoa_synth.h
+
+ @brief Synthetic CTE IQ capture generator used by the host-side AoA bench.
+        Captures are written in the exact layout consumed by
+        AOA_getPairAngles (RTLS_MASTER): reference period followed by
+        sample slots, sampleRate samples per slot. RAW RF captures for
+        AOA_getPairAnglesRaw keep the switch slots as well.
+
+        The channel between the transmitter and every array element is
+        modelled with a carrier frequency offset, AWGN, a random walk
+        phase noise, multipath taps arriving from other angles and
+        switching transients at the start of sample slots. A parameter
+        block that is all zero apart from the capture configuration is
+        an ideal plane wave.
+
+ *****************************************************************************/
+
+#ifndef AOA_SYNTH_H_
+#define AOA_SYNTH_H_
+
+#include <stdint.h>
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define AOA_SYNTH_REF_PERIOD_US     8     //!< CTE reference period
+#define AOA_SYNTH_GUARD_US          4     //!< CTE guard period
+#define AOA_SYNTH_TONE_MHZ          0.25  //!< CTE tone offset from the carrier
+#define AOA_SYNTH_MAX_IQ_SAMPLES    512   //!< Largest capture the generator will produce
+#define AOA_SYNTH_MAX_ANT           16    //!< Longest antenna pattern
+#define AOA_SYNTH_MAX_TAPS          4     //!< Multipath taps besides the direct path
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+/// @brief A multipath component, relative to the direct path
+typedef struct
+{
+  double   angleDeg;        //!< Angle of arrival of the reflection
+  double   gainDb;          //!< Power relative to the direct path
+  double   phaseDeg;        //!< Carrier phase relative to the direct path
+} aoaSynthTap_t;
+
+/// @brief Parameters of one synthetic capture
+typedef struct
+{
+  uint8_t  sampleRate;      //!< 1-4 MHz
+  uint8_t  sampleSize;      //!< 1 = 8 bit, 2 = 16 bit
+  uint8_t  slotDuration;    //!< 1 = 1us, 2 = 2us
+  uint8_t  numAnt;          //!< Number of antennas in the switching pattern
+  uint16_t numIqSamples;    //!< Number of IQ samples to generate
+  double   angleDeg;        //!< True angle of arrival
+  double   amplitude;       //!< Sample amplitude (LSB)
+  double   spacingWl;       //!< Element spacing in wavelengths
+  double   cfoKHz;          //!< Carrier frequency offset of the transmitter
+  const float *pPosition;   //!< Position of every pattern slot in wavelengths, NULL for slot * spacingWl
+  double   noiseRms;        //!< AWGN standard deviation of I and Q (LSB), 0 for none
+  double   phaseNoiseDeg;   //!< Phase noise, rms random walk over 1 us in degrees, 0 for none
+  double   glitchProb;      //!< Probability that the first sample of a sample slot is a switching transient
+  uint8_t  rawRf;           //!< 1: RAW RF capture, every switch slot is sampled as well
+  double   transientUs;     //!< RAW RF: samples this long after every antenna switch are of any phase and level
+  uint8_t  numTaps;         //!< Number of multipath taps
+  aoaSynthTap_t taps[AOA_SYNTH_MAX_TAPS]; //!< Multipath taps
+  uint32_t seed;            //!< Seed of the noise and transient draws
+} aoaSynthParams_t;
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+
+/**
+* @brief   Number of IQ samples reported for a CTE
+*
+* @param   cteLength - CTE length in 8us units (2-20)
+* @param   slotDuration - 1 = 1us, 2 = 2us
+* @param   sampleRate - 1-4 MHz
+*
+* @return  Number of IQ samples
+*/
+uint16_t AoaSynth_numIqSamples(uint8_t cteLength, uint8_t slotDuration, uint8_t sampleRate);
+
+/**
+* @brief   Number of IQ samples of a RAW RF capture of a CTE
+*
+* @param   cteLength - CTE length in 8us units (2-20)
+* @param   slotDuration - 1 = 1us, 2 = 2us
+* @param   sampleRate - 1-4 MHz
+*
+* @return  Number of IQ samples
+*/
+uint16_t AoaSynth_numRawIqSamples(uint8_t cteLength, uint8_t slotDuration, uint8_t sampleRate);
+
+/**
+* @brief   Number of complete switching-pattern repetitions in a capture
+*
+* @param   numIqSamples - number of IQ samples
+* @param   sampleRate - 1-4 MHz
+* @param   numAnt - number of antennas in the pattern
+*
+* @return  Number of repetitions
+*/
+uint16_t AoaSynth_numReps(uint16_t numIqSamples, uint8_t sampleRate, uint8_t numAnt);
+
+/**
+* @brief   Noise standard deviation of I and Q for a signal to noise ratio
+*
+* @param   amplitude - sample amplitude (LSB)
+* @param   snrDb - ratio of the direct path power to the noise power
+*
+* @return  noiseRms of aoaSynthParams_t
+*/
+double AoaSynth_noiseRms(double amplitude, double snrDb);
+
+/**
+* @brief   Generate a capture of a plane wave through the channel model
+*
+* @param   pParams - capture parameters
+* @param   pIQ - output buffer, AoA_IQSample_t or AoA_IQSample_Ext_t depending on sampleSize
+*
+* @return  none
+*/
+void AoaSynth_generate(const aoaSynthParams_t *pParams, int8_t *pIQ);
+
+#endif /* AOA_SYNTH_H_ */
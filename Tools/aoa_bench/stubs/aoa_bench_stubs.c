@@ -0,0 +1,50 @@
+/*
+ * Host stubs for the TI driver symbols referenced by the AoA sources.
+ * Used by the aoa_bench build only.
+ */
+#include <stddef.h>
+
+#include <ti/drivers/PIN.h>
+#include <ti/drivers/pin/PINCC26XX.h>
+#include <ti/drivers/rf/RF.h>
+
+#include "rf_hal.h"
+
+RF_Handle urfiHandle = NULL;
+
+uint8_t gAoaBenchRfRam[AOA_BENCH_RF_RAM_SIZE];
+
+RF_CmdHandle RF_scheduleCmd(RF_Handle h, RF_Op *pOp, RF_ScheduleCmdParams *pSchParams, RF_Callback pCb, RF_EventMask bmEvent)
+{
+  (void)h;
+  (void)pOp;
+  (void)pSchParams;
+  (void)pCb;
+  (void)bmEvent;
+  return 0;
+}
+
+PIN_Handle PIN_open(PIN_State *state, const PIN_Config pinList[])
+{
+  (void)pinList;
+  return state;
+}
+
+PIN_Status PIN_add(PIN_Handle handle, PIN_Config pinCfg)
+{
+  (void)handle;
+  (void)pinCfg;
+  return PIN_SUCCESS;
+}
+
+void PIN_close(PIN_Handle handle)
+{
+  (void)handle;
+}
+
+PIN_Status PINCC26XX_setOutputValue(PIN_Id pinId, uint32_t val)
+{
+  (void)pinId;
+  (void)val;
+  return PIN_SUCCESS;
+}
@@ -0,0 +1,11 @@
+/*
+ * Host stub of driverlib/ioc.h, used by the aoa_bench build only.
+ */
+#ifndef IOC_STUB_H_
+#define IOC_STUB_H_
+
+#include <stdint.h>
+
+#define IOID_UNUSED 0xFFFFFFFF
+
+#endif /* IOC_STUB_H_ */
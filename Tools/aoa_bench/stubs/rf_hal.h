@@ -0,0 +1,65 @@
+/*
+ * Host stub of the BLE stack rf_hal.h, used by the aoa_bench build only.
+ * Provides the stack base types, the RF command structures referenced by AOA.c
+ * and a simulated RF core RAM.
+ */
+#ifndef RF_HAL_STUB_H_
+#define RF_HAL_STUB_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+typedef uint8_t  uint8;
+typedef uint16_t uint16;
+typedef uint32_t uint32;
+typedef int8_t   int8;
+typedef int16_t  int16;
+typedef int32_t  int32;
+
+#ifndef TRUE
+#define TRUE  1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+// RF core RAM, simulated by the bench in gAoaBenchRfRam
+#define AOA_BENCH_RF_RAM_SIZE 0xD000
+extern uint8_t gAoaBenchRfRam[AOA_BENCH_RF_RAM_SIZE];
+
+#define RFC_RAM_BASE ((uintptr_t)gAoaBenchRfRam)
+#define HWREGB(x)    (*((volatile uint8_t *)(x)))
+
+// Radio commands, status and trigger values AOA.c issues its RF RAM commands with
+#define CMD_FORCE_CLK_ENA               0x0402
+#define CMD_RUN_IMMEDIATE_COMMAND       0x0404
+#define RFSTAT_IDLE                     0x0000
+#define TRIGTYPE_NOW                    0
+#define CONDTYPE_ALWAYS_RUN_NEXT_CMD    0
+
+typedef struct
+{
+  uint16_t cmdNum;
+  uint16_t status;
+  void     *pNextRfOp;
+  uint32_t startTime;
+  uint8_t  startTrig;
+  uint8_t  condition;
+} rfOpCmd_t;
+
+typedef struct
+{
+  rfOpCmd_t rfOpCmd;
+  uint16_t  reserved;
+  uint32_t  cmdVal;
+  uint32_t  cmdStatVal;
+} rfOpCmd_runImmedCmd_t;
+
+typedef struct
+{
+  uint16_t cmdNum;
+  uint16_t clkEnab;
+} rfOpImmedCmd_ForceClkEnab_t;
+
+#endif /* RF_HAL_STUB_H_ */
@@ -0,0 +1,9 @@
+/*
+ * Host stub of the SimpleLink DeviceFamily.h, used by the aoa_bench build only.
+ */
+#ifndef DEVICEFAMILY_STUB_H_
+#define DEVICEFAMILY_STUB_H_
+
+#define DeviceFamily_CC26X2
+
+#endif /* DEVICEFAMILY_STUB_H_ */
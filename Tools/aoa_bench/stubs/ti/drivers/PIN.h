@@ -0,0 +1,28 @@
+/*
+ * Host stub of ti/drivers/PIN.h, used by the aoa_bench build only.
+ */
+#ifndef PIN_STUB_H_
+#define PIN_STUB_H_
+
+#include <stdint.h>
+
+typedef uint32_t PIN_Config;
+typedef uint32_t PIN_Id;
+typedef int      PIN_Status;
+typedef struct { uint32_t dummy; } PIN_State;
+typedef PIN_State *PIN_Handle;
+
+#define PIN_SUCCESS          0
+#define PIN_TERMINATE        0xFE
+#define PIN_GPIO_OUTPUT_EN   (1 << 23)
+#define PIN_GPIO_LOW         (0 << 22)
+#define PIN_GPIO_HIGH        (1 << 22)
+#define PIN_PUSHPULL         0
+#define PIN_INPUT_DIS        (1 << 29)
+#define PIN_DRVSTR_MED       (1 << 25)
+
+PIN_Handle PIN_open(PIN_State *state, const PIN_Config pinList[]);
+PIN_Status PIN_add(PIN_Handle handle, PIN_Config pinCfg);
+void PIN_close(PIN_Handle handle);
+
+#endif /* PIN_STUB_H_ */
@@ -0,0 +1,11 @@
+/*
+ * Host stub of ti/drivers/pin/PINCC26XX.h, used by the aoa_bench build only.
+ */
+#ifndef PINCC26XX_STUB_H_
+#define PINCC26XX_STUB_H_
+
+#include <ti/drivers/PIN.h>
+
+PIN_Status PINCC26XX_setOutputValue(PIN_Id pinId, uint32_t val);
+
+#endif /* PINCC26XX_STUB_H_ */
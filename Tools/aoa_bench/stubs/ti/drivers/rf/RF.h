@@ -0,0 +1,50 @@
+/*
+ * Host stub of ti/drivers/rf/RF.h, used by the aoa_bench build only.
+ */
+#ifndef RF_STUB_H_
+#define RF_STUB_H_
+
+#include <stdint.h>
+
+typedef void    *RF_Handle;
+typedef int16_t  RF_CmdHandle;
+typedef uint64_t RF_EventMask;
+typedef void     RF_Op;
+
+typedef void (*RF_Callback)(RF_Handle h, RF_CmdHandle ch, RF_EventMask e);
+
+#define RF_EventCmdDone        (1ull << 0)
+#define RF_EventInternalError  (1ull << 39)
+
+typedef enum
+{
+  RF_StartNotSpecified = 0,
+} RF_StartType;
+
+typedef enum
+{
+  RF_EndNotSpecified = 0,
+} RF_EndType;
+
+typedef enum
+{
+  RF_PriorityCoexDefault = 0,
+} RF_PriorityCoex;
+
+#define RF_AllowDelayAny       (~0u)
+
+typedef struct
+{
+  uint32_t        startTime;
+  RF_StartType    startType;
+  uint32_t        allowDelay;
+  uint32_t        endTime;
+  RF_EndType      endType;
+  uint32_t        duration;
+  uint32_t        activityInfo;
+  RF_PriorityCoex coexPriority;
+} RF_ScheduleCmdParams;
+
+RF_CmdHandle RF_scheduleCmd(RF_Handle h, RF_Op *pOp, RF_ScheduleCmdParams *pSchParams, RF_Callback pCb, RF_EventMask bmEvent);
+
+#endif /* RF_STUB_H_ */
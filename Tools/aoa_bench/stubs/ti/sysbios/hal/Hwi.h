@@ -0,0 +1,20 @@
+/*
+ * Host stub of ti/sysbios/hal/Hwi.h, used by the aoa_bench build only.
+ * The bench is single threaded, interrupts are never disabled.
+ */
+#ifndef HWI_STUB_H_
+#define HWI_STUB_H_
+
+#include <stdint.h>
+
+static inline uint32_t Hwi_disable(void)
+{
+  return 0;
+}
+
+static inline void Hwi_restore(uint32_t key)
+{
+  (void)key;
+}
+
+#endif /* HWI_STUB_H_ */
@@ -0,0 +1,158 @@
+/******************************************************************************
+
+ @file  aoa_test.c
+
+ @brief Assertions, shared helpers and the runner of the Drivers/AOA self checks.
+
+ *****************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include "AOA.h"
+#include "aoa_test.h"
+
+/*********************************************************************
+ * TYPEDEFS
+ */
+
+// Storage of an array described at runtime
+typedef struct
+{
+  AoA_AntennaConfig_t config;
+  AoA_AntennaPair_t pairs[AOA_MAX_NUM_PAIRS];
+  uint8_t element[AOA_MAX_NUM_ANT];
+  float position[AOA_MAX_NUM_ANT];
+} aoaTestArray_t;
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// Every check in the order -k runs them, the RTLS_PASSIVE build runs the role neutral ones
+static void (* const aoaTestChecks[])(void) =
+{
+  AoaTest_kernelCmac,
+  AoaTest_kernelNormalize,
+#ifdef RTLS_MASTER
+  AoaTest_kernelAngle,
+  AoaTest_spectrum,
+  AoaTest_pairRotation,
+  AoaTest_rawRf,
+  AoaTest_decimation,
+  AoaTest_screen,
+  AoaTest_quality,
+  AoaTest_fuse,
+#endif
+  AoaTest_track,
+  AoaTest_report,
+  AoaTest_rawPack,
+#ifdef RTLS_MASTER
+  AoaTest_iqHandles,
+#endif
+  AoaTest_rfRam,
+  AoaTest_cal,
+  AoaTest_calCapture,
+};
+
+// Failed assertions of the running check
+static uint32_t aoaTestNumFailed;
+
+// Runtime array of AoaTest_getArray
+static aoaTestArray_t aoaTestArray;
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+
+bool AoaTest_assert(bool cond, const char *pFile, int line, const char *pExpr, const char *pFmt, ...)
+{
+  const char *pName = strrchr(pFile, '/');
+  va_list args;
+
+  if (cond)
+  {
+    return true;
+  }
+
+  if (aoaTestNumFailed < AOA_TEST_MAX_REPORTS)
+  {
+    printf("%s:%d: failed: %s", pName ? pName + 1 : pFile, line, pExpr);
+    if (pFmt[1] != '\0')
+    {
+      printf(" (");
+      va_start(args, pFmt);
+      vprintf(&pFmt[1], args);
+      va_end(args);
+      printf(")");
+    }
+    printf("\n");
+  }
+
+  aoaTestNumFailed++;
+
+  return false;
+}
+
+uint32_t AoaTest_numFailed(void)
+{
+  return aoaTestNumFailed;
+}
+
+AoA_AntennaConfig_t *AoaTest_getArray(uint8_t numAnt)
+{
+  if (numAnt == 0)
+  {
+    return getAntennaArray1Config();
+  }
+
+  for (uint8_t k = 0; k < numAnt; k++)
+  {
+    aoaTestArray.element[k] = k;
+    aoaTestArray.position[k] = k * AOA_TEST_ARRAY_SPACING;
+  }
+
+  if (!AOA_initArrayConfig(&aoaTestArray.config, numAnt, numAnt, aoaTestArray.element, aoaTestArray.position, aoaTestArray.pairs))
+  {
+    return NULL;
+  }
+
+  return &aoaTestArray.config;
+}
+
+AoA_Covariance_t *AoaTest_allocCov(uint8_t numElements)
+{
+  AoA_Covariance_t *pCov = calloc(1, AOA_COV_SIZE(numElements));
+
+  pCov->numAnt = numElements;
+
+  return pCov;
+}
+
+uint32_t AoaTest_run(void)
+{
+  uint32_t numFailed = 0;
+
+  for (uint32_t c = 0; c < sizeof(aoaTestChecks) / sizeof(aoaTestChecks[0]); c++)
+  {
+    aoaTestNumFailed = 0;
+    aoaTestChecks[c]();
+    numFailed += aoaTestNumFailed;
+  }
+
+  return numFailed;
+}
+
+#ifdef RTLS_PASSIVE
+// The passive build has no bench, its checks run on their own
+int main(void)
+{
+  return (AoaTest_run() == 0) ? 0 : 1;
+}
+#endif
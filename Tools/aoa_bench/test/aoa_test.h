@@ -0,0 +1,135 @@
+/******************************************************************************
+
+ @file  aoa_test.h
+
+ @brief Self checks of the Drivers/AOA modules, run by aoa_bench -k.
+
+        Every module has its own test_<module>.c. A check asserts every
+        condition on its own with AOA_TEST_ASSERT, a failed assertion
+        prints its file, line, the condition and the context it was given,
+        so a failure says what broke. Each check prints one summary line
+        with its number of failed assertions.
+
+ *****************************************************************************/
+
+#ifndef AOA_TEST_H_
+#define AOA_TEST_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "AOA.h"
+#include "ant_array1_config_boostxl_rev1v1.h"
+#include "ant_array2_config_boostxl_rev1v1.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define AOA_TEST_MAX_REPORTS       10      //!< Failed assertions printed per check, the others are only counted
+
+#define AOA_TEST_NUM_ANT           BOOSTXL_AOA_NUM_ANT
+#define AOA_TEST_AMPLITUDE_8BIT    100.0
+#define AOA_TEST_AMPLITUDE_16BIT   1500.0
+#define AOA_TEST_ARRAY_SPACING     0.5f
+#define AOA_TEST_MIN_REPS          2       //!< A single repetition carries no pair information
+
+/*********************************************************************
+ * MACROS
+ */
+
+/**
+* @brief   Assert a condition, the optional printf format and arguments give its context
+*
+*          The format is passed on behind a space, so an assertion without
+*          a context still has a format to check.
+*
+* @return  the condition
+*/
+#define AOA_TEST_ASSERT(cond, ...) \
+  AoaTest_assert((cond), __FILE__, __LINE__, #cond, " " __VA_ARGS__)
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+
+/**
+* @brief   Count and report a failed assertion, use AOA_TEST_ASSERT
+*
+* @param   cond - the condition
+* @param   pFile - source file of the assertion
+* @param   line - source line of the assertion
+* @param   pExpr - the condition as written
+* @param   pFmt - a space followed by the printf format of the context
+*
+* @return  cond
+*/
+bool AoaTest_assert(bool cond, const char *pFile, int line, const char *pExpr, const char *pFmt, ...)
+  __attribute__((format(printf, 5, 6)));
+
+/**
+* @brief   Failed assertions of the running check
+*/
+uint32_t AoaTest_numFailed(void);
+
+/**
+* @brief   BOOSTXL-AOA array 1 for numAnt 0, else a uniform linear array of
+*          numAnt elements described at runtime
+*
+* @return  the array, NULL if it can not be described
+*/
+AoA_AntennaConfig_t *AoaTest_getArray(uint8_t numAnt);
+
+/**
+* @brief   Allocate a covariance of numElements elements, free with free()
+*/
+AoA_Covariance_t *AoaTest_allocCov(uint8_t numElements);
+
+/**
+* @brief   Run every check
+*
+* @return  number of failed assertions
+*/
+uint32_t AoaTest_run(void);
+
+// Checks of test_AOA_kernel.c
+void AoaTest_kernelCmac(void);
+void AoaTest_kernelNormalize(void);
+
+#ifdef RTLS_MASTER
+void AoaTest_kernelAngle(void);
+
+// Checks of test_AOA_spectrum.c
+void AoaTest_spectrum(void);
+
+// Checks of test_AOA.c
+void AoaTest_pairRotation(void);
+void AoaTest_rawRf(void);
+void AoaTest_decimation(void);
+void AoaTest_screen(void);
+void AoaTest_quality(void);
+void AoaTest_fuse(void);
+#endif
+
+// Checks of test_AOA_track.c
+void AoaTest_track(void);
+
+// Checks of test_AOA_report.c
+void AoaTest_report(void);
+
+// Checks of test_AOA_raw.c
+void AoaTest_rawPack(void);
+
+#ifdef RTLS_MASTER
+// Checks of test_AOA_iq.c
+void AoaTest_iqHandles(void);
+#endif
+
+// Checks of test_AOA_rfRam.c
+void AoaTest_rfRam(void);
+
+// Checks of test_AOA_cal.c
+void AoaTest_cal(void);
+void AoaTest_calCapture(void);
+
+#endif /* AOA_TEST_H_ */
@@ -0,0 +1,508 @@
+/******************************************************************************
+
+ @file  test_AOA.c
+
+ @brief Self checks of the AOA angle path.
+
+        Both averaging modes must agree on the angle of every pair,
+        whatever the distance of the pairs before it.
+        AOA_getPairAnglesRaw must mask the switching transients of RAW RF
+        captures and beat the filtered captures of the same CTEs.
+        AOA_decimateSamples must average oversampled captures down to a
+        factor fewer samples per pair without losing their SNR gain.
+        AOA_screenCapture must pass clean captures and catch saturated,
+        empty and noise only ones.
+        The pair spread must be the same in both averaging modes, near
+        full coherence at 40 dB SNR and about half of it at 0 dB.
+        AOA_fuseArrayAngles must find the azimuth and elevation of a tag
+        from the angles both BOOSTXL-AOA arrays see.
+
+ *****************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "AOA.h"
+#include "aoa_synth.h"
+#include "aoa_test.h"
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+
+// Pair angles of both averaging modes against each other, for pairs at odd and even distance
+void AoaTest_pairRotation(void)
+{
+  static int16_t buf[AOA_SYNTH_MAX_IQ_SAMPLES * 2];
+  static int16_t angleMode[AOA_MAX_NUM_PAIRS];
+  static int16_t phasorMode[AOA_MAX_NUM_PAIRS];
+  AoA_AntennaConfig_t *antConfig = AoaTest_getArray(4);
+  const uint8_t numAnt = antConfig->numAntennas;
+  uint32_t numPairs = 0;
+  int32_t maxErr = 0;
+
+  for (uint8_t sampleRate = 1; sampleRate <= 4; sampleRate++)
+  {
+    for (uint8_t slotDuration = 1; slotDuration <= 2; slotDuration++)
+    {
+      // The widest pair stays within half a turn. The angle mode averages wrapped angles, the
+      // frequency offset is kept small so it does not turn a pair onto the +-180 seam.
+      for (int32_t angle = -15; angle <= 15; angle += 5)
+      {
+        aoaSynthParams_t synth = {0};
+        AoA_AntennaResult_t result = {0};
+        uint8_t size = 1;
+
+        synth.sampleRate = sampleRate;
+        synth.sampleSize = 1;
+        synth.slotDuration = slotDuration;
+        synth.numAnt = numAnt;
+        synth.numIqSamples = AoaSynth_numIqSamples(20, slotDuration, sampleRate);
+        synth.angleDeg = angle;
+        synth.amplitude = AOA_TEST_AMPLITUDE_8BIT;
+        synth.spacingWl = AOA_TEST_ARRAY_SPACING;
+        synth.cfoKHz = 5;
+        synth.noiseRms = AoaSynth_noiseRms(synth.amplitude, 30);
+        synth.seed = 900 + angle;
+        AoaSynth_generate(&synth, (int8_t *)buf);
+
+        AOA_selectKernel(sampleRate, size, slotDuration, numAnt);
+
+        AOA_setAvgMode(AOA_AVG_MODE_ANGLE);
+        result.pairAngle = angleMode;
+        AOA_getPairAngles(antConfig, &result, synth.numIqSamples, sampleRate, size, slotDuration, numAnt, (int8_t *)buf);
+
+        AOA_setAvgMode(AOA_AVG_MODE_PHASOR);
+        result.pairAngle = phasorMode;
+        AOA_getPairAngles(antConfig, &result, synth.numIqSamples, sampleRate, size, slotDuration, numAnt, (int8_t *)buf);
+
+        // Every pair is turned by its own nominal rotation, whichever pairs come before it
+        for (uint8_t pair = 0; pair < antConfig->numPairs; pair++)
+        {
+          int32_t err = abs(angleMode[pair] - phasorMode[pair]);
+
+          err = (err > 180) ? 360 - err : err;
+          maxErr = (err > maxErr) ? err : maxErr;
+
+          AOA_TEST_ASSERT(err <= 3, "rate %u slot %u angle %d pair %u-%u: angle %d phasor %d", sampleRate, slotDuration, angle,
+                          antConfig->pairs[pair].a, antConfig->pairs[pair].b, angleMode[pair], phasorMode[pair]);
+          numPairs++;
+        }
+      }
+    }
+  }
+
+  AOA_selectKernel(0, 0, 0, 0);
+  AOA_setAvgMode(AOA_AVG_MODE_ANGLE);
+  printf("pair rotation: %u pairs, max difference %d deg, %u errors\n", numPairs, maxErr, AoaTest_numFailed());
+}
+
+// RAW RF captures with switching transients against filtered captures of the same CTEs
+void AoaTest_rawRf(void)
+{
+  static const AoA_AvgMode_t avgModes[] = {AOA_AVG_MODE_ANGLE, AOA_AVG_MODE_PHASOR};
+  static int16_t buf[AOA_SYNTH_MAX_IQ_SAMPLES * 2];
+  static int16_t pairAngle[AOA_MAX_NUM_PAIRS];
+  AoA_AntennaConfig_t *antConfig = AoaTest_getArray(4);
+  const uint8_t numAnt = antConfig->numAntennas;
+  double sumSq[2] = {0};
+  uint32_t numSamples[2] = {0};
+  uint32_t numCaptures = 0;
+
+  AOA_selectKernel(0, 0, 0, 0);
+
+  for (uint8_t sampleRate = 1; sampleRate <= 4; sampleRate++)
+  {
+    for (uint8_t sampleSize = 1; sampleSize <= 2; sampleSize++)
+    {
+      for (uint8_t slotDuration = 1; slotDuration <= 2; slotDuration++)
+      {
+        const uint8_t switchSamples = slotDuration * sampleRate;
+        uint8_t cteLength = 20;
+
+        // The longest CTE whose RAW RF capture fits the buffer
+        while (AoaSynth_numRawIqSamples(cteLength, slotDuration, sampleRate) > AOA_SYNTH_MAX_IQ_SAMPLES)
+        {
+          cteLength--;
+        }
+
+        for (uint32_t seed = 0; seed < 40; seed++)
+        {
+          const double angle = -40.0 + seed * 2;
+          const uint16_t numReps = AoaSynth_numReps(AoaSynth_numIqSamples(cteLength, slotDuration, sampleRate), sampleRate, numAnt);
+          aoaSynthParams_t synth = {0};
+
+          synth.sampleRate = sampleRate;
+          synth.sampleSize = sampleSize;
+          synth.slotDuration = slotDuration;
+          synth.numAnt = numAnt;
+          synth.angleDeg = angle;
+          synth.amplitude = (sampleSize == 1) ? AOA_TEST_AMPLITUDE_8BIT : AOA_TEST_AMPLITUDE_16BIT;
+          synth.spacingWl = AOA_TEST_ARRAY_SPACING;
+          synth.cfoKHz = -100.0 + seed * 5;
+          synth.noiseRms = AoaSynth_noiseRms(synth.amplitude, 10);
+          synth.transientUs = 0.5;
+          synth.seed = 500 + seed;
+
+          // Filtered and RAW RF captures of the same CTE, only RAW RF sees the transients
+          for (uint8_t raw = 0; raw < 2; raw++)
+          {
+            uint8_t size = sampleSize;
+
+            synth.rawRf = raw;
+            synth.numIqSamples = raw ? AoaSynth_numRawIqSamples(cteLength, slotDuration, sampleRate) :
+                                       AoaSynth_numIqSamples(cteLength, slotDuration, sampleRate);
+            AoaSynth_generate(&synth, (int8_t *)buf);
+            AOA_normalizeSamples((int8_t *)buf, synth.numIqSamples, &size);
+
+            for (uint32_t m = 0; m < sizeof(avgModes) / sizeof(avgModes[0]); m++)
+            {
+              AoA_AntennaResult_t antResult = {.pairAngle = pairAngle};
+              int16_t arrayAngle;
+
+              AOA_setAvgMode(avgModes[m]);
+
+              if (raw)
+              {
+                AOA_getPairAnglesRaw(antConfig, &antResult, synth.numIqSamples, sampleRate, size, slotDuration, numAnt, (int8_t *)buf);
+
+                // Transient samples must be masked, the settled switch slot samples kept
+                AOA_TEST_ASSERT(antResult.numSamples % numReps == 0, "rate %u size %u slot %u: %u samples kept over %u reps",
+                                sampleRate, sampleSize, slotDuration, antResult.numSamples, numReps);
+                AOA_TEST_ASSERT(antResult.numSamples <= numReps * (2 * switchSamples - (uint16_t)ceil(synth.transientUs * sampleRate)),
+                                "rate %u size %u slot %u: %u samples kept over %u reps", sampleRate, sampleSize, slotDuration, antResult.numSamples, numReps);
+              }
+              else
+              {
+                AOA_getPairAngles(antConfig, &antResult, synth.numIqSamples, sampleRate, size, slotDuration, numAnt, (int8_t *)buf);
+              }
+
+              if (!AOA_TEST_ASSERT(AOA_getArrayAngle(antConfig, &antResult, &arrayAngle), "%s rate %u size %u slot %u seed %u",
+                                   raw ? "raw" : "filtered", sampleRate, sampleSize, slotDuration, seed))
+              {
+                continue;
+              }
+
+              sumSq[raw] += (arrayAngle - angle) * (arrayAngle - angle);
+              numSamples[raw] += antResult.numSamples;
+            }
+          }
+
+          numCaptures++;
+        }
+      }
+    }
+  }
+
+  AOA_setAvgMode(AOA_AVG_MODE_ANGLE);
+
+  // Twice the samples per slot and the in-slot offset estimate must buy accuracy
+  AOA_TEST_ASSERT(sumSq[1] < 0.8 * sumSq[0], "squared error filtered %.0f raw %.0f", sumSq[0], sumSq[1]);
+
+  printf("raw rf: %u captures, samples per capture filtered %u raw %u, rmse filtered %.2f raw %.2f, %u errors\n",
+         numCaptures, numSamples[0] / (2 * numCaptures), numSamples[1] / (2 * numCaptures),
+         sqrt(sumSq[0] / (2 * numCaptures)), sqrt(sumSq[1] / (2 * numCaptures)), AoaTest_numFailed());
+}
+
+// Oversampled captures averaged down against the same captures at their own rate
+void AoaTest_decimation(void)
+{
+  static int16_t buf[AOA_SYNTH_MAX_IQ_SAMPLES * 2];
+  static int16_t pairAngle[AOA_MAX_NUM_PAIRS];
+  AoA_AntennaConfig_t *antConfig = AoaTest_getArray(4);
+  const uint8_t numAnt = antConfig->numAntennas;
+  const uint8_t cteLength = 20;
+  double sumSq[2] = {0};
+  uint32_t numCaptures = 0;
+
+  AOA_setAvgMode(AOA_AVG_MODE_ANGLE);
+
+  for (uint8_t sampleRate = 2; sampleRate <= 4; sampleRate++)
+  {
+    for (uint8_t factor = 2; factor <= sampleRate; factor++)
+    {
+      if ((sampleRate % factor) != 0)
+      {
+        continue;
+      }
+
+      for (uint8_t sampleSize = 1; sampleSize <= 2; sampleSize++)
+      {
+        for (uint8_t slotDuration = 1; slotDuration <= 2; slotDuration++)
+        {
+          for (uint32_t seed = 0; seed < 40; seed++)
+          {
+            const double angle = -40.0 + seed * 2;
+            aoaSynthParams_t synth = {0};
+
+            synth.sampleRate = sampleRate;
+            synth.sampleSize = sampleSize;
+            synth.slotDuration = slotDuration;
+            synth.numAnt = numAnt;
+            synth.numIqSamples = AoaSynth_numIqSamples(cteLength, slotDuration, sampleRate);
+            synth.angleDeg = angle;
+            synth.amplitude = (sampleSize == 1) ? AOA_TEST_AMPLITUDE_8BIT : AOA_TEST_AMPLITUDE_16BIT;
+            synth.spacingWl = AOA_TEST_ARRAY_SPACING;
+            synth.cfoKHz = -100.0 + seed * 5;
+            synth.noiseRms = AoaSynth_noiseRms(synth.amplitude, 5);
+            synth.seed = 700 + seed;
+
+            // The same CTE at its own rate and averaged down, as RTLSCtrl_postProcessAoa hands it on
+            for (uint8_t dec = 0; dec < 2; dec++)
+            {
+              AoA_AntennaResult_t antResult = {.pairAngle = pairAngle};
+              uint16_t numIqSamples = synth.numIqSamples;
+              uint8_t rate = sampleRate;
+              uint8_t size = sampleSize;
+              int16_t arrayAngle;
+
+              AoaSynth_generate(&synth, (int8_t *)buf);
+
+              if (dec && !AOA_TEST_ASSERT(AOA_decimateSamples((int8_t *)buf, &numIqSamples, &rate, size, factor) == factor,
+                                          "rate %u factor %u size %u slot %u", sampleRate, factor, sampleSize, slotDuration))
+              {
+                continue;
+              }
+              AOA_normalizeSamples((int8_t *)buf, numIqSamples, &size);
+
+              AOA_selectKernel(rate, size, slotDuration, numAnt);
+              AOA_getPairAngles(antConfig, &antResult, numIqSamples, rate, size, slotDuration, numAnt, (int8_t *)buf);
+
+              // Every slot must collapse to a factor fewer samples
+              if (dec)
+              {
+                AOA_TEST_ASSERT(rate * factor == sampleRate, "rate %u factor %u: %u MHz", sampleRate, factor, rate);
+                AOA_TEST_ASSERT(numIqSamples * factor == synth.numIqSamples, "rate %u factor %u slot %u: %u of %u samples",
+                                sampleRate, factor, slotDuration, numIqSamples, synth.numIqSamples);
+                AOA_TEST_ASSERT(antResult.numSamples * factor == AoaSynth_numReps(synth.numIqSamples, sampleRate, numAnt) * sampleRate,
+                                "rate %u factor %u size %u slot %u: %u per pair", sampleRate, factor, sampleSize, slotDuration, antResult.numSamples);
+              }
+
+              if (!AOA_TEST_ASSERT(AOA_getArrayAngle(antConfig, &antResult, &arrayAngle), "rate %u factor %u size %u slot %u seed %u",
+                                   sampleRate, dec ? factor : 1, sampleSize, slotDuration, seed))
+              {
+                continue;
+              }
+
+              sumSq[dec] += (arrayAngle - angle) * (arrayAngle - angle);
+            }
+
+            numCaptures++;
+          }
+        }
+      }
+    }
+  }
+
+  // Averaging before the angle must keep the SNR gain of the samples it drops, less the
+  // amplitude the tone loses turning within a group (0.9 over a 4 MHz group of 4)
+  AOA_TEST_ASSERT(sumSq[1] <= 1.2 * sumSq[0], "squared error full rate %.0f decimated %.0f", sumSq[0], sumSq[1]);
+
+  printf("decimation: %u captures, rmse full rate %.2f decimated %.2f, %u errors\n",
+         numCaptures, sqrt(sumSq[0] / numCaptures), sqrt(sumSq[1] / numCaptures), AoaTest_numFailed());
+}
+
+// Screen clean, saturated, empty and noise only captures of every configuration
+void AoaTest_screen(void)
+{
+  enum {CLEAN, SATURATED, EMPTY, NOISE, NUM_CASES};
+  static const char *names[NUM_CASES] = {"clean", "saturated", "empty", "noise"};
+  static int16_t buf[AOA_SYNTH_MAX_IQ_SAMPLES * 2];
+  const AoA_ScreenParams_t params = {AOA_SCREEN_MAX_PEAK_DB, AOA_SCREEN_MIN_POWER_DB, AOA_SCREEN_MIN_LINEARITY};
+  uint32_t numUsable[NUM_CASES] = {0};
+  uint32_t numCaptures = 0;
+
+  for (uint8_t sampleSize = 1; sampleSize <= 2; sampleSize++)
+  {
+    const double amplitude = (sampleSize == 1) ? AOA_TEST_AMPLITUDE_8BIT : AOA_TEST_AMPLITUDE_16BIT;
+    const double fullScale = (sampleSize == 1) ? INT8_MAX : INT16_MAX;
+
+    for (uint8_t sampleRate = 1; sampleRate <= 4; sampleRate++)
+    {
+      for (uint32_t seed = 0; seed < 50; seed++)
+      {
+        aoaSynthParams_t synth;
+        AoA_CaptureQuality_t quality;
+
+        memset(&synth, 0, sizeof(synth));
+        synth.sampleRate = sampleRate;
+        synth.sampleSize = sampleSize;
+        synth.slotDuration = 2;
+        synth.numAnt = BOOSTXL_AOA_NUM_ANT;
+        synth.numIqSamples = AoaSynth_numIqSamples(20, 2, sampleRate);
+        synth.angleDeg = -60 + seed * 2.4;
+        synth.spacingWl = BOOSTXL_AOA_ANT_SPACING;
+        synth.cfoKHz = -150.0 + seed * 6;
+        synth.seed = 100 + seed;
+
+        for (uint32_t c = 0; c < NUM_CASES; c++)
+        {
+          bool usable;
+
+          // Clean at 25 dB SNR, clipped at four times full scale, below one LSB, and noise without a tone
+          synth.amplitude = (c == CLEAN) ? amplitude : ((c == SATURATED) ? 4 * fullScale : ((c == EMPTY) ? 0.3 : 0));
+          synth.noiseRms = (c == NOISE) ? amplitude / 2 : ((c == CLEAN) ? AoaSynth_noiseRms(amplitude, 25) : 0);
+
+          AoaSynth_generate(&synth, (int8_t *)buf);
+
+          usable = AOA_screenCapture(&params, &quality, synth.numIqSamples, sampleRate, sampleSize, BOOSTXL_AOA_NUM_ANT, (int8_t *)buf);
+          numUsable[c] += usable;
+
+          if (c == CLEAN)
+          {
+            AOA_TEST_ASSERT(usable, "clean rate %u size %u seed %u", sampleRate, sampleSize, seed);
+          }
+          else if (c != NOISE)
+          {
+            AOA_TEST_ASSERT(!usable, "%s rate %u size %u seed %u", names[c], sampleRate, sampleSize, seed);
+          }
+        }
+
+        numCaptures++;
+      }
+    }
+  }
+
+  for (uint32_t c = 0; c < NUM_CASES; c++)
+  {
+    printf("screen %s: %u of %u usable\n", names[c], numUsable[c], numCaptures);
+  }
+
+  // Noise may look like a tone over the short reference period of 1 MHz captures
+  AOA_TEST_ASSERT(numUsable[NOISE] * 10 <= numCaptures, "%u of %u noise captures usable", numUsable[NOISE], numCaptures);
+
+  printf("screen: %u errors\n", AoaTest_numFailed());
+}
+
+// Pair spread of clean and noisy captures in both averaging modes
+void AoaTest_quality(void)
+{
+  static const AoA_AvgMode_t avgModes[] = {AOA_AVG_MODE_ANGLE, AOA_AVG_MODE_PHASOR};
+  static int16_t buf[AOA_SYNTH_MAX_IQ_SAMPLES * 2];
+  AoA_AntennaConfig_t *antConfig = getAntennaArray1Config();
+  int16_t pairAngle[CALC_NUM_ANT_PAIRS(AOA_TEST_NUM_ANT)];
+  AoA_PairQuality_t quality[2][CALC_NUM_ANT_PAIRS(AOA_TEST_NUM_ANT)];
+  uint32_t coherenceSum[2] = {0};
+  uint8_t minClean = UINT8_MAX;
+  uint32_t numPairs = 0;
+
+  for (uint8_t sampleSize = 1; sampleSize <= 2; sampleSize++)
+  {
+    const double amplitude = (sampleSize == 1) ? AOA_TEST_AMPLITUDE_8BIT : AOA_TEST_AMPLITUDE_16BIT;
+
+    for (uint8_t sampleRate = 1; sampleRate <= 4; sampleRate++)
+    {
+      for (uint32_t seed = 0; seed < 20; seed++)
+      {
+        aoaSynthParams_t synth;
+
+        memset(&synth, 0, sizeof(synth));
+        synth.sampleRate = sampleRate;
+        synth.sampleSize = sampleSize;
+        synth.slotDuration = 2;
+        synth.numAnt = BOOSTXL_AOA_NUM_ANT;
+        synth.numIqSamples = AoaSynth_numIqSamples(20, 2, sampleRate);
+        synth.angleDeg = -60.0 + seed * 6;
+        synth.spacingWl = BOOSTXL_AOA_ANT_SPACING;
+        synth.amplitude = amplitude;
+        synth.cfoKHz = -150.0 + seed * 15;
+        synth.seed = 300 + seed;
+
+        // 40 dB leaves every product in phase, 0 dB halves the mean product
+        for (uint32_t noisy = 0; noisy < 2; noisy++)
+        {
+          uint8_t size = sampleSize;
+          uint16_t numSamples[2];
+
+          synth.noiseRms = AoaSynth_noiseRms(amplitude, noisy ? 0 : 40);
+          AoaSynth_generate(&synth, (int8_t *)buf);
+          AOA_normalizeSamples((int8_t *)buf, synth.numIqSamples, &size);
+
+          for (uint32_t m = 0; m < 2; m++)
+          {
+            AoA_AntennaResult_t result = {0};
+
+            result.pairAngle = pairAngle;
+            result.pPairQuality = quality[m];
+            AOA_setAvgMode(avgModes[m]);
+            AOA_getPairAngles(antConfig, &result, synth.numIqSamples, sampleRate, size, 2, AOA_TEST_NUM_ANT, (int8_t *)buf);
+            numSamples[m] = result.numSamples;
+          }
+
+          // Both modes take the spread from the same sums
+          AOA_TEST_ASSERT(numSamples[0] != 0, "rate %u size %u seed %u", sampleRate, sampleSize, seed);
+          AOA_TEST_ASSERT(numSamples[0] == numSamples[1], "rate %u size %u seed %u: %u vs %u", sampleRate, sampleSize, seed, numSamples[0], numSamples[1]);
+
+          for (uint8_t pair = 0; pair < antConfig->numPairs; pair++)
+          {
+            AOA_TEST_ASSERT(quality[0][pair].coherence == quality[1][pair].coherence, "rate %u size %u seed %u pair %u: %u vs %u",
+                            sampleRate, sampleSize, seed, pair, quality[0][pair].coherence, quality[1][pair].coherence);
+            AOA_TEST_ASSERT(quality[0][pair].phaseVar == quality[1][pair].phaseVar, "rate %u size %u seed %u pair %u: %u vs %u",
+                            sampleRate, sampleSize, seed, pair, quality[0][pair].phaseVar, quality[1][pair].phaseVar);
+          }
+
+          for (uint8_t pair = 0; pair < antConfig->numPairs; pair++)
+          {
+            coherenceSum[noisy] += quality[0][pair].coherence;
+            if (!noisy)
+            {
+              minClean = (quality[0][pair].coherence < minClean) ? quality[0][pair].coherence : minClean;
+            }
+          }
+        }
+
+        numPairs += antConfig->numPairs;
+      }
+    }
+  }
+
+  AOA_setAvgMode(AOA_AVG_MODE_ANGLE);
+
+  AOA_TEST_ASSERT(minClean >= 250, "min clean coherence %u", minClean);
+  AOA_TEST_ASSERT(coherenceSum[1] <= numPairs * 160, "mean noisy coherence %u", coherenceSum[1] / numPairs);
+  AOA_TEST_ASSERT(coherenceSum[1] >= numPairs * 96, "mean noisy coherence %u", coherenceSum[1] / numPairs);
+
+  printf("quality: mean coherence clean %u noisy %u, min clean %u, %u errors\n",
+         coherenceSum[0] / numPairs, coherenceSum[1] / numPairs, minClean, AoaTest_numFailed());
+}
+
+// Fuse the whole degree angles both BOOSTXL-AOA arrays see of a tag
+void AoaTest_fuse(void)
+{
+  uint32_t numCases = 0;
+  int32_t maxAzErr = 0, maxElErr = 0;
+
+  for (int32_t el = 0; el <= 70; el += 10)
+  {
+    for (int32_t az = -135; az < 225; az += 5)
+    {
+      const double rad = M_PI / 180;
+      const int16_t angleA1 = (int16_t)lround(asin(sin((az - 45) * rad) * cos(el * rad)) / rad);
+      const int16_t angleA2 = (int16_t)lround(asin(cos((az - 45) * rad) * cos(el * rad)) / rad);
+      int16_t azimuth, elevation;
+      int32_t azErr, elErr;
+
+      AOA_fuseArrayAngles(angleA1, angleA2, &azimuth, &elevation);
+
+      // -135 and 225 are the same direction, only 225 is in the azimuth range
+      azErr = abs(azimuth - az) % 360;
+      AOA_TEST_ASSERT((azimuth >= AOA_AZIMUTH_MIN) && (azimuth < AOA_AZIMUTH_MIN + 360), "az %d el %d: %d", az, el, azimuth);
+      elErr = abs(elevation - el);
+      maxAzErr = (azErr > maxAzErr) ? azErr : maxAzErr;
+      maxElErr = (elErr > maxElErr) ? elErr : maxElErr;
+
+      // Inputs are rounded to whole degrees
+      AOA_TEST_ASSERT(azErr <= 2, "az %d el %d: A1 %d A2 %d -> az %d", az, el, angleA1, angleA2, azimuth);
+      AOA_TEST_ASSERT(elErr <= 2, "az %d el %d: A1 %d A2 %d -> el %d", az, el, angleA1, angleA2, elevation);
+      numCases++;
+    }
+  }
+
+  printf("fuse: %u directions, max error az %d el %d, %u errors\n", numCases, maxAzErr, maxElErr, AoaTest_numFailed());
+}
@@ -0,0 +1,194 @@
+/******************************************************************************
+
+ @file  test_AOA_cal.c
+
+ @brief Self checks of AOA_cal.
+
+        A single bin calibration table must return the built-in channel
+        offsets, a multi bin table the linear interpolation of its offsets,
+        and the Q15 pair gain the float gain within a degree. A calibration
+        capture of a tag with channel offsets and pair gain errors must
+        learn tables that give its angle on every channel.
+
+ *****************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "AOA.h"
+#include "AOA_cal.h"
+#include "aoa_test.h"
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+
+// Check the calibration tables against the built-in channel offsets and a float
+// interpolation, and the Q15 pair gain against the float gain
+void AoaTest_cal(void)
+{
+  static AoA_CalPoint_t points[AOA_CAL_NUM_CHANNELS * AOA_CAL_MAX_BINS];
+  static int8_t offsets[AOA_CAL_NUM_CHANNELS * AOA_CAL_MAX_BINS];
+  const int8_t *builtIn[2] = {getAntennaArray1ChannelOffsets(), getAntennaArray2ChannelOffsets()};
+  AoA_CalTable_t cal;
+  double maxErr = 0;
+  int32_t maxGainErr = 0;
+
+  // One bin per channel is the built-in table at every angle
+  for (uint32_t a = 0; a < 2; a++)
+  {
+    if (!AOA_TEST_ASSERT(AOA_calInit(&cal, points, 1, 0, 0, builtIn[a]), "A%u", a + 1))
+    {
+      continue;
+    }
+
+    for (uint8_t ch = 0; ch < AOA_CAL_NUM_CHANNELS; ch++)
+    {
+      for (int16_t angle = -180; angle <= 180; angle++)
+      {
+        const int16_t offset = AOA_calGetOffset(&cal, ch, angle);
+
+        AOA_TEST_ASSERT(offset == builtIn[a][ch], "A%u channel %u angle %d: %d vs %d", a + 1, ch, angle, offset, builtIn[a][ch]);
+      }
+    }
+  }
+
+  // Random offsets at every bin layout, held beyond the first and the last bin
+  srand(13);
+
+  for (uint8_t numBins = 2; numBins <= AOA_CAL_MAX_BINS; numBins++)
+  {
+    const uint8_t step = 180 / (numBins - 1);
+    const int16_t start = -90;
+
+    for (uint32_t i = 0; i < AOA_CAL_NUM_CHANNELS * numBins; i++)
+    {
+      offsets[i] = (int8_t)(rand() % 61 - 30);
+    }
+
+    if (!AOA_TEST_ASSERT(AOA_calInit(&cal, points, numBins, start, step, offsets), "%u bins", numBins))
+    {
+      continue;
+    }
+
+    for (uint8_t ch = 0; ch < AOA_CAL_NUM_CHANNELS; ch++)
+    {
+      const int8_t *pRow = &offsets[ch * numBins];
+
+      for (int16_t angle = -120; angle <= 120; angle++)
+      {
+        const double pos = (angle - start) / (double)step;
+        const int32_t bin = (pos <= 0) ? 0 : ((pos >= numBins - 1) ? numBins - 2 : (int32_t)pos);
+        const double frac = (pos <= 0) ? 0 : ((pos >= numBins - 1) ? 1 : pos - bin);
+        const double ref = pRow[bin] + (pRow[bin + 1] - pRow[bin]) * frac;
+        const int16_t offset = AOA_calGetOffset(&cal, ch, angle);
+        const double err = fabs(offset - ref);
+
+        maxErr = (err > maxErr) ? err : maxErr;
+
+        // Rounded to whole degrees
+        AOA_TEST_ASSERT(err <= 0.5 + 1e-3, "%u bins channel %u angle %d: %d vs %.2f", numBins, ch, angle, offset, ref);
+      }
+    }
+  }
+
+  // Layouts the table cannot hold
+  AOA_TEST_ASSERT(!AOA_calInit(&cal, points, 0, 0, 10, offsets), "no bins");
+  AOA_TEST_ASSERT(!AOA_calInit(&cal, points, AOA_CAL_MAX_BINS + 1, 0, 10, offsets), "%u bins", AOA_CAL_MAX_BINS + 1);
+  AOA_TEST_ASSERT(!AOA_calInit(&cal, points, 2, 0, 0, offsets), "2 bins of step 0");
+
+  // Q15 pair gain against the float multiply it replaces
+  for (uint32_t p = 0; p < 3; p++)
+  {
+    const AoA_AntennaPair_t *pPair = &getAntennaArray1Config()->pairs[p];
+    const float gain = (float)pPair->gain / AOA_PAIR_GAIN_ONE;
+
+    for (int32_t angle = -180; angle <= 180; angle++)
+    {
+      const int32_t x = pPair->sign * angle + pPair->offset;
+      const int32_t err = abs((x * (int32_t)pPair->gain) / AOA_PAIR_GAIN_ONE - (int)(x * gain));
+
+      maxGainErr = (err > maxGainErr) ? err : maxGainErr;
+      AOA_TEST_ASSERT(err <= 1, "pair %u angle %d: %d deg off", p, angle, err);
+    }
+  }
+
+  printf("cal: interpolation max error %.2f deg, pair gain max error %d deg, %u errors\n", maxErr, maxGainErr, AoaTest_numFailed());
+}
+
+// Learn the calibration of a reference tag with channel offsets and pair gain errors
+void AoaTest_calCapture(void)
+{
+  static const int16_t refAngles[] = {0, -40, 25, 60};
+  AoA_CalCapture_t cap;
+  double maxErr = 0;
+
+  srand(17);
+
+  for (uint32_t r = 0; r < sizeof(refAngles) / sizeof(refAngles[0]); r++)
+  {
+    for (int8_t sign = -1; sign <= 1; sign += 2)
+    {
+      const int16_t ref = refAngles[r];
+      const double scale[3] = {0.8 + (rand() % 41) / 100.0, 0.8 + (rand() % 41) / 100.0, 0.5};
+      int8_t truth[AOA_CAL_NUM_CHANNELS];
+      int8_t offsets[AOA_CAL_NUM_CHANNELS];
+      uint16_t gain[3] = {AOA_PAIR_GAIN_ONE, AOA_PAIR_GAIN_ONE, AOA_PAIR_GAIN(0.5)};
+
+      AOA_TEST_ASSERT(AOA_calCaptureInit(&cap, 3, 2, ref), "ref %d sign %d", ref, sign);
+
+      // Every pair sees the tag offset by the channel and scaled by its gain error, +-3 degrees of noise.
+      // Channel 39 is not in the channel map.
+      for (uint8_t ch = 0; ch < AOA_CAL_NUM_CHANNELS; ch++)
+      {
+        truth[ch] = (int8_t)(rand() % 11 - 5);
+        offsets[ch] = 99;
+
+        for (uint32_t k = 0; (ch < AOA_CAL_NUM_CHANNELS - 1) && (k < 50); k++)
+        {
+          int16_t pairAngle[3];
+
+          for (uint8_t p = 0; p < 3; p++)
+          {
+            pairAngle[p] = (int16_t)lround(scale[p] * (ref - sign * truth[ch]) + (rand() % 7 - 3));
+          }
+
+          AOA_calCaptureAdd(&cap, ch, pairAngle);
+        }
+      }
+
+      AOA_calCaptureSolve(&cap, gain, sign, offsets);
+
+      // Channels without CTEs keep their offset, the others must give the reference angle with the learned gains
+      AOA_TEST_ASSERT(offsets[AOA_CAL_NUM_CHANNELS - 1] == 99, "ref %d sign %d: %d", ref, sign, offsets[AOA_CAL_NUM_CHANNELS - 1]);
+
+      for (uint8_t ch = 0; ch < AOA_CAL_NUM_CHANNELS - 1; ch++)
+      {
+        const double angle = (scale[0] * gain[0] + scale[1] * gain[1]) / (2.0 * AOA_PAIR_GAIN_ONE) * (ref - sign * truth[ch]) + sign * offsets[ch];
+        const double err = fabs(angle - ref);
+
+        maxErr = (err > maxErr) ? err : maxErr;
+
+        // Offsets are whole degrees, the noise leaves a third of a degree in the mean of 50 CTEs
+        AOA_TEST_ASSERT(err <= 1.5, "ref %d sign %d channel %u: %.1f", ref, sign, ch, angle);
+      }
+
+      // Close to broadside the gains are kept
+      if (abs(ref) < AOA_CAL_MIN_GAIN_ANGLE)
+      {
+        AOA_TEST_ASSERT(gain[0] == AOA_PAIR_GAIN_ONE, "ref %d sign %d: %u", ref, sign, gain[0]);
+        AOA_TEST_ASSERT(gain[1] == AOA_PAIR_GAIN_ONE, "ref %d sign %d: %u", ref, sign, gain[1]);
+      }
+    }
+  }
+
+  AOA_TEST_ASSERT(!AOA_calCaptureInit(&cap, AOA_CAL_CAPTURE_MAX_PAIRS + 1, 2, 0), "%u pairs", AOA_CAL_CAPTURE_MAX_PAIRS + 1);
+  AOA_TEST_ASSERT(!AOA_calCaptureInit(&cap, 2, 3, 0), "3 angle pairs of 2");
+
+  printf("cal capture: max error %.2f deg, %u errors\n", maxErr, AoaTest_numFailed());
+}
@@ -0,0 +1,185 @@
+/******************************************************************************
+
+ @file  test_AOA_iq.c
+
+ @brief Self checks of AOA_iq.
+
+        IQ handles must wrap captures without copying them, keep a capture
+        while any reference to it is held, free it on the last release and
+        reject a stale handle once its entry went to the next capture.
+
+ *****************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "AOA_iq.h"
+#include "aoa_test.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define TEST_IQ_CAPTURE_SIZE       64
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// Captures freed by the last release of their IQ handle
+static uint32_t testIqNumFreed;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+static void Test_iqFree(int8_t *pIQ)
+{
+  free(pIQ);
+  testIqNumFreed++;
+}
+
+// A heap capture as RTLS Services hands it over, every byte fill
+static int8_t *Test_iqCapture(uint8_t fill)
+{
+  int8_t *pIQ = malloc(TEST_IQ_CAPTURE_SIZE);
+
+  memset(pIQ, fill, TEST_IQ_CAPTURE_SIZE);
+
+  return pIQ;
+}
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+
+// Hand captures through IQ handles as RTLS Services, RTLS Control and a RAW stream do
+void AoaTest_iqHandles(void)
+{
+  AoA_IqHandle_t handles[AOA_IQ_NUM_HANDLES];
+  AoA_IqHandle_t streamed[AOA_IQ_NUM_HANDLES];
+  int8_t *pIQ;
+  AoA_IqStats_t stats;
+  uint32_t numStreamed = 0;
+
+  testIqNumFreed = 0;
+
+  // Every handle once, then none, the capture is never copied
+  for (uint8_t k = 0; k < AOA_IQ_NUM_HANDLES; k++)
+  {
+    pIQ = Test_iqCapture(k);
+    handles[k] = AOA_iqWrap(pIQ, Test_iqFree);
+    AOA_TEST_ASSERT(handles[k] != AOA_IQ_NO_HANDLE, "capture %u", k);
+    AOA_TEST_ASSERT(AOA_iqGet(handles[k]) == pIQ, "capture %u", k);
+    for (uint8_t j = 0; j < k; j++)
+    {
+      AOA_TEST_ASSERT(handles[j] != handles[k], "captures %u and %u", j, k);
+    }
+  }
+  pIQ = Test_iqCapture(0);
+  AOA_TEST_ASSERT(AOA_iqWrap(pIQ, Test_iqFree) == AOA_IQ_NO_HANDLE);
+  AOA_TEST_ASSERT(testIqNumFreed == 0, "%u freed", testIqNumFreed);
+  free(pIQ);
+
+  for (uint8_t k = 0; k < AOA_IQ_NUM_HANDLES; k++)
+  {
+    AOA_TEST_ASSERT(AOA_iqRelease(handles[k]), "capture %u", k);
+    AOA_TEST_ASSERT(testIqNumFreed == k + 1u, "capture %u: %u freed", k, testIqNumFreed);
+  }
+
+  // A handle released twice is left alone, its stale release must not take
+  // a reference of the capture its entry went to next
+  handles[0] = AOA_iqWrap(Test_iqCapture(1), Test_iqFree);
+  AOA_TEST_ASSERT(AOA_iqRelease(handles[0]));
+  handles[1] = AOA_iqWrap(Test_iqCapture(2), Test_iqFree);
+  AOA_TEST_ASSERT((handles[1] & 0xFF) == (handles[0] & 0xFF), "0x%04X after 0x%04X", handles[1], handles[0]);
+  AOA_TEST_ASSERT(handles[1] != handles[0], "0x%04X", handles[1]);
+  AOA_TEST_ASSERT(!AOA_iqRelease(handles[0]));
+  AOA_TEST_ASSERT(!AOA_iqRetain(handles[0]));
+  AOA_TEST_ASSERT(AOA_iqGet(handles[0]) == NULL);
+  AOA_TEST_ASSERT(!AOA_iqRelease(AOA_IQ_NO_HANDLE));
+  AOA_TEST_ASSERT(testIqNumFreed == AOA_IQ_NUM_HANDLES + 1u, "%u freed", testIqNumFreed);
+  if (AOA_TEST_ASSERT(AOA_iqGet(handles[1]) != NULL))
+  {
+    AOA_TEST_ASSERT(AOA_iqGet(handles[1])[0] == 2, "holds %d", AOA_iqGet(handles[1])[0]);
+  }
+  AOA_TEST_ASSERT(AOA_iqRelease(handles[1]));
+  AOA_TEST_ASSERT(testIqNumFreed == AOA_IQ_NUM_HANDLES + 2u, "%u freed", testIqNumFreed);
+
+  // RTLS Control holds every capture until it is processed, a RAW stream keeps
+  // every other one for a few captures more
+  for (uint8_t k = 0; k < AOA_IQ_NUM_HANDLES; k++)
+  {
+    streamed[k] = AOA_IQ_NO_HANDLE;
+  }
+
+  for (uint32_t capture = 0; capture < 1000; capture++)
+  {
+    uint32_t stream = capture % AOA_IQ_NUM_HANDLES;
+    AoA_IqHandle_t handle;
+
+    pIQ = Test_iqCapture((uint8_t)capture);
+
+    if ((handle = AOA_iqWrap(pIQ, Test_iqFree)) == AOA_IQ_NO_HANDLE)
+    {
+      // Only when every handle is streamed, the captures are sent and the new one dropped
+      AOA_TEST_ASSERT(numStreamed == AOA_IQ_NUM_HANDLES, "capture %u dropped with %u streamed", capture, numStreamed);
+      free(pIQ);
+      for (uint8_t k = 0; k < AOA_IQ_NUM_HANDLES; k++)
+      {
+        AOA_TEST_ASSERT(AOA_iqRelease(streamed[k]), "capture %u stream %u", capture, k);
+        streamed[k] = AOA_IQ_NO_HANDLE;
+      }
+      numStreamed = 0;
+      continue;
+    }
+
+    if ((capture & 1) && (streamed[stream] == AOA_IQ_NO_HANDLE))
+    {
+      AOA_TEST_ASSERT(AOA_iqRetain(handle), "capture %u", capture);
+      streamed[stream] = handle;
+      numStreamed++;
+    }
+
+    // Processed, RTLS Control gives back its reference
+    AOA_TEST_ASSERT(AOA_iqRelease(handle), "capture %u", capture);
+
+    // A stream finishes now and then, its capture must still be intact
+    if ((capture % 7 == 0) && (streamed[(stream + 1) % AOA_IQ_NUM_HANDLES] != AOA_IQ_NO_HANDLE))
+    {
+      AoA_IqHandle_t out = streamed[(stream + 1) % AOA_IQ_NUM_HANDLES];
+      const int8_t *pOut = AOA_iqGet(out);
+
+      if (AOA_TEST_ASSERT(pOut != NULL, "capture %u", capture))
+      {
+        AOA_TEST_ASSERT(memcmp(pOut, pOut + 1, TEST_IQ_CAPTURE_SIZE - 1) == 0, "capture %u", capture);
+      }
+      AOA_TEST_ASSERT(AOA_iqRelease(out), "capture %u", capture);
+      streamed[(stream + 1) % AOA_IQ_NUM_HANDLES] = AOA_IQ_NO_HANDLE;
+      numStreamed--;
+    }
+  }
+
+  for (uint8_t k = 0; k < AOA_IQ_NUM_HANDLES; k++)
+  {
+    if (streamed[k] != AOA_IQ_NO_HANDLE)
+    {
+      AOA_TEST_ASSERT(AOA_iqRelease(streamed[k]), "stream %u", k);
+    }
+  }
+
+  // Every capture wrapped went back to the heap once
+  AOA_iqGetStats(&stats);
+  AOA_TEST_ASSERT(stats.numFree == AOA_IQ_NUM_HANDLES, "%u", stats.numFree);
+  AOA_TEST_ASSERT(stats.minFree == 0, "%u", stats.minFree);
+  AOA_TEST_ASSERT(stats.numBadRefs == 3, "%u", stats.numBadRefs);
+  AOA_TEST_ASSERT(testIqNumFreed == stats.numWraps, "%u freed of %u wrapped", testIqNumFreed, stats.numWraps);
+
+  printf("iq handles: %u handles, %u captures, %u dropped, %u errors\n",
+         AOA_IQ_NUM_HANDLES, stats.numWraps, stats.numDrops, AoaTest_numFailed());
+}
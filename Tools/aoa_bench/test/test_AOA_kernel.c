@@ -0,0 +1,236 @@
+/******************************************************************************
+
+ @file  test_AOA_kernel.c
+
+ @brief Self checks of AOA_kernel.
+
+        The built AOA_kernel routines are compared bit for bit against the
+        scalar reference on random and full scale input, and the
+        specialized angle kernels against the generic loop on random
+        captures of every configuration. The normalization must keep every
+        sample within half a step of its exponent, in place and out of
+        place. The RTLS_PASSIVE build runs the routines on Q first samples,
+        it has no angle kernels to check.
+
+ *****************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "AOA.h"
+#include "AOA_kernel.h"
+#include "aoa_synth.h"
+#include "aoa_test.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+#define TEST_ROUNDS                20000
+#define TEST_MAX_SAMPLES           1024
+
+// int16 of a 16 bit capture that holds component k of its narrowed capture, passive captures hold Q first
+#ifdef RTLS_PASSIVE
+#define TEST_EXT_INDEX(k)          ((k) ^ 1)
+#else
+#define TEST_EXT_INDEX(k)          (k)
+#endif
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+static const char *Test_kernelName(void)
+{
+  switch (AOA_KERNEL_IMPL)
+  {
+    case AOA_KERNEL_IMPL_ARM_DSP: return "arm_dsp";
+    case AOA_KERNEL_IMPL_SSE2:    return "sse2";
+    case AOA_KERNEL_IMPL_AVX2:    return "avx2";
+    default:                      return "scalar";
+  }
+}
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+
+// Compare the built kernels against the scalar reference
+void AoaTest_kernelCmac(void)
+{
+  static int16_t bufX[TEST_MAX_SAMPLES * 2];
+  static int16_t bufY[TEST_MAX_SAMPLES * 2];
+
+  srand(1);
+
+  for (uint32_t round = 0; round < TEST_ROUNDS; round++)
+  {
+    const uint16_t runLen = 1 + rand() % 24;
+    const uint16_t stride = runLen + ((rand() % 2) ? 0 : rand() % 24);
+    const uint16_t maxRuns = (TEST_MAX_SAMPLES - runLen) / stride + 1;
+    const uint16_t numRuns = 1 + rand() % maxRuns;
+    // Every 8th round is full scale, the worst case for the accumulators
+    const int fullScale = (round % 8) == 0;
+    AoA_Phasor_t ref8 = {0}, got8 = {0}, ref16 = {0}, got16 = {0};
+
+    for (uint32_t k = 0; k < TEST_MAX_SAMPLES * 2; k++)
+    {
+      bufX[k] = fullScale ? -32768 : (int16_t)(rand() - RAND_MAX / 2);
+      bufY[k] = fullScale ? ((k & 1) ? 32767 : -32768) : (int16_t)(rand() - RAND_MAX / 2);
+    }
+
+    AOA_cmacConjScalar((AoA_IQSample_t *)bufX, (AoA_IQSample_t *)bufY, runLen, numRuns, stride, &ref8);
+    AOA_cmacConj((AoA_IQSample_t *)bufX, (AoA_IQSample_t *)bufY, runLen, numRuns, stride, &got8);
+    AOA_cmacConjExtScalar((AoA_IQSample_Ext_t *)bufX, (AoA_IQSample_Ext_t *)bufY, runLen, numRuns, stride, &ref16);
+    AOA_cmacConjExt((AoA_IQSample_Ext_t *)bufX, (AoA_IQSample_Ext_t *)bufY, runLen, numRuns, stride, &got16);
+
+    AOA_TEST_ASSERT(got8.re == ref8.re, "8 bit runLen %u numRuns %u stride %u: %lld vs %lld",
+                    runLen, numRuns, stride, (long long)got8.re, (long long)ref8.re);
+    AOA_TEST_ASSERT(got8.im == ref8.im, "8 bit runLen %u numRuns %u stride %u: %lld vs %lld",
+                    runLen, numRuns, stride, (long long)got8.im, (long long)ref8.im);
+    AOA_TEST_ASSERT(got16.re == ref16.re, "16 bit runLen %u numRuns %u stride %u: %lld vs %lld",
+                    runLen, numRuns, stride, (long long)got16.re, (long long)ref16.re);
+    AOA_TEST_ASSERT(got16.im == ref16.im, "16 bit runLen %u numRuns %u stride %u: %lld vs %lld",
+                    runLen, numRuns, stride, (long long)got16.im, (long long)ref16.im);
+  }
+
+  printf("kernel %s: %u rounds, %u mismatches\n", Test_kernelName(), TEST_ROUNDS, AoaTest_numFailed());
+}
+
+// Check the normalization of 16 bit captures of every magnitude
+void AoaTest_kernelNormalize(void)
+{
+  static int16_t bufIn[TEST_MAX_SAMPLES * 2];
+  static int16_t bufInPlace[TEST_MAX_SAMPLES * 2];
+  static int8_t bufOut[TEST_MAX_SAMPLES * 2];
+  static int8_t bufRef[TEST_MAX_SAMPLES * 2];
+
+  srand(3);
+
+  for (uint32_t round = 0; round < TEST_ROUNDS / 10; round++)
+  {
+    const uint16_t numSamples = 1 + rand() % TEST_MAX_SAMPLES;
+    // Magnitudes from silence to full scale, every 8th round hits both ends of the int16 range
+    const int magBits = round % 17;
+    const int fullScale = (round % 8) == 0;
+#ifdef RTLS_MASTER
+    uint8_t sampleSize = 2;
+#endif
+    uint8_t shift;
+    int32_t peak = 0;
+
+    for (uint32_t k = 0; k < numSamples * 2; k++)
+    {
+      const int32_t v = (magBits == 0) ? 0 : (rand() % (1 << magBits)) - (1 << (magBits - 1));
+
+      bufIn[k] = fullScale ? ((k & 1) ? 32767 : -32768) : (int16_t)v;
+    }
+
+    // The built kernels out of place and in place against the scalar reference
+    memcpy(bufInPlace, bufIn, numSamples * sizeof(AoA_IQSample_Ext_t));
+    shift = AOA_blockExponentScalar((AoA_IQSample_Ext_t *)bufIn, numSamples);
+    AOA_narrowSamplesScalar((AoA_IQSample_Ext_t *)bufIn, (AoA_IQSample_t *)bufRef, numSamples, shift);
+    AOA_narrowSamples((AoA_IQSample_Ext_t *)bufIn, (AoA_IQSample_t *)bufOut, numSamples, AOA_blockExponent((AoA_IQSample_Ext_t *)bufIn, numSamples));
+
+#ifdef RTLS_MASTER
+    AOA_TEST_ASSERT(AOA_normalizeSamples((int8_t *)bufInPlace, numSamples, &sampleSize) == shift, "round %u numSamples %u", round, numSamples);
+    AOA_TEST_ASSERT(sampleSize == AOA_NORM_SAMPLE_SIZE, "round %u", round);
+#else
+    // Passive AOA_normalizeSamples narrows the whole RF RAM capture in place like this
+    AOA_narrowSamples((AoA_IQSample_Ext_t *)bufInPlace, (AoA_IQSample_t *)bufInPlace, numSamples, shift);
+#endif
+    AOA_TEST_ASSERT(memcmp(bufOut, bufRef, numSamples * sizeof(AoA_IQSample_t)) == 0, "out of place, round %u numSamples %u shift %u", round, numSamples, shift);
+    AOA_TEST_ASSERT(memcmp(bufInPlace, bufRef, numSamples * sizeof(AoA_IQSample_t)) == 0, "in place, round %u numSamples %u shift %u", round, numSamples, shift);
+
+    for (uint32_t k = 0; k < numSamples * 2; k++)
+    {
+      // Within half a step, a full step where rounding saturated
+      const int32_t in = bufIn[TEST_EXT_INDEX(k)];
+      const int32_t err = abs(bufOut[k] * (1 << shift) - in);
+
+      AOA_TEST_ASSERT(err <= ((bufOut[k] == 127) ? (1 << shift) : (1 << shift) / 2),
+                      "round %u sample %u: %d from %d at shift %u", round, k, bufOut[k], in, shift);
+
+      peak = (abs(bufOut[k]) > peak) ? abs(bufOut[k]) : peak;
+    }
+
+    // The smallest exponent that fits, a shift of one less would not
+    AOA_TEST_ASSERT((shift == 0) || (peak >= (1 << (AOA_NARROW_BITS - 1))), "round %u shift %u peak %d", round, shift, peak);
+  }
+
+  printf("normalize: %u rounds, %u errors\n", TEST_ROUNDS / 10, AoaTest_numFailed());
+}
+
+#ifdef RTLS_MASTER
+// Compare the specialized angle kernels against the generic loop
+void AoaTest_kernelAngle(void)
+{
+  static int16_t buf[AOA_SYNTH_MAX_IQ_SAMPLES * 2];
+  AoA_AntennaConfig_t *antConfig = getAntennaArray1Config();
+  int16_t generic[CALC_NUM_ANT_PAIRS(AOA_TEST_NUM_ANT)];
+  int16_t specialized[CALC_NUM_ANT_PAIRS(AOA_TEST_NUM_ANT)];
+  AoA_AntennaResult_t result = {0};
+  uint32_t numCfgs = 0;
+
+  AOA_setAvgMode(AOA_AVG_MODE_ANGLE);
+  srand(2);
+
+  for (uint8_t sampleRate = 1; sampleRate <= 4; sampleRate++)
+  {
+    for (uint8_t sampleSize = 1; sampleSize <= 2; sampleSize++)
+    {
+      for (uint8_t slotDuration = 1; slotDuration <= 2; slotDuration++)
+      {
+        for (uint8_t cteLength = 2; cteLength <= 20; cteLength++)
+        {
+          const uint16_t numIq = AoaSynth_numIqSamples(cteLength, slotDuration, sampleRate);
+          // 16 bit captures reach the kernels normalized
+          const uint8_t normSize = (sampleSize == 2) ? AOA_NORM_SAMPLE_SIZE : sampleSize;
+
+          if (!AOA_TEST_ASSERT(AOA_selectKernel(sampleRate, normSize, slotDuration, AOA_TEST_NUM_ANT),
+                               "no specialized kernel for rate %u size %u slot %u", sampleRate, sampleSize, slotDuration))
+          {
+            continue;
+          }
+
+          for (uint32_t round = 0; round < 20; round++)
+          {
+            // Random samples, 8 bit captures only use the low byte pairs
+            uint8_t size = sampleSize;
+
+            for (uint32_t k = 0; k < AOA_SYNTH_MAX_IQ_SAMPLES * 2; k++)
+            {
+              buf[k] = (sampleSize == 1) ? (int16_t)(rand() & 0xFFFF) : (int16_t)(rand() - RAND_MAX / 2);
+            }
+
+            AOA_normalizeSamples((int8_t *)buf, numIq, &size);
+
+            AOA_selectKernel(0, 0, 0, 0);
+            result.pairAngle = generic;
+            AOA_getPairAngles(antConfig, &result, numIq, sampleRate, size, slotDuration, AOA_TEST_NUM_ANT, (int8_t *)buf);
+
+            AOA_selectKernel(sampleRate, normSize, slotDuration, AOA_TEST_NUM_ANT);
+            result.pairAngle = specialized;
+            AOA_getPairAngles(antConfig, &result, numIq, sampleRate, size, slotDuration, AOA_TEST_NUM_ANT, (int8_t *)buf);
+
+            for (uint8_t pair = 0; pair < antConfig->numPairs; pair++)
+            {
+              AOA_TEST_ASSERT(specialized[pair] == generic[pair], "rate %u size %u slot %u cte %u pair %u: %d vs %d",
+                              sampleRate, sampleSize, slotDuration, cteLength, pair, specialized[pair], generic[pair]);
+            }
+          }
+          numCfgs++;
+        }
+      }
+    }
+  }
+
+  AOA_selectKernel(0, 0, 0, 0);
+  printf("angle kernels: %u configurations, %u mismatches\n", numCfgs, AoaTest_numFailed());
+}
+#endif // RTLS_MASTER
@@ -0,0 +1,169 @@
+/******************************************************************************
+
+ @file  test_AOA_raw.c
+
+ @brief Self checks of AOA_raw.
+
+        AOA_rawPack must pack RAW captures of both sample sizes in chunks
+        that unpack to the same samples, keep 8 bit samples at 8 bits and
+        16 bit samples that fit at 12, and never grow them with deltas.
+
+ *****************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "AOA.h"
+#include "AOA_raw.h"
+#include "aoa_synth.h"
+#include "aoa_test.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Samples per RAW result, about as many as the NPI TX buffer of RTLSCtrl holds
+#define TEST_RAW_CHUNK             32
+
+// Passive captures hold Q first in AoA_IQSample_Ext_t, RAW packs I first
+#ifdef RTLS_PASSIVE
+#define TEST_RAW_EXT_I_FIRST       false
+#else
+#define TEST_RAW_EXT_I_FIRST       true
+#endif
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+
+// Pack RAW captures chunk by chunk as RTLSCtrl_postProcessAoa does and unpack them
+void AoaTest_rawPack(void)
+{
+  static AoA_IQSample_Ext_t buf[AOA_SYNTH_MAX_IQ_SAMPLES];
+  static uint8_t packed[AOA_RAW_PACKED_MAX_SIZE(TEST_RAW_CHUNK, 2)];
+  static int16_t unpacked[2 * TEST_RAW_CHUNK];
+  static const char *names[] = {"none", "delta"};
+
+  for (uint8_t sampleSize = 1; sampleSize <= 2; sampleSize++)
+  {
+    // 8 bit captures, 16 bit captures within 12 bits and full scale ones
+    for (uint32_t level = 0; level < sampleSize; level++)
+    {
+      const double amplitude = (sampleSize == 1) ? 100 : (level ? 30000 : 1500);
+      const uint8_t expectedBits = (sampleSize == 1) ? 8 : (level ? 16 : 12);
+
+      for (uint8_t coding = AOA_RAW_CODING_NONE; coding <= AOA_RAW_CODING_DELTA; coding++)
+      {
+        uint32_t numBytes[4] = {0};
+        uint32_t numSamples[4] = {0};
+
+        for (uint8_t sampleRate = 1; sampleRate <= 4; sampleRate++)
+        {
+          for (uint32_t seed = 0; seed < 20; seed++)
+          {
+            aoaSynthParams_t synth;
+
+            memset(&synth, 0, sizeof(synth));
+            synth.sampleRate = sampleRate;
+            synth.sampleSize = sampleSize;
+            synth.slotDuration = 2;
+            synth.numAnt = BOOSTXL_AOA_NUM_ANT;
+            synth.numIqSamples = AoaSynth_numIqSamples(20, 2, sampleRate);
+            synth.angleDeg = -60 + seed * 6;
+            synth.amplitude = amplitude;
+            synth.spacingWl = BOOSTXL_AOA_ANT_SPACING;
+            synth.cfoKHz = -100.0 + seed * 10;
+            synth.noiseRms = AoaSynth_noiseRms(amplitude, 20);
+            synth.seed = 300 + seed;
+
+            AoaSynth_generate(&synth, (int8_t *)buf);
+
+            for (uint16_t offset = 0; offset < synth.numIqSamples; offset += TEST_RAW_CHUNK)
+            {
+              const uint16_t num = (synth.numIqSamples - offset > TEST_RAW_CHUNK) ? TEST_RAW_CHUNK : synth.numIqSamples - offset;
+              const int8_t *pChunk = (const int8_t *)buf + offset * 2 * sampleSize;
+              AoA_RawFormat_t format;
+              uint16_t len;
+
+              len = AOA_rawPack(pChunk, sampleSize, num, coding, &format, packed);
+
+              // Chunks of a 12 bit capture may fit 8 bits as well, they are still packed at 12
+              AOA_TEST_ASSERT(format.sampleBits == expectedBits, "%s rate %u seed %u offset %u: %u bits", names[coding], sampleRate, seed, offset, format.sampleBits);
+              AOA_TEST_ASSERT(len <= AOA_RAW_PACKED_MAX_SIZE(num, sampleSize), "%s rate %u seed %u offset %u: %u bytes", names[coding], sampleRate, seed, offset, len);
+              AOA_TEST_ASSERT(len <= (2 * num * format.sampleBits + 7) / 8, "%s rate %u seed %u offset %u: %u bytes", names[coding], sampleRate, seed, offset, len);
+              if (format.coding == AOA_RAW_CODING_NONE)
+              {
+                AOA_TEST_ASSERT(len == (2 * num * format.sampleBits + 7) / 8, "rate %u seed %u offset %u: %u bytes", sampleRate, seed, offset, len);
+              }
+              AOA_TEST_ASSERT((len <= 1) || !AOA_rawUnpack(packed, len - 1, num, &format, unpacked),
+                              "%s rate %u seed %u offset %u: unpacked short of %u bytes", names[coding], sampleRate, seed, offset, len);
+
+              if (!AOA_TEST_ASSERT(AOA_rawUnpack(packed, len, num, &format, unpacked), "%s rate %u seed %u offset %u", names[coding], sampleRate, seed, offset))
+              {
+                continue;
+              }
+
+              for (uint16_t k = 0; k < num; k++)
+              {
+                const int16_t re = (sampleSize == 1) ? ((const AoA_IQSample_t *)pChunk)[k].i : ((const AoA_IQSample_Ext_t *)pChunk)[k].i;
+                const int16_t im = (sampleSize == 1) ? ((const AoA_IQSample_t *)pChunk)[k].q : ((const AoA_IQSample_Ext_t *)pChunk)[k].q;
+
+                AOA_TEST_ASSERT(unpacked[2 * k] == re, "%s rate %u seed %u sample %u: %d vs %d", names[coding], sampleRate, seed, offset + k, unpacked[2 * k], re);
+                AOA_TEST_ASSERT(unpacked[2 * k + 1] == im, "%s rate %u seed %u sample %u: %d vs %d", names[coding], sampleRate, seed, offset + k, unpacked[2 * k + 1], im);
+              }
+
+              // Uncoded 8 and 16 bit chunks are the samples as they are in memory, where that holds I first
+              if ((format.coding == AOA_RAW_CODING_NONE) && ((format.sampleBits == 8) || ((format.sampleBits == 16) && TEST_RAW_EXT_I_FIRST)))
+              {
+                AOA_TEST_ASSERT(memcmp(packed, pChunk, len) == 0, "rate %u seed %u offset %u", sampleRate, seed, offset);
+              }
+
+              numBytes[sampleRate - 1] += len;
+              numSamples[sampleRate - 1] += num;
+            }
+          }
+        }
+
+        printf("raw pack %s %u bit %s:", (sampleSize == 1) ? "8 bit" : "16 bit", expectedBits, names[coding]);
+        for (uint8_t r = 0; r < 4; r++)
+        {
+          printf(" %uMHz %.2f", r + 1, (double)numBytes[r] / numSamples[r]);
+        }
+        printf(" bytes/sample (legacy %u)\n", (unsigned)sizeof(AoA_IQSample_Ext_t));
+      }
+    }
+  }
+
+  // Full scale samples of random sign, deltas as wide as they get
+  for (uint32_t trial = 0; trial < 200; trial++)
+  {
+    AoA_RawFormat_t format;
+    uint16_t len;
+
+    for (uint16_t k = 0; k < TEST_RAW_CHUNK; k++)
+    {
+      buf[k].i = (rand() & 1) ? INT16_MAX : INT16_MIN;
+      buf[k].q = (int16_t)(rand() % 65536 - 32768);
+    }
+
+    len = AOA_rawPack((const int8_t *)buf, 2, TEST_RAW_CHUNK, AOA_RAW_CODING_DELTA, &format, packed);
+    AOA_TEST_ASSERT(format.sampleBits == 16, "trial %u: %u bits", trial, format.sampleBits);
+    if (!AOA_TEST_ASSERT(AOA_rawUnpack(packed, len, TEST_RAW_CHUNK, &format, unpacked), "trial %u", trial))
+    {
+      continue;
+    }
+
+    for (uint16_t k = 0; k < TEST_RAW_CHUNK; k++)
+    {
+      AOA_TEST_ASSERT(unpacked[2 * k] == buf[k].i, "trial %u sample %u: %d vs %d", trial, k, unpacked[2 * k], buf[k].i);
+      AOA_TEST_ASSERT(unpacked[2 * k + 1] == buf[k].q, "trial %u sample %u: %d vs %d", trial, k, unpacked[2 * k + 1], buf[k].q);
+    }
+  }
+
+  printf("raw pack: %u errors\n", AoaTest_numFailed());
+}
@@ -0,0 +1,174 @@
+/******************************************************************************
+
+ @file  test_AOA_report.c
+
+ @brief Self checks of AOA_report.
+
+        Fusing a window of CTEs on hopping channels must average out the
+        multipath error of each channel, and a tag at rest must be reported
+        an order of magnitude less often than it sends CTEs.
+
+ *****************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "AOA_report.h"
+#include "aoa_test.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Channels a connection hops over
+#define TEST_NUM_DATA_CHANNELS     37
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+
+// Result fusion over hopping channels and reporting on change
+void AoaTest_report(void)
+{
+  AoA_ReportParams_t params;
+  AoA_ReportResult_t fused;
+  AoA_Report_t report;
+  double channelBias[TEST_NUM_DATA_CHANNELS];
+
+  srand(17);
+
+  // The default parameters hand on every CTE as it is
+  AOA_reportDefaultParams(&params);
+  AOA_reportReset(&report);
+  for (uint32_t k = 0; k < 1000; k++)
+  {
+    const int16_t angle = (int16_t)(rand() % 360 - 180);
+    const int16_t elevation = (int16_t)(rand() % 181 - 90);
+    const int8_t rssi = (int8_t)(-(rand() % 100));
+
+    if (!AOA_TEST_ASSERT(AOA_reportUpdate(&report, &params, angle, elevation, rssi, -180, &fused), "CTE %u", k))
+    {
+      continue;
+    }
+
+    AOA_TEST_ASSERT(fused.angle == angle, "CTE %u: %d vs %d", k, fused.angle, angle);
+    AOA_TEST_ASSERT(fused.elevation == elevation, "CTE %u: %d vs %d", k, fused.elevation, elevation);
+    AOA_TEST_ASSERT(fused.rssi == rssi, "CTE %u: %d vs %d", k, fused.rssi, rssi);
+    AOA_TEST_ASSERT(fused.numCtes == 1, "CTE %u: %u", k, fused.numCtes);
+  }
+
+  // Angles on both sides of the seam average to it, not to 0
+  params.window = 2;
+  AOA_reportReset(&report);
+  AOA_reportUpdate(&report, &params, 179, 0, -50, -180, &fused);
+  if (AOA_TEST_ASSERT(AOA_reportUpdate(&report, &params, -179, 0, -50, -180, &fused)))
+  {
+    AOA_TEST_ASSERT(fused.angle == -180, "179 and -179 fused to %d", fused.angle);
+  }
+
+  // Azimuths alternating across their seam fuse to it and stay in the azimuth range
+  params.window = 4;
+  AOA_reportReset(&report);
+  for (uint32_t k = 0; k < 40; k++)
+  {
+    const int16_t angle = (k & 1) ? AOA_AZIMUTH_MIN + 359 : AOA_AZIMUTH_MIN + 1;
+
+    if (AOA_reportUpdate(&report, &params, angle, 0, -50, AOA_AZIMUTH_MIN, &fused))
+    {
+      AOA_TEST_ASSERT((fused.angle >= AOA_AZIMUTH_MIN) && (fused.angle < AOA_AZIMUTH_MIN + 360), "CTE %u: %d", k, fused.angle);
+      AOA_TEST_ASSERT(fused.angle == AOA_AZIMUTH_MIN, "CTE %u: %d", k, fused.angle);
+    }
+  }
+
+  // A window of no CTEs and changes beyond half a turn are refused
+  params.window = 0;
+  AOA_TEST_ASSERT(!AOA_reportCheckParams(&params), "window 0");
+  params.window = 8;
+  params.minChange = 181;
+  AOA_TEST_ASSERT(!AOA_reportCheckParams(&params), "minChange 181");
+
+  // Every channel sees its own multipath error of up to +-6 degrees, every CTE +-2 degrees of noise
+  for (uint32_t ch = 0; ch < TEST_NUM_DATA_CHANNELS; ch++)
+  {
+    channelBias[ch] = (rand() % 1201 - 600) / 100.0;
+  }
+
+  // Tags at rest and tags moving by 0.025 degrees per CTE, from -40 to 60 degrees.
+  // The channel hops by 7 per CTE, a window of 8 CTEs sees 8 channels.
+  for (uint32_t motion = 0; motion < 2; motion++)
+  {
+    const char *pName = motion ? "moving" : "at rest";
+    const double rate = motion ? 0.025 : 0;
+    const uint32_t numCtes = 4000;
+    double cteSumSq = 0, fusedSumSq = 0;
+    uint32_t numFused = 0, numChanged = 0;
+
+    params.window = 8;
+
+    // Every window sent, then only the windows that moved by 3 degrees, and at least every 11th
+    for (uint32_t gate = 0; gate < 2; gate++)
+    {
+      uint8_t ch = 0;
+
+      params.minChange = gate ? 3 : 0;
+      params.maxHold = gate ? 10 : 0;
+      AOA_reportReset(&report);
+
+      for (uint32_t k = 0; k < numCtes; k++)
+      {
+        const double truth = (motion ? -40 : 20) + rate * k;
+        const int16_t angle = (int16_t)lround(truth + channelBias[ch] + (rand() % 5 - 2));
+
+        ch = (ch + 7) % TEST_NUM_DATA_CHANNELS;
+
+        if (!gate)
+        {
+          cteSumSq += (angle - truth) * (angle - truth);
+        }
+
+        if (!AOA_reportUpdate(&report, &params, angle, 0, -60, -180, &fused))
+        {
+          continue;
+        }
+
+        // A fused result stands for the middle of its window
+        if (!gate)
+        {
+          const double err = fused.angle - (truth - rate * (params.window - 1) / 2.0);
+
+          fusedSumSq += err * err;
+          numFused++;
+        }
+        else
+        {
+          numChanged++;
+        }
+      }
+    }
+
+    printf("report %s: rmse per CTE %.2f fused %.2f, %u CTEs sent as %u results, %u on change\n",
+           pName, sqrt(cteSumSq / numCtes), sqrt(fusedSumSq / numFused), numCtes, numFused, numChanged);
+
+    // One result per window with at most half the error of a CTE. A tag at rest must cut the
+    // traffic tenfold, a moving one must still be reported about every time it moved by minChange.
+    AOA_TEST_ASSERT(numFused == numCtes / params.window, "%s: %u results of %u CTEs", pName, numFused, numCtes);
+    AOA_TEST_ASSERT(fusedSumSq / numFused <= 0.25 * cteSumSq / numCtes, "%s: rmse fused %.2f per CTE %.2f",
+                    pName, sqrt(fusedSumSq / numFused), sqrt(cteSumSq / numCtes));
+    if (!motion)
+    {
+      AOA_TEST_ASSERT(numChanged * 10 <= numCtes, "%s: %u of %u CTEs reported on change", pName, numChanged, numCtes);
+    }
+    else
+    {
+      AOA_TEST_ASSERT(numChanged >= (uint32_t)(0.8 * rate * numCtes / params.minChange), "%s: %u of %u CTEs reported on change",
+                      pName, numChanged, numCtes);
+    }
+  }
+
+  printf("report: %u errors\n", AoaTest_numFailed());
+}
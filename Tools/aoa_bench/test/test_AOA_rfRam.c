@@ -0,0 +1,287 @@
+/******************************************************************************
+
+ @file  test_AOA_rfRam.c
+
+ @brief Self checks of AOA_rfRam.
+
+        AOA_rfRamRead must read RTLS Passive captures out of a simulated
+        RF RAM once the RF core is done writing them, retry rather than
+        spin while it is busy, report every read exactly once and give up
+        reads the RF callback never finishes, leaving their buffer alone.
+        The late callback of a given up read must not copy its capture
+        into the buffer of the read armed after it.
+        While a capture is held the next ones must be read into the other
+        ping-pong buffers and handed over oldest first, and a capture that
+        finds every buffer held must be dropped rather than overwrite one.
+
+ *****************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "rf_hal.h"
+#include "AOA.h"
+#include "AOA_rfRam.h"
+#include "aoa_test.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// Simulated RF RAM registers, as AOA_rfRam reads them
+#define TEST_RF_RAM_DATA_RFE       0xC000
+#define TEST_RF_RAM_LAST_CAPTURE   0x19
+#define TEST_RF_RAM_STATE_MCE      0x1C
+#define TEST_RF_RAM_STATE_RFE      0x20
+
+#define TEST_RF_RAM_TIMEOUT        100
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// RF RAM reads that ended, as AOA_rfRamRead reports them
+static uint32_t testRfRamNumDone;
+
+/*********************************************************************
+ * LOCAL FUNCTIONS
+ */
+
+static void Test_rfRamDone(void)
+{
+  testRfRamNumDone++;
+}
+
+// Have the simulated RF core leave a capture in RF RAM
+static void Test_rfRamCapture(uint8_t lastCapture, uint8_t state, uint8_t fill)
+{
+  gAoaBenchRfRam[TEST_RF_RAM_LAST_CAPTURE] = lastCapture;
+  gAoaBenchRfRam[TEST_RF_RAM_STATE_MCE] = (lastCapture == 0x00) ? state : 0;
+  gAoaBenchRfRam[TEST_RF_RAM_STATE_RFE] = (lastCapture == 0x01) ? state : 0;
+  memset(&gAoaBenchRfRam[TEST_RF_RAM_DATA_RFE], fill, AOA_RES_MAX_SIZE * sizeof(AoA_IQSample_Ext_t));
+}
+
+// TRUE if RF RAM was released for the next CTE
+static bool Test_rfRamReleased(void)
+{
+  return (gAoaBenchRfRam[TEST_RF_RAM_STATE_MCE] == 0) && (gAoaBenchRfRam[TEST_RF_RAM_STATE_RFE] == 0);
+}
+
+// TRUE if every byte of a capture is fill
+static bool Test_rfRamHolds(const AoA_IQSample_Ext_t *pBuf, uint8_t fill)
+{
+  const uint8_t *pBytes = (const uint8_t *)pBuf;
+
+  return (pBytes[0] == fill) && !memcmp(pBytes, pBytes + 1, AOA_RES_MAX_SIZE * sizeof(AoA_IQSample_Ext_t) - 1);
+}
+
+// Issue an RF RAM command for a read and have it done, as AOA_rfEnableRam and
+// AOA_getRfIqSamples do, returns TRUE if the command is to be issued again
+static bool Test_rfRamCommand(uint8_t *pSeq)
+{
+  return AOA_rfRamIssue(*pSeq) && AOA_rfRamRead(pSeq);
+}
+
+// Take the capture AOA_rfRamCheck hands over at now, it must be the one of buffer index holding fill
+static void Test_rfRamTake(uint32_t now, uint8_t index, uint8_t fill)
+{
+  uint32_t wait;
+  uint8_t taken = AOA_RF_RAM_NO_BUF;
+
+  if (!AOA_TEST_ASSERT(AOA_rfRamCheck(now, TEST_RF_RAM_TIMEOUT, &wait, &taken) == SAMPLES_READY, "at %u", now) ||
+      !AOA_TEST_ASSERT(taken == index, "at %u: buffer %u, armed %u", now, taken, index))
+  {
+    return;
+  }
+
+  AOA_TEST_ASSERT(Test_rfRamHolds(AOA_rfRamGetBuf(taken), fill), "at %u: buffer %u not 0x%02X", now, taken, fill);
+  AOA_TEST_ASSERT(AOA_rfRamRelease(taken), "at %u: buffer %u", now, taken);
+}
+
+// The state AOA_rfRamCheck reports at now
+static uint8_t Test_rfRamState(uint32_t now, uint32_t *pWait)
+{
+  uint32_t wait;
+  uint8_t taken;
+
+  return AOA_rfRamCheck(now, TEST_RF_RAM_TIMEOUT, (pWait != NULL) ? pWait : &wait, &taken);
+}
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+
+// Read captures out of a simulated RF RAM as the RTLS Passive RF callback and RTLS Control do
+void AoaTest_rfRam(void)
+{
+  static AoA_IQSample_Ext_t bufs[AOA_RF_RAM_NUM_BUFS][AOA_RES_MAX_SIZE];
+  uint32_t wait = 0;
+  uint32_t numRetries;
+  uint8_t order[AOA_RF_RAM_NUM_BUFS];
+  uint8_t index;
+  uint8_t seq;
+  uint8_t staleSeq;
+
+  memset(bufs, 0, sizeof(bufs));
+  AOA_rfRamInit(&bufs[0][0], Test_rfRamDone);
+
+  // A capture ready in RFE RAM, and one still being written for a few commands
+  for (uint32_t busy = 0; busy <= AOA_RF_RAM_MAX_RETRIES; busy++)
+  {
+    testRfRamNumDone = 0;
+    Test_rfRamCapture(0x01, (busy == 0) ? 0x03 : ((busy & 1) ? 0x02 : 0x01), 0x5A);
+    index = AOA_rfRamArm(1000, &seq);
+    AOA_TEST_ASSERT(index < AOA_RF_RAM_NUM_BUFS, "busy %u", busy);
+
+    for (numRetries = 0; Test_rfRamCommand(&seq); numRetries++)
+    {
+      AOA_TEST_ASSERT(testRfRamNumDone == 0, "busy %u retry %u", busy, numRetries);
+      AOA_TEST_ASSERT(Test_rfRamState(1001, &wait) == SAMPLES_NOT_READY, "busy %u retry %u", busy, numRetries);
+      AOA_TEST_ASSERT(wait == TEST_RF_RAM_TIMEOUT - 1, "busy %u retry %u: wait %u", busy, numRetries, wait);
+      AOA_TEST_ASSERT(AOA_rfRamArm(1001, &staleSeq) == AOA_RF_RAM_NO_BUF, "busy %u retry %u", busy, numRetries);
+      if (numRetries + 1 == busy)
+      {
+        gAoaBenchRfRam[TEST_RF_RAM_STATE_RFE] = (busy & 1) ? 0x04 : 0x03;
+      }
+    }
+
+    AOA_TEST_ASSERT(numRetries == busy, "busy %u: %u retries", busy, numRetries);
+    AOA_TEST_ASSERT(testRfRamNumDone == 1, "busy %u: %u done", busy, testRfRamNumDone);
+    AOA_TEST_ASSERT(Test_rfRamReleased(), "busy %u", busy);
+    Test_rfRamTake(1002, index, 0x5A);
+    memset(bufs, 0, sizeof(bufs));
+  }
+
+  // Busy for good, no capture and a capture across both RAMs are not read
+  for (uint8_t lastCapture = 0; lastCapture < 3; lastCapture++)
+  {
+    testRfRamNumDone = 0;
+    Test_rfRamCapture((lastCapture == 0) ? 0x01 : ((lastCapture == 1) ? 0xFF : 0x00), (lastCapture == 0) ? 0x01 : 0x03, 0x33);
+    index = AOA_rfRamArm(1000, &seq);
+
+    for (numRetries = 0; Test_rfRamCommand(&seq) && (numRetries <= AOA_RF_RAM_MAX_RETRIES); numRetries++);
+
+    AOA_TEST_ASSERT(index < AOA_RF_RAM_NUM_BUFS, "case %u", lastCapture);
+    AOA_TEST_ASSERT(numRetries == ((lastCapture == 0) ? AOA_RF_RAM_MAX_RETRIES : 0), "case %u: %u retries", lastCapture, numRetries);
+    AOA_TEST_ASSERT(testRfRamNumDone == 1, "case %u: %u done", lastCapture, testRfRamNumDone);
+    AOA_TEST_ASSERT(Test_rfRamReleased(), "case %u", lastCapture);
+    AOA_TEST_ASSERT(Test_rfRamHolds(bufs[0], 0), "case %u", lastCapture);
+    AOA_TEST_ASSERT(Test_rfRamState(1001, NULL) == SAMPLES_NOT_VALID, "case %u", lastCapture);
+  }
+
+  // The RF RAM command failed
+  testRfRamNumDone = 0;
+  index = AOA_rfRamArm(1000, &seq);
+  AOA_rfRamIssue(seq);
+  AOA_rfRamFail();
+  AOA_TEST_ASSERT(index < AOA_RF_RAM_NUM_BUFS);
+  AOA_TEST_ASSERT(testRfRamNumDone == 1, "%u done", testRfRamNumDone);
+  AOA_TEST_ASSERT(Test_rfRamState(1001, NULL) == SAMPLES_NOT_VALID);
+
+  // Ping-pong: the next captures are read into the other buffers while the first one is held,
+  // then a capture finds no free buffer until the first one is released for good
+  for (uint8_t k = 0; k < AOA_RF_RAM_NUM_BUFS; k++)
+  {
+    Test_rfRamCapture(0x01, 0x03, 0x10 + k);
+    order[k] = AOA_rfRamArm(1000, &seq);
+    AOA_TEST_ASSERT(order[k] < AOA_RF_RAM_NUM_BUFS, "capture %u", k);
+    AOA_TEST_ASSERT(!Test_rfRamCommand(&seq), "capture %u", k);
+
+    if (k == 0)
+    {
+      uint8_t taken = AOA_RF_RAM_NO_BUF;
+
+      AOA_TEST_ASSERT(AOA_rfRamCheck(1001, TEST_RF_RAM_TIMEOUT, &wait, &taken) == SAMPLES_READY);
+      AOA_TEST_ASSERT(taken == order[0], "buffer %u, armed %u", taken, order[0]);
+      AOA_TEST_ASSERT(AOA_rfRamRetain(taken));
+    }
+  }
+
+  for (uint8_t k = 1; k < AOA_RF_RAM_NUM_BUFS; k++)
+  {
+    AOA_TEST_ASSERT(order[k] != order[0], "capture %u", k);
+    AOA_TEST_ASSERT(order[k] != order[k - 1], "capture %u", k);
+  }
+
+  AOA_TEST_ASSERT((order[0] < AOA_RF_RAM_NUM_BUFS) && Test_rfRamHolds(AOA_rfRamGetBuf(order[0]), 0x10));
+  AOA_TEST_ASSERT(AOA_rfRamArm(1002, &seq) == AOA_RF_RAM_NO_BUF, "every buffer held");
+  AOA_TEST_ASSERT(AOA_rfRamRelease(order[0]));
+  AOA_TEST_ASSERT(AOA_rfRamArm(1002, &seq) == AOA_RF_RAM_NO_BUF, "buffer %u still retained", order[0]);
+  AOA_TEST_ASSERT(AOA_rfRamRelease(order[0]));
+  AOA_TEST_ASSERT(!AOA_rfRamRelease(order[0]), "released twice");
+  AOA_TEST_ASSERT(!AOA_rfRamRetain(order[0]), "retained once free");
+  AOA_TEST_ASSERT(AOA_rfRamArm(1002, &seq) == order[0]);
+  AOA_rfRamIssue(seq);
+  AOA_rfRamFail();
+
+  // Captures are taken oldest first, each one as it was read
+  for (uint8_t k = 1; k < AOA_RF_RAM_NUM_BUFS; k++)
+  {
+    Test_rfRamTake(1003, order[k], 0x10 + k);
+  }
+  AOA_TEST_ASSERT(Test_rfRamState(1003, NULL) == SAMPLES_NOT_VALID);
+  AOA_TEST_ASSERT(!AOA_rfRamRelease(AOA_RF_RAM_NO_BUF));
+
+  // The RF callback never comes in time, across a wrap of the tick counter. The late
+  // callback must release RF RAM, leave the buffer alone and not report the read again
+  memset(bufs, 0, sizeof(bufs));
+  testRfRamNumDone = 0;
+  index = AOA_rfRamArm(UINT32_MAX - 10, &seq);
+  AOA_TEST_ASSERT(index < AOA_RF_RAM_NUM_BUFS);
+  AOA_TEST_ASSERT(AOA_rfRamIssue(seq));
+  AOA_TEST_ASSERT(Test_rfRamState(UINT32_MAX, &wait) == SAMPLES_NOT_READY);
+  AOA_TEST_ASSERT(wait == TEST_RF_RAM_TIMEOUT - 10, "wait %u", wait);
+  AOA_TEST_ASSERT(Test_rfRamState(TEST_RF_RAM_TIMEOUT - 12, &wait) == SAMPLES_NOT_READY, "after the wrap");
+  AOA_TEST_ASSERT(wait == 1, "wait %u", wait);
+  AOA_TEST_ASSERT(Test_rfRamState(TEST_RF_RAM_TIMEOUT - 11, NULL) == SAMPLES_NOT_VALID, "timed out");
+  Test_rfRamCapture(0x01, 0x03, 0x77);
+  AOA_TEST_ASSERT(!AOA_rfRamRead(&seq), "late callback");
+  AOA_TEST_ASSERT(testRfRamNumDone == 0, "%u done", testRfRamNumDone);
+  AOA_TEST_ASSERT(Test_rfRamReleased());
+  AOA_TEST_ASSERT(Test_rfRamHolds(bufs[index % AOA_RF_RAM_NUM_BUFS], 0), "buffer %u written", index);
+  AOA_TEST_ASSERT(Test_rfRamState(TEST_RF_RAM_TIMEOUT, NULL) == SAMPLES_NOT_VALID);
+
+  // The next connection event arms a read before the late callback of the given up one
+  // comes: the stale capture must not be copied into the new buffer, the capture of the
+  // new event is read once RF RAM was released
+  memset(bufs, 0, sizeof(bufs));
+  testRfRamNumDone = 0;
+  AOA_rfRamArm(2000, &staleSeq);
+  AOA_TEST_ASSERT(AOA_rfRamIssue(staleSeq));
+  AOA_TEST_ASSERT(Test_rfRamState(2000 + TEST_RF_RAM_TIMEOUT, NULL) == SAMPLES_NOT_VALID, "timed out");
+  index = AOA_rfRamArm(2001, &seq);
+  AOA_TEST_ASSERT(index < AOA_RF_RAM_NUM_BUFS);
+  AOA_TEST_ASSERT(seq != staleSeq, "seq %u", seq);
+  AOA_TEST_ASSERT(AOA_rfRamIssue(seq));
+  Test_rfRamCapture(0x01, 0x03, 0x77);
+  AOA_TEST_ASSERT(!AOA_rfRamRead(&staleSeq), "late callback");
+  AOA_TEST_ASSERT(testRfRamNumDone == 0, "%u done", testRfRamNumDone);
+  AOA_TEST_ASSERT(Test_rfRamReleased());
+  AOA_TEST_ASSERT(Test_rfRamHolds(bufs[0], 0), "stale capture copied");
+  AOA_TEST_ASSERT(Test_rfRamState(2002, NULL) == SAMPLES_NOT_READY);
+  Test_rfRamCapture(0x01, 0x03, 0x88);
+  AOA_TEST_ASSERT(!AOA_rfRamRead(&seq));
+  AOA_TEST_ASSERT(testRfRamNumDone == 1, "%u done", testRfRamNumDone);
+  Test_rfRamTake(2003, index, 0x88);
+
+  // A late failure of the given up read is ignored as well
+  testRfRamNumDone = 0;
+  AOA_rfRamArm(3000, &staleSeq);
+  AOA_TEST_ASSERT(AOA_rfRamIssue(staleSeq));
+  AOA_TEST_ASSERT(Test_rfRamState(3000 + TEST_RF_RAM_TIMEOUT, NULL) == SAMPLES_NOT_VALID, "timed out");
+  index = AOA_rfRamArm(3001, &seq);
+  AOA_TEST_ASSERT(AOA_rfRamIssue(seq));
+  AOA_rfRamFail();
+  AOA_TEST_ASSERT(testRfRamNumDone == 0, "%u done", testRfRamNumDone);
+  AOA_TEST_ASSERT(Test_rfRamState(3002, NULL) == SAMPLES_NOT_READY);
+  Test_rfRamCapture(0x01, 0x03, 0x99);
+  AOA_TEST_ASSERT(!AOA_rfRamRead(&seq));
+  AOA_TEST_ASSERT(testRfRamNumDone == 1, "%u done", testRfRamNumDone);
+  Test_rfRamTake(3003, index, 0x99);
+
+  printf("rf ram: %u buffers, %u errors\n", AOA_RF_RAM_NUM_BUFS, AoaTest_numFailed());
+}
@@ -0,0 +1,173 @@
+/******************************************************************************
+
+ @file  test_AOA_spectrum.c
+
+ @brief Self checks of AOA_spectrum.
+
+        Both spectrum estimators and AOA_getArrayAngle must find the angle
+        of synthetic captures of the BOOSTXL-AOA array and of runtime
+        arrays, with carrier frequency offsets up to +-150 kHz and 16 bit
+        captures up to full scale.
+
+ *****************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "AOA.h"
+#include "AOA_spectrum.h"
+#include "aoa_synth.h"
+#include "aoa_test.h"
+
+/*********************************************************************
+ * CONSTANTS
+ */
+
+// A tag close to the array, sample products reach 2^31
+#define TEST_AMPLITUDE_FULL_SCALE  32000.0
+#define TEST_SPECTRUM_MAX_ERR      2
+// Pair angle errors grow through asin towards endfire, 1 / cos(60) = 2x at 60 deg
+#define TEST_ARRAY_MAX_ERR         4
+
+/*********************************************************************
+ * LOCAL VARIABLES
+ */
+
+// Steering table of the array under test
+static AoA_Steer_t testSteer[AOA_SPECTRUM_NUM_BINS * AOA_MAX_NUM_ANT];
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+
+// Both spectrum estimators on synthetic captures of every configuration
+void AoaTest_spectrum(void)
+{
+  static const double angles[] = {-60.0, -35.0, -10.0, 0.0, 20.0, 45.0};
+  static const AoA_SpectrumMethod_t methods[] = {AOA_SPECTRUM_BARTLETT, AOA_SPECTRUM_MVDR};
+  static const AoA_AvgMode_t avgModes[] = {AOA_AVG_MODE_ANGLE, AOA_AVG_MODE_PHASOR};
+  // Transmitter offsets up to the +-150 kHz BLE allows
+  static const double cfos[] = {0.0, -150.0, 60.0, 150.0};
+  // 0 is the BOOSTXL-AOA array 1, others are runtime arrays of that many elements
+  static const uint8_t arrays[] = {0, 4, 8, 16};
+  // 16 bit captures of a distant and of a near tag
+  static const double amplitudes16[] = {AOA_TEST_AMPLITUDE_16BIT, TEST_AMPLITUDE_FULL_SCALE};
+  static int16_t buf[AOA_SYNTH_MAX_IQ_SAMPLES * 2];
+  static int16_t pairAngle[AOA_MAX_NUM_PAIRS];
+  AoA_AntennaResult_t antResult = {.pairAngle = pairAngle};
+  AoA_SpectrumResult_t result;
+  uint32_t numCaptures = 0;
+
+  for (uint32_t arr = 0; arr < sizeof(arrays) / sizeof(arrays[0]); arr++)
+  {
+    AoA_AntennaConfig_t *antConfig = AoaTest_getArray(arrays[arr]);
+    AoA_Covariance_t *pCov = AoaTest_allocCov(antConfig->numElements);
+    AoA_Covariance_t *pWork = AoaTest_allocCov(antConfig->numElements);
+    const uint8_t numAnt = antConfig->numAntennas;
+
+    AOA_spectrumInit(antConfig, testSteer);
+    AOA_selectKernel(0, 0, 0, 0);
+
+    for (uint8_t sampleRate = 1; sampleRate <= 4; sampleRate++)
+    {
+      // Size 3 is a full scale 16 bit capture
+      for (uint8_t sizeIdx = 1; sizeIdx <= 3; sizeIdx++)
+      {
+        const uint8_t sampleSize = (sizeIdx == 1) ? 1 : 2;
+
+        for (uint8_t slotDuration = 1; slotDuration <= 2; slotDuration++)
+        {
+          for (uint8_t cteLength = 2; cteLength <= 20; cteLength++)
+          {
+            aoaSynthParams_t synth = {0};
+
+            synth.sampleRate = sampleRate;
+            synth.sampleSize = sampleSize;
+            synth.slotDuration = slotDuration;
+            synth.numAnt = numAnt;
+            synth.numIqSamples = AoaSynth_numIqSamples(cteLength, slotDuration, sampleRate);
+            synth.amplitude = (sampleSize == 1) ? AOA_TEST_AMPLITUDE_8BIT : amplitudes16[sizeIdx - 2];
+            synth.spacingWl = arrays[arr] ? AOA_TEST_ARRAY_SPACING : BOOSTXL_AOA_ANT_SPACING;
+            synth.cfoKHz = 0;
+
+            if (AoaSynth_numReps(synth.numIqSamples, sampleRate, numAnt) < AOA_TEST_MIN_REPS)
+            {
+              continue;
+            }
+
+            for (uint32_t n = 0; n < sizeof(angles) / sizeof(angles[0]) * sizeof(cfos) / sizeof(cfos[0]); n++)
+            {
+              const double angle = angles[n % (sizeof(angles) / sizeof(angles[0]))];
+              uint8_t size = sampleSize;
+
+              synth.angleDeg = angle;
+              synth.cfoKHz = cfos[n / (sizeof(angles) / sizeof(angles[0]))];
+              AoaSynth_generate(&synth, (int8_t *)buf);
+
+              // As RTLSCtrl_postProcessAoa hands the capture over
+              AOA_normalizeSamples((int8_t *)buf, synth.numIqSamples, &size);
+
+              if (!AOA_TEST_ASSERT(AOA_getCovariance(antConfig, pCov, synth.numIqSamples, sampleRate, size, slotDuration, numAnt, (int8_t *)buf),
+                                   "ant %u rate %u size %u slot %u cte %u", numAnt, sampleRate, sampleSize, slotDuration, cteLength))
+              {
+                continue;
+              }
+
+              for (uint32_t m = 0; m < sizeof(methods) / sizeof(methods[0]); m++)
+              {
+                const char *pName = (methods[m] == AOA_SPECTRUM_MVDR) ? "mvdr" : "bartlett";
+
+                AOA_spectrumSetMethod(methods[m]);
+
+                if (AOA_TEST_ASSERT(AOA_spectrumScan(pCov, pWork, &result), "%s ant %u rate %u size %u slot %u cte %u",
+                                    pName, numAnt, sampleRate, sampleSize, slotDuration, cteLength))
+                {
+                  AOA_TEST_ASSERT(fabs(result.angle - angle) <= TEST_SPECTRUM_MAX_ERR,
+                                  "%s ant %u rate %u size %u amp %.0f slot %u cte %u cfo %.0f: %d deg, expected %.0f",
+                                  pName, numAnt, sampleRate, sampleSize, synth.amplitude, slotDuration, cteLength, synth.cfoKHz, result.angle, angle);
+                }
+                numCaptures++;
+              }
+
+              // The BOOSTXL-AOA boards map pair angles through their own calibration
+              if (arrays[arr] == 0)
+              {
+                continue;
+              }
+
+              for (uint32_t m = 0; m < sizeof(avgModes) / sizeof(avgModes[0]); m++)
+              {
+                const char *pName = (avgModes[m] == AOA_AVG_MODE_PHASOR) ? "phasor" : "angle";
+                int16_t arrayAngle;
+
+                AOA_setAvgMode(avgModes[m]);
+                AOA_getPairAngles(antConfig, &antResult, synth.numIqSamples, sampleRate, size, slotDuration, numAnt, (int8_t *)buf);
+
+                if (AOA_TEST_ASSERT(AOA_getArrayAngle(antConfig, &antResult, &arrayAngle), "array %s ant %u rate %u size %u slot %u cte %u",
+                                    pName, numAnt, sampleRate, sampleSize, slotDuration, cteLength))
+                {
+                  AOA_TEST_ASSERT(fabs(arrayAngle - angle) <= TEST_ARRAY_MAX_ERR,
+                                  "array %s ant %u rate %u size %u amp %.0f slot %u cte %u cfo %.0f: %d deg, expected %.0f",
+                                  pName, numAnt, sampleRate, sampleSize, synth.amplitude, slotDuration, cteLength, synth.cfoKHz, arrayAngle, angle);
+                }
+                numCaptures++;
+              }
+            }
+          }
+        }
+      }
+    }
+
+    free(pCov);
+    free(pWork);
+  }
+
+  AOA_setAvgMode(AOA_AVG_MODE_ANGLE);
+  AOA_spectrumSetMethod(AOA_SPECTRUM_METHOD_DEFAULT);
+  printf("spectrum: %u estimates, %u misses\n", numCaptures, AoaTest_numFailed());
+}
@@ -0,0 +1,177 @@
+/******************************************************************************
+
+ @file  test_AOA_track.c
+
+ @brief Self checks of AOA_track.
+
+        The moving average tracker must match the legacy window sum, the
+        alpha-beta and Kalman trackers must follow a moving tag without
+        lag, and every tracker must smooth the angles it is fed. Circular
+        trackers must keep azimuths across the seam of their range together.
+
+ *****************************************************************************/
+
+/*********************************************************************
+ * INCLUDES
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "AOA.h"
+#include "AOA_track.h"
+#include "aoa_test.h"
+
+/*********************************************************************
+ * API FUNCTIONS
+ */
+
+// Compare the moving average tracker with the legacy window sum and check that the
+// alpha-beta and Kalman trackers follow a moving tag
+void AoaTest_track(void)
+{
+  static const char *names[] = {"moving avg", "alpha-beta", "kalman"};
+  AoA_TrackParams_t params[3];
+  AoA_TrackParams_t bad;
+  AoA_Track_t track;
+
+  srand(5);
+
+  // Running sum against the re-summed window of the legacy RTLSCtrl_estimateAngle
+  for (uint8_t window = 1; window <= AOA_TRACK_MAX_WINDOW; window++)
+  {
+    int16_t array[AOA_TRACK_MAX_WINDOW];
+    uint8_t idx = 0, numEntries = 0;
+
+    AOA_trackDefaultParams(&params[0]);
+    params[0].window = window;
+    AOA_TEST_ASSERT(AOA_trackInit(&track, &params[0]), "window %u", window);
+
+    for (uint32_t k = 0; k < 1000; k++)
+    {
+      const int16_t angle = (int16_t)(rand() % 361 - 180);
+      int32_t sum = 0;
+      int16_t tracked;
+
+      array[idx] = angle;
+      numEntries = (numEntries < window) ? numEntries + 1 : window;
+      idx = (idx >= window - 1) ? 0 : idx + 1;
+      for (uint8_t i = 0; i < numEntries; i++)
+      {
+        sum += array[i];
+      }
+
+      tracked = AOA_trackUpdate(&track, angle);
+      AOA_TEST_ASSERT(tracked == sum / numEntries, "window %u step %u: %d vs %d", window, k, tracked, sum / numEntries);
+    }
+  }
+
+  // Parameters out of range leave the tracker untouched
+  AOA_trackDefaultParams(&bad);
+  bad.window = AOA_TRACK_MAX_WINDOW + 1;
+  AOA_TEST_ASSERT(!AOA_trackInit(&track, &bad), "moving avg window %u", bad.window);
+  bad.type = AOA_TRACK_ALPHA_BETA;
+  AOA_TEST_ASSERT(!AOA_trackInit(&track, &bad), "alpha-beta without gains");
+  bad.type = AOA_TRACK_KALMAN;
+  AOA_TEST_ASSERT(!AOA_trackInit(&track, &bad), "kalman without variances");
+  bad.type = AOA_TRACK_KALMAN + 1;
+  AOA_TEST_ASSERT(!AOA_trackInit(&track, &bad), "type %u", bad.type);
+
+  AOA_trackDefaultParams(&params[0]);
+  memset(&params[1], 0, sizeof(params[1]));
+  params[1].type = AOA_TRACK_ALPHA_BETA;
+  params[1].alpha = AOA_TRACK_GAIN_ONE / 2;
+  params[1].beta = AOA_TRACK_GAIN_ONE / 10;
+  memset(&params[2], 0, sizeof(params[2]));
+  params[2].type = AOA_TRACK_KALMAN;
+  params[2].measVar = 9;
+  params[2].accelVar = 64;
+
+  // Tags at rest and tags moving by half a degree per CTE, +-5 degrees of noise.
+  // The first 50 CTEs settle the filters.
+  for (uint32_t motion = 0; motion < 2; motion++)
+  {
+    const double rate = motion ? 0.5 : 0;
+    double rawSumSq = 0;
+
+    for (uint32_t f = 0; f < 3; f++)
+    {
+      double sum = 0, sumSq = 0;
+      uint32_t num = 0;
+
+      // Eight tags, so the noise averages out of the bias
+      for (uint32_t run = 0; run < 8; run++)
+      {
+        srand(11 + run);
+        AOA_TEST_ASSERT(AOA_trackInit(&track, &params[f]), "%s", names[f]);
+
+        for (uint32_t k = 0; k < 250; k++)
+        {
+          const double truth = -60 + rate * k;
+          const int16_t angle = (int16_t)lround(truth + (rand() % 11 - 5));
+          const double err = AOA_trackUpdate(&track, angle) - truth;
+
+          if (k >= 50)
+          {
+            sum += err;
+            sumSq += err * err;
+            rawSumSq += (f == 0) ? (angle - truth) * (angle - truth) : 0;
+            num++;
+          }
+        }
+      }
+
+      printf("track %s %s: bias %.2f, rmse %.2f\n", motion ? "moving" : "at rest", names[f], sum / num, sqrt(sumSq / num));
+
+      // The moving average lags a moving tag, the velocity trackers must not, and every filter must smooth
+      AOA_TEST_ASSERT((f == 0) || (fabs(sum / num) <= 0.5), "%s %s: bias %.2f", motion ? "moving" : "at rest", names[f], sum / num);
+      AOA_TEST_ASSERT(sqrt(sumSq / num) < sqrt(rawSumSq / num), "%s %s: rmse %.2f, raw %.2f",
+                      motion ? "moving" : "at rest", names[f], sqrt(sumSq / num), sqrt(rawSumSq / num));
+    }
+  }
+
+  // Azimuths over the full circle: a tag on the seam, readings alternating across it, and a tag circling
+  // the board for three turns. Every filter must stay at the seam and follow the tag round it.
+  for (uint32_t f = 0; f < 3; f++)
+  {
+    int32_t maxSeamErr = 0, maxTurnErr = 0;
+
+    AOA_trackInit(&track, &params[f]);
+    for (uint32_t k = 0; k < 200; k++)
+    {
+      const int16_t angle = (k & 1) ? AOA_AZIMUTH_MIN + 358 : AOA_AZIMUTH_MIN + 1;
+      const int16_t tracked = AOA_trackUpdateCircular(&track, angle, AOA_AZIMUTH_MIN);
+      int32_t err = tracked - AOA_AZIMUTH_MIN;
+
+      // The seam lies between AOA_AZIMUTH_MIN + 359 and AOA_AZIMUTH_MIN, both are as close to it
+      err = (err > 180) ? 359 - err : err;
+      maxSeamErr = (err > maxSeamErr) ? err : maxSeamErr;
+      AOA_TEST_ASSERT((tracked >= AOA_AZIMUTH_MIN) && (tracked < AOA_AZIMUTH_MIN + 360), "%s seam step %u: %d", names[f], k, tracked);
+      AOA_TEST_ASSERT(err <= 2, "%s seam step %u: %d", names[f], k, tracked);
+    }
+
+    AOA_trackInit(&track, &params[f]);
+    for (uint32_t k = 0; k < 3 * 360; k++)
+    {
+      const int16_t truth = (int16_t)(AOA_AZIMUTH_MIN + (k % 360));
+      const int16_t tracked = AOA_trackUpdateCircular(&track, truth, AOA_AZIMUTH_MIN);
+      int32_t err = abs(tracked - truth);
+
+      err = (err > 180) ? 360 - err : err;
+      AOA_TEST_ASSERT((tracked >= AOA_AZIMUTH_MIN) && (tracked < AOA_AZIMUTH_MIN + 360), "%s circling step %u: %d", names[f], k, tracked);
+
+      // The moving average lags by half its window, the velocity trackers settle in a few CTEs
+      if (k >= 50)
+      {
+        maxTurnErr = (err > maxTurnErr) ? err : maxTurnErr;
+        AOA_TEST_ASSERT(err <= AOA_TRACK_DEFAULT_WINDOW / 2, "%s circling step %u: %d vs %d", names[f], k, tracked, truth);
+      }
+    }
+
+    printf("track circular %s: max error at the seam %d, circling %d\n", names[f], maxSeamErr, maxTurnErr);
+  }
+
+  printf("track: %u errors\n", AoaTest_numFailed());
+}